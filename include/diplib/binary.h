@@ -538,6 +538,58 @@ DIP_NODISCARD inline Image EuclideanSkeleton(
    return out;
 }
 
+/// \brief Binary skeleton through multithreaded subiteration thinning (2D and 3D only).
+///
+/// This algorithm iteratively removes simple points from the object boundary, in directional passes
+/// (first pixels whose neighbor along the negative x direction is background, then those with a background
+/// neighbor along the positive x direction, then along y, and, in 3D, along z). Each directional pass is
+/// further split into subfields, the sets of pixels whose coordinates all have the same parity. Pixels within
+/// one subfield are never neighbors of each other, so all the simple points within a subfield are removed
+/// in parallel, by as many threads as are available (see \ref dip::SetNumberOfThreads), with exactly the same
+/// result as removing them one at a time. The result is thus deterministic and doesn't depend on the number of
+/// threads used. Only pixels adjacent to the ones removed in the previous iteration are visited, so the
+/// cost is proportional to the size of the object boundary, not the size of the image.
+///
+/// As in \ref dip::EuclideanSkeleton, the object is 8-connected in 2D and 26-connected in 3D, and the background
+/// 4-connected in 2D and 6-connected in 3D. In 2D, the same Hilditch conditions are tested as in
+/// \ref dip::EuclideanSkeleton, and thus the topology guarantees are identical. In 3D, a pixel is removed only if
+/// it doesn't change the number of object components, background components or tunnels (i.e. it is a simple point).
+/// Contrary to \ref dip::EuclideanSkeleton, planes in 3D are always thinned down to lines. The skeleton is not
+/// guaranteed to be centered as well as that of \ref dip::EuclideanSkeleton, which uses quasi-Euclidean distances
+/// to determine the order in which pixels are removed.
+///
+/// The `endPixelCondition` parameter determines what is considered an "end pixel" in the skeleton, and thus affects
+/// how many branches are generated. It is one of the following strings:
+///
+/// - `"loose ends away"`: Loose ends are eaten away (nothing is considered an end point).
+/// - `"natural"`: Equal to `"one neighbor"`.
+/// - `"one neighbor"`: Keep endpoint if it has one neighbor.
+/// - `"two neighbors"`: Keep endpoint if it has two neighbors.
+/// - `"three neighbors"`: Keep endpoint if it has three neighbors.
+///
+/// The `edgeCondition` parameter specifies whether the border of the image should be treated as object (`"object"`)
+/// or as background (`"background"`). Contrary to \ref dip::EuclideanSkeleton, all pixels in the image are processed.
+///
+/// `iterations` limits the number of iterations (each one composed of all directional passes). If it is 0,
+/// the algorithm iterates until idempotency.
+DIP_EXPORT void SubiterationSkeleton(
+      Image const& in,
+      Image& out,
+      String const& endPixelCondition = S::NATURAL,
+      String const& edgeCondition = S::BACKGROUND,
+      dip::uint iterations = 0
+);
+DIP_NODISCARD inline Image SubiterationSkeleton(
+      Image const& in,
+      String const& endPixelCondition = S::NATURAL,
+      String const& edgeCondition = S::BACKGROUND,
+      dip::uint iterations = 0
+) {
+   Image out;
+   SubiterationSkeleton( in, out, endPixelCondition, edgeCondition, iterations );
+   return out;
+}
+
 /// \brief Counts the number of set neighbors for each pixel in the binary image `in`.
 ///
 /// Out will contain, for each set pixel, 1 + the number of neighbors that are also set. The neighborhood is
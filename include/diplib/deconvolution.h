@@ -72,6 +72,8 @@ namespace dip {
 /// The PSF (point spread function) should sum to one in order to preserve the mean image intensity.
 /// If the OTF (optical transfer function, the Fourier transform of the PSF) is known, it is possible to pass
 /// that as `psf`; add the string `"OTF"` to `options`.
+/// For the overload that takes `regularization`, the OTF must be conjugate symmetric (i.e. the Fourier
+/// transform of a real-valued PSF), as only its non-redundant half is used.
 ///
 /// All input images must be real-valued and scalar, except if the OFT is given instead of the PSF, in which
 /// case `psf` could be complex-valued.
@@ -155,6 +157,8 @@ DIP_NODISCARD inline Image WienerDeconvolution(
 /// The PSF (point spread function) should sum to one in order to preserve the mean image intensity.
 /// If the OTF (optical transfer function, the Fourier transform of the PSF) is known, it is possible to pass
 /// that as `psf`; add the string `"OTF"` to `options`.
+/// The OTF must be conjugate symmetric (i.e. the Fourier transform of a real-valued PSF), as only its
+/// non-redundant half is used.
 ///
 /// All input images must be real-valued and scalar, except if the OFT is given instead of the PSF, in which
 /// case `psf` could be complex-valued.
@@ -214,6 +218,8 @@ DIP_NODISCARD inline Image TikhonovMiller(
 /// The PSF (point spread function) should sum to one in order to preserve the mean image intensity.
 /// If the OTF (optical transfer function, the Fourier transform of the PSF) is known, it is possible to pass
 /// that as `psf`; add the string `"OTF"` to `options`.
+/// The OTF must be conjugate symmetric (i.e. the Fourier transform of a real-valued PSF), as only its
+/// non-redundant half is used.
 ///
 /// All input images must be real-valued and scalar, except if the OFT is given instead of the PSF, in which
 /// case `psf` could be complex-valued.
@@ -275,6 +281,8 @@ DIP_NODISCARD inline Image IterativeConstrainedTikhonovMiller(
 /// The PSF (point spread function) should sum to one in order to preserve the mean image intensity.
 /// If the OTF (optical transfer function, the Fourier transform of the PSF) is known, it is possible to pass
 /// that as `psf`; add the string `"OTF"` to `options`.
+/// The OTF must be conjugate symmetric (i.e. the Fourier transform of a real-valued PSF), as only its
+/// non-redundant half is used.
 ///
 /// All input images must be real-valued and scalar, except if the OFT is given instead of the PSF, in which
 /// case `psf` could be complex-valued.
@@ -340,6 +348,8 @@ DIP_NODISCARD inline Image RichardsonLucy(
 /// The PSF (point spread function) should sum to one in order to preserve the mean image intensity.
 /// If the OTF (optical transfer function, the Fourier transform of the PSF) is known, it is possible to pass
 /// that as `psf`; add the string `"OTF"` to `options`.
+/// The OTF must be conjugate symmetric (i.e. the Fourier transform of a real-valued PSF), as only its
+/// non-redundant half is used.
 ///
 /// All input images must be real-valued and scalar, except if the OFT is given instead of the PSF, in which
 /// case `psf` could be complex-valued.
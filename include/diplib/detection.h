@@ -59,6 +59,9 @@ namespace dip {
 ///
 /// `range` must be empty, or have exactly two elements representing the minimum and maximum radius to
 /// be considered. If empty, the minimum radius is 0, and the maximum is the length of the image diagonal.
+///
+/// When running in multiple threads, each thread accumulates votes into its own copy of the parameter space,
+/// requiring one additional image of the size of `out` for each additional thread.
 DIP_EXPORT void HoughTransformCircleCenters(
       Image const& in,
       Image const& gv,
@@ -94,6 +97,10 @@ DIP_EXPORT CoordinateArray FindHoughMaxima(
 ///
 /// `range` must be empty, or have exactly two elements representing the minimum and maximum distance to
 /// be considered. If empty, the minimum distance is 0, and the maximum is the length of the image diagonal.
+/// The 'on' pixels are sorted into a coarse grid, and only the grid cells that intersect the given distance
+/// range around a point are visited, so a small `range` makes this function much faster.
+///
+/// The points must have the same dimensionality as `in`.
 DIP_EXPORT Distribution PointDistanceDistribution(
       Image const& in,
       CoordinateArray const& points,
@@ -175,6 +182,14 @@ using RadonCircleParametersArray = std::vector< RadonCircleParameters >;
 ///
 /// By default, `options` contains `"normalize"` and `"correct"`.
 ///
+/// If `mode` is `"full"` and `options` contains `"no parameter space"`, the parameter space is not stored.
+/// Instead, it is computed in slabs of 32 slices along the *r* axis, each overlapping its neighbors by
+/// 16 slices, and the maxima are found within each slab. Thus, the memory used is bounded by 32 times the size
+/// of `in`, rather than `radii.Size()` times. Peaks are found by \ref dip::WatershedMaxima within each slab,
+/// and kept only if they lie in the central part of the slab. The results can differ slightly from those found
+/// in the full parameter space if the depth of a peak is determined by a path through the parameter space
+/// that leaves the slab. The order of the maxima in the output array is also different.
+///
 /// `in` must be scalar and non-complex, and have at least one dimension. `out` will be of type \ref dip::DT_SFLOAT.
 ///
 /// !!! literature
@@ -184,7 +199,6 @@ using RadonCircleParametersArray = std::vector< RadonCircleParameters >;
 ///     - C.L. Luengo Hendriks, M. van Ginkel and L.J. van Vliet,
 ///       "Underestimation of the radius in the Radon transform for circles and spheres",
 ///       Technical Report PH-2003-02, Pattern Recognition Group, Delft University of Technology, The Netherlands, 2003.
-// TODO: If `mode` is `"full"`, then the parameter space is computed chunks to save memory.
 DIP_EXPORT RadonCircleParametersArray RadonTransformCircles(
       Image const& in,
       Image& out,
@@ -898,6 +898,12 @@ class DIP_CLASS_EXPORT FullLineFilter {
 /// The input and output buffers will never share memory. That is, the line filter can freely write in the output
 /// buffer without invalidating the input buffer, even when the filter is being applied in-place.
 ///
+/// The pixel table is prepared for the input buffer, with the runs along `dimension`, such that `pixelTable.Stride()`
+/// is equal to `inBuffer.stride`. Filters that keep a running state over the neighborhood as it slides along the line
+/// (such as a sum or a histogram) should use \ref dip::PixelTableOffsets::TrailingEdge and
+/// \ref dip::PixelTableOffsets::LeadingEdge to update that state. Filters that compute a weighted sum over the
+/// neighborhood should use \ref dip::PixelTableOffsets::WeightedSum.
+///
 /// `dip::Framework::Full` will process the image using multiple threads, so `lineFilter` will be called from multiple
 /// threads simultaneously. If it is not thread safe, specify \ref dip::Framework::FullOption::NoMultiThreading as an
 /// option. The `SetNumberOfThreads` method to `lineFilter` will be called once before the processing starts, when
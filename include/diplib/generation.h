@@ -1427,11 +1427,10 @@ DIP_NODISCARD inline Image CityBlockDistanceToPoint(
 /// [`lowerBound`, `upperBound`). That is, for each pixel it does
 /// `in += uniformRandomGenerator( lowerBound, upperBound )`. The output image is of the same type as the input image.
 ///
-/// `random` is used to generate the random values needed by the first thread. If the algorithm runs in multiple
-/// threads, portions of the image processed by additional threads take their random values from `random.Split()`,
-/// which is essentially a copy of `random` set to a different random stream. Given a \ref dip::Random object in an
-/// identical state before calling this function, the output image will be different depending on the number of
-/// threads used.
+/// `random` is used to generate a single value, the key for a \ref dip::CounterBasedRandom generator. The noise
+/// for each sample is computed from this key and the sample's linear index (where the tensor dimension is the last
+/// dimension). Given a \ref dip::Random object in an identical state before calling this function, the output image
+/// will be identical independently of the number of threads used.
 ///
 /// \see dip::UniformRandomGenerator
 DIP_EXPORT void UniformNoise(
@@ -1458,11 +1457,10 @@ DIP_NODISCARD inline Image UniformNoise(
 /// for each pixel it does `in += gaussianRandomGenerator( 0, std::sqrt( variance ))`. The output image is of the
 /// same type as the input image.
 ///
-/// `random` is used to generate the random values needed by the first thread. If the algorithm runs in multiple
-/// threads, portions of the image processed by additional threads take their random values from `random.Split()`,
-/// which is essentially a copy of `random` set to a different random stream. Given a \ref dip::Random object in an
-/// identical state before calling this function, the output image will be different depending on the number of
-/// threads used.
+/// `random` is used to generate a single value, the key for a \ref dip::CounterBasedRandom generator. The noise
+/// for each sample is computed from this key and the sample's linear index (where the tensor dimension is the last
+/// dimension). Given a \ref dip::Random object in an identical state before calling this function, the output image
+/// will be identical independently of the number of threads used.
 ///
 /// \see dip::GaussianRandomGenerator
 DIP_EXPORT void GaussianNoise( Image const& in, Image& out, Random& random, dfloat variance = 1.0 );
@@ -1483,11 +1481,13 @@ DIP_NODISCARD inline Image GaussianNoise( Image const& in, Random& random, dfloa
 ///
 /// The output image is of the same type as the input image.
 ///
-/// `random` is used to generate the random values needed by the first thread. If the algorithm runs in multiple
-/// threads, portions of the image processed by additional threads take their random values from `random.Split()`,
-/// which is essentially a copy of `random` set to a different random stream. Given a \ref dip::Random object in an
-/// identical state before calling this function, the output image will be different depending on the number of
-/// threads used.
+/// `random` is used to generate a single value, the key for a \ref dip::CounterBasedRandom generator. The noise
+/// for each sample is computed from this key and the sample's linear index (where the tensor dimension is the last
+/// dimension). Given a \ref dip::Random object in an identical state before calling this function, the output image
+/// will be identical independently of the number of threads used. The Poisson-distributed values are computed
+/// from the generator's output directly (by inversion for small means, and by transformed rejection for large ones),
+/// rather than through `std::poisson_distribution`, so that the result does not depend on the standard library
+/// implementation either.
 ///
 /// \see dip::PoissonRandomGenerator
 DIP_EXPORT void PoissonNoise( Image const& in, Image& out, Random& random, dfloat conversion = 1.0 );
@@ -1540,11 +1540,10 @@ DIP_NODISCARD inline Image PoissonNoise( Image const& in, Random& random, dfloat
 /// poissonPoint3 = poissonPoint3 >= threshold;
 /// ```
 ///
-/// `random` is used to generate the random values needed by the first thread. If the algorithm runs in multiple
-/// threads, portions of the image processed by additional threads take their random values from `random.Split()`,
-/// which is essentially a copy of `random` set to a different random stream. Given a \ref dip::Random object in an
-/// identical state before calling this function, the output image will be different depending on the number of
-/// threads used.
+/// `random` is used to generate a single value, the key for a \ref dip::CounterBasedRandom generator. The noise
+/// for each sample is computed from this key and the sample's linear index (where the tensor dimension is the last
+/// dimension). Given a \ref dip::Random object in an identical state before calling this function, the output image
+/// will be identical independently of the number of threads used.
 ///
 /// \see dip::BinaryRandomGenerator
 DIP_EXPORT void BinaryNoise(
@@ -1576,11 +1575,10 @@ DIP_NODISCARD inline Image BinaryNoise(
 /// Note that the noise generated corresponds to a Poisson point process. The distances between changed pixels
 /// have a Poisson distribution.
 ///
-/// `random` is used to generate the random values needed by the first thread. If the algorithm runs in multiple
-/// threads, portions of the image processed by additional threads take their random values from `random.Split()`,
-/// which is essentially a copy of `random` set to a different random stream. Given a \ref dip::Random object in an
-/// identical state before calling this function, the output image will be different depending on the number of
-/// threads used.
+/// `random` is used to generate a single value, the key for a \ref dip::CounterBasedRandom generator. The noise
+/// for each sample is computed from this key and the sample's linear index (where the tensor dimension is the last
+/// dimension). Given a \ref dip::Random object in an identical state before calling this function, the output image
+/// will be identical independently of the number of threads used.
 ///
 /// \see dip::UniformRandomGenerator
 DIP_EXPORT void SaltPepperNoise(
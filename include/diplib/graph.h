@@ -19,8 +19,10 @@
 #define DIP_GRAPH_H
 
 #include <array>
+#include <cmath>
 #include <cstdlib>
 #include <utility>
+#include <vector>
 
 #include "diplib.h"
 #include "diplib/label_map.h"
@@ -38,6 +40,10 @@ namespace dip {
 /// \ingroup segmentation
 /// \brief Representing graphs and working with an image as a graph.
 ///
+/// \ref dip::Graph and \ref dip::DirectedGraph are flexible, vertices and edges can be added and removed at will.
+/// \ref dip::CompactGraph stores a graph that doesn't change topology much more efficiently, and \ref dip::GridGraph
+/// represents the pixels of an image without storing any edges at all.
+///
 /// \see dip::RegionAdjacencyGraph, dip::Relabel(dip::Image const&, dip::Image&, dip::Graph const&)
 ///
 /// \addtogroup
@@ -274,7 +280,7 @@ class DIP_NO_EXPORT Graph {
          UpdateEdgeWeights( []( dfloat val1, dfloat val2 ) { return std::abs( val1 - val2 ); } );
       }
 
-      /// \brief Computes the minimum spanning forest (MSF) using Prim's algorithm.
+      /// \brief Computes the minimum spanning forest (MSF) using Borůvka's algorithm.
       /// See \ref dip::MinimumSpanningForest for details. Does not modify `this`.
       // NOTE: We're keeping this for backwards-compatibility.
       DIP_NODISCARD Graph MinimumSpanningForest( std::vector< VertexIndex > const& roots = {} ) const;
@@ -317,6 +323,8 @@ class DIP_NO_EXPORT Graph {
 
 };
 
+class DIP_NO_EXPORT CompactGraph;
+
 /// \brief A directed, edge-weighted graph.
 ///
 /// Vertices are identified by an index, these indices are expected to be consecutive. Each vertex contains a list
@@ -399,6 +407,9 @@ class DIP_NO_EXPORT DirectedGraph {
       /// \brief Constructs a directed graph from an undirected graph.
       DIP_EXPORT explicit DirectedGraph( Graph const& graph );
 
+      /// \brief Constructs a directed graph from an undirected graph.
+      DIP_EXPORT explicit DirectedGraph( CompactGraph const& graph );
+
       /// \brief Returns the number of vertices in the graph.
       DIP_NODISCARD dip::uint NumberOfVertices() const {
          return vertices_.size();
@@ -718,19 +729,340 @@ class DIP_NO_EXPORT DirectedGraph {
 
 };
 
-/// \brief Computes the minimum spanning forest (MSF) of a graph using Prim's algorithm.
+/// \brief A non-directed, edge-weighted graph stored in compressed sparse row (CSR) format.
+///
+/// This graph stores the same information as \ref dip::Graph, but in a few contiguous arrays: the vertex values,
+/// the edges, and, for each vertex, a range of indices into a single array of edge indices. It therefore uses much
+/// less memory, and is much faster to construct, than a \ref dip::Graph with the same edges. But vertices and edges
+/// cannot be added after construction. Edges can be deleted, these remain in the edge list of their vertices,
+/// use \ref IsValidEdge to test.
+///
+/// Vertices are identified by an index, these indices are consecutive. Edges are of type \ref dip::Graph::Edge.
+class DIP_NO_EXPORT CompactGraph {
+   public:
+      /// Type for indices to vertices
+      using VertexIndex = Graph::VertexIndex;
+      /// Type for indices to edges
+      using EdgeIndex = Graph::EdgeIndex;
+      /// Type for edges
+      using Edge = Graph::Edge;
+
+      /// \brief A view over the indices to the edges that join a vertex. Behaves like a `const` container.
+      class EdgeIndexRange {
+         public:
+            EdgeIndexRange( EdgeIndex const* begin, EdgeIndex const* end ) : begin_( begin ), end_( end ) {}
+            EdgeIndex const* begin() const { return begin_; }
+            EdgeIndex const* end() const { return end_; }
+            dip::uint size() const { return static_cast< dip::uint >( end_ - begin_ ); }
+            bool empty() const { return begin_ == end_; }
+            EdgeIndex operator[]( dip::uint index ) const { return begin_[ index ]; }
+         private:
+            EdgeIndex const* begin_;
+            EdgeIndex const* end_;
+      };
+
+      CompactGraph() = default;
+
+      /// \brief Construct a graph with `nVertices` vertices, and the edges in `edges`. For each edge,
+      /// `vertices[0]` must be smaller than `vertices[1]`, and both must be smaller than `nVertices`.
+      /// The edges are not tested for duplicates. Invalid edges are kept, but not linked to any vertex.
+      DIP_EXPORT CompactGraph( dip::uint nVertices, std::vector< Edge > edges );
+
+      /// \brief Construct a graph from a \ref dip::Graph. Invalid edges are not copied.
+      DIP_EXPORT explicit CompactGraph( Graph const& graph );
+
+      /// \brief Construct a graph for the given image.
+      ///
+      /// Each pixel becomes a vertex in the graph, the vertex's index is equal to the linear index (see \ref pointers)
+      /// of the pixel in the image. The graph is identical to the one constructed by \ref dip::Graph::Graph(Image const&, dip::uint, String const&),
+      /// except for the order of the edges. The graph is constructed in parallel.
+      DIP_EXPORT explicit CompactGraph( Image const& image, dip::uint connectivity = 1, String const& weights = "difference" );
+
+      /// \brief Returns the number of vertices in the graph.
+      DIP_NODISCARD dip::uint NumberOfVertices() const {
+         return values_.size();
+      };
+
+      /// \brief Returns the number of edges in the graph, including invalid edges.
+      DIP_NODISCARD dip::uint NumberOfEdges() const {
+         return edges_.size();
+      };
+
+      /// \brief Counts the number of valid edges in the graph.
+      DIP_NODISCARD dip::uint CountEdges() const {
+         dip::uint count = 0;
+         for( auto& e: edges_ ) {
+            if( e.IsValid() ) {
+               ++count;
+            }
+         }
+         return count;
+      };
+
+      /// \brief Gets the set of edges in the graph. The weights of the edges are mutable, they can be directly modified.
+      /// Not all edges connect vertices, use \ref Graph::Edge::IsValid to test.
+      DIP_NODISCARD std::vector< Edge > const& Edges() const {
+         return edges_;
+      }
+
+      /// \brief Gets the index to one of the two vertices that are joined by an edge.
+      /// `which` is 0 or 1 to specify which of the two vertices to return.
+      DIP_NODISCARD VertexIndex EdgeVertex( EdgeIndex edge, bool which ) const {
+         DIP_ASSERT( edge < edges_.size() );
+         return edges_[ edge ].vertices[ which ];
+      }
+
+      /// \brief Finds the index to the vertex that is joined to the vertex with index `vertex` through the edge with
+      /// index `edge`.
+      DIP_NODISCARD VertexIndex OtherVertex( EdgeIndex edge, VertexIndex vertex ) const {
+         DIP_ASSERT( edge < edges_.size() );
+         return edges_[ edge ].vertices[ ( edges_[ edge ].vertices[ 0 ] != vertex ) ? 0 : 1 ];
+      }
+
+      /// \brief Returns a reference to the weight of the edge with index `edge`. This value is mutable even
+      /// if the graph is `const`.
+      DIP_NODISCARD dfloat& EdgeWeight( EdgeIndex edge ) const {
+         DIP_ASSERT( edge < edges_.size() );
+         return edges_[ edge ].weight;
+      }
+
+      /// \brief Returns `true` if the edge is a valid edge.
+      DIP_NODISCARD bool IsValidEdge( EdgeIndex edge ) const {
+         return edge < edges_.size() ? edges_[ edge ].IsValid() : false;
+      }
+
+      /// \brief Get the indices to the edges that join vertex `vertex`. These can include deleted edges.
+      DIP_NODISCARD EdgeIndexRange EdgeIndices( VertexIndex vertex ) const {
+         DIP_ASSERT( vertex < values_.size() );
+         return { adjacency_.data() + offsets_[ vertex ], adjacency_.data() + offsets_[ vertex + 1 ] };
+      }
+
+      /// \brief Calls `func( EdgeIndex edge, VertexIndex neighbor )` for each valid edge that joins vertex `vertex`.
+      template< typename F >
+      void ForEachEdge( VertexIndex vertex, F func ) const {
+         for( auto edge : EdgeIndices( vertex )) {
+            if( edges_[ edge ].IsValid() ) {
+               func( edge, OtherVertex( edge, vertex ));
+            }
+         }
+      }
+
+      /// \brief Returns a reference to the value of the vertex `vertex`. This value is mutable even if the graph is `const`.
+      DIP_NODISCARD dfloat& VertexValue( VertexIndex vertex ) const {
+         DIP_ASSERT( vertex < values_.size() );
+         return values_[ vertex ];
+      }
+
+      /// \brief Delete the edge `edge`. The edge index remains in the edge lists of its two vertices.
+      void DeleteEdge( EdgeIndex edge ) {
+         DIP_ASSERT( edge < edges_.size() );
+         edges_[ edge ].vertices = { 0, 0 };
+      }
+
+      /// \brief Returns a list of indices to neighboring vertices. The list is created. \ref ForEachEdge is
+      /// a more efficient, but less convenient, function.
+      std::vector< VertexIndex > Neighbors( VertexIndex vertex ) const {
+         std::vector< VertexIndex > neighbors;
+         ForEachEdge( vertex, [ & ]( EdgeIndex /**/, VertexIndex neighbor ) { neighbors.push_back( neighbor ); } );
+         return neighbors;
+      }
+
+      /// \brief Re-computes edge weights using the function `func`, called as `dfloat func(dfloat val1, dfloat val2)`,
+      /// where the two inputs to `func` are the value of the two vertices.
+      template< typename F >
+      void UpdateEdgeWeights( F func ) const {
+         for( auto& edge: edges_ ) {
+            if( edge.IsValid() ) {
+               edge.weight = func( values_[ edge.vertices[ 0 ]], values_[ edge.vertices[ 1 ]] );
+            }
+         }
+      }
+
+      /// \brief Re-computes edge weights as the absolute difference between vertex values.
+      void UpdateEdgeWeights() const {
+         UpdateEdgeWeights( []( dfloat val1, dfloat val2 ) { return std::abs( val1 - val2 ); } );
+      }
+
+      /// \brief Removes `number` edges with the largest weights from the graph.
+      ///
+      /// If the graph is a minimum spanning tree, it will be converted to a minimum spanning forest with
+      /// `number + 1` trees. See \ref dip::Graph::RemoveLargestEdges.
+      DIP_EXPORT void RemoveLargestEdges( dip::uint number );
+
+   private:
+      mutable std::vector< dfloat > values_{};  // one per vertex
+      std::vector< EdgeIndex > offsets_{};      // one per vertex, plus one: the edges for vertex `ii` are at `adjacency_[ offsets_[ ii ] ]` to `adjacency_[ offsets_[ ii + 1 ] ]`
+      std::vector< EdgeIndex > adjacency_{};    // two per valid edge
+      std::vector< Edge > edges_{};
+
+      // Fills `offsets_` and `adjacency_` from `edges_`.
+      void BuildAdjacency();
+};
+
+/// \brief An implicit, non-directed, edge-weighted graph representing the pixels of an image.
+///
+/// Each pixel is a vertex, its index is equal to the linear index (see \ref pointers) of the pixel in the image.
+/// Each vertex is joined to its direct neighbors (connectivity 1). The edges are not stored, the neighbors of
+/// a vertex are computed from its index, and the weight of an edge is computed from the values of the two vertices
+/// when requested. The only storage is one value per vertex, and changing a vertex value implicitly changes the
+/// weights of its edges.
+///
+/// The edge joining vertex `v` to its neighbor along dimension `d` with a larger index has index `v * nDims + d`.
+/// Vertices at the image edge have fewer neighbors, and so not all edge indices are used; use \ref IsValidEdge
+/// to test this.
+///
+/// Because edges are implicit, they cannot be removed: a `GridGraph` always forms a single connected component.
+/// For this reason there is no \ref dip::Label(Graph const&) or \ref dip::Relabel(Image const&, Image&, Graph const&)
+/// overload for this type; use \ref dip::MinimumSpanningForest(GridGraph const&, std::vector<GridGraph::VertexIndex> const&)
+/// to obtain a \ref dip::CompactGraph from which edges can be removed, then label that graph.
+/// Likewise, \ref dip::GraphCut needs a \ref dip::DirectedGraph to store the residual capacities in;
+/// there is no grid-specialized max-flow. Construct a `DirectedGraph` from the image instead, it has the same
+/// edges as the `GridGraph` when using the default connectivity of 1.
+class DIP_NO_EXPORT GridGraph {
+   public:
+      /// Type for indices to vertices
+      using VertexIndex = Graph::VertexIndex;
+      /// Type for indices to edges
+      using EdgeIndex = Graph::EdgeIndex;
+
+      GridGraph() = default;
+
+      /// \brief Construct a graph for the given image.
+      ///
+      /// Vertex values are set to the corresponding pixel value. `connectivity` must be 1.
+      ///
+      /// The value of `weights` is:
+      ///  - `"difference"` (default): the edge weights are given by the absolute difference between the two pixel values.
+      ///  - `"average"`: the edge weights are given by the average of the two pixel values.
+      DIP_EXPORT explicit GridGraph( Image const& image, dip::uint connectivity = 1, String const& weights = "difference" );
+
+      /// \brief Returns the sizes of the image that the graph represents.
+      DIP_NODISCARD UnsignedArray const& Sizes() const {
+         return sizes_;
+      }
+
+      /// \brief Returns the number of vertices in the graph.
+      DIP_NODISCARD dip::uint NumberOfVertices() const {
+         return values_.size();
+      };
+
+      /// \brief Returns the number of edge indices in the graph, including invalid edges.
+      DIP_NODISCARD dip::uint NumberOfEdges() const {
+         return values_.size() * sizes_.size();
+      };
+
+      /// \brief Counts the number of valid edges in the graph.
+      DIP_NODISCARD dip::uint CountEdges() const {
+         dip::uint count = 0;
+         for( dip::uint ii = 0; ii < sizes_.size(); ++ii ) {
+            count += values_.size() / sizes_[ ii ] * ( sizes_[ ii ] - 1 );
+         }
+         return count;
+      }
+
+      /// \brief Returns `true` if the edge is a valid edge.
+      DIP_NODISCARD bool IsValidEdge( EdgeIndex edge ) const {
+         if( edge >= NumberOfEdges() ) {
+            return false;
+         }
+         dip::uint dim = edge % sizes_.size();
+         return Coordinate( edge / sizes_.size(), dim ) < sizes_[ dim ] - 1;
+      }
+
+      /// \brief Gets the index to one of the two vertices that are joined by an edge.
+      /// `which` is 0 or 1 to specify which of the two vertices to return.
+      DIP_NODISCARD VertexIndex EdgeVertex( EdgeIndex edge, bool which ) const {
+         DIP_ASSERT( IsValidEdge( edge ));
+         VertexIndex vertex = edge / sizes_.size();
+         return which ? vertex + indexStrides_[ edge % sizes_.size() ] : vertex;
+      }
+
+      /// \brief Finds the index to the vertex that is joined to the vertex with index `vertex` through the edge with
+      /// index `edge`.
+      DIP_NODISCARD VertexIndex OtherVertex( EdgeIndex edge, VertexIndex vertex ) const {
+         VertexIndex vertex0 = EdgeVertex( edge, 0 );
+         return vertex0 != vertex ? vertex0 : EdgeVertex( edge, 1 );
+      }
+
+      /// \brief Returns the weight of the edge with index `edge`, computed from the values of its two vertices.
+      DIP_NODISCARD dfloat EdgeWeight( EdgeIndex edge ) const {
+         return Weight( values_[ EdgeVertex( edge, 0 ) ], values_[ EdgeVertex( edge, 1 ) ] );
+      }
+
+      /// \brief Calls `func( EdgeIndex edge, VertexIndex neighbor )` for each edge that joins vertex `vertex`.
+      template< typename F >
+      void ForEachEdge( VertexIndex vertex, F func ) const {
+         DIP_ASSERT( vertex < values_.size() );
+         dip::uint nDims = sizes_.size();
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            dip::uint coord = Coordinate( vertex, ii );
+            if( coord > 0 ) {
+               VertexIndex neighbor = vertex - indexStrides_[ ii ];
+               func( neighbor * nDims + ii, neighbor );
+            }
+            if( coord < sizes_[ ii ] - 1 ) {
+               func( vertex * nDims + ii, vertex + indexStrides_[ ii ] );
+            }
+         }
+      }
+
+      /// \brief Returns a list of indices to neighboring vertices. The list is created. \ref ForEachEdge is
+      /// a more efficient, but less convenient, function.
+      std::vector< VertexIndex > Neighbors( VertexIndex vertex ) const {
+         std::vector< VertexIndex > neighbors;
+         ForEachEdge( vertex, [ & ]( EdgeIndex /**/, VertexIndex neighbor ) { neighbors.push_back( neighbor ); } );
+         return neighbors;
+      }
+
+      /// \brief Returns a reference to the value of the vertex `vertex`. This value is mutable even if the graph is `const`.
+      DIP_NODISCARD dfloat& VertexValue( VertexIndex vertex ) const {
+         DIP_ASSERT( vertex < values_.size() );
+         return values_[ vertex ];
+      }
+
+   private:
+      UnsignedArray sizes_{};
+      UnsignedArray indexStrides_{};
+      mutable std::vector< dfloat > values_{};
+      bool useDifferences_ = true;
+
+      dip::uint Coordinate( VertexIndex vertex, dip::uint dim ) const {
+         return ( vertex / indexStrides_[ dim ] ) % sizes_[ dim ];
+      }
+
+      dfloat Weight( dfloat val1, dfloat val2 ) const {
+         return useDifferences_ ? std::abs( val1 - val2 ) : ( val1 + val2 ) / 2;
+      }
+};
+
+/// \brief Computes the minimum spanning forest (MSF) of a graph using Borůvka's algorithm.
 ///
 /// If `roots` is an empty set, the vertex with index 0 is used as the root, and the resulting graph
 /// will be a minimum spanning tree (MST). If multiple roots are given, each one will spawn a tree.
 ///
 /// The output graph only contains edges reachable from the given roots. Any components not connected
 /// to the roots will not remain in the graph (the vertices will be copied over, but not connected).
+///
+/// The algorithm runs in parallel. Edges with equal weight are ordered by their index, so that the result
+/// is always the same, independently of the number of threads used. If all edge weights are distinct,
+/// the MSF is unique.
 DIP_NODISCARD DIP_EXPORT Graph MinimumSpanningForest( Graph const& graph, std::vector< Graph::VertexIndex > const& roots = {} );
 
 DIP_NODISCARD inline Graph Graph::MinimumSpanningForest( std::vector< VertexIndex > const& roots ) const {
    return dip::MinimumSpanningForest( *this, roots );
 }
 
+/// \brief Computes the minimum spanning forest (MSF) of a graph using Borůvka's algorithm.
+///
+/// \ref dip::CompactGraph version of the function above.
+DIP_NODISCARD DIP_EXPORT CompactGraph MinimumSpanningForest( CompactGraph const& graph, std::vector< CompactGraph::VertexIndex > const& roots = {} );
+
+/// \brief Computes the minimum spanning forest (MSF) of a graph using Borůvka's algorithm.
+///
+/// \ref dip::GridGraph version of the function above. The output graph has the same vertices and vertex values
+/// as the input, and the edges of the forest with their weights.
+DIP_NODISCARD DIP_EXPORT CompactGraph MinimumSpanningForest( GridGraph const& graph, std::vector< GridGraph::VertexIndex > const& roots = {} );
+
 /// \brief Computes the minimum cut of the graph, separating the source node from the sink node.
 ///
 /// `graph` is a directed graph where each edge has a reverse sibling. That is, each pair of connected
@@ -778,6 +1110,14 @@ DIP_NODISCARD DIP_EXPORT LabelMap Label( Graph const& graph );
 /// See also \ref Relabel(Image const&, Image&, DirectedGraph const&).
 DIP_NODISCARD DIP_EXPORT LabelMap Label( DirectedGraph const& graph );
 
+/// \brief Connected component analysis of a graph.
+///
+/// The output can be used to relabel the image that the graph was constructed from. It maps the graph's vertex
+/// indices to labels, where each connected component in the graph represents a label.
+///
+/// See also \ref Relabel(Image const&, Image&, CompactGraph const&).
+DIP_NODISCARD DIP_EXPORT LabelMap Label( CompactGraph const& graph );
+
 /// \endgroup
 
 } // namespace dip
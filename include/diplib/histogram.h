@@ -196,16 +196,16 @@ class DIP_NO_EXPORT Histogram {
          /// \brief Returns the bin that the value belongs in. If the value is out of range, returns the first or
          /// last bin. If the value is NaN, returns the first bin.
          template< typename T, std::enable_if_t< std::is_integral< T >::value, int > = 0 >
+         dip::sint FindBin( T value ) const { // integral types don't need the isnan test.
+            return detail::FindBin( static_cast< dfloat >( value ), lowerBound, binSize, nBins );
+         }
+         template< typename T, std::enable_if_t< std::is_floating_point< T >::value, int > = 0 >
          dip::sint FindBin( T value ) const {
             if( std::isnan( value )) {
                return 0;
             }
             return detail::FindBin( static_cast< dfloat >( value ), lowerBound, binSize, nBins );
          }
-         template< typename T, std::enable_if_t< std::is_floating_point< T >::value, int > = 0 >
-         dip::sint FindBin( T value ) const { // integral types don't need the isnan test.
-            return detail::FindBin( static_cast< dfloat >( value ), lowerBound, binSize, nBins );
-         }
          dip::sint FindBin( bin value ) const { // Ensure we don't use the isnan test when the input is binary.
             return detail::FindBin( static_cast< dfloat >( value ), lowerBound, binSize, nBins );
          }
@@ -187,6 +187,74 @@ class DIP_CLASS_EXPORT AlignedAllocInterface : public ExternalInterface {
       }
 };
 
+/// \brief \ref dip::ExternalInterface that recycles data segments.
+///
+/// When an image that was forged using this external interface releases its data segment (i.e. when it is
+/// stripped or destroyed, and no other image shares the data), the data segment is not freed, but kept for
+/// reuse. A subsequent call to \ref dip::Image::Forge, for an image using the same external interface, that
+/// needs a data segment of a similar size will receive this one. This avoids the cost of repeatedly allocating
+/// and freeing large memory blocks, which typically involves mapping new memory pages, and the page faults
+/// when these are first written to. It is useful, for example, when each frame of a video is processed with
+/// the same sequence of operations.
+///
+/// Data segments are grouped into size classes, with four classes for each power of two; a data segment
+/// is reused for any request within the same size class. At most `maxCachedBytes` bytes are kept for reuse,
+/// data segments that don't fit are freed.
+///
+/// Images forged with this external interface always have normal strides, any strides set before forging
+/// are ignored.
+///
+/// Unlike \ref dip::AlignedAllocInterface, this class is not a singleton. The data segments are kept by an
+/// object shared with the images that use them, such that the interface can safely be destroyed
+/// before these images.
+///
+/// ```cpp
+/// dip::PooledAllocInterface pool;
+/// for( auto const& frame : video ) {
+///    dip::Image tmp;
+///    tmp.SetExternalInterface( &pool );
+///    dip::Gauss( frame, tmp, { 2 } ); // from the second frame on, `tmp` reuses a data segment
+///    // ...
+/// } // `tmp` is destroyed here, its data segment goes back to `pool`
+/// ```
+class DIP_CLASS_EXPORT PooledAllocInterface : public ExternalInterface {
+   public:
+      /// \brief Counters for the use of the pool.
+      struct Statistics {
+         dip::uint allocations = 0;  ///< Number of data segments allocated
+         dip::uint reuses = 0;       ///< Number of data segments reused, the number of allocations avoided
+         dip::uint cachedBytes = 0;  ///< Number of bytes currently kept for reuse
+      };
+
+      /// \brief Constructor, `maxCachedBytes` is the maximum number of bytes kept for reuse.
+      DIP_EXPORT explicit PooledAllocInterface( dip::uint maxCachedBytes = 1024 * 1024 * 1024 );
+
+      /// Called by \ref dip::Image::Forge.
+      DIP_EXPORT DataSegment AllocateData(
+            void*& origin,
+            dip::DataType dataType,
+            UnsignedArray const& sizes,
+            IntegerArray& strides,
+            dip::Tensor const& tensor,
+            dip::sint& tensorStride
+      ) override;
+
+      /// \brief Returns counters for the use of the pool.
+      DIP_EXPORT Statistics GetStatistics() const;
+
+      /// \brief Frees all data segments kept for reuse. Data segments in use by images are not affected.
+      DIP_EXPORT void Clear();
+
+      /// \brief Overriding the `Name` function.
+      virtual String Name() const override {
+         return "PooledAllocInterface";
+      }
+
+   private:
+      class Pool;
+      std::shared_ptr< Pool > pool_;
+};
+
 
 //
 // Functor that converts indices or offsets to coordinates.
@@ -625,6 +693,13 @@ class DIP_NO_EXPORT Image {
       /// The image must be raw, but its sizes should be set first.
       DIP_EXPORT void SetNormalStrides();
 
+      /// \brief Set the strides array and tensor stride for a planar layout (see \ref planar_strides).
+      /// The image must be raw, but its sizes should be set first.
+      ///
+      /// Each tensor element is stored as a contiguous plane with normal strides, the tensor stride is
+      /// the number of pixels in the image. For a scalar image this is the same as \ref dip::Image::SetNormalStrides.
+      DIP_EXPORT void SetPlanarStrides();
+
       /// \brief Set the strides array and tensor stride to match the dimension order of `src`. The image must be raw,
       /// but its sizes should be set first.
       DIP_EXPORT void MatchStrideOrder( Image const& src );
@@ -652,6 +727,11 @@ class DIP_NO_EXPORT Image {
       /// \brief Test if strides are as by default (see \ref normal_strides). The image must be forged.
       DIP_EXPORT bool HasNormalStrides() const;
 
+      /// \brief Test if strides are planar (see \ref planar_strides). The image must be forged.
+      ///
+      /// A scalar image with normal strides also has planar strides.
+      DIP_EXPORT bool HasPlanarStrides() const;
+
       /// \brief Test if any of the image dimensions is a singleton dimension (size is 1). Singleton expanded
       /// dimensions are not considered. The image must be forged.
       DIP_EXPORT bool HasSingletonDimension() const;
@@ -2533,6 +2613,31 @@ class DIP_NO_EXPORT Image {
          }
       }
 
+      /// \brief Copies pixel data over to a new data segment if the strides are not planar.
+      ///
+      /// Nothing is copied if the image already has \ref planar_strides, as is always the case for a scalar image
+      /// with normal strides. Use \ref dip::Image::ForceNormalStrides to convert back to the interleaved layout.
+      ///
+      /// Will throw an exception if reallocating the data segment does not yield planar strides.
+      /// This can happen only if there is an external interface.
+      ///
+      /// The image must be forged.
+      ///
+      /// \see dip::Image::HasPlanarStrides, dip::Image::ForceNormalStrides
+      void ForcePlanarStrides() {
+         if( !HasPlanarStrides() ) {
+            DIP_ASSERT( IsForged() );
+            Image tmp;
+            tmp.externalInterface_ = externalInterface_;
+            tmp.CopyProperties( *this );
+            tmp.SetPlanarStrides();
+            tmp.Forge();
+            tmp.Copy( *this );
+            swap( tmp );
+            DIP_THROW_IF( !HasPlanarStrides(), "Cannot force strides to planar" );
+         }
+      }
+
       /// \brief Copies pixel data over to a new data segment if the data is not contiguous.
       ///
       /// The image must be forged.
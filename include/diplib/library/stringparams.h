@@ -184,6 +184,7 @@ constexpr char const* FORWARD_BACKWARD = "forward backward";
 constexpr char const* REAL = "real";
 constexpr char const* SYMMETRIC = "symmetric";
 constexpr char const* CORNER = "corner";
+constexpr char const* HALF = "half";
 //constexpr char const* FAST = "fast";
 constexpr char const* LARGER = "larger";
 constexpr char const* SMALLER = "smaller";
@@ -577,6 +577,11 @@ DIP_MONADIC_OPERATOR( Rank )
 /// `method` is either `"precise"` or `"fast"`. The precise method uses an iterative QR decomposition.
 /// The fast method uses a closed-form algorithm that is much faster, but potentially less accurate.
 /// This faster algorithm is only used for real-valued, 2x2 or 3x3 symmetric tensor images.
+///
+/// For real-valued, 2x2 or 3x3 symmetric tensor images, the eigenvalues are computed directly from the
+/// packed tensor storage. For 2x2 matrices, both methods use the closed-form solution, which is as precise as
+/// the QR decomposition. For 3x3 matrices, the precise method also uses the closed-form solution, except when
+/// two eigenvalues are nearly equal, in which case it uses the QL algorithm on the tridiagonalized matrix.
 DIP_EXPORT void Eigenvalues( Image const& in, Image& out, String const& method = S::PRECISE );
 DIP_MONADIC_OPERATOR_WITH_DEFAULTED_PARAM( Eigenvalues, String const&, S::PRECISE )
 
@@ -1177,6 +1177,44 @@ DIP_EXPORT void MeasurementWriteCSV(
 );
 
 
+/// \brief Computes simple statistics of the grey values in `grey` for each object in `label`.
+///
+/// This is a faster alternative to \ref dip::MeasurementTool for the most common grey-value measurements.
+/// All requested statistics are computed in a single, multithreaded pass over the image. `label` is a
+/// scalar, unsigned integer image, `grey` is a real-valued image with the same sizes, and can be a tensor
+/// image. `mask`, if forged, limits the pixels taken into account.
+///
+/// `statistics` lists the features to compute, each one becomes a feature in the output \ref dip::Measurement
+/// object. Possible values are:
+///
+/// - `"Count"`: the number of pixels in the object.
+/// - `"Sum"`: the sum of the grey values.
+/// - `"SumSquares"`: the sum of the squared grey values.
+/// - `"Mean"`: the mean grey value.
+/// - `"StandardDeviation"`: the (sample) standard deviation of the grey values.
+/// - `"Minimum"`: the smallest grey value.
+/// - `"Maximum"`: the largest grey value.
+///
+/// If `percentiles` is not empty, a feature `"Percentiles"` is added with one value for each given
+/// percentile (in the range [0,100]), named for example `"P25"`. These are exact, and require storing
+/// a copy of all grey values.
+///
+/// For tensor images, each feature except `"Count"` has one value per tensor element, named `"chan0"`, `"chan1"`, etc.
+///
+/// Objects are listed in increasing order of their label, only labels present in the image are included.
+/// If `background` is `"include"`, the pixels with label 0 are treated as an object too.
+///
+/// \see dip::PerObjectHistogram, dip::MeasurementTool::Measure
+DIP_EXPORT Measurement PerObjectStatistics(
+      Image const& grey,
+      Image const& label,
+      Image const& mask = {},
+      StringArray const& statistics = { "Count", "Mean", "StandardDeviation", "Minimum", "Maximum" },
+      FloatArray const& percentiles = {},
+      String const& background = S::EXCLUDE
+);
+
+
 /// \brief Returns the smallest feature value in the first column of `featureValues`.
 ///
 /// The input `featureValues` is a view over a specific feature in a \ref dip::Measurement object. Only the
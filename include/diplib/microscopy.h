@@ -419,6 +419,10 @@ DIP_EXPORT ColocalizationCoefficients CostesColocalizationCoefficients(
 /// If `mask` is forged, only blocks that overlap the masked area by at least 3/4 are used.
 /// However, the full block is used, including the portion that falls outside the mask.
 ///
+/// The repetitions are computed in parallel. A single value is drawn from `random`, and used as the key
+/// for a \ref dip::CounterBasedRandom generator; each repetition uses the random stream given by its index.
+/// Therefore, the result does not depend on the number of threads used.
+///
 /// \see dip::PearsonCorrelation, dip::SpearmanRankCorrelation, dip::IntensityCorrelationQuotient, dip::MandersColocalizationCoefficients, dip::CostesColocalizationCoefficients
 ///
 /// !!! literature
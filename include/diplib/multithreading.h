@@ -28,6 +28,9 @@ inline int omp_get_max_threads() { return 1; }
 inline int omp_get_num_threads() { return 1; }
 #endif
 
+#include <functional>
+#include <map>
+
 #include "diplib.h"
 
 
@@ -78,9 +81,85 @@ DIP_EXPORT dip::uint GetNumberOfThreads();
 // (experimentally determined on Cris' computer, might be different elsewhere).
 // I also noticed that going to 2 threads or 4 threads does not make a huge difference in overhead, so this is a
 // threshold for single vs multithreaded computation, not a threshold per thread created.
+// The frameworks use the cost model below instead, see `dip::ChooseNumberOfThreads`.
 constexpr dip::uint threadingThreshold = 70000;
 
 
+/// \brief Parameters of the model used by the frameworks to decide how many threads to use.
+///
+/// The time taken by a computation with an estimated number of operations `ops` is modeled as
+/// `ops * secondsPerOperation` when using a single thread, and as
+/// `ops * secondsPerOperation / n + startupCost + n * perThreadCost` when using `n` threads.
+/// The number of threads that minimizes this time is used, see \ref dip::ChooseNumberOfThreads.
+///
+/// The operation counts given by the line filters are rough estimates. For a line filter that is listed
+/// in `filterCosts`, its own cost per operation is used instead of `secondsPerOperation`, correcting its estimate.
+/// Line filters are identified by the name given by `typeid(filter).name()`, which is compiler-specific.
+///
+/// The default values are a reasonable choice for a modern desktop computer.
+/// \ref dip::CalibrateThreadingCostModel measures `secondsPerOperation`, `startupCost` and `perThreadCost`
+/// on the current machine, and \ref dip::LearnThreadingCosts records `filterCosts` for the line filters
+/// used while it is enabled. The result can be stored with \ref dip::SaveThreadingCostModel, and
+/// loaded in a later session with \ref dip::LoadThreadingCostModel.
+struct ThreadingCostModel {
+   dfloat secondsPerOperation = 1e-9;                    ///< Cost of one operation, in seconds.
+   dfloat startupCost = 35e-6;                           ///< Cost of starting a parallel section, in seconds.
+   dfloat perThreadCost = 2e-6;                          ///< Additional cost for each thread in a parallel section, in seconds.
+   std::map< String, dfloat, std::less<>> filterCosts;   ///< Cost of one operation for specific line filters, in seconds.
+};
+
+/// \brief Returns the model used to decide how many threads to use.
+DIP_EXPORT ThreadingCostModel GetThreadingCostModel();
+
+/// \brief Sets the model used to decide how many threads to use.
+///
+/// Unlike \ref dip::SetNumberOfThreads, this setting applies to all threads.
+///
+/// All costs must be finite. `secondsPerOperation` and the values in `filterCosts` must be positive,
+/// `startupCost` and `perThreadCost` must not be negative.
+DIP_EXPORT void SetThreadingCostModel( ThreadingCostModel const& model );
+
+/// \brief Returns the number of threads to use for a computation with an estimated `operations` operations.
+///
+/// Uses the model set with \ref dip::SetThreadingCostModel. `filter` is the name of a line filter type
+/// (as given by `typeid(filter).name()`); if it is listed in the model's `filterCosts`, that cost
+/// per operation is used. The result is between 1 and `maxThreads`.
+DIP_EXPORT dip::uint ChooseNumberOfThreads(
+      dip::uint operations,
+      dip::uint maxThreads,
+      char const* filter = nullptr
+);
+
+/// \brief Measures the costs in the model used to decide how many threads to use.
+///
+/// Runs a simple computation through \ref dip::Framework::Scan with different image sizes and numbers of
+/// threads, and updates `secondsPerOperation`, `startupCost` and `perThreadCost` in the model.
+/// `filterCosts` is not modified. Takes a fraction of a second.
+///
+/// If \ref dip::GetNumberOfThreads returns 1, only `secondsPerOperation` is measured.
+///
+/// The measurements are done in the calling thread, which meanwhile ignores the model and uses all
+/// the threads it is allowed to use. Other threads keep using the existing model, but
+/// calibrating while other threads are busy will yield inaccurate costs.
+DIP_EXPORT void CalibrateThreadingCostModel();
+
+/// \brief Enables or disables learning the cost per operation for the line filters used.
+///
+/// While enabled, the frameworks time the line filter for each call with a large enough estimated number of
+/// operations, and update the corresponding entry in `filterCosts` of the model. Timing adds a small overhead
+/// to each framework call.
+DIP_EXPORT void LearnThreadingCosts( bool enable = true );
+
+/// \brief Writes the model used to decide how many threads to use to a text file.
+DIP_EXPORT void SaveThreadingCostModel( String const& filename );
+
+/// \brief Reads a model written by \ref dip::SaveThreadingCostModel, and sets it as the model used to decide
+/// how many threads to use.
+///
+/// Throws if the file contains invalid costs, see \ref dip::SetThreadingCostModel.
+DIP_EXPORT void LoadThreadingCostModel( String const& filename );
+
+
 /// \endgroup
 
 } // namespace dip
@@ -0,0 +1,358 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_PACKED_BINARY_H
+#define DIP_PACKED_BINARY_H
+
+#include <utility>
+#include <vector>
+
+#include "diplib.h"
+
+
+/// \file
+/// \brief A bit-packed binary image representation, and binary image processing functions that use it.
+/// See \ref binary.
+
+
+namespace dip {
+
+
+/// \addtogroup binary
+
+/// \brief A binary image stored with one bit per pixel.
+///
+/// A \ref dip::Image with data type \ref dip::DT_BIN uses one byte per pixel. This class stores a binary image
+/// using one bit per pixel, reducing memory usage by a factor 8, and allowing logical operations, counting, and
+/// binary morphology to process 64 pixels at once.
+///
+/// Image lines along dimension 0 are packed into 64-bit words: pixel `x` of a line is bit `x % 64` of word `x / 64`.
+/// Each line starts at a new word, padding bits at the end of each line are always 0. Lines are stored in the order
+/// a \ref dip::ImageIterator with processing dimension 0 visits them (dimension 1 varies fastest). Direct access
+/// to the words of each line is available through \ref Line; when writing directly into the words, the padding bits
+/// must be kept at 0.
+///
+/// The object is a value type, copying it copies the data. There is no equivalent to the view semantics of
+/// \ref dip::Image. Use the constructor to convert a \ref dip::Image to this representation, and \ref Unpack to
+/// convert it back. To create a packed image too large to first hold as a \ref dip::Image, create an empty packed
+/// image of the right sizes, and use \ref Insert to fill it in piece by piece (for example one slice at a time).
+/// \ref Extract does the reverse.
+///
+/// \see dip::BinaryDilation(PackedBinaryImage const&, PackedBinaryImage&, dip::sint, dip::uint, String const&),
+///      dip::BinaryErosion(PackedBinaryImage const&, PackedBinaryImage&, dip::sint, dip::uint, String const&),
+///      dip::BinaryPropagation(PackedBinaryImage const&, PackedBinaryImage const&, PackedBinaryImage&, dip::sint, dip::uint, String const&),
+///      dip::BinaryLineDilation, dip::BinaryLineErosion,
+///      dip::CountNeighbors(PackedBinaryImage const&, Image&, dip::uint, String const&, String const&)
+class DIP_NO_EXPORT PackedBinaryImage {
+   public:
+      /// The type of a word, each word contains 64 pixels.
+      using Word = uint64;
+      /// The number of pixels in a word.
+      static constexpr dip::uint wordBits = 64;
+
+      /// \brief The default-initialized object has no pixels.
+      PackedBinaryImage() = default;
+
+      /// \brief Creates a packed image of the given sizes, with all pixels set to `value`.
+      /// `sizes` must have at least one element, and none of the sizes can be 0.
+      DIP_EXPORT explicit PackedBinaryImage( UnsignedArray sizes, bool value = false );
+
+      /// \brief Creates a packed image with the contents of `in`, which must be a forged scalar binary image
+      /// with at least one dimension.
+      DIP_EXPORT explicit PackedBinaryImage( Image const& in );
+
+      /// \brief Writes the contents into `out`, which will be reforged as a scalar binary image of the same sizes.
+      DIP_EXPORT void Unpack( Image& out ) const;
+      /// \brief Returns the contents as a scalar binary image.
+      DIP_NODISCARD Image Unpack() const {
+         Image out;
+         Unpack( out );
+         return out;
+      }
+
+      /// \brief Copies the contents of the binary image `in` into the packed image, with the first pixel of `in`
+      /// at `origin`. `in` must fit within the packed image, and cannot have more dimensions. If it has fewer dimensions,
+      /// singleton dimensions are added at the end.
+      DIP_EXPORT void Insert( Image const& in, UnsignedArray const& origin );
+
+      /// \brief Returns a binary image with the contents of the region of the packed image given by `origin` and
+      /// `sizes`.
+      DIP_NODISCARD DIP_EXPORT Image Extract( UnsignedArray const& origin, UnsignedArray const& sizes ) const;
+
+      /// \brief Returns true if the object contains data.
+      bool IsForged() const { return !data_.empty(); }
+
+      /// \brief Returns the image sizes.
+      UnsignedArray const& Sizes() const { return sizes_; }
+      /// \brief Returns the image dimensionality.
+      dip::uint Dimensionality() const { return sizes_.size(); }
+      /// \brief Returns the number of pixels.
+      dip::uint NumberOfPixels() const { return sizes_.product(); }
+      /// \brief Returns the number of words used to store each image line.
+      dip::uint WordsPerLine() const { return wordsPerLine_; }
+      /// \brief Returns the number of image lines.
+      dip::uint NumberOfLines() const { return nLines_; }
+      /// \brief Returns a mask for the last word of each line, bits corresponding to pixels within the image are set.
+      Word LastWordMask() const { return lastWordMask_; }
+
+      /// \brief Returns a pointer to the first word of line `line`.
+      Word* Line( dip::uint line ) { return data_.data() + line * wordsPerLine_; }
+      /// \brief Returns a pointer to the first word of line `line`.
+      Word const* Line( dip::uint line ) const { return data_.data() + line * wordsPerLine_; }
+
+      /// \brief Returns the value of the pixel at `coords`.
+      DIP_EXPORT bool At( UnsignedArray const& coords ) const;
+      /// \brief Sets the value of the pixel at `coords`.
+      DIP_EXPORT void Set( UnsignedArray const& coords, bool value );
+
+      /// \brief Sets all pixels to `value`.
+      DIP_EXPORT void Fill( bool value );
+
+      /// \brief Inverts all pixels.
+      DIP_EXPORT void Invert();
+
+      /// \brief Returns the number of set pixels.
+      DIP_EXPORT dip::uint Count() const;
+      /// \brief Returns true if any pixel is set.
+      DIP_EXPORT bool Any() const;
+      /// \brief Returns true if all pixels are set.
+      DIP_EXPORT bool All() const;
+
+      /// \brief Pixel-wise logical AND, the two images must have the same sizes.
+      DIP_EXPORT PackedBinaryImage& operator&=( PackedBinaryImage const& other );
+      /// \brief Pixel-wise logical OR, the two images must have the same sizes.
+      DIP_EXPORT PackedBinaryImage& operator|=( PackedBinaryImage const& other );
+      /// \brief Pixel-wise logical XOR, the two images must have the same sizes.
+      DIP_EXPORT PackedBinaryImage& operator^=( PackedBinaryImage const& other );
+
+      /// \brief Returns true if both images have the same sizes and pixel values.
+      bool operator==( PackedBinaryImage const& other ) const {
+         return ( sizes_ == other.sizes_ ) && ( data_ == other.data_ );
+      }
+      /// \brief Returns true if the images have different sizes or different pixel values.
+      bool operator!=( PackedBinaryImage const& other ) const {
+         return !( *this == other );
+      }
+
+      /// \brief Swaps `this` and `other`.
+      void swap( PackedBinaryImage& other ) noexcept {
+         using std::swap;
+         swap( sizes_, other.sizes_ );
+         swap( wordsPerLine_, other.wordsPerLine_ );
+         swap( nLines_, other.nLines_ );
+         swap( lastWordMask_, other.lastWordMask_ );
+         swap( data_, other.data_ );
+      }
+
+   private:
+      UnsignedArray sizes_;
+      dip::uint wordsPerLine_ = 0;
+      dip::uint nLines_ = 0;
+      Word lastWordMask_ = 0;
+      std::vector< Word > data_;
+
+      dip::uint LineIndex( UnsignedArray const& coords ) const;
+};
+
+inline void swap( PackedBinaryImage& v1, PackedBinaryImage& v2 ) noexcept {
+   v1.swap( v2 );
+}
+
+/// \brief Pixel-wise logical AND of two packed binary images.
+inline PackedBinaryImage operator&( PackedBinaryImage lhs, PackedBinaryImage const& rhs ) {
+   lhs &= rhs;
+   return lhs;
+}
+
+/// \brief Pixel-wise logical OR of two packed binary images.
+inline PackedBinaryImage operator|( PackedBinaryImage lhs, PackedBinaryImage const& rhs ) {
+   lhs |= rhs;
+   return lhs;
+}
+
+/// \brief Pixel-wise logical XOR of two packed binary images.
+inline PackedBinaryImage operator^( PackedBinaryImage lhs, PackedBinaryImage const& rhs ) {
+   lhs ^= rhs;
+   return lhs;
+}
+
+/// \brief Pixel-wise logical NOT of a packed binary image.
+inline PackedBinaryImage operator~( PackedBinaryImage in ) {
+   in.Invert();
+   return in;
+}
+
+/// \brief Binary morphological dilation operation on a packed binary image.
+///
+/// Yields the same result as \ref dip::BinaryDilation(Image const&, Image&, dip::sint, dip::uint, String const&),
+/// see there for the meaning of the parameters. Each iteration processes 64 pixels at once, and only image lines
+/// next to a line that changed in the previous iteration are processed. If there are enough of these lines,
+/// they are processed in parallel.
+///
+/// `in` and `out` can be the same object.
+DIP_EXPORT void BinaryDilation(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::BACKGROUND
+);
+DIP_NODISCARD inline PackedBinaryImage BinaryDilation(
+      PackedBinaryImage const& in,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   PackedBinaryImage out;
+   BinaryDilation( in, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Binary morphological erosion operation on a packed binary image.
+///
+/// Yields the same result as \ref dip::BinaryErosion(Image const&, Image&, dip::sint, dip::uint, String const&),
+/// see there for the meaning of the parameters. See
+/// \ref dip::BinaryDilation(PackedBinaryImage const&, PackedBinaryImage&, dip::sint, dip::uint, String const&)
+/// for details on the implementation.
+///
+/// `in` and `out` can be the same object.
+DIP_EXPORT void BinaryErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::BACKGROUND
+);
+DIP_NODISCARD inline PackedBinaryImage BinaryErosion(
+      PackedBinaryImage const& in,
+      dip::sint connectivity = -1,
+      dip::uint iterations = 3,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   PackedBinaryImage out;
+   BinaryErosion( in, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Conditional binary dilation on packed binary images.
+///
+/// Yields the same result as \ref dip::BinaryPropagation(Image const&, Image const&, Image&, dip::sint, dip::uint, String const&),
+/// see there for the meaning of the parameters. See
+/// \ref dip::BinaryDilation(PackedBinaryImage const&, PackedBinaryImage&, dip::sint, dip::uint, String const&)
+/// for details on the implementation.
+///
+/// If `iterations` is 0, the dilation is repeated until the result no longer changes. Note that, unlike for the
+/// \ref dip::Image overload, in this case the cost is proportional to the geodesic diameter of the mask.
+///
+/// `inSeed` and `out` can be the same object.
+DIP_EXPORT void BinaryPropagation(
+      PackedBinaryImage const& inSeed,
+      PackedBinaryImage const& inMask,
+      PackedBinaryImage& out,
+      dip::sint connectivity = 1,
+      dip::uint iterations = 0,
+      String const& edgeCondition = S::BACKGROUND
+);
+DIP_NODISCARD inline PackedBinaryImage BinaryPropagation(
+      PackedBinaryImage const& inSeed,
+      PackedBinaryImage const& inMask,
+      dip::sint connectivity = 1,
+      dip::uint iterations = 0,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   PackedBinaryImage out;
+   BinaryPropagation( inSeed, inMask, out, connectivity, iterations, edgeCondition );
+   return out;
+}
+
+/// \brief Binary dilation of a packed binary image with a line structuring element along one image axis.
+///
+/// The structuring element has `length` pixels along dimension `dimension`. For even lengths, the origin is
+/// placed to the right of the center, as for the rectangular structuring element in \ref dip::Dilation.
+/// The operation is computed with a logarithmic number of shift-and-OR passes over the packed data. By applying
+/// this function along each image dimension, a dilation with a rectangular structuring element is obtained.
+///
+/// `edgeCondition` determines the value of pixels outside the image domain, and can be `"object"` or `"background"`.
+///
+/// `in` and `out` can be the same object.
+DIP_EXPORT void BinaryLineDilation(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::uint dimension,
+      dip::uint length,
+      String const& edgeCondition = S::BACKGROUND
+);
+DIP_NODISCARD inline PackedBinaryImage BinaryLineDilation(
+      PackedBinaryImage const& in,
+      dip::uint dimension,
+      dip::uint length,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   PackedBinaryImage out;
+   BinaryLineDilation( in, out, dimension, length, edgeCondition );
+   return out;
+}
+
+/// \brief Binary erosion of a packed binary image with a line structuring element along one image axis.
+///
+/// See \ref dip::BinaryLineDilation for the meaning of the parameters.
+DIP_EXPORT void BinaryLineErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::uint dimension,
+      dip::uint length,
+      String const& edgeCondition = S::BACKGROUND
+);
+DIP_NODISCARD inline PackedBinaryImage BinaryLineErosion(
+      PackedBinaryImage const& in,
+      dip::uint dimension,
+      dip::uint length,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   PackedBinaryImage out;
+   BinaryLineErosion( in, out, dimension, length, edgeCondition );
+   return out;
+}
+
+/// \brief Counts the number of set neighbors for each pixel in the packed binary image `in`.
+///
+/// Yields the same result as \ref dip::CountNeighbors(Image const&, Image&, dip::uint, String const&, String const&),
+/// see there for the meaning of the parameters. The output is a \ref dip::DT_UINT8 image.
+///
+/// The counts are accumulated with bit-sliced adders, 64 pixels at a time.
+DIP_EXPORT void CountNeighbors(
+      PackedBinaryImage const& in,
+      Image& out,
+      dip::uint connectivity = 0,
+      String const& mode = S::FOREGROUND,
+      String const& edgeCondition = S::BACKGROUND
+);
+DIP_NODISCARD inline Image CountNeighbors(
+      PackedBinaryImage const& in,
+      dip::uint connectivity = 0,
+      String const& mode = S::FOREGROUND,
+      String const& edgeCondition = S::BACKGROUND
+) {
+   Image out;
+   CountNeighbors( in, out, connectivity, mode, edgeCondition );
+   return out;
+}
+
+/// \endgroup
+
+} // namespace dip
+
+#endif // DIP_PACKED_BINARY_H
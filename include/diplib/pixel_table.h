@@ -74,6 +74,18 @@ class DIP_NO_EXPORT PixelTable; // forward declaration, it's defined a little lo
 /// for( auto offset: offsets ) { ... }     // most efficient (when iterating many times)
 /// ```
 ///
+/// Filters that keep a running state over the neighborhood (a sum, a histogram, etc.) while moving it along
+/// the processing dimension only need to update that state with the pixels that leave and enter the neighborhood.
+/// \ref TrailingEdge and \ref LeadingEdge give the offsets to these pixels, one of each per run:
+///
+/// ```cpp
+/// for( dip::uint ii = 0; ii < pt.TrailingEdge().size(); ++ii ) {
+///    sum -= in[ pt.TrailingEdge()[ ii ]];
+///    sum += in[ pt.LeadingEdge()[ ii ]];
+/// }
+/// in += pt.Stride();                      // the neighborhood has moved by one pixel
+/// ```
+///
 /// \see dip::PixelTable, dip::Framework::Full, dip::ImageIterator
 class DIP_NO_EXPORT PixelTableOffsets {
    public:
@@ -138,8 +150,72 @@ class DIP_NO_EXPORT PixelTableOffsets {
       /// Computes an array with the offsets.
       std::vector< dip::sint > Offsets() const;
 
+      /// \brief Returns the offsets of the pixels that leave the neighborhood when it moves by one pixel along the
+      /// processing dimension. These are the first pixels of each run, in the same order as \ref Runs.
+      std::vector< dip::sint > const& TrailingEdge() const { return trailingEdge_; }
+
+      /// \brief Returns the offsets of the pixels that enter the neighborhood when it moves by one pixel along the
+      /// processing dimension. These are the pixels just past the end of each run, in the same order as \ref Runs.
+      ///
+      /// Like \ref TrailingEdge, the offsets are w.r.t. the origin of the neighborhood before it moves.
+      std::vector< dip::sint > const& LeadingEdge() const { return leadingEdge_; }
+
+      /// \brief Computes the weighted sum over the neighborhood for each of `length` consecutive pixels along
+      /// the processing dimension.
+      ///
+      /// `in` points to the first input pixel, `out` to the first output pixel, and `inStride` and `outStride` are
+      /// the strides along the line. `inStride` must be equal to \ref Stride. `weights` points to one weight for each
+      /// pixel in the neighborhood, in the order of \ref Offsets. These are typically the values of \ref Weights,
+      /// converted to `FloatType< TPI >` (or to `TPI` for complex weights) once, before processing the image.
+      ///
+      /// Rather than computing the sum over the neighborhood for each output pixel in turn, this function loops
+      /// over the pixels in the neighborhood, and adds the weighted input line to the output line. The inner loop
+      /// thus reads and writes consecutive samples, which the compiler can vectorize if both strides are 1.
+      /// For each output pixel, the terms are added in the same order as when looping over the neighborhood.
+      /// This is the preferred way of applying a weighted kernel in a \ref dip::Framework::FullLineFilter.
+      template< typename TPI, typename TW >
+      void WeightedSum(
+            TPI const* in,
+            dip::sint inStride,
+            TPI* out,
+            dip::sint outStride,
+            dip::uint length,
+            TW const* weights
+      ) const {
+         if(( inStride == 1 ) && ( outStride == 1 )) {
+            std::fill( out, out + length, TPI( 0 ));
+            for( auto const& run : runs_ ) {
+               TPI const* src = in + run.offset;
+               for( dip::uint jj = 0; jj < run.length; ++jj, ++src, ++weights ) {
+                  TW const weight = *weights;
+                  for( dip::uint ii = 0; ii < length; ++ii ) {
+                     out[ ii ] += src[ ii ] * weight;
+                  }
+               }
+            }
+         } else {
+            TPI* dest = out;
+            for( dip::uint ii = 0; ii < length; ++ii, dest += outStride ) {
+               *dest = TPI( 0 );
+            }
+            for( auto const& run : runs_ ) {
+               TPI const* src = in + run.offset;
+               for( dip::uint jj = 0; jj < run.length; ++jj, src += inStride, ++weights ) {
+                  TW const weight = *weights;
+                  TPI const* pin = src;
+                  dest = out;
+                  for( dip::uint ii = 0; ii < length; ++ii, pin += inStride, dest += outStride ) {
+                     *dest += *pin * weight;
+                  }
+               }
+            }
+         }
+      }
+
    private:
       std::vector< PixelRun > runs_;
+      std::vector< dip::sint > trailingEdge_; // run.offset for each run
+      std::vector< dip::sint > leadingEdge_;  // run.offset + run.length * stride_ for each run
       std::vector< dfloat > weights_;
       UnsignedArray sizes_;      // the size of the bounding box
       IntegerArray origin_;      // the coordinates of the origin w.r.t. the top-left corner of the bounding box
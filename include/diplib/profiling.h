@@ -0,0 +1,160 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DIP_PROFILING_H
+#define DIP_PROFILING_H
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "diplib.h"
+
+
+/// \file
+/// \brief Instrumentation of the frameworks and selected algorithms, to see where time is spent.
+/// See \ref testing.
+
+
+namespace dip {
+
+
+/// \addtogroup testing
+
+
+/// \brief Instrumentation of the frameworks and selected algorithms.
+///
+/// When profiling is enabled with \ref dip::profiling::Enable, every call to \ref dip::Framework::Scan,
+/// \ref dip::Framework::Separable, \ref dip::Framework::OneDimensionalLineFilter, \ref dip::Framework::Full
+/// and \ref dip::Framework::Projection records a
+/// \ref dip::profiling::Event, as do selected algorithms (for example \ref dip::Gauss, \ref dip::SeparableConvolution,
+/// \ref dip::ConvolveFT and \ref dip::FourierTransform). An event contains the image sizes and data types, the number
+/// of threads used, the number of bytes read and written, and the time spent in buffer conversion versus the time
+/// spent in the line filter. Framework events also record the name of the algorithm they were called from, if that
+/// algorithm is instrumented.
+///
+/// The events can be retrieved with \ref dip::profiling::Events, summarized with \ref dip::profiling::Report, or
+/// written as a JSON file that can be loaded into the Chrome trace viewer (`chrome://tracing`) or Perfetto
+/// (<https://ui.perfetto.dev>) with \ref dip::profiling::WriteChromeTrace.
+///
+/// ```cpp
+/// dip::profiling::Enable();
+/// dip::Gauss( img, out, { 4 } );
+/// dip::profiling::Enable( false );
+/// std::cout << dip::profiling::Report();
+/// dip::profiling::WriteChromeTrace( "trace.json" );
+/// ```
+///
+/// When profiling is disabled (the default), the overhead is a test of a flag for each image line processed,
+/// which does not touch shared data. When it is enabled, the frameworks read the clock twice for each image
+/// line processed.
+///
+/// Profiling is enabled or disabled for all threads at once. Events are recorded from any thread, and stored in
+/// a single list. At most 1,048,576 events are stored, further events are counted but discarded.
+namespace profiling {
+
+/// \brief Profiling data recorded for one framework call or one instrumented algorithm.
+///
+/// For algorithms, only `name`, `caller`, `sizes`, `tensorElements`, `inImageTypes`, `thread`, `start` and
+/// `duration` are filled out.
+///
+/// Times are wall-clock times in seconds. `conversionTime` and `filterTime` are summed over all threads,
+/// and are therefore not directly comparable to `duration` when multiple threads are used. The difference
+/// between `duration` and the sum of these two, divided by `nThreads`, is the overhead of the framework
+/// (allocating output images, starting threads, etc.).
+struct Event {
+   String name;                  ///< Name of the framework function or algorithm.
+   String caller;                ///< Name of the innermost instrumented algorithm active in the calling thread, if any.
+   String lineFilter;            ///< Type name of the line filter used by the framework (as given by `typeid`, compiler-specific).
+   UnsignedArray sizes;          ///< Sizes of the (first) input image, or of the output image if there are no inputs.
+   dip::uint tensorElements = 1; ///< Number of tensor elements of that image.
+   DataTypeArray inImageTypes;   ///< Data types of the input images.
+   DataTypeArray inBufferTypes;  ///< Data types of the input buffers given to the line filter.
+   DataTypeArray outBufferTypes; ///< Data types of the output buffers given to the line filter.
+   DataTypeArray outImageTypes;  ///< Data types of the output images.
+   dip::uint nThreads = 1;       ///< The number of threads used.
+   dip::uint operations = 0;     ///< The estimated number of operations compared to the multithreading threshold, 0 if not estimated.
+   dip::uint lines = 0;          ///< The number of image lines (or output pixels for the projection framework) processed.
+   dip::uint bytes = 0;          ///< The number of bytes read from the input images and written to the output images.
+   dip::uint thread = 0;         ///< An identifier for the calling thread, threads are numbered in order of first use.
+   double start = 0;             ///< Start time, in seconds since profiling was first enabled (or cleared).
+   double duration = 0;          ///< Duration of the call, in seconds.
+   double conversionTime = 0;    ///< Time spent copying data to and from buffers, summed over threads, in seconds.
+   double filterTime = 0;        ///< Time spent in the line filter, summed over threads, in seconds.
+};
+
+/// \brief Enables or disables profiling.
+DIP_EXPORT void Enable( bool enable = true );
+
+/// \brief Returns true if profiling is enabled.
+DIP_EXPORT bool IsEnabled();
+
+/// \brief Removes all recorded events, and resets the time origin.
+DIP_EXPORT void Clear();
+
+/// \brief Returns a copy of the recorded events, in the order in which they completed.
+DIP_EXPORT std::vector< Event > Events();
+
+/// \brief Returns a summary of the recorded events, as a table with one row per combination of `name` and `caller`.
+///
+/// For each row, the table gives the number of calls, the total duration, the total conversion and filter times,
+/// the average number of threads used, and the throughput (bytes read and written per second).
+DIP_EXPORT String Report();
+
+/// \brief Returns the recorded events in the Chrome trace event format (JSON).
+DIP_EXPORT String ChromeTrace();
+
+/// \brief Writes the recorded events in the Chrome trace event format (JSON) to the file `filename`.
+DIP_EXPORT void WriteChromeTrace( String const& filename );
+
+/// \brief Records an event for an algorithm.
+///
+/// Create an object of this type at the top of a function to time it. It records an event when it goes out
+/// of scope, if profiling was enabled when it was created. Framework calls made while the object exists, in the
+/// same thread, will have `name` as their `caller`.
+///
+/// `name` must be a string literal (or have static storage duration in some other way).
+///
+/// ```cpp
+/// void MyFilter( dip::Image const& in, dip::Image& out ) {
+///    dip::profiling::Region region( "MyFilter", in );
+///    // ...
+/// }
+/// ```
+class DIP_CLASS_EXPORT Region {
+   public:
+      /// \brief Starts timing the region `name`.
+      DIP_EXPORT explicit Region( char const* name );
+      /// \brief Starts timing the region `name`, records the sizes and data type of `image`.
+      DIP_EXPORT Region( char const* name, Image const& image );
+      Region( Region const& ) = delete;
+      Region& operator=( Region const& ) = delete;
+      /// \brief Records the event.
+      DIP_EXPORT ~Region();
+   private:
+      std::unique_ptr< Event > event_; // nullptr if profiling is disabled
+      char const* parent_ = nullptr;
+      std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace profiling
+
+/// \endgroup
+
+} // namespace dip
+
+#endif // DIP_PROFILING_H
@@ -19,6 +19,8 @@
 #define DIP_RANDOM_H
 
 
+#include <array>
+#include <cstdint>
 #include <limits>
 #include <random>
 
@@ -49,7 +51,8 @@ namespace dip {
 /// streams. This causes those algorithms to not replicate the same sequence when run with a different number
 /// of threads. Thus, even if seeded with the same value, the same algorithm can yield different results
 /// when run on a different computer with a different number of cores. To guarantee exact replicability,
-/// run your code single-threaded.
+/// run your code single-threaded. The noise generation functions, such as \ref dip::UniformNoise, instead use
+/// a \ref dip::CounterBasedRandom generator, and produce the same result independently of the number of threads.
 ///
 /// `Random` has a 128-bit internal state, and produces 64-bit output with a period of 2^128^.
 /// On architectures where 128-bit integers are not natively supported, this changes to have a 64-bit internal state,
@@ -134,6 +137,124 @@ class DIP_NO_EXPORT Random {
 };
 
 
+/// \brief A counter-based pseudo-random number generator, computes each random value directly from a key and a counter.
+///
+/// This generator implements the Philox-4x32-10 algorithm (Salmon et al., 2011). Unlike \ref dip::Random, it doesn't
+/// have a state that must be advanced sequentially, each random value is a function of the key (the seed) and the
+/// position in the sequence. The position is given by an index, set with \ref SetIndex, and a step, which is
+/// incremented with each call to `operator()`. Thus, using the linear index of a pixel as the index, each pixel of an
+/// image gets its own sequence of random values, which depends only on the seed and the pixel's location.
+/// Algorithms using this generator produce the same results independently of the number of threads used, or the
+/// order in which pixels are processed.
+///
+/// The `operator()` method returns the next 64-bit random integer in the sequence for the current index.
+/// Each call to \ref Generate produces 128 random bits, so pairs of consecutive values are obtained
+/// with a single call to that function.
+///
+/// Satisfies the requirements for [*UniformRandomBitGenerator*](https://en.cppreference.com/w/cpp/named_req/UniformRandomBitGenerator),
+/// and hence can be used in all algorithms of the standard library that require such an object. Note that some of
+/// the standard library's distributions cache values between calls, these must be reset when changing the index.
+///
+/// !!! literature
+///     - J.K. Salmon, M.A. Moraes, R.O. Dror and D.E. Shaw, "Parallel random numbers: as easy as 1, 2, 3",
+///       Proceedings of the International Conference for High Performance Computing, Networking, Storage and Analysis, 2011.
+///
+/// \see dip::Random
+class DIP_NO_EXPORT CounterBasedRandom {
+   public:
+      /// The type of the integer returned by the generator.
+      using result_type = std::uint64_t;
+      /// The type of the counter and of the output of \ref Generate.
+      using Block = std::array< std::uint32_t, 4 >;
+      /// The minimum possible value returned by the generator.
+      static constexpr result_type min() { return std::numeric_limits< result_type >::min(); }
+      /// The maximum possible value returned by the generator.
+      static constexpr result_type max() { return std::numeric_limits< result_type >::max(); }
+
+      /// The default random generator is initialized using `std::random_device`.
+      CounterBasedRandom() {
+         Seed();
+      }
+
+      /// Provide a seed to create a random generator that gives the same sequences every time.
+      explicit CounterBasedRandom( dip::uint seed ) {
+         Seed( seed );
+      }
+
+      /// Reseed the random generator using `std::random_device`.
+      void Seed() {
+         std::random_device device;
+         Seed( static_cast< dip::uint >(( static_cast< std::uint64_t >( device() ) << 32u ) ^ device() ));
+      }
+
+      /// Reseed the random generator using `seed`. The index is reset to 0.
+      void Seed( dip::uint seed ) {
+         key_ = { Low( seed ), High( seed ) };
+         SetIndex( 0 );
+      }
+
+      /// Start the sequence for index `index`.
+      void SetIndex( dip::uint index ) {
+         index_ = index;
+         step_ = 0;
+         available_ = 0;
+      }
+
+      /// Get the next random value in the sequence for the current index.
+      result_type operator()() {
+         if( available_ == 0 ) {
+            block_ = Generate( { Low( index_ ), High( index_ ), Low( step_ ), High( step_ ) } );
+            ++step_;
+            available_ = 2;
+         }
+         dip::uint ii = available_ == 2 ? 0 : 2;
+         --available_;
+         return ( static_cast< result_type >( block_[ ii + 1 ] ) << 32u ) | block_[ ii ];
+      }
+
+      /// \brief Converts a random value produced by this generator into a floating-point value uniformly distributed
+      /// in the half-open interval [0, 1), with 53 bits of precision.
+      static constexpr dfloat Canonical( result_type value ) {
+         return static_cast< dfloat >( value >> 11u ) * ( 1.0 / 9007199254740992.0 ); // 2^53
+      }
+
+      /// \brief Computes the Philox-4x32-10 function for `counter`, using the generator's key.
+      /// The result depends only on the seed and `counter`, not on the state of the generator.
+      Block Generate( Block counter ) const {
+         std::array< std::uint32_t, 2 > key = key_;
+         for( dip::uint round = 0; round < 10; ++round ) {
+            if( round > 0 ) {
+               key[ 0 ] += 0x9E3779B9u;
+               key[ 1 ] += 0xBB67AE85u;
+            }
+            std::uint64_t product0 = static_cast< std::uint64_t >( 0xD2511F53u ) * counter[ 0 ];
+            std::uint64_t product1 = static_cast< std::uint64_t >( 0xCD9E8D57u ) * counter[ 2 ];
+            counter = {
+                  static_cast< std::uint32_t >( product1 >> 32u ) ^ counter[ 1 ] ^ key[ 0 ],
+                  static_cast< std::uint32_t >( product1 ),
+                  static_cast< std::uint32_t >( product0 >> 32u ) ^ counter[ 3 ] ^ key[ 1 ],
+                  static_cast< std::uint32_t >( product0 )
+            };
+         }
+         return counter;
+      }
+
+   private:
+      std::array< std::uint32_t, 2 > key_{};
+      dip::uint index_ = 0;
+      dip::uint step_ = 0;
+      Block block_{};
+      dip::uint available_ = 0;
+
+      static std::uint32_t Low( dip::uint value ) {
+         return static_cast< std::uint32_t >( value );
+      }
+      static std::uint32_t High( dip::uint value ) {
+         return static_cast< std::uint32_t >( static_cast< std::uint64_t >( value ) >> 32u );
+      }
+};
+
+
 /// \brief Generates random floating-point values taken from a uniform distribution.
 ///
 /// The `operator()` method returns the next random value in the sequence. It takes two
@@ -194,6 +194,16 @@ DIP_NODISCARD inline Image Relabel( Image const& label, DirectedGraph const& gra
    return out;
 }
 
+/// \brief Re-assigns labels to objects in a labeled image, such that regions joined by an edge in `graph` obtain the same label.
+///
+/// \ref dip::CompactGraph version of the function above.
+DIP_EXPORT void Relabel( Image const& label, Image& out, CompactGraph const& graph );
+DIP_NODISCARD inline Image Relabel( Image const& label, CompactGraph const& graph ) {
+   Image out;
+   Relabel( label, out, graph );
+   return out;
+}
+
 /// \brief Removes small objects from a labeled or binary image.
 ///
 /// If `in` is an unsigned integer image, it is assumed to be a labeled image. The size of the objects
@@ -427,6 +437,98 @@ DIP_EXPORT Graph RegionAdjacencyGraph(
    String const& mode = "touching"
 );
 
+/// \brief The result of \ref dip::HierarchicalRegionMerging: the sequence of merges that joins the regions in a
+/// labeled image into ever larger regions.
+///
+/// Each region is identified by its smallest original label. That is, when two regions are merged, the resulting
+/// region is identified by the smaller of the two labels, the other label disappears. Thus, label IDs are stable
+/// when cutting the hierarchy at different levels.
+///
+/// Use \ref Cut or \ref CutNumberOfRegions to obtain a \ref dip::LabelMap, which can be applied to the labeled image
+/// to obtain the segmentation at a given level of the hierarchy. Cutting the hierarchy is cheap, no statistics
+/// are recomputed.
+///
+/// ```cpp
+/// dip::RegionMergeHierarchy hierarchy = dip::HierarchicalRegionMerging( label, grey );
+/// dip::Image coarse = hierarchy.Cut( 20.0 ).Apply( label );
+/// dip::Image tenRegions = hierarchy.CutNumberOfRegions( 10 ).Apply( label );
+/// ```
+class DIP_NO_EXPORT RegionMergeHierarchy {
+   public:
+      /// \brief One merge in the hierarchy.
+      struct Merge {
+         LabelType region1;  ///< The region that remains, `region1 < region2`
+         LabelType region2;  ///< The region that is merged into `region1`
+         dfloat cost;        ///< The cost of the merge, computed when the two regions were merged
+      };
+
+      RegionMergeHierarchy() = default;
+      RegionMergeHierarchy( std::vector< LabelType > labels, std::vector< Merge > merges )
+            : labels_( std::move( labels )), merges_( std::move( merges )) {}
+
+      /// \brief The labels of the regions in the input image, sorted.
+      std::vector< LabelType > const& Labels() const { return labels_; }
+
+      /// \brief The merges, in the order they were applied.
+      std::vector< Merge > const& Merges() const { return merges_; }
+
+      /// \brief The number of regions in the input image.
+      dip::uint NumberOfRegions() const { return labels_.size(); }
+
+      /// \brief Returns the map that applies the merges in order, stopping at the first merge with a cost larger
+      /// than `threshold`.
+      ///
+      /// Merge costs are not necessarily increasing (depending on the criterion used), so it is possible that
+      /// some merges after the first one that is not applied have a cost lower than `threshold`.
+      DIP_EXPORT LabelMap Cut( dfloat threshold ) const;
+
+      /// \brief Returns the map that applies the merges in order until `nRegions` regions are left.
+      ///
+      /// If the regions are not all connected, the hierarchy might end with more than `nRegions` regions.
+      DIP_EXPORT LabelMap CutNumberOfRegions( dip::uint nRegions ) const;
+
+   private:
+      std::vector< LabelType > labels_;
+      std::vector< Merge > merges_;
+
+      LabelMap Apply( dip::uint nMerges ) const;
+};
+
+/// \brief Merges the regions in a labeled image, two at a time, producing a full merge hierarchy.
+///
+/// Starting from the regions in `labels` (for example an oversegmentation produced by \ref dip::Watershed or
+/// \ref dip::Superpixels), the two adjacent regions with the lowest merge cost are merged, and this is repeated until
+/// all regions that are connected form a single region. The result is a \ref dip::RegionMergeHierarchy, which can
+/// be cut at any level without re-running the merging process.
+///
+/// Region adjacency is determined as in \ref dip::RegionAdjacencyGraph, with `mode` either `"touching"` or
+/// `"watershed"`. The background (label 0) is not merged.
+///
+/// For each region, its size, its mean value in `grey` and its boundary length (the number of boundary pixels shared
+/// with other regions) are kept. When merging two regions, these statistics are updated directly from the two
+/// regions' statistics, and only the costs of the edges that connect to the merged region are recomputed.
+/// A priority queue of edge costs determines which two regions to merge next. The images are read in three
+/// passes before merging starts (to find the largest label, the region adjacency and the region statistics);
+/// the merging process itself does not access the images.
+///
+/// `criterion` determines the merge cost for two regions *a* and *b*:
+///
+/// - `"mean"`: the Euclidean distance between the mean values of `grey` within the two regions.
+/// - `"Ward"`: Ward's criterion, the increase in the sum of square differences to the mean caused by the merge,
+///   $\frac{n_a n_b}{n_a + n_b} \| \mu_a - \mu_b \|^2$, with $n$ the size of the region and $\mu$ its mean value.
+///   This criterion tends to merge small regions first.
+/// - `"boundary"`: the edge weight used by \ref dip::RegionAdjacencyGraph: one minus the largest of the fractions of
+///   the boundaries of *a* and *b* that are shared between the two. `grey` is not used.
+///
+/// `grey` must be real-valued, and can have any number of tensor elements. It can be left unforged if `criterion`
+/// is `"boundary"`. `labels` must be a scalar image of an unsigned integer type. Labels do not need to be consecutive.
+DIP_EXPORT RegionMergeHierarchy HierarchicalRegionMerging(
+   Image const& labels,
+   Image const& grey,
+   String const& criterion = "mean",
+   String const& mode = "touching"
+);
+
 
 /// \endgroup
 
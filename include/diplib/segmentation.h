@@ -44,10 +44,20 @@ namespace dip {
 ///
 /// Note that this creates a spatial partitioning, not a partitioning of image intensities.
 ///
-/// K-means clustering is an iterative process with a random initialization. It is likely to get
-/// stuck in local minima. Repeating the clustering several times and picking the best result
-/// (e.g. determined by times each cluster center is found) can be necessary. You can leave out
-/// the \ref dip::Random` object in this function call, a default-initialized object will be used.
+/// K-means clustering is an iterative process with a random initialization. The initial cluster centers
+/// are chosen using the k-means++ algorithm, where each pixel has a probability of being picked proportional
+/// to its value times the squared distance to the nearest center already picked. The iterations use Hamerly's
+/// distance bounds to avoid computing most pixel-to-center distances, producing the same result as the
+/// standard (Lloyd's) algorithm at a fraction of the cost. Only pixels with a non-zero value take part
+/// in the clustering. This makes the function efficient when applied to a sparse image, such as
+/// a multi-dimensional histogram (see \ref dip::KMeansClustering( dip::Histogram const&, dip::uint )).
+/// The coordinates and values of the non-zero pixels are stored, and the iterations keep a cluster assignment
+/// and two distance bounds for each of them: the temporary memory used is about `8 * ( nDims + 4 )` bytes per
+/// non-zero pixel, with `nDims` the image dimensionality. For a dense 3D image this is 56 bytes per pixel.
+///
+/// K-means clustering is likely to get stuck in local minima. Repeating the clustering several times and
+/// picking the best result (e.g. determined by times each cluster center is found) can be necessary. You can
+/// leave out the \ref dip::Random` object in this function call, a default-initialized object will be used.
 ///
 /// The returned \ref dip::CoordinateArray contains the cluster centers.
 /// Element `i` in this array corresponds to label `i+1`.
@@ -714,9 +724,12 @@ DIP_NODISCARD inline Image Superpixels(
 /// allows us to have, for each pixel, either an edge to only the source or to only the sink, but never both. This
 /// saves a significant amount of memory and computation time.
 ///
-/// Finally, this function calls \ref GraphCut(DirectedGraph&, DirectedGraph::VertexIndex, DirectedGraph::VertexIndex)
-/// to compute the globally optimal segmentation of the graph. All pixels connected to the source node will
-/// become object pixels in the output binary image.
+/// Finally, the globally optimal segmentation of the graph is computed using the same algorithm as
+/// \ref GraphCut(DirectedGraph&, DirectedGraph::VertexIndex, DirectedGraph::VertexIndex). The graph is not
+/// stored explicitly: the neighbors of each pixel are implicit in the image grid, and the residual capacities of
+/// the edges are stored in one array per direction. This uses much less memory and is significantly faster than
+/// building a \ref dip::DirectedGraph. All pixels connected to the source node will become object pixels in the
+/// output binary image.
 ///
 /// `in` must be scalar and real-valued. `markers` must have the same sizes and be of an unsigned integer type.
 ///
@@ -725,7 +738,7 @@ DIP_NODISCARD inline Image Superpixels(
 ///       Proceedings Eighth IEEE International Conference on Computer Vision (ICCV 2001) 1:105-112, 2001.
 ///
 /// !!! attention
-///     This is a slow algorithm that uses a lot of memory. It is not suited for very large images.
+///     This algorithm can be slow for large images, and its memory usage is several times that of the input image.
 ///     It is usually advantageous to work with superpixels if a graph-cut segmentation is needed.
 DIP_EXPORT void GraphCut(
    Image const& in,
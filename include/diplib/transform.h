@@ -72,9 +72,23 @@ namespace dip {
 /// - "symmetric": the normalization is made symmetric, where both forward and inverse transforms
 ///   are normalized by the same amount. Each transform is multiplied by `1/sqrt(size)` for each
 ///   dimension. This makes the transform identical to how it was in *DIPlib 2*.
+/// - "half": the forward transform of a real-valued image produces only the non-redundant half of the
+///   spectrum, and the inverse transform takes such a half spectrum as input. See below.
 ///
 /// For tensor images, each plane is transformed independently.
 ///
+/// The Fourier transform of a real-valued image is conjugate symmetric, and thus half of it is redundant.
+/// With the "half" option, the forward transform of a real-valued image produces only the non-redundant half:
+/// along the first dimension in `process`, the output has `N/2+1` pixels instead of `N`. These are the first
+/// `N/2+1` pixels of the full transform, so the origin is at the last pixel along that dimension, or at the first
+/// pixel if "corner" is given. This halves the amount of memory used and roughly halves the computational cost.
+/// The half spectrum can be multiplied with other half spectra (e.g. with \ref dip::Multiply or
+/// \ref dip::MultiplyConjugate) as usual. The inverse transform with the "half" option takes such a half
+/// spectrum and produces a real-valued image (the "real" option is implied). Because the half spectrum doesn't
+/// record whether `N` was even or odd, the inverse transform produces an even size `2*(M-1)` along that dimension,
+/// with `M` the size of the half spectrum. Use \ref dip::InverseHalfFourierTransform to specify the output sizes,
+/// which is necessary if `N` was odd.
+///
 /// With the "fast" mode, the input might be padded. This padding causes the output to be interpolated.
 /// This is not always a problem when computing convolutions or correlations, but could introduce e.g. edge effects
 /// in the result of the convolution. The normalization applied relates to the output sizes, not the input
@@ -131,6 +145,32 @@ DIP_NODISCARD inline Image InverseFourierTransform(
    return out;
 }
 
+/// \brief Inverse Fourier Transform of a half spectrum, producing a real-valued image of sizes `sizes`.
+///
+/// `in` is a half spectrum, as produced by \ref FourierTransform with the "half" option. Because the half
+/// spectrum doesn't record whether the full spectrum had an even or odd size along the first dimension in
+/// `process`, the sizes of the output image must be given. `sizes` must match the sizes of `in` in all dimensions
+/// except that one, where `sizes[ ii ] / 2 + 1` must match the size of `in`.
+///
+/// Calls \ref FourierTransform after adding "inverse" and "half" to `options`.
+DIP_EXPORT void InverseHalfFourierTransform(
+      Image const& in,
+      Image& out,
+      UnsignedArray const& sizes,
+      StringSet options = {},
+      BooleanArray process = {}
+);
+DIP_NODISCARD inline Image InverseHalfFourierTransform(
+      Image const& in,
+      UnsignedArray const& sizes,
+      StringSet options = {},
+      BooleanArray process = {}
+) {
+   Image out;
+   InverseHalfFourierTransform( in, out, sizes, std::move( options ), std::move( process ));
+   return out;
+}
+
 /// \brief Returns the next larger (or smaller) multiple of small integers. An image of this size is more
 /// efficient for FFT computations.
 ///
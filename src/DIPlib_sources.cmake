@@ -51,6 +51,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/neighborlist.h
 ../include/diplib/nonlinear.h
 ../include/diplib/overload.h
+../include/diplib/packed_binary.h
 ../include/diplib/pixel_table.h
 ../include/diplib/polygon.h
 ../include/diplib/private/constfor.h
@@ -58,6 +59,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/private/robin_hash.h
 ../include/diplib/private/robin_map.h
 ../include/diplib/private/robin_set.h
+../include/diplib/profiling.h
 ../include/diplib/random.h
 ../include/diplib/regions.h
 ../include/diplib/saturated_arithmetic.h
@@ -85,7 +87,9 @@ binary/binary_support.h
 binary/bucket.h
 binary/count_neighbors.cpp
 binary/hilditch_condition_lut.h
+binary/packed_binary.cpp
 binary/skeleton.cpp
+binary/subiteration_skeleton.cpp
 binary/sup_inf_generator.cpp
 binary/thick_thin_2D.cpp
 color/cmyk.h
@@ -140,12 +144,13 @@ geometry/resampleat.cpp
 geometry/tile.cpp
 geometry/wrap.cpp
 histogram/distribution.cpp
-histogram/equalization.cpp
+histogram/histo_equalization.cpp
+histogram/histo_statistics.cpp
 histogram/histogram.cpp
 histogram/per_object_hist.cpp
-histogram/statistics.cpp
 histogram/threshold_algorithms.cpp
 histogram/threshold_algorithms.h
+library/benchmarks.cpp
 library/boundary.cpp
 library/copy_buffer.cpp
 library/datatype.cpp
@@ -167,6 +172,7 @@ library/multithreading.cpp
 library/neighborhood.cpp
 library/physical_dimensions.cpp
 library/pixel_table.cpp
+library/profiling.cpp
 library/types.cpp
 library/unit_tests.cpp
 linear/convolution.cpp
@@ -242,6 +248,7 @@ measurement/measure_polygon.cpp
 measurement/measurement.cpp
 measurement/measurement_tool.cpp
 measurement/object_to_measurement.cpp
+measurement/per_object_statistics.cpp
 measurement/polygon.cpp
 microscopy/attenuation_correction.cpp
 microscopy/colocalization.cpp
@@ -283,6 +290,7 @@ segmentation/superpixels.cpp
 segmentation/threshold.cpp
 statistics/copy_non_nan.h
 statistics/error.cpp
+statistics/per_label_reduction.h
 statistics/projection.cpp
 statistics/radial.cpp
 statistics/statistics.cpp
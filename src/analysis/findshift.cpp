@@ -52,17 +52,24 @@ void CrossCorrelationFT(
    DIP_STACK_TRACE_THIS( in2Spatial = BooleanFromString( in2Representation, S::SPATIAL, S::FREQUENCY ));
    bool outSpatial{};
    DIP_STACK_TRACE_THIS( outSpatial = BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY ));
+   // If all of the computation happens here, we compute only half the spectrum
+   bool half = in1Spatial && in2Spatial && outSpatial;
+   StringSet options;
+   if( half ) {
+      options.insert( S::HALF );
+   }
+   UnsignedArray sizes = in1.Sizes();
    Image in1FT;
    if( in1Spatial ) {
       DIP_THROW_IF( !in1.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-      DIP_STACK_TRACE_THIS( FourierTransform( in1, in1FT ));
+      DIP_STACK_TRACE_THIS( FourierTransform( in1, in1FT, options ));
    } else {
       in1FT = in1.QuickCopy();
    }
    Image in2FT;
    if( in2Spatial ) {
       DIP_THROW_IF( !in2.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-      DIP_STACK_TRACE_THIS( FourierTransform( in2, in2FT ));
+      DIP_STACK_TRACE_THIS( FourierTransform( in2, in2FT, options ));
    } else {
       in2FT = in2.QuickCopy();
    }
@@ -91,7 +98,11 @@ void CrossCorrelationFT(
       DIP_THROW_INVALID_FLAG( normalize );
    }
    if( outSpatial ) {
-      DIP_STACK_TRACE_THIS( FourierTransform( outFT, out, { S::INVERSE, S::REAL } ));
+      if( half ) {
+         DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( outFT, out, sizes ));
+      } else {
+         DIP_STACK_TRACE_THIS( FourierTransform( outFT, out, { S::INVERSE, S::REAL } ));
+      }
    }
 }
 
@@ -106,6 +117,18 @@ void AutoCorrelationFT(
    DIP_THROW_IF( in.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
    bool inSpatial{};
    DIP_STACK_TRACE_THIS( inSpatial = BooleanFromString( inRepresentation, S::SPATIAL, S::FREQUENCY ));
+   bool outSpatial{};
+   DIP_STACK_TRACE_THIS( outSpatial = BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY ));
+   if( inSpatial && outSpatial ) {
+      // All of the computation happens here, we compute only half the spectrum
+      DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+      UnsignedArray sizes = in.Sizes();
+      Image inFT;
+      DIP_STACK_TRACE_THIS( FourierTransform( in, inFT, { S::HALF } ));
+      SquareModulus( inFT, inFT );
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( inFT, out, sizes ));
+      return;
+   }
    Image inFT;
    if( inSpatial ) {
       DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
@@ -114,7 +137,7 @@ void AutoCorrelationFT(
       inFT = in.QuickCopy();
    }
    SquareModulus( inFT, out );
-   if( BooleanFromString( outRepresentation, S::SPATIAL, S::FREQUENCY )) {
+   if( outSpatial ) {
       DIP_STACK_TRACE_THIS( FourierTransform( out, out, { S::INVERSE, S::REAL } ));
    }
 }
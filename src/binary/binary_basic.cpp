@@ -19,26 +19,22 @@
 
 #include "diplib.h"
 #include "diplib/distance.h"
-#include "diplib/neighborlist.h"
+#include "diplib/packed_binary.h"
 #include "diplib/regions.h"
 
-#include "binary_support.h"
-
 namespace dip {
 
 namespace {
 
 
 // Worker function for both dilation and erosion, since they are very alike
-template< typename F >
 void BinaryDilationErosion(
       Image const& in,
       Image& out,
       dip::sint connectivity,
       dip::uint iterations,
       String const& s_edgeCondition,
-      bool findObjectPixels,
-      F const& propagationOperation
+      bool dilation
 ) {
    // Verify that the image is forged, scalar and binary
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
@@ -47,88 +43,24 @@ void BinaryDilationErosion(
    dip::uint nDims = in.Dimensionality();
    DIP_THROW_IF( connectivity > static_cast< dip::sint >( nDims ), E::ILLEGAL_CONNECTIVITY );
 
-   // Edge condition: true means object, false means background
-   bool outsideImageIsObject{};
-   DIP_STACK_TRACE_THIS( outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
-
-   // Copy input plane to output plane. Operation takes place directly in the output plane.
    Image c_in = in; // temporary copy of image header, so we can strip out. NOLINT(*-unnecessary-copy-initialization)
-   out.ReForge( in.Sizes(), 1, DT_BIN ); // reforging first in case `out` is the right size but a different data type
-   out.Copy( c_in );
-
-   // Negative connectivity means: alternate between two different connectivities
-
-   // Create arrays with offsets to neighbours for even iterations
-   dip::uint iterConnectivity0 = GetAbsBinaryConnectivity( nDims, connectivity, 0 );
-   NeighborList neighborList0( { Metric::TypeCode::CONNECTED, iterConnectivity0 }, nDims );
-   IntegerArray neighborOffsetsOut0 = neighborList0.ComputeOffsets( out.Strides() );
-
-   // Create arrays with offsets to neighbours for odd iterations
-   dip::uint iterConnectivity1 = GetAbsBinaryConnectivity( nDims, connectivity, 1 );
-   NeighborList neighborList1( { Metric::TypeCode::CONNECTED, iterConnectivity1 }, nDims );
-   IntegerArray neighborOffsetsOut1 = neighborList1.ComputeOffsets( out.Strides() );
-
-   // Data mask: the pixel data is in the first 'plane'
-   uint8 dataMask = 1;
-
-   // Use border mask to mark pixels of the image border
-   uint8 borderMask = uint8( 1 << 2 );
-   ApplyBinaryBorderMask( out, borderMask );
-
-   // The edge pixel queue
-   BinaryFifoQueue edgePixels;
-
-   // Initialize the queue by finding all edge pixels of the type according to findObjectPixels
-   FindBinaryEdgePixels( out, findObjectPixels, neighborList0, neighborOffsetsOut0, dataMask, borderMask, outsideImageIsObject, edgePixels );
-
-   // First iteration: simply process the queue
-   if( iterations > 0 ) {
-      for( BinaryFifoQueue::const_iterator itEP = edgePixels.begin(); itEP != edgePixels.end(); ++itEP ) {
-         propagationOperation( static_cast< uint8& >( **itEP ), dataMask );
-      }
+   if(( iterations == 0 ) || ( nDims == 0 )) {
+      DIP_STACK_TRACE_THIS( BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND )); // Tests the flag for validity
+      out.ReForge( in.Sizes(), 1, DT_BIN ); // reforging first in case `out` is the right size but a different data type
+      out.Copy( c_in );
+      return;
    }
 
-   // Create a coordinates computer for bounds checking of border pixels
-   CoordinatesComputer const coordsComputer = out.OffsetToCoordinatesComputer();
-
-   // Second and further iterations
-   for( dip::uint iDilIter = 1; iDilIter < iterations; ++iDilIter ) {
-      // Obtain neighbor list and offsets for this iteration
-      NeighborList const& neighborList = iDilIter & 1 ? neighborList1 : neighborList0;
-      IntegerArray const& neighborOffsetsOut = iDilIter & 1 ? neighborOffsetsOut1 : neighborOffsetsOut0;
-
-      // Process all elements currently in the queue
-      dip::sint count = static_cast< dip::sint >( edgePixels.size() );
-
-      while( --count >= 0 ) {
-         // Get front pixel from the queue
-         dip::bin* pPixel = edgePixels.front();
-         uint8& pixelByte = static_cast< uint8& >( *pPixel );
-         bool isBorderPixel = TestAnyBit( pixelByte, borderMask );
-
-         // Propagate to all neighbours which are not yet processed
-         dip::IntegerArray::const_iterator itNeighborOffset = neighborOffsetsOut.begin();
-         for( NeighborList::Iterator itNeighbor = neighborList.begin(); itNeighbor != neighborList.end(); ++itNeighbor, ++itNeighborOffset ) {
-            if( !isBorderPixel || itNeighbor.IsInImage( coordsComputer( pPixel - static_cast< dip::bin* >( out.Origin() )), out.Sizes() )) { // IsInImage() is not evaluated for non-border pixels
-               dip::bin* pNeighbor = pPixel + *itNeighborOffset;
-               uint8& neighborByte = static_cast< uint8& >( *pNeighbor );
-               bool neighborIsObject = TestAnyBit( neighborByte, dataMask );
-               if( neighborIsObject == findObjectPixels ) {
-                  // Propagate to the neighbor pixel
-                  propagationOperation( neighborByte, dataMask );
-                  // Add neighbor to the queue
-                  edgePixels.push_back( pNeighbor );
-               }
-            }
-         }
-
-         // Remove the front pixel from the queue
-         edgePixels.pop_front();
-      }
+   // The operation takes place on a bit-packed copy of the input, 64 pixels are processed at once.
+   // `BinaryDilation` and `BinaryErosion` test `s_edgeCondition`, and `Unpack` reforges `out`.
+   PackedBinaryImage image( c_in );
+   if( dilation ) {
+      DIP_STACK_TRACE_THIS( BinaryDilation( image, image, connectivity, iterations, s_edgeCondition ));
+   } else {
+      DIP_STACK_TRACE_THIS( BinaryErosion( image, image, connectivity, iterations, s_edgeCondition ));
    }
-
-   // Clear the edge mask of the image border
-   ClearBinaryBorderMask( out, borderMask );
+   image.Unpack( out );
+   out.CopyNonDataProperties( c_in );
 }
 
 } // namespace
@@ -140,9 +72,7 @@ void BinaryDilation(
       dip::uint iterations,
       String const& edgeCondition
 ) {
-   bool findObjectPixels = false; // Dilation propagates to background pixels
-   auto propagationFunc = []( uint8& pixel, uint8 dataMask ) { SetBits( pixel, dataMask ); };   // Propagate by adding the data mask
-   BinaryDilationErosion( in, out, connectivity, iterations, edgeCondition, findObjectPixels, propagationFunc );
+   BinaryDilationErosion( in, out, connectivity, iterations, edgeCondition, true );
 }
 
 void BinaryErosion(
@@ -152,9 +82,7 @@ void BinaryErosion(
       dip::uint iterations,
       String const& edgeCondition
 ) {
-   bool findObjectPixels = true; // Erosion propagates to object pixels
-   auto propagationFunc = []( uint8& pixel, uint8 dataMask ) { ResetBits( pixel, dataMask ); };  // Propagate by removing the data mask
-   BinaryDilationErosion( in, out, connectivity, iterations, edgeCondition, findObjectPixels, propagationFunc );
+   BinaryDilationErosion( in, out, connectivity, iterations, edgeCondition, false );
 }
 
 void BinaryOpening(
@@ -284,6 +212,31 @@ DOCTEST_TEST_CASE( "[DIPlib] testing the binary morphological filters" ) {
    dip::BinaryErosion( out, out, -2, 7 );
    DOCTEST_CHECK( dip::Count( out ) == 1 );
    DOCTEST_CHECK( out.At( 32, 20 ) == 1 );
+
+   // Lines longer than one 64-bit word, propagating across word boundaries
+   in = dip::Image( { 130, 9, 7 }, 1, dip::DT_BIN );
+   in = 0;
+   in.At( 63, 4, 3 ) = 1;
+   dip::BinaryDilation( in, out, 1, 1 );
+   DOCTEST_CHECK( dip::Count( out ) == 7 );
+   DOCTEST_CHECK( out.At( 64, 4, 3 ) == 1 );
+   DOCTEST_CHECK( out.At( 62, 4, 3 ) == 1 );
+   dip::BinaryDilation( in, out, 3, 2 );
+   DOCTEST_CHECK( dip::Count( out ) == 5 * 5 * 5 );
+   dip::Image mask = in.Similar();
+   mask = 1;
+   dip::BinaryPropagation( in, mask, out, 3, 2 );
+   DOCTEST_CHECK( dip::Count( out ) == 5 * 5 * 5 );
+
+   // Edge conditions
+   in = true;
+   dip::BinaryErosion( in, out, 1, 1, "background" );
+   DOCTEST_CHECK( dip::Count( out ) == 128 * 7 * 5 );
+   dip::BinaryErosion( in, out, 1, 1, "object" );
+   DOCTEST_CHECK( dip::Count( out ) == in.NumberOfPixels() );
+   in = false;
+   dip::BinaryDilation( in, out, 2, 1, "object" );
+   DOCTEST_CHECK( dip::Count( out ) == in.NumberOfPixels() - 128 * 7 * 5 );
 }
 
 #endif // DIP_CONFIG_ENABLE_DOCTEST
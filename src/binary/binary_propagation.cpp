@@ -26,8 +26,7 @@
 #include "diplib/generation.h"
 #include "diplib/iterators.h"
 #include "diplib/neighborlist.h"
-
-#include "binary_support.h"
+#include "diplib/packed_binary.h"
 
 namespace dip {
 
@@ -197,13 +196,6 @@ void BinaryPropagation_Fast (
 }
 
 
-// Bit planes
-constexpr uint8 dataBitmask{ 1u }; // Data mask: the pixel data is in the first 'plane'.
-constexpr uint8 borderBitmask{ 1u << 2u };
-constexpr uint8 maskBitmask{ 1u << 3u };
-constexpr uint8 maskOrDataBitmask = dataBitmask | maskBitmask;
-
-
 void BinaryPropagation_Iterative(
       Image& out,
       Image const& inMask,
@@ -211,93 +203,10 @@ void BinaryPropagation_Iterative(
       dip::uint iterations,
       bool outsideImageIsObject
 ) {
-   // Use border mask to mark pixels of the image border
-   ApplyBinaryBorderMask( out, borderBitmask );
-
-   // Add mask plane to out image
-   JointImageIterator< bin, bin > itInMaskOut( { inMask, out } );
-   itInMaskOut.OptimizeAndFlatten();
-   do {
-      if( itInMaskOut.In() ) {
-         SetBits( *reinterpret_cast< uint8* >( itInMaskOut.OutPointer() ), maskBitmask );
-      }
-   } while( ++itInMaskOut );
-
-   // Create arrays with offsets to neighbours for even iterations
-   dip::uint nDims = out.Dimensionality();
-   dip::uint iterConnectivity0 = GetAbsBinaryConnectivity( nDims, connectivity, 0 );
-   NeighborList neighborList0( { Metric::TypeCode::CONNECTED, iterConnectivity0 }, nDims );
-   IntegerArray neighborOffsetsOut0 = neighborList0.ComputeOffsets( out.Strides() );
-
-   // Create arrays with offsets to neighbours for odd iterations
-   dip::uint iterConnectivity1 = GetAbsBinaryConnectivity( nDims, connectivity, 1 ); // won't throw
-   NeighborList neighborList1( { Metric::TypeCode::CONNECTED, iterConnectivity1 }, nDims );
-   IntegerArray neighborOffsetsOut1 = neighborList1.ComputeOffsets( out.Strides() );
-
-   // Initialize the queue by finding all edge pixels of type 'background'
-   BinaryFifoQueue edgePixels;
-   bool findObjectPixels = false;
-   FindBinaryEdgePixels( out, findObjectPixels, neighborList0, neighborOffsetsOut0, dataBitmask, borderBitmask, outsideImageIsObject, edgePixels );
-
-   // First iteration: process all elements in the queue a first time
-   dip::uint count = edgePixels.size();
-   for( dip::uint jj = 0; jj < count; ++jj ) {
-      bin* pPixel = edgePixels.front();
-      uint8& pixelByte = *reinterpret_cast< uint8* >( pPixel );
-      if(( pixelByte & maskOrDataBitmask ) == maskBitmask ) {
-         SetBits( pixelByte, dataBitmask );
-         edgePixels.push_back( pPixel );
-      }
-      // Remove the front pixel from the queue
-      edgePixels.pop_front();
-   }
-
-   // Create a coordinates computer for bounds checking of border pixels
-   CoordinatesComputer const coordsComputer = out.OffsetToCoordinatesComputer();
-
-   // Second and further iterations. Loop stops if the queue is empty
-   for( dip::uint ii = 1; ( ii < iterations ) && !edgePixels.empty(); ++ii ) {
-      // Obtain neighbor list and offsets for this iteration
-      NeighborList const& neighborList = ( ii & 1u ) == 1 ? neighborList1 : neighborList0;
-      IntegerArray const& neighborOffsetsOut = ( ii & 1u ) == 1 ? neighborOffsetsOut1 : neighborOffsetsOut0;
-
-      // Process all elements currently in the queue
-      count = edgePixels.size();
-      for( dip::uint jj = 0; jj < count; ++jj ) {
-         // Get front pixel from the queue
-         bin* pPixel = edgePixels.front();
-         edgePixels.pop_front();
-         uint8& pixelByte = *reinterpret_cast< uint8* >( pPixel );
-         bool isBorderPixel = TestAnyBit( pixelByte, borderBitmask );
-
-         // Propagate to all neighbours which are not yet processed
-         IntegerArray::const_iterator itNeighborOffset = neighborOffsetsOut.begin();
-         for( NeighborList::Iterator itNeighbor = neighborList.begin(); itNeighbor != neighborList.end(); ++itNeighbor, ++itNeighborOffset ) {
-            if( !isBorderPixel || itNeighbor.IsInImage( coordsComputer( pPixel - static_cast< bin* >( out.Origin() )), out.Sizes() )) { // IsInImage() is not evaluated for non-border pixels
-               bin* pNeighbor = pPixel + *itNeighborOffset;
-               uint8& neighborByte = *reinterpret_cast< uint8* >( pNeighbor );
-               // If the neighbor has the mask-bit (means: propagation allowed)
-               // but not the seed-bit (means: not yet processed),
-               // process this neighbor.
-               if(( neighborByte & maskOrDataBitmask ) == maskBitmask ) {
-                  // Propagate to the neighbor pixel
-                  SetBits( neighborByte, dataBitmask );
-                  // Add neighbor to the queue
-                  edgePixels.push_back( pNeighbor );
-               }
-            }
-         }
-      }
-   }
-
-   // Final step: pixels have their data bit set iff they have both seed-bit and mask-bit
-   // The result is stored in a way that resets all bits except bit 0
-   // This means that the border mask is also removed
-   ImageIterator< bin > itOut( out );
-   itOut.OptimizeAndFlatten();
-   do {
-      *itOut = TestAllBits( static_cast< uint8 >( *itOut ), maskOrDataBitmask );
-   } while( ++itOut );
+   // Conditional dilation on bit-packed copies of the seed and mask images, 64 pixels are processed at once.
+   PackedBinaryImage seed( out );
+   BinaryPropagation( seed, PackedBinaryImage( inMask ), seed, connectivity, iterations, outsideImageIsObject ? S::OBJECT : S::BACKGROUND );
+   seed.Unpack( out );
 }
 
 } // namespace
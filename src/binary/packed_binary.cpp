@@ -0,0 +1,923 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib/packed_binary.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "diplib.h"
+#include "diplib/binary.h"
+#include "diplib/iterators.h"
+#include "diplib/multithreading.h"
+#include "diplib/neighborlist.h"
+
+#include "binary_support.h"
+
+namespace dip {
+
+using Word = PackedBinaryImage::Word;
+constexpr dip::uint wordBits = PackedBinaryImage::wordBits;
+
+namespace {
+
+// Sets the bits [ begin, end ) of a line
+void SetBitRange( Word* line, dip::uint begin, dip::uint end ) {
+   for( dip::uint x = begin; x < end; ) {
+      dip::uint ww = x / wordBits;
+      dip::uint bb = x % wordBits;
+      dip::uint n = std::min( wordBits - bb, end - x );
+      Word mask = n == wordBits ? ~Word( 0 ) : (( Word( 1 ) << n ) - 1 ) << bb;
+      line[ ww ] |= mask;
+      x += n;
+   }
+}
+
+dip::uint PopCount( Word value ) {
+#if defined( __GNUC__ ) || defined( __clang__ )
+   return static_cast< dip::uint >( __builtin_popcountll( value ));
+#else
+   value = value - (( value >> 1u ) & 0x5555555555555555u );
+   value = ( value & 0x3333333333333333u ) + (( value >> 2u ) & 0x3333333333333333u );
+   value = ( value + ( value >> 4u )) & 0x0F0F0F0F0F0F0F0Fu;
+   return static_cast< dip::uint >(( value * 0x0101010101010101u ) >> 56u );
+#endif
+}
+
+} // namespace
+
+PackedBinaryImage::PackedBinaryImage( UnsignedArray sizes, bool value ) : sizes_( std::move( sizes )) {
+   DIP_THROW_IF( sizes_.empty(), E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF(( sizes_ == dip::uint( 0 )).any(), E::INVALID_PARAMETER );
+   wordsPerLine_ = div_ceil( sizes_[ 0 ], wordBits );
+   nLines_ = sizes_.product() / sizes_[ 0 ];
+   dip::uint remainder = sizes_[ 0 ] % wordBits;
+   lastWordMask_ = remainder == 0 ? ~Word( 0 ) : ( Word( 1 ) << remainder ) - 1;
+   data_.resize( wordsPerLine_ * nLines_, 0 );
+   if( value ) {
+      Fill( true );
+   }
+}
+
+PackedBinaryImage::PackedBinaryImage( Image const& in ) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !in.DataType().IsBinary(), E::IMAGE_NOT_BINARY );
+   DIP_STACK_TRACE_THIS( PackedBinaryImage( in.Sizes() ).swap( *this ));
+   dip::uint size = sizes_[ 0 ];
+   dip::sint stride = in.Stride( 0 );
+   dip::uint line = 0;
+   ImageIterator< bin > it( in, 0 );
+   do {
+      bin const* src = it.Pointer();
+      Word* dest = Line( line );
+      for( dip::uint x = 0, ww = 0; ww < wordsPerLine_; ++ww ) {
+         dip::uint n = std::min( wordBits, size - x );
+         Word word = 0;
+         for( dip::uint bb = 0; bb < n; ++bb, src += stride ) {
+            word |= static_cast< Word >( static_cast< bool >( *src )) << bb;
+         }
+         dest[ ww ] = word;
+         x += n;
+      }
+      ++line;
+   } while( ++it );
+}
+
+void PackedBinaryImage::Unpack( Image& out ) const {
+   DIP_THROW_IF( !IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_STACK_TRACE_THIS( out.ReForge( sizes_, 1, DT_BIN ));
+   dip::uint size = sizes_[ 0 ];
+   dip::sint stride = out.Stride( 0 );
+   dip::uint line = 0;
+   ImageIterator< bin > it( out, 0 );
+   do {
+      bin* dest = it.Pointer();
+      Word const* src = Line( line );
+      for( dip::uint x = 0, ww = 0; ww < wordsPerLine_; ++ww ) {
+         dip::uint n = std::min( wordBits, size - x );
+         Word word = src[ ww ];
+         for( dip::uint bb = 0; bb < n; ++bb, dest += stride ) {
+            *dest = static_cast< bool >(( word >> bb ) & 1u );
+         }
+         x += n;
+      }
+      ++line;
+   } while( ++it );
+}
+
+void PackedBinaryImage::Insert( Image const& c_in, UnsignedArray const& origin ) {
+   DIP_THROW_IF( !IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !c_in.DataType().IsBinary(), E::IMAGE_NOT_BINARY );
+   dip::uint nDims = Dimensionality();
+   DIP_THROW_IF( c_in.Dimensionality() > nDims, E::DIMENSIONALITIES_DONT_MATCH );
+   DIP_THROW_IF( origin.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   Image in = c_in.QuickCopy();
+   if( in.Dimensionality() < nDims ) {
+      in.ExpandDimensionality( nDims );
+   }
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      DIP_THROW_IF( origin[ ii ] + in.Size( ii ) > sizes_[ ii ], E::INDEX_OUT_OF_RANGE );
+   }
+   dip::uint size = in.Size( 0 );
+   dip::sint stride = in.Stride( 0 );
+   UnsignedArray coords( nDims );
+   ImageIterator< bin > it( in, 0 );
+   do {
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         coords[ ii ] = origin[ ii ] + it.Coordinates()[ ii ];
+      }
+      Word* dest = Line( LineIndex( coords ));
+      bin const* src = it.Pointer();
+      for( dip::uint x = origin[ 0 ]; x < origin[ 0 ] + size; ++x, src += stride ) {
+         Word bit = Word( 1 ) << ( x % wordBits );
+         if( *src ) {
+            dest[ x / wordBits ] |= bit;
+         } else {
+            dest[ x / wordBits ] &= ~bit;
+         }
+      }
+   } while( ++it );
+}
+
+Image PackedBinaryImage::Extract( UnsignedArray const& origin, UnsignedArray const& sizes ) const {
+   DIP_THROW_IF( !IsForged(), E::IMAGE_NOT_FORGED );
+   dip::uint nDims = Dimensionality();
+   DIP_THROW_IF( origin.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   DIP_THROW_IF( sizes.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      DIP_THROW_IF( origin[ ii ] + sizes[ ii ] > sizes_[ ii ], E::INDEX_OUT_OF_RANGE );
+   }
+   Image out( sizes, 1, DT_BIN );
+   dip::sint stride = out.Stride( 0 );
+   UnsignedArray coords( nDims );
+   ImageIterator< bin > it( out, 0 );
+   do {
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         coords[ ii ] = origin[ ii ] + it.Coordinates()[ ii ];
+      }
+      Word const* src = Line( LineIndex( coords ));
+      bin* dest = it.Pointer();
+      for( dip::uint x = origin[ 0 ]; x < origin[ 0 ] + sizes[ 0 ]; ++x, dest += stride ) {
+         *dest = static_cast< bool >(( src[ x / wordBits ] >> ( x % wordBits )) & 1u );
+      }
+   } while( ++it );
+   return out;
+}
+
+dip::uint PackedBinaryImage::LineIndex( UnsignedArray const& coords ) const {
+   dip::uint line = 0;
+   for( dip::uint ii = sizes_.size() - 1; ii > 0; --ii ) {
+      line = line * sizes_[ ii ] + coords[ ii ];
+   }
+   return line;
+}
+
+bool PackedBinaryImage::At( UnsignedArray const& coords ) const {
+   DIP_THROW_IF( coords.size() != Dimensionality(), E::ARRAY_PARAMETER_WRONG_LENGTH );
+   DIP_THROW_IF( !( coords < sizes_ ), E::INDEX_OUT_OF_RANGE );
+   Word const* line = Line( LineIndex( coords ));
+   return (( line[ coords[ 0 ] / wordBits ] >> ( coords[ 0 ] % wordBits )) & 1u ) != 0;
+}
+
+void PackedBinaryImage::Set( UnsignedArray const& coords, bool value ) {
+   DIP_THROW_IF( coords.size() != Dimensionality(), E::ARRAY_PARAMETER_WRONG_LENGTH );
+   DIP_THROW_IF( !( coords < sizes_ ), E::INDEX_OUT_OF_RANGE );
+   Word* line = Line( LineIndex( coords ));
+   Word bit = Word( 1 ) << ( coords[ 0 ] % wordBits );
+   if( value ) {
+      line[ coords[ 0 ] / wordBits ] |= bit;
+   } else {
+      line[ coords[ 0 ] / wordBits ] &= ~bit;
+   }
+}
+
+void PackedBinaryImage::Fill( bool value ) {
+   std::fill( data_.begin(), data_.end(), value ? ~Word( 0 ) : Word( 0 ));
+   if( value && ( lastWordMask_ != ~Word( 0 ))) {
+      for( dip::uint line = 0; line < nLines_; ++line ) {
+         Line( line )[ wordsPerLine_ - 1 ] = lastWordMask_;
+      }
+   }
+}
+
+void PackedBinaryImage::Invert() {
+   for( dip::uint line = 0; line < nLines_; ++line ) {
+      Word* ptr = Line( line );
+      for( dip::uint ww = 0; ww < wordsPerLine_; ++ww ) {
+         ptr[ ww ] = ~ptr[ ww ];
+      }
+      ptr[ wordsPerLine_ - 1 ] &= lastWordMask_;
+   }
+}
+
+dip::uint PackedBinaryImage::Count() const {
+   dip::uint count = 0;
+   for( Word word : data_ ) {
+      count += PopCount( word );
+   }
+   return count;
+}
+
+bool PackedBinaryImage::Any() const {
+   return std::any_of( data_.begin(), data_.end(), []( Word word ) { return word != 0; } );
+}
+
+bool PackedBinaryImage::All() const {
+   for( dip::uint line = 0; line < nLines_; ++line ) {
+      Word const* ptr = Line( line );
+      for( dip::uint ww = 0; ww < wordsPerLine_ - 1; ++ww ) {
+         if( ptr[ ww ] != ~Word( 0 )) {
+            return false;
+         }
+      }
+      if( ptr[ wordsPerLine_ - 1 ] != lastWordMask_ ) {
+         return false;
+      }
+   }
+   return IsForged();
+}
+
+PackedBinaryImage& PackedBinaryImage::operator&=( PackedBinaryImage const& other ) {
+   DIP_THROW_IF( sizes_ != other.sizes_, E::SIZES_DONT_MATCH );
+   for( dip::uint ii = 0; ii < data_.size(); ++ii ) {
+      data_[ ii ] &= other.data_[ ii ];
+   }
+   return *this;
+}
+
+PackedBinaryImage& PackedBinaryImage::operator|=( PackedBinaryImage const& other ) {
+   DIP_THROW_IF( sizes_ != other.sizes_, E::SIZES_DONT_MATCH );
+   for( dip::uint ii = 0; ii < data_.size(); ++ii ) {
+      data_[ ii ] |= other.data_[ ii ];
+   }
+   return *this;
+}
+
+PackedBinaryImage& PackedBinaryImage::operator^=( PackedBinaryImage const& other ) {
+   DIP_THROW_IF( sizes_ != other.sizes_, E::SIZES_DONT_MATCH );
+   for( dip::uint ii = 0; ii < data_.size(); ++ii ) {
+      data_[ ii ] ^= other.data_[ ii ];
+   }
+   return *this;
+}
+
+namespace {
+
+// The neighbors of a pixel, grouped by line. For each neighboring line we record which of the pixels at x-1, x
+// and x+1 are neighbors.
+struct LineNeighbor {
+   IntegerArray displacement; // displacement along dimensions 1 and up
+   dip::sint offset = 0;      // displacement in number of lines
+   bool left = false;         // the pixel at x-1 is a neighbor
+   bool center = false;       // the pixel at x is a neighbor
+   bool right = false;        // the pixel at x+1 is a neighbor
+};
+using LineNeighborhood = std::vector< LineNeighbor >;
+
+// For dilation, the neighborhood must include the central pixel.
+LineNeighborhood CreateLineNeighborhood(
+      dip::uint nDims,
+      dip::uint connectivity,
+      IntegerArray const& lineStrides,
+      bool includeCenter
+) {
+   LineNeighborhood neighborhood;
+   auto add = [ & ]( IntegerArray const& coords ) {
+      IntegerArray displacement( nDims - 1 );
+      for( dip::uint ii = 1; ii < nDims; ++ii ) {
+         displacement[ ii - 1 ] = coords[ ii ];
+      }
+      auto it = std::find_if( neighborhood.begin(), neighborhood.end(), [ & ]( LineNeighbor const& n ) {
+         return n.displacement == displacement;
+      } );
+      if( it == neighborhood.end() ) {
+         LineNeighbor n;
+         n.displacement = displacement;
+         for( dip::uint ii = 0; ii < nDims - 1; ++ii ) {
+            n.offset += displacement[ ii ] * lineStrides[ ii ];
+         }
+         neighborhood.push_back( std::move( n ));
+         it = neighborhood.end() - 1;
+      }
+      switch( coords[ 0 ] ) {
+         case -1: it->left = true; break;
+         case 0: it->center = true; break;
+         default: it->right = true; break;
+      }
+   };
+   NeighborList neighborList( { Metric::TypeCode::CONNECTED, connectivity }, nDims );
+   for( NeighborList::Iterator itNeighbor = neighborList.begin(); itNeighbor != neighborList.end(); ++itNeighbor ) {
+      add( itNeighbor.Coordinates() );
+   }
+   if( includeCenter ) {
+      add( IntegerArray( nDims, 0 ));
+   }
+   return neighborhood;
+}
+
+// Sizes of and strides along the dimensions perpendicular to the lines (strides in number of lines)
+void LineGeometry( UnsignedArray const& sizes, UnsignedArray& lineSizes, IntegerArray& lineStrides ) {
+   dip::uint nDims = sizes.size();
+   lineSizes.resize( nDims - 1 );
+   lineStrides.resize( nDims - 1 );
+   dip::sint stride = 1;
+   for( dip::uint ii = 1; ii < nDims; ++ii ) {
+      lineSizes[ ii - 1 ] = sizes[ ii ];
+      lineStrides[ ii - 1 ] = stride;
+      stride *= static_cast< dip::sint >( sizes[ ii ] );
+   }
+}
+
+void LineCoordinates( dip::uint line, UnsignedArray const& lineSizes, UnsignedArray& coords ) {
+   for( dip::uint ii = 0; ii < lineSizes.size(); ++ii ) {
+      coords[ ii ] = line % lineSizes[ ii ];
+      line /= lineSizes[ ii ];
+   }
+}
+
+// Is the line at `coords + sign * displacement` within the image?
+bool LineIsInImage( UnsignedArray const& coords, IntegerArray const& displacement, dip::sint sign, UnsignedArray const& lineSizes ) {
+   for( dip::uint ii = 0; ii < coords.size(); ++ii ) {
+      dip::sint pos = static_cast< dip::sint >( coords[ ii ] ) + sign * displacement[ ii ];
+      if(( pos < 0 ) || ( pos >= static_cast< dip::sint >( lineSizes[ ii ] ))) {
+         return false;
+      }
+   }
+   return true;
+}
+
+// Each line has two buffers: the one in the image and one in `other_`. The current value of a line is in one of
+// them, the next value is written to the other one. This way we never need to copy lines that don't change.
+class LineBuffers {
+   public:
+      explicit LineBuffers( PackedBinaryImage& image ) :
+            image_( image ),
+            other_( image.NumberOfLines() * image.WordsPerLine() ),
+            current_( image.NumberOfLines(), 0 ) {}
+
+      Word const* Current( dip::uint line ) const {
+         return current_[ line ] ? other_.data() + line * image_.WordsPerLine() : image_.Line( line );
+      }
+
+      Word* Next( dip::uint line ) {
+         return current_[ line ] ? image_.Line( line ) : other_.data() + line * image_.WordsPerLine();
+      }
+
+      void Flip( dip::uint line ) {
+         current_[ line ] ^= 1u;
+      }
+
+      // Copies current values back into the image
+      void Finalize() {
+         dip::uint nWords = image_.WordsPerLine();
+         for( dip::uint line = 0; line < current_.size(); ++line ) {
+            if( current_[ line ] ) {
+               Word const* src = other_.data() + line * nWords;
+               std::copy( src, src + nWords, image_.Line( line ));
+               current_[ line ] = 0;
+            }
+         }
+      }
+
+   private:
+      PackedBinaryImage& image_;
+      std::vector< Word > other_;
+      std::vector< uint8 > current_;
+};
+
+// Computes the next value of one line, returns true if it changed.
+bool DilateLine(
+      LineBuffers& buffers,
+      PackedBinaryImage const* mask,
+      dip::uint line,
+      UnsignedArray const& coords,
+      UnsignedArray const& lineSizes,
+      LineNeighborhood const& neighborhood,
+      dip::uint nWords,
+      dip::uint lastBit,
+      Word lastWordMask,
+      bool outsideImageIsObject
+) {
+   Word* out = buffers.Next( line );
+   std::fill( out, out + nWords, Word( 0 ));
+   for( auto const& n : neighborhood ) {
+      if( !LineIsInImage( coords, n.displacement, 1, lineSizes )) {
+         if( outsideImageIsObject ) {
+            std::fill( out, out + nWords, ~Word( 0 ));
+            break;
+         }
+         continue;
+      }
+      Word const* in = buffers.Current( static_cast< dip::uint >( static_cast< dip::sint >( line ) + n.offset ));
+      if( n.center ) {
+         for( dip::uint ww = 0; ww < nWords; ++ww ) {
+            out[ ww ] |= in[ ww ];
+         }
+      }
+      if( n.left ) { // out[ x ] |= in[ x - 1 ]
+         Word carry = outsideImageIsObject ? 1u : 0u;
+         for( dip::uint ww = 0; ww < nWords; ++ww ) {
+            out[ ww ] |= ( in[ ww ] << 1u ) | carry;
+            carry = in[ ww ] >> ( wordBits - 1 );
+         }
+      }
+      if( n.right ) { // out[ x ] |= in[ x + 1 ]
+         for( dip::uint ww = 0; ww < nWords - 1; ++ww ) {
+            out[ ww ] |= ( in[ ww ] >> 1u ) | ( in[ ww + 1 ] << ( wordBits - 1 ));
+         }
+         out[ nWords - 1 ] |= in[ nWords - 1 ] >> 1u;
+         if( outsideImageIsObject ) {
+            out[ nWords - 1 ] |= Word( 1 ) << lastBit;
+         }
+      }
+   }
+   out[ nWords - 1 ] &= lastWordMask;
+   Word const* current = buffers.Current( line );
+   if( mask ) {
+      Word const* maskLine = mask->Line( line );
+      for( dip::uint ww = 0; ww < nWords; ++ww ) {
+         out[ ww ] &= maskLine[ ww ] | current[ ww ];
+      }
+   }
+   return !std::equal( out, out + nWords, current );
+}
+
+void PackedDilation(
+      PackedBinaryImage& image,
+      PackedBinaryImage const* mask,
+      dip::sint connectivity,
+      dip::uint iterations,
+      bool outsideImageIsObject
+) {
+   dip::uint nDims = image.Dimensionality();
+   dip::uint nLines = image.NumberOfLines();
+   if(( iterations == 0 ) || ( nLines == 0 )) {
+      return;
+   }
+   DIP_ASSERT( !mask || ( mask->Sizes() == image.Sizes() ));
+   dip::uint nWords = image.WordsPerLine();
+   dip::uint lastBit = ( image.Sizes()[ 0 ] - 1 ) % wordBits;
+   Word lastWordMask = image.LastWordMask();
+
+   UnsignedArray lineSizes;
+   IntegerArray lineStrides;
+   LineGeometry( image.Sizes(), lineSizes, lineStrides );
+
+   // Neighborhoods for even and odd iterations
+   LineNeighborhood neighborhood0 = CreateLineNeighborhood( nDims, GetAbsBinaryConnectivity( nDims, connectivity, 0 ), lineStrides, true );
+   LineNeighborhood neighborhood1 = CreateLineNeighborhood( nDims, GetAbsBinaryConnectivity( nDims, connectivity, 1 ), lineStrides, true );
+
+   LineBuffers buffers( image );
+   std::vector< dip::uint > active( nLines );
+   std::iota( active.begin(), active.end(), dip::uint( 0 ));
+   std::vector< dip::uint > next;
+   std::vector< uint8 > changed( nLines, 0 );
+   std::vector< uint8 > queued( nLines, 0 );
+   UnsignedArray coords( nDims - 1 );
+
+   for( dip::uint iter = 0; ( iter < iterations ) && !active.empty(); ++iter ) {
+      LineNeighborhood const& neighborhood = ( iter & 1u ) ? neighborhood1 : neighborhood0;
+
+      // Compute the next value for all active lines. Each line is written independently of the others,
+      // so lines can be processed in parallel.
+      dip::uint nThreads = 1;
+      dip::uint operations = active.size() * nWords * neighborhood.size() * 4;
+      if( operations >= threadingThreshold ) {
+         nThreads = std::min( GetNumberOfThreads(), active.size() );
+      }
+      dip::sint nActive = static_cast< dip::sint >( active.size() );
+      #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+      {
+         UnsignedArray lineCoords( nDims - 1 );
+         #pragma omp for schedule( static )
+         for( dip::sint ii = 0; ii < nActive; ++ii ) {
+            dip::uint line = active[ static_cast< dip::uint >( ii ) ];
+            LineCoordinates( line, lineSizes, lineCoords );
+            changed[ line ] = DilateLine( buffers, mask, line, lineCoords, lineSizes, neighborhood,
+                                          nWords, lastBit, lastWordMask, outsideImageIsObject );
+         }
+      }
+
+      // Make the new values current, and find the lines that depend on the ones that changed:
+      // these need to be processed in the next iteration.
+      LineNeighborhood const& nextNeighborhood = ( iter & 1u ) ? neighborhood0 : neighborhood1;
+      next.clear();
+      for( dip::uint line : active ) {
+         if( !changed[ line ] ) {
+            continue;
+         }
+         buffers.Flip( line );
+         LineCoordinates( line, lineSizes, coords );
+         for( auto const& n : nextNeighborhood ) {
+            if( LineIsInImage( coords, n.displacement, -1, lineSizes )) {
+               dip::uint dependent = static_cast< dip::uint >( static_cast< dip::sint >( line ) - n.offset );
+               if( !queued[ dependent ] ) {
+                  queued[ dependent ] = 1;
+                  next.push_back( dependent );
+               }
+            }
+         }
+      }
+      for( dip::uint line : next ) {
+         queued[ line ] = 0;
+      }
+      std::sort( next.begin(), next.end() ); // Improves memory access patterns
+      active.swap( next );
+   }
+
+   buffers.Finalize();
+}
+
+// dst[ x ] = src[ x + shift ], pixels outside of the line are `fill`.
+void ShiftLine(
+      Word const* src,
+      Word* dst,
+      dip::uint nWords,
+      dip::uint length,
+      dip::sint shift,
+      bool fill,
+      Word lastWordMask
+) {
+   dip::sint sWords = static_cast< dip::sint >( nWords );
+   if( shift >= 0 ) {
+      dip::sint wordShift = shift / static_cast< dip::sint >( wordBits );
+      dip::uint bitShift = static_cast< dip::uint >( shift ) % wordBits;
+      for( dip::sint ww = 0; ww < sWords; ++ww ) {
+         Word lo = ww + wordShift < sWords ? src[ ww + wordShift ] : 0u;
+         Word hi = ww + wordShift + 1 < sWords ? src[ ww + wordShift + 1 ] : 0u;
+         dst[ ww ] = bitShift == 0 ? lo : ( lo >> bitShift ) | ( hi << ( wordBits - bitShift ));
+      }
+      if( fill ) {
+         dip::uint begin = static_cast< dip::uint >( shift ) >= length ? 0 : length - static_cast< dip::uint >( shift );
+         SetBitRange( dst, begin, length );
+      }
+   } else {
+      dip::sint wordShift = -shift / static_cast< dip::sint >( wordBits );
+      dip::uint bitShift = static_cast< dip::uint >( -shift ) % wordBits;
+      for( dip::sint ww = 0; ww < sWords; ++ww ) {
+         Word lo = ww - wordShift - 1 >= 0 ? src[ ww - wordShift - 1 ] : 0u;
+         Word hi = ww - wordShift >= 0 ? src[ ww - wordShift ] : 0u;
+         dst[ ww ] = bitShift == 0 ? hi : ( hi << bitShift ) | ( lo >> ( wordBits - bitShift ));
+      }
+      if( fill ) {
+         SetBitRange( dst, 0, std::min( static_cast< dip::uint >( -shift ), length ));
+      }
+   }
+   dst[ nWords - 1 ] &= lastWordMask;
+}
+
+// out[ x ] = in[ x + shift * e_dimension ], pixels outside the image are `fill`.
+void ShiftImage( PackedBinaryImage const& in, PackedBinaryImage& out, dip::uint dimension, dip::sint shift, bool fill ) {
+   dip::uint nWords = in.WordsPerLine();
+   dip::uint nLines = in.NumberOfLines();
+   if( dimension == 0 ) {
+      for( dip::uint line = 0; line < nLines; ++line ) {
+         ShiftLine( in.Line( line ), out.Line( line ), nWords, in.Sizes()[ 0 ], shift, fill, in.LastWordMask() );
+      }
+      return;
+   }
+   UnsignedArray lineSizes;
+   IntegerArray lineStrides;
+   LineGeometry( in.Sizes(), lineSizes, lineStrides );
+   dip::uint size = lineSizes[ dimension - 1 ];
+   dip::sint stride = lineStrides[ dimension - 1 ];
+   for( dip::uint line = 0; line < nLines; ++line ) {
+      dip::sint pos = static_cast< dip::sint >(( line / static_cast< dip::uint >( stride )) % size ) + shift;
+      Word* dst = out.Line( line );
+      if(( pos >= 0 ) && ( pos < static_cast< dip::sint >( size ))) {
+         Word const* src = in.Line( static_cast< dip::uint >( static_cast< dip::sint >( line ) + shift * stride ));
+         std::copy( src, src + nWords, dst );
+      } else {
+         std::fill( dst, dst + nWords, fill ? ~Word( 0 ) : Word( 0 ));
+         dst[ nWords - 1 ] &= in.LastWordMask();
+      }
+   }
+}
+
+// out |= OR_{j=0..extent} in[ x + j * direction * e_dimension ], computed with a logarithmic number of passes.
+void WindowOr(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::uint dimension,
+      dip::uint extent,
+      dip::sint direction,
+      bool outsideImageIsObject
+) {
+   PackedBinaryImage window = in;
+   PackedBinaryImage tmp( in.Sizes() );
+   dip::uint length = extent + 1;
+   dip::uint width = 1; // `window[ x ]` is the OR over `width` pixels starting at `x`
+   while( 2 * width <= length ) {
+      ShiftImage( window, tmp, dimension, direction * static_cast< dip::sint >( width ), outsideImageIsObject );
+      window |= tmp;
+      width *= 2;
+   }
+   if( width < length ) {
+      // Two overlapping windows of size `width` cover `length` pixels.
+      ShiftImage( window, tmp, dimension, direction * static_cast< dip::sint >( length - width ), outsideImageIsObject );
+      window |= tmp;
+   }
+   out |= window;
+}
+
+void PackedLineDilation( PackedBinaryImage& image, dip::uint dimension, dip::uint length, bool outsideImageIsObject ) {
+   if( length <= 1 ) {
+      return;
+   }
+   // The structuring element covers `backward` pixels to the left of the origin and `forward` pixels to its right.
+   dip::uint backward = length / 2;
+   dip::uint forward = ( length - 1 ) / 2;
+   PackedBinaryImage out( image.Sizes() );
+   WindowOr( image, out, dimension, backward, -1, outsideImageIsObject );
+   if( forward > 0 ) {
+      WindowOr( image, out, dimension, forward, 1, outsideImageIsObject );
+   }
+   image.swap( out );
+}
+
+} // namespace
+
+void BinaryDilation(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( connectivity > static_cast< dip::sint >( in.Dimensionality() ), E::ILLEGAL_CONNECTIVITY );
+   bool outsideImageIsObject{};
+   DIP_STACK_TRACE_THIS( outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+   if( &out != &in ) {
+      out = in;
+   }
+   DIP_STACK_TRACE_THIS( PackedDilation( out, nullptr, connectivity, iterations, outsideImageIsObject ));
+}
+
+void BinaryErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( connectivity > static_cast< dip::sint >( in.Dimensionality() ), E::ILLEGAL_CONNECTIVITY );
+   bool outsideImageIsObject{};
+   DIP_STACK_TRACE_THIS( outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+   if( &out != &in ) {
+      out = in;
+   }
+   // Erosion is the dilation of the background, with the opposite edge condition.
+   out.Invert();
+   DIP_STACK_TRACE_THIS( PackedDilation( out, nullptr, connectivity, iterations, !outsideImageIsObject ));
+   out.Invert();
+}
+
+void BinaryPropagation(
+      PackedBinaryImage const& inSeed,
+      PackedBinaryImage const& inMask,
+      PackedBinaryImage& out,
+      dip::sint connectivity,
+      dip::uint iterations,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !inMask.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( inSeed.IsForged() && ( inSeed.Sizes() != inMask.Sizes() ), E::SIZES_DONT_MATCH );
+   DIP_THROW_IF( connectivity > static_cast< dip::sint >( inMask.Dimensionality() ), E::ILLEGAL_CONNECTIVITY );
+   bool outsideImageIsObject{};
+   DIP_STACK_TRACE_THIS( outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+   PackedBinaryImage maskCopy;
+   PackedBinaryImage const* mask = &inMask;
+   if( &out == &inMask ) {
+      maskCopy = inMask;
+      mask = &maskCopy;
+   }
+   if( !inSeed.IsForged() ) {
+      PackedBinaryImage( mask->Sizes() ).swap( out );
+   } else if( &out != &inSeed ) {
+      out = inSeed;
+   }
+   if( iterations == 0 ) {
+      iterations = std::numeric_limits< dip::uint >::max(); // Iterate until nothing changes
+   }
+   DIP_STACK_TRACE_THIS( PackedDilation( out, mask, connectivity, iterations, outsideImageIsObject ));
+   // Turn off seed pixels outside the mask
+   out &= *mask;
+}
+
+void BinaryLineDilation(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::uint dimension,
+      dip::uint length,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( dimension >= in.Dimensionality(), E::ILLEGAL_DIMENSION );
+   bool outsideImageIsObject{};
+   DIP_STACK_TRACE_THIS( outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+   if( &out != &in ) {
+      out = in;
+   }
+   PackedLineDilation( out, dimension, length, outsideImageIsObject );
+}
+
+void BinaryLineErosion(
+      PackedBinaryImage const& in,
+      PackedBinaryImage& out,
+      dip::uint dimension,
+      dip::uint length,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( dimension >= in.Dimensionality(), E::ILLEGAL_DIMENSION );
+   bool outsideImageIsObject{};
+   DIP_STACK_TRACE_THIS( outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+   if( &out != &in ) {
+      out = in;
+   }
+   out.Invert();
+   PackedLineDilation( out, dimension, length, !outsideImageIsObject );
+   out.Invert();
+}
+
+void CountNeighbors(
+      PackedBinaryImage const& in,
+      Image& out,
+      dip::uint connectivity,
+      String const& s_mode,
+      String const& s_edgeCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( connectivity > nDims, E::ILLEGAL_CONNECTIVITY );
+   bool all{};
+   bool outsideImageIsObject{};
+   DIP_START_STACK_TRACE
+      all = BooleanFromString( s_mode, S::ALL, S::FOREGROUND );
+      outsideImageIsObject = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND );
+      out.ReForge( in.Sizes(), 1, DT_UINT8 );
+   DIP_END_STACK_TRACE
+   UnsignedArray lineSizes;
+   IntegerArray lineStrides;
+   LineGeometry( in.Sizes(), lineSizes, lineStrides );
+   LineNeighborhood neighborhood = CreateLineNeighborhood( nDims, connectivity, lineStrides, false );
+   dip::uint nNeighbors = 1; // the pixel itself
+   for( auto const& n : neighborhood ) {
+      nNeighbors += static_cast< dip::uint >( n.left ) + static_cast< dip::uint >( n.center ) + static_cast< dip::uint >( n.right );
+   }
+   dip::uint nPlanes = 1;
+   while(( dip::uint( 1 ) << nPlanes ) <= nNeighbors ) {
+      ++nPlanes;
+   }
+   dip::uint nWords = in.WordsPerLine();
+   dip::uint nLines = in.NumberOfLines();
+   dip::uint length = in.Sizes()[ 0 ];
+   Word lastWordMask = in.LastWordMask();
+   dip::sint outStride = out.Stride( 0 );
+
+   dip::uint nThreads = 1;
+   if( nLines * nWords * nNeighbors * nPlanes >= threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), nLines );
+   }
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      // The count for each pixel is stored in bit planes: bit `jj` of the count for pixel `x` is bit `x` of `planes[ jj ]`.
+      std::vector< Word > planes( nPlanes * nWords );
+      std::vector< Word > shifted( nWords );
+      UnsignedArray coords( nDims, 0 );
+      UnsignedArray lineCoords( nDims - 1 );
+      auto add = [ & ]( Word const* value ) {
+         for( dip::uint ww = 0; ww < nWords; ++ww ) {
+            Word carry = value[ ww ];
+            for( dip::uint jj = 0; ( jj < nPlanes ) && carry; ++jj ) {
+               Word& plane = planes[ jj * nWords + ww ];
+               Word newCarry = plane & carry;
+               plane ^= carry;
+               carry = newCarry;
+            }
+         }
+      };
+      #pragma omp for schedule( static )
+      for( dip::sint ll = 0; ll < static_cast< dip::sint >( nLines ); ++ll ) {
+         dip::uint line = static_cast< dip::uint >( ll );
+         std::fill( planes.begin(), planes.end(), Word( 0 ));
+         Word const* center = in.Line( line );
+         add( center );
+         LineCoordinates( line, lineSizes, lineCoords );
+         for( auto const& n : neighborhood ) {
+            if( !LineIsInImage( lineCoords, n.displacement, 1, lineSizes )) {
+               if( outsideImageIsObject ) {
+                  std::fill( shifted.begin(), shifted.end(), ~Word( 0 ));
+                  shifted[ nWords - 1 ] = lastWordMask;
+                  dip::uint count = static_cast< dip::uint >( n.left ) + static_cast< dip::uint >( n.center ) + static_cast< dip::uint >( n.right );
+                  for( dip::uint ii = 0; ii < count; ++ii ) {
+                     add( shifted.data() );
+                  }
+               }
+               continue;
+            }
+            Word const* neighbor = in.Line( static_cast< dip::uint >( static_cast< dip::sint >( line ) + n.offset ));
+            if( n.center ) {
+               add( neighbor );
+            }
+            if( n.left ) {
+               ShiftLine( neighbor, shifted.data(), nWords, length, -1, outsideImageIsObject, lastWordMask );
+               add( shifted.data() );
+            }
+            if( n.right ) {
+               ShiftLine( neighbor, shifted.data(), nWords, length, 1, outsideImageIsObject, lastWordMask );
+               add( shifted.data() );
+            }
+         }
+         // Write out the counts
+         for( dip::uint ii = 1; ii < nDims; ++ii ) {
+            coords[ ii ] = lineCoords[ ii - 1 ];
+         }
+         uint8* dest = static_cast< uint8* >( out.Pointer( coords ));
+         for( dip::uint x = 0; x < length; ++x, dest += outStride ) {
+            dip::uint ww = x / wordBits;
+            dip::uint bb = x % wordBits;
+            dip::uint count = 0;
+            if( all || (( center[ ww ] >> bb ) & 1u )) {
+               for( dip::uint jj = 0; jj < nPlanes; ++jj ) {
+                  count |= static_cast< dip::uint >(( planes[ jj * nWords + ww ] >> bb ) & 1u ) << jj;
+               }
+            }
+            *dest = clamp_cast< uint8 >( count );
+         }
+      }
+   }
+}
+
+} // namespace dip
+
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/random.h"
+#include "diplib/generation.h"
+#include "diplib/morphology.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing the packed binary image" ) {
+   dip::Random random( 0 );
+   dip::Image grey( { 131, 23, 5 }, 1, dip::DT_SFLOAT );
+   grey = 0;
+   dip::UniformNoise( grey, grey, random );
+   dip::Image in = grey > 0.7;
+   dip::PackedBinaryImage packed( in );
+   DOCTEST_CHECK( packed.Count() == dip::Count( in ));
+   DOCTEST_CHECK( dip::Count( packed.Unpack() != in ) == 0 );
+   DOCTEST_CHECK( packed.At( { 70, 11, 2 } ) == static_cast< bool >( in.At< dip::bin >( 70, 11, 2 )));
+   DOCTEST_CHECK( packed.Any() );
+   DOCTEST_CHECK( !packed.All() );
+   DOCTEST_CHECK(( ~packed | packed ).All() );
+   DOCTEST_CHECK( !( ~packed & packed ).Any() );
+   DOCTEST_CHECK(( packed ^ packed ).Count() == 0 );
+
+   // Insert and extract
+   dip::PackedBinaryImage copy( in.Sizes() );
+   copy.Insert( in.At( dip::Range( 0, 69 ), dip::Range{}, dip::Range{} ), { 0, 0, 0 } );
+   copy.Insert( in.At( dip::Range( 70, -1 ), dip::Range{}, dip::Range{} ), { 70, 0, 0 } );
+   DOCTEST_CHECK( copy == packed );
+   dip::Image slice = in.At( dip::Range{}, dip::Range{}, dip::Range{ 3 } );
+   DOCTEST_CHECK( dip::Count( packed.Extract( { 0, 0, 3 }, { 131, 23, 1 } ) != slice ) == 0 );
+
+   // Line SEs compared to the general dilation and erosion
+   dip::PackedBinaryImage result = dip::BinaryLineDilation( dip::BinaryLineDilation( packed, 0, 70 ), 1, 4 );
+   dip::Image reference = dip::Dilation( in, { { 70, 4, 1 }, "rectangular" } );
+   DOCTEST_CHECK( dip::Count( result.Unpack() != reference ) == 0 );
+   result = dip::BinaryLineErosion( dip::BinaryLineErosion( packed, 0, 3, "object" ), 2, 3, "object" );
+   reference = dip::Erosion( in, { { 3, 1, 3 }, "rectangular" } );
+   DOCTEST_CHECK( dip::Count( result.Unpack() != reference ) == 0 );
+
+   // Neighbor counts compared to the unpacked version
+   for( dip::uint connectivity = 1; connectivity <= 3; ++connectivity ) {
+      dip::Image count = dip::CountNeighbors( packed, connectivity, "all", "object" );
+      DOCTEST_CHECK( dip::Count( count != dip::CountNeighbors( in, connectivity, "all", "object" )) == 0 );
+      count = dip::CountNeighbors( packed, connectivity, "foreground", "background" );
+      DOCTEST_CHECK( dip::Count( count != dip::CountNeighbors( in, connectivity, "foreground", "background" )) == 0 );
+   }
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -0,0 +1,440 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib/binary.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+#include "diplib.h"
+#include "diplib/iterators.h"
+#include "diplib/multithreading.h"
+
+#include "hilditch_condition_lut.h"
+
+namespace dip {
+
+namespace {
+
+// Bit planes in the working image
+constexpr uint8 dataBitmask = 1;      // the object
+constexpr uint8 enqueuedBitmask = 2;  // the pixel is in the candidate list
+constexpr uint8 fixedBitmask = 4;     // the pixel is part of the padding, it is never modified
+constexpr uint8 deletedBitmask = 8;   // the pixel was deleted in the current iteration
+
+// Index into the 3x3x3 neighborhood cube: bit `( dz + 1 ) * 9 + ( dy + 1 ) * 3 + ( dx + 1 )`.
+constexpr dip::uint cubeCenter = 13;
+
+class CubeTables {
+   public:
+      CubeTables() {
+         for( dip::uint ii = 0; ii < 27; ++ii ) {
+            dip::sint x0 = static_cast< dip::sint >( ii % 3 ) - 1;
+            dip::sint y0 = static_cast< dip::sint >(( ii / 3 ) % 3 ) - 1;
+            dip::sint z0 = static_cast< dip::sint >( ii / 9 ) - 1;
+            dip::uint n0 = static_cast< dip::uint >(( x0 != 0 ) + ( y0 != 0 ) + ( z0 != 0 ));
+            if( n0 == 1 ) {
+               n6 |= 1u << ii;
+            }
+            if(( n0 > 0 ) && ( n0 < 3 )) {
+               n18 |= 1u << ii;
+            }
+            adjacent26[ ii ] = 0;
+            adjacent6[ ii ] = 0;
+            for( dip::uint jj = 0; jj < 27; ++jj ) {
+               if(( jj == ii ) || ( jj == cubeCenter )) {
+                  continue;
+               }
+               dip::sint dx = std::abs( static_cast< dip::sint >( jj % 3 ) - 1 - x0 );
+               dip::sint dy = std::abs( static_cast< dip::sint >(( jj / 3 ) % 3 ) - 1 - y0 );
+               dip::sint dz = std::abs( static_cast< dip::sint >( jj / 9 ) - 1 - z0 );
+               if(( dx <= 1 ) && ( dy <= 1 ) && ( dz <= 1 )) {
+                  adjacent26[ ii ] |= 1u << jj;
+                  if( dx + dy + dz == 1 ) {
+                     adjacent6[ ii ] |= 1u << jj;
+                  }
+               }
+            }
+         }
+      }
+
+      // Tests whether the center pixel of the cube is a simple point for the (26,6) topology: removing it
+      // doesn't change the number of 26-connected object components, nor the number of 6-connected
+      // background components or tunnels. This is the classical characterization by the number of
+      // 26-connected object components in N26 and the number of 6-connected background components in N18
+      // that are 6-adjacent to the center, which must both be 1.
+      bool IsSimple( uint32 cube ) const {
+         uint32 object = cube & ~( 1u << cubeCenter );
+         if(( object == 0 ) || ( CountComponents( object, adjacent26 ) != 1 )) {
+            return false;
+         }
+         uint32 background = ~cube & n18;
+         if(( background & n6 ) == 0 ) {
+            return false; // interior point
+         }
+         // Count only the background components in N18 that contain a 6-neighbor of the center
+         dip::uint count = 0;
+         while(( background & n6 ) != 0 ) {
+            uint32 component = Grow( LowestBit( background & n6 ), background, adjacent6 );
+            background &= ~component;
+            if( ++count > 1 ) {
+               return false;
+            }
+         }
+         return true;
+      }
+
+   private:
+      std::array< uint32, 27 > adjacent26{};
+      std::array< uint32, 27 > adjacent6{};
+      uint32 n6 = 0;
+      uint32 n18 = 0;
+
+      static uint32 LowestBit( uint32 set ) {
+         return set & ( ~set + 1u );
+      }
+
+      static uint32 Grow( uint32 seed, uint32 set, std::array< uint32, 27 > const& adjacency ) {
+         uint32 component = seed;
+         uint32 front = seed;
+         while( front != 0 ) {
+            uint32 next = 0;
+            for( dip::uint ii = 0; ii < 27; ++ii ) {
+               if( front & ( 1u << ii )) {
+                  next |= adjacency[ ii ];
+               }
+            }
+            front = next & set & ~component;
+            component |= front;
+         }
+         return component;
+      }
+
+      static dip::uint CountComponents( uint32 set, std::array< uint32, 27 > const& adjacency ) {
+         dip::uint count = 0;
+         while( set != 0 ) {
+            set &= ~Grow( LowestBit( set ), set, adjacency );
+            ++count;
+         }
+         return count;
+      }
+};
+
+class SubiterationThinning {
+   public:
+      SubiterationThinning( Image& image, int endPixelCondition ) : image_( image ), endPixelCondition_( endPixelCondition ) {
+         nDims_ = image_.Dimensionality();
+         strides_ = image_.Strides();
+         // The offsets to all neighbors in the 3x3(x3) neighborhood, in the order of the cube bits
+         dip::uint nNeighbors = nDims_ == 2 ? 9 : 27;
+         cubeOffsets_.resize( nNeighbors );
+         for( dip::uint ii = 0; ii < nNeighbors; ++ii ) {
+            dip::sint dx = static_cast< dip::sint >( ii % 3 ) - 1;
+            dip::sint dy = static_cast< dip::sint >(( ii / 3 ) % 3 ) - 1;
+            dip::sint dz = static_cast< dip::sint >( ii / 9 ) - 1;
+            cubeOffsets_[ ii ] = dx * strides_[ 0 ] + dy * strides_[ 1 ] + ( nDims_ == 3 ? dz * strides_[ 2 ] : 0 );
+         }
+         // The offsets for the directional passes, alternating opposite directions
+         for( dip::uint ii = 0; ii < nDims_; ++ii ) {
+            directions_.push_back( -strides_[ ii ] );
+            directions_.push_back( strides_[ ii ] );
+         }
+         // 2D end pixel conditions use the Hilditch LUT, same as in `EuclideanSkeleton`
+         switch( endPixelCondition_ ) {
+            case 1:
+            case 2:
+            case 3:
+               luthile_ = luthil[ endPixelCondition_ ];
+               break;
+            default: // -1, the "natural" condition was mapped to 1 by the caller
+               luthile_ = luthil[ 0 ];
+         }
+      }
+
+      void Run( dip::uint iterations ) {
+         uint8* origin = static_cast< uint8* >( image_.Origin() );
+         std::vector< std::vector< dip::sint >> lists( dip::uint( 1 ) << nDims_ );
+         InitializeLists( lists );
+         for( dip::uint iter = 0; ( iterations == 0 ) || ( iter < iterations ); ++iter ) {
+            bool changed = false;
+            for( dip::sint direction : directions_ ) {
+               for( auto& list : lists ) {
+                  changed |= DeleteInSubfield( origin, list, direction );
+               }
+            }
+            if( !changed ) {
+               break;
+            }
+            UpdateLists( origin, lists );
+         }
+      }
+
+   private:
+      Image& image_;
+      int endPixelCondition_;
+      dip::uint nDims_;
+      IntegerArray strides_;
+      std::vector< dip::sint > cubeOffsets_;
+      std::vector< dip::sint > directions_;
+      uint8 const* luthile_ = nullptr;
+      CubeTables cubeTables_;
+
+      // Subfields are the sets of pixels with the same parity of all coordinates. Two pixels in the same
+      // subfield are never neighbors, so simple points within one subfield can all be deleted at once,
+      // in any order and by any number of threads, with the same result as deleting them sequentially.
+      dip::uint Subfield( dip::sint offset ) const {
+         dip::uint subfield = 0;
+         for( dip::uint ii = nDims_; ii > 0; ) {
+            --ii;
+            dip::sint coord = offset / strides_[ ii ];
+            offset -= coord * strides_[ ii ];
+            subfield |= static_cast< dip::uint >( coord & 1 ) << ii;
+         }
+         return subfield;
+      }
+
+      void Enqueue( uint8* origin, dip::sint offset, std::vector< std::vector< dip::sint >>& lists ) const {
+         uint8& pixel = origin[ offset ];
+         if( pixel == dataBitmask ) { // object pixel, not fixed, not enqueued
+            pixel |= enqueuedBitmask;
+            lists[ Subfield( offset ) ].push_back( offset );
+         }
+      }
+
+      void InitializeLists( std::vector< std::vector< dip::sint >>& lists ) const {
+         // Enqueue all object pixels that have a background neighbor along one of the axes
+         uint8* origin = static_cast< uint8* >( image_.Origin() );
+         ImageIterator< uint8 > it( image_ );
+         do {
+            if( *it == dataBitmask ) {
+               uint8* ptr = it.Pointer();
+               for( dip::sint direction : directions_ ) {
+                  if( !( ptr[ direction ] & dataBitmask )) {
+                     Enqueue( origin, ptr - origin, lists );
+                     break;
+                  }
+               }
+            }
+         } while( ++it );
+      }
+
+      void UpdateLists( uint8* origin, std::vector< std::vector< dip::sint >>& lists ) const {
+         // The pixels that can change state in the next iteration are the object neighbors of the deleted pixels.
+         // Any other pixel has an unchanged neighborhood, and was already found not to be deletable.
+         std::vector< dip::sint > deleted;
+         for( auto& list : lists ) {
+            for( dip::sint offset : list ) {
+               uint8& pixel = origin[ offset ];
+               pixel &= static_cast< uint8 >( ~enqueuedBitmask );
+               if( pixel & deletedBitmask ) {
+                  pixel = 0;
+                  deleted.push_back( offset );
+               }
+            }
+            list.clear();
+         }
+         for( dip::sint offset : deleted ) {
+            for( dip::sint neighbor : cubeOffsets_ ) {
+               Enqueue( origin, offset + neighbor, lists );
+            }
+         }
+      }
+
+      bool IsDeletable( uint8 const* ptr ) const {
+         if( nDims_ == 2 ) {
+            // Same neighbor order as in `CanReset()` in thick_thin_2D.cpp
+            dip::sint sx = strides_[ 0 ];
+            dip::sint sy = strides_[ 1 ];
+            uint8 entry = 0;
+            if( ptr[ sx ] & dataBitmask ) { entry |= 1; }
+            if( ptr[ sx - sy ] & dataBitmask ) { entry |= 2; }
+            if( ptr[ -sy ] & dataBitmask ) { entry |= 4; }
+            if( ptr[ -sx - sy ] & dataBitmask ) { entry |= 8; }
+            if( ptr[ -sx ] & dataBitmask ) { entry |= 16; }
+            if( ptr[ -sx + sy ] & dataBitmask ) { entry |= 32; }
+            if( ptr[ sy ] & dataBitmask ) { entry |= 64; }
+            if( ptr[ sx + sy ] & dataBitmask ) { entry |= 128; }
+            return luthile_[ entry ] == 0;
+         }
+         uint32 cube = 0;
+         for( dip::uint ii = 0; ii < 27; ++ii ) {
+            if( ptr[ cubeOffsets_[ ii ]] & dataBitmask ) {
+               cube |= 1u << ii;
+            }
+         }
+         if( endPixelCondition_ > 0 ) {
+            dip::uint count = 0;
+            for( uint32 neighbors = cube & ~( 1u << cubeCenter ); neighbors != 0; neighbors &= neighbors - 1 ) {
+               ++count;
+            }
+            if(( count > 0 ) && ( count <= static_cast< dip::uint >( endPixelCondition_ ))) {
+               return false;
+            }
+         }
+         return cubeTables_.IsSimple( cube );
+      }
+
+      bool DeleteInSubfield( uint8* origin, std::vector< dip::sint > const& list, dip::sint direction ) const {
+         dip::sint size = static_cast< dip::sint >( list.size() );
+         dip::uint nThreads = 1;
+         dip::uint operations = list.size() * ( nDims_ == 2 ? 20 : 200 );
+         if( operations > threadingThreshold ) {
+            nThreads = std::min( GetNumberOfThreads(), list.size() / 64 + 1 );
+         }
+         bool changed = false;
+         #pragma omp parallel num_threads( static_cast< int >( nThreads )) reduction( || : changed )
+         {
+            #pragma omp for schedule( static )
+            for( dip::sint ii = 0; ii < size; ++ii ) {
+               // Each pixel only reads pixels that are in other subfields, and writes only itself
+               uint8* ptr = origin + list[ static_cast< dip::uint >( ii ) ];
+               if(( *ptr & dataBitmask ) && !( ptr[ direction ] & dataBitmask ) && IsDeletable( ptr )) {
+                  *ptr = static_cast< uint8 >(( *ptr & ~dataBitmask ) | deletedBitmask );
+                  changed = true;
+               }
+            }
+         }
+         return changed;
+      }
+};
+
+} // namespace
+
+void SubiterationSkeleton(
+      Image const& c_in,
+      Image& out,
+      String const& s_endPixelCondition,
+      String const& s_edgeCondition,
+      dip::uint iterations
+) {
+   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_in.DataType().IsBinary(), E::IMAGE_NOT_BINARY );
+   DIP_THROW_IF( !c_in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   dip::uint nDims = c_in.Dimensionality();
+   DIP_THROW_IF(( nDims != 2 ) && ( nDims != 3 ), E::DIMENSIONALITY_NOT_SUPPORTED );
+
+   // End pixel condition
+   int endPixelCondition{};
+   if( s_endPixelCondition == S::LOOSE_ENDS_AWAY ) {
+      endPixelCondition = -1;
+   } else if(( s_endPixelCondition == S::NATURAL ) || ( s_endPixelCondition == S::ONE_NEIGHBOR )) {
+      endPixelCondition = 1;
+   } else if( s_endPixelCondition == S::TWO_NEIGHBORS ) {
+      endPixelCondition = 2;
+   } else if( s_endPixelCondition == S::THREE_NEIGHBORS ) {
+      endPixelCondition = 3;
+   } else {
+      DIP_THROW_INVALID_FLAG( s_endPixelCondition );
+   }
+
+   // Edge condition
+   bool edgeCondition{};
+   DIP_STACK_TRACE_THIS( edgeCondition = BooleanFromString( s_edgeCondition, S::OBJECT, S::BACKGROUND ));
+
+   // Working image with a 1-pixel border, so we don't need to test for the image edge
+   UnsignedArray sizes = c_in.Sizes();
+   for( auto& s : sizes ) {
+      s += 2;
+   }
+   Image work( sizes, 1, DT_UINT8 );
+   work.Fill( edgeCondition ? dataBitmask | fixedBitmask : fixedBitmask );
+   Image inner = work.At( RangeArray( nDims, Range{ 1, -2 } ));
+   inner.Protect();
+   DIP_STACK_TRACE_THIS( inner.Copy( c_in )); // converts binary to uint8 0 and 1, which is `dataBitmask`
+
+   SubiterationThinning thinning( work, endPixelCondition );
+   thinning.Run( iterations );
+
+   Image in = c_in; // temporary copy of image header, so we can strip out. NOLINT(*-unnecessary-copy-initialization)
+   out.ReForge( in.Sizes(), 1, DT_BIN );
+   inner.Protect( false );
+   inner &= dataBitmask;
+   out.Copy( inner );
+   out.CopyNonDataProperties( in );
+}
+
+} // namespace dip
+
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/regions.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::SubiterationSkeleton" ) {
+   // 2D: a thick ring with an attached bar; topology must be preserved, result must be thin
+   dip::Image in2( { 80, 60 }, 1, dip::DT_BIN );
+   in2.Fill( 0 );
+   in2.At( dip::Range{ 10, 50 }, dip::Range{ 10, 50 } ).Fill( 1 );
+   in2.At( dip::Range{ 22, 38 }, dip::Range{ 22, 38 } ).Fill( 0 );
+   in2.At( dip::Range{ 50, 75 }, dip::Range{ 26, 33 } ).Fill( 1 );
+   dip::Image out2 = dip::SubiterationSkeleton( in2 );
+   DOCTEST_CHECK( dip::Count( out2 ) < dip::Count( in2 ) / 5 );
+   DOCTEST_CHECK( dip::Count( out2 & ~in2 ) == 0 );
+   dip::uint n = static_cast< dip::uint >( dip::Maximum( dip::Label( out2, 2 )).As< dip::uint >() );
+   DOCTEST_CHECK( n == 1 );
+   n = static_cast< dip::uint >( dip::Maximum( dip::Label( ~out2, 1 )).As< dip::uint >() );
+   DOCTEST_CHECK( n == 2 );
+   // The branch is kept with "natural", removed with "loose ends away"
+   DOCTEST_CHECK( dip::Count( out2.At( dip::Range{ 70 }, dip::Range{ 26, 32 } )) == 1 );
+   dip::Image loose = dip::SubiterationSkeleton( in2, dip::S::LOOSE_ENDS_AWAY );
+   DOCTEST_CHECK( dip::Count( loose.At( dip::Range{ 70 }, dip::Range{ 26, 32 } )) == 0 );
+   DOCTEST_CHECK( dip::Count( loose ) < dip::Count( out2 ));
+   // Idempotent
+   DOCTEST_CHECK( dip::Count( dip::SubiterationSkeleton( out2 ) != out2 ) == 0 );
+   // The result doesn't depend on the number of threads
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Image single2 = dip::SubiterationSkeleton( in2 );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::Count( single2 != out2 ) == 0 );
+   // Edge condition: object edges keep the object connected to the image edge
+   dip::Image full( { 20, 20 }, 1, dip::DT_BIN );
+   full.Fill( 1 );
+   DOCTEST_CHECK( dip::Count( dip::SubiterationSkeleton( full, dip::S::NATURAL, dip::S::OBJECT )) == 400 );
+   DOCTEST_CHECK( dip::Count( dip::SubiterationSkeleton( full, dip::S::LOOSE_ENDS_AWAY, dip::S::BACKGROUND )) == 1 );
+
+   // 3D: a thick box with a tunnel through it
+   dip::Image in3( { 40, 40, 40 }, 1, dip::DT_BIN );
+   in3.Fill( 0 );
+   in3.At( dip::Range{ 5, 34 }, dip::Range{ 5, 34 }, dip::Range{ 8, 31 } ).Fill( 1 );
+   in3.At( dip::Range{ 15, 24 }, dip::Range{ 15, 24 }, dip::Range{} ).Fill( 0 );
+   dip::Image out3 = dip::SubiterationSkeleton( in3 );
+   DOCTEST_CHECK( dip::Count( out3 ) < dip::Count( in3 ) / 20 );
+   DOCTEST_CHECK( dip::Count( out3 & ~in3 ) == 0 );
+   n = static_cast< dip::uint >( dip::Maximum( dip::Label( out3, 3 )).As< dip::uint >() );
+   DOCTEST_CHECK( n == 1 );
+   // The tunnel must be preserved: the skeleton is a closed loop, so no pixel can be removed with "loose ends away"
+   dip::Image loop3 = dip::SubiterationSkeleton( in3, dip::S::LOOSE_ENDS_AWAY );
+   DOCTEST_CHECK( dip::Count( loop3 ) > 0 );
+   n = static_cast< dip::uint >( dip::Maximum( dip::Label( loop3, 3 )).As< dip::uint >() );
+   DOCTEST_CHECK( n == 1 );
+   DOCTEST_CHECK( dip::Count( dip::SubiterationSkeleton( loop3, dip::S::LOOSE_ENDS_AWAY ) != loop3 ) == 0 );
+   dip::SetNumberOfThreads( 1 );
+   dip::Image single3 = dip::SubiterationSkeleton( in3 );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::Count( single3 != out3 ) == 0 );
+   // A solid box without tunnels shrinks to a single point with "loose ends away"
+   dip::Image box( { 30, 30, 30 }, 1, dip::DT_BIN );
+   box.Fill( 0 );
+   box.At( dip::Range{ 5, 24 }, dip::Range{ 7, 20 }, dip::Range{ 6, 25 } ).Fill( 1 );
+   DOCTEST_CHECK( dip::Count( dip::SubiterationSkeleton( box, dip::S::LOOSE_ENDS_AWAY )) == 1 );
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -58,7 +58,7 @@ class grey2lab : public ColorSpaceConverter {
          do {
             dfloat y = input[ 0 ] / 255;  // Yn == 1.000 by definition
             output[ 0 ] = y > lab::epsilon
-                          ? 116.0 * std::cbrt( y ) - 16.0
+                          ? 116.0 * FastCbrt( y ) - 16.0
                           : lab::kappa * y;
             output[ 1 ] = 0;
             output[ 2 ] = 0;
@@ -108,13 +108,13 @@ class xyz2lab : public ColorSpaceConverter {
             dfloat y = input[ 1 ] / whitePoint_[ 1 ];
             dfloat z = input[ 2 ] / whitePoint_[ 2 ];
             dfloat fx = x > lab::epsilon
-                        ? std::cbrt( x )
+                        ? FastCbrt( x )
                         : ( lab::kappa * x + 16.0 ) / 116.0;
             dfloat fy = y > lab::epsilon
-                        ? std::cbrt( y )
+                        ? FastCbrt( y )
                         : ( lab::kappa * y + 16.0 ) / 116.0;
             dfloat fz = z > lab::epsilon
-                        ? std::cbrt( z )
+                        ? FastCbrt( z )
                         : ( lab::kappa * z + 16.0 ) / 116.0;
             output[ 0 ] = 116.0 * fy - 16.0;
             output[ 1 ] = 500.0 * ( fx - fy );
@@ -188,7 +188,7 @@ class xyz2luv : public ColorSpaceConverter {
             dfloat v = 9 * input[ 1 ] / sum;
             dfloat y = input[ 1 ];
             dfloat L = y > lab::epsilon
-                          ? 116.0 * std::cbrt( y ) - 16.0
+                          ? 116.0 * FastCbrt( y ) - 16.0
                           : lab::kappa * y;
             output[ 0 ] = L;
             output[ 1 ] = 13.0 * L * ( u - un );
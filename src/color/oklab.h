@@ -43,7 +43,7 @@ class grey2oklab : public ColorSpaceConverter {
       void Convert( ConstLineIterator< dfloat >& input, LineIterator< dfloat >& output ) const override {
          do {
             dfloat l = input[ 0 ] / 255;  // Yn == 1.000 by definition
-            l = std::cbrt( l );
+            l = FastCbrt( l );
             output[ 0 ] = l;
             output[ 1 ] = 0;
             output[ 2 ] = 0;
@@ -81,9 +81,9 @@ class xyz2oklab : public ColorSpaceConverter {
             dfloat l = 0.8189330101 * input[ 0 ] + 0.3618667424 * input[ 1 ] - 0.1288597137 * input[ 2 ];
             dfloat m = 0.0329845436 * input[ 0 ] + 0.9293118715 * input[ 1 ] + 0.0361456387 * input[ 2 ];
             dfloat s = 0.0482003018 * input[ 0 ] + 0.2643662691 * input[ 1 ] + 0.6338517070 * input[ 2 ];
-            l = std::cbrt( l );
-            m = std::cbrt( m );
-            s = std::cbrt( s );
+            l = FastCbrt( l );
+            m = FastCbrt( m );
+            s = FastCbrt( s );
             output[ 0 ] = 0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s;
             output[ 1 ] = 1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s;
             output[ 2 ] = 0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s;
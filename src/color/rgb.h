@@ -71,7 +71,9 @@ inline dfloat LinearToS( dfloat in ) {
    if( in <= srgb::K_0 / srgb::phi ) {
       return in * srgb::phi;
    } else {
-      return ( 1 + srgb::a ) * std::pow( in, 1.0 / srgb::gamma ) - srgb::a;
+      // pow( in, 1 / 2.4 ) == c * pow( c, 1 / 4 ), with c = cbrt( in ); this is much cheaper to compute
+      dfloat c = FastCbrt( in );
+      return ( 1 + srgb::a ) * c * std::sqrt( std::sqrt( c )) - srgb::a;
    }
 }
 
@@ -84,6 +86,33 @@ inline dfloat SToLinear( dfloat in ) {
    }
 }
 
+// sRGB to linear for values in the range [0,255]. Integer values, as obtained from 8-bit images, are looked up
+// in a table, computing `std::pow` for each sample is expensive.
+class SToLinear255 {
+   public:
+      SToLinear255() {
+         static std::array< dfloat, 256 > const table = [] {
+            std::array< dfloat, 256 > t{};
+            for( dip::uint ii = 0; ii < 256; ++ii ) {
+               t[ ii ] = SToLinear( static_cast< dfloat >( ii ) / 255.0 ) * 255.0;
+            }
+            return t;
+         }();
+         table_ = table.data();
+      }
+      dfloat operator()( dfloat in ) const {
+         if(( in >= 0 ) && ( in <= 255 )) {
+            dip::uint ii = static_cast< dip::uint >( in );
+            if( static_cast< dfloat >( ii ) == in ) {
+               return table_[ ii ];
+            }
+         }
+         return SToLinear( in / 255.0 ) * 255.0;
+      }
+   private:
+      dfloat const* table_;
+};
+
 class rgb2srgb : public ColorSpaceConverter {
    public:
       String InputColorSpace() const override { return RGB_name; }
@@ -104,10 +133,11 @@ class srgb2rgb : public ColorSpaceConverter {
       String OutputColorSpace() const override { return RGB_name; }
       dip::uint Cost() const override { return 2; }
       void Convert( ConstLineIterator< dfloat >& input, LineIterator< dfloat >& output ) const override {
+         SToLinear255 sToLinear;
          do {
-            output[ 0 ] = SToLinear( input[ 0 ] / 255.0 ) * 255.0;
-            output[ 1 ] = SToLinear( input[ 1 ] / 255.0 ) * 255.0;
-            output[ 2 ] = SToLinear( input[ 2 ] / 255.0 ) * 255.0;
+            output[ 0 ] = sToLinear( input[ 0 ] );
+            output[ 1 ] = sToLinear( input[ 1 ] );
+            output[ 2 ] = sToLinear( input[ 2 ] );
          } while( ++input, ++output );
       }
 };
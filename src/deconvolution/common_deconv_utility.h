@@ -19,8 +19,12 @@
  * limitations under the License.
  */
 
+#include <type_traits>
+
 #include "diplib.h"
 #include "diplib/boundary.h"
+#include "diplib/framework.h"
+#include "diplib/overload.h"
 #include "diplib/statistics.h"
 #include "diplib/transform.h"
 
@@ -28,36 +32,88 @@ namespace dip {
 
 namespace {
 
-inline Image GetOTF( Image const& psf, UnsignedArray const& sizes, bool isOtf ) {
+// If `half`, returns only the non-redundant half of the OTF (see the "half" option to `dip::FourierTransform`).
+// `sizes` are always the sizes of the full OTF.
+inline Image GetOTF( Image const& psf, UnsignedArray const& sizes, bool isOtf, bool half = false ) {
    Image H;
    if( isOtf ) {
       H = psf.QuickCopy();
       DIP_THROW_IF( H.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
       DIP_THROW_IF( H.Sizes() != sizes, E::SIZES_DONT_MATCH );
+      if( half ) {
+         // The half spectrum is the first half of the full spectrum along the first dimension. This is only
+         // correct if the OTF is conjugate symmetric (i.e. the OTF of a real-valued PSF), as the other half is
+         // never looked at. The deconvolution functions document this requirement.
+         RangeArray window( sizes.size() );
+         window[ 0 ].stop = static_cast< dip::sint >( sizes[ 0 ] / 2 );
+         H = H.At( window );
+      }
    } else {
       DIP_THROW_IF( !psf.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
       DIP_STACK_TRACE_THIS( H = psf.Pad( sizes ));
-      DIP_STACK_TRACE_THIS( FourierTransform( H, H ));
+      StringSet options;
+      if( half ) {
+         options.insert( S::HALF );
+      }
+      DIP_STACK_TRACE_THIS( FourierTransform( H, H, options ));
    }
    return H;
 }
 
-inline void FourierTransformImageAndKernel(
+// Computes `out = a * b + weight * c` in a single pass over the data. `a` and `c` are complex-valued spectra,
+// `b` can be real- or complex-valued. `out` can be the same image as `a`.
+inline void MultiplyAdd( Image const& a, Image const& b, Image const& c, Image& out, dfloat weight ) {
+   DataType dt = DataType::SuggestComplex( DataType::SuggestArithmetic( a.DataType(), c.DataType() ));
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+   DIP_OVL_CALL_ASSIGN_COMPLEX( scanLineFilter, Framework::NewTriadicScanLineFilter, (
+         [ = ]( auto its ) {
+            using TPI = std::remove_const_t< std::remove_reference_t< decltype( *its[ 0 ] ) >>;
+            return static_cast< TPI >( *its[ 0 ] * *its[ 1 ] + TPI( static_cast< FloatType< TPI >>( weight )) * *its[ 2 ] );
+         }, 8
+   ), dt );
+   ImageRefArray outar{ out };
+   DIP_STACK_TRACE_THIS( Framework::Scan( { a, b, c }, outar, { dt, dt, dt }, { dt }, { dt }, { 1 }, *scanLineFilter ));
+}
+
+// Returns the sum of the square modulus over all samples of the full spectrum, given only its non-redundant half
+// `F` (as computed with the "half" option to `dip::FourierTransform`, with the origin in the center). `size`
+// is the size of the full spectrum along the first dimension.
+inline dfloat HalfSpectrumSumSquareModulus( Image const& F, dip::uint size ) {
+   // Each column of the half spectrum represents two columns of the full spectrum, except the last one (the origin),
+   // and, for an even size, the first one (the Nyquist frequency)
+   dfloat sum = 2 * SumSquareModulus( F ).As< dfloat >();
+   RangeArray window( F.Dimensionality() );
+   window[ 0 ] = Range( static_cast< dip::sint >( F.Size( 0 ) - 1 ));
+   sum -= SumSquareModulus( F.At( window )).As< dfloat >();
+   if(( size > 1 ) && !( size & 1u )) {
+      window[ 0 ] = Range( 0 );
+      sum -= SumSquareModulus( F.At( window )).As< dfloat >();
+   }
+   return sum;
+}
+
+// Returns the sizes of the full spectrum, which are different from the sizes of `G` and `H` if `half`.
+inline UnsignedArray FourierTransformImageAndKernel(
       Image const& in,
       Image const& psf,
       Image& G, // == FT(in)
       Image& H, // == FT(psf)
       bool isOtf,
       bool pad,
-      dip::uint powersOfTwo = 0 // pad to a size that is a multiple of 2 this number of times, even if pad is false.
+      dip::uint powersOfTwo = 0, // pad to a size that is a multiple of 2 this number of times, even if pad is false.
+      bool half = false          // compute only the non-redundant half of the spectra
 ) {
+   StringSet options;
+   if( half ) {
+      options.insert( S::HALF );
+   }
+   UnsignedArray sizes = in.Sizes();
    dip::uint nDims = in.Dimensionality();
    DIP_THROW_IF( psf.Dimensionality() != nDims, E::DIMENSIONALITIES_DONT_MATCH );
    DIP_THROW_IF( pad && isOtf, E::ILLEGAL_FLAG_COMBINATION );
    if( pad || ( powersOfTwo > 0 )) {
       dip::uint multiple = static_cast< dip::uint >( std::pow( 2, powersOfTwo ));
       dip::String purpose = in.DataType().IsComplex() ? S::COMPLEX : S::REAL;
-      dip::UnsignedArray sizes = in.Sizes();
       for( dip::uint ii = 0; ii < nDims; ++ii ) {
          if( pad ) {
             sizes[ ii ] += 2 * psf.Size( ii );
@@ -65,11 +121,12 @@ inline void FourierTransformImageAndKernel(
          sizes[ ii ] = OptimalFourierTransformSize( div_ceil( sizes[ ii ], multiple ), S::LARGER, purpose ) * multiple;
       }
       Image tmp = ExtendImageToSize( in, sizes, S::CENTER );
-      DIP_STACK_TRACE_THIS( FourierTransform( tmp, G ));
+      DIP_STACK_TRACE_THIS( FourierTransform( tmp, G, options ));
    } else {
-      DIP_STACK_TRACE_THIS( FourierTransform( in, G ));
+      DIP_STACK_TRACE_THIS( FourierTransform( in, G, options ));
    }
-   DIP_STACK_TRACE_THIS( H = GetOTF( psf, G.Sizes(), isOtf ));
+   DIP_STACK_TRACE_THIS( H = GetOTF( psf, sizes, isOtf, half ));
+   return sizes;
 }
 
 } // namespace
@@ -75,10 +75,12 @@ void FastIterativeShrinkageThresholding(
    constexpr dfloat stepSize = 0.5; // Do we want to make this a parameter, or doesn't it matter?
    regularization *= stepSize;
 
-   // Fourier transform of inputs etc.
+   // Fourier transform of inputs etc. We work with half spectra, all images in the spatial domain are real-valued.
    Image G, H;
-   DIP_STACK_TRACE_THIS( FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad, nScales ));
-   pad = in.Sizes() != G.Sizes();
+   UnsignedArray sizes;
+   DIP_STACK_TRACE_THIS( sizes = FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad, nScales, true ));
+   pad = in.Sizes() != sizes;
+   dfloat nPixels = static_cast< dfloat >( sizes.product() );
 
    // A = 1 - 2 * s * H^T H (in the frequency domain)
    Image A = SquareModulus( H );
@@ -93,11 +95,12 @@ void FastIterativeShrinkageThresholding(
    Image& x = pad ? temp_out : out; // we use `temp_out` if padding, otherwise directly use `out`.
    RangeArray window;
    if( pad ) {
-      window = G.CropWindow( in.Sizes() );
+      window = Image::CropWindow( sizes, in.Sizes() );
    }
-   FourierTransform( G, x, { S::INVERSE, S::REAL } );
+   DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( G, x, sizes ));
    Image Y = G.Copy();
 
+   // The work images are allocated in the first iteration, and reused in subsequent ones.
    dfloat t = 1;
    Image xPrev, y;
    dfloat thetaPrev = 1e8;
@@ -107,9 +110,8 @@ void FastIterativeShrinkageThresholding(
 
       // Compute y (2nd part, we skip the 1st part in the first iteration)
       // Y = X - 2 s (H^T H X + H^T G) = (1 - 2 s H^T H) X + 2 s H^T G = A X + B
-      Y *= A;
-      Y += B;
-      FourierTransform( Y, y, { S::INVERSE, S::REAL } );
+      DIP_STACK_TRACE_THIS( MultiplyAdd( Y, A, B, Y, 1.0 ));
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( Y, y, sizes ));
 
       // Shrinkage-threshold of y yields x
       HaarWaveletTransform( y, y, nScales );
@@ -130,10 +132,9 @@ void FastIterativeShrinkageThresholding(
       }
       if( tolerance > 0 ) {
          // Note that we ignore the regularization term of the objective function
-         DIP_STACK_TRACE_THIS( FourierTransform( x, tmp ));
-         tmp *= H;
-         tmp -= G;
-         dfloat theta = MeanSquareModulus( tmp ).As< dfloat >() / static_cast< dfloat >( tmp.NumberOfPixels() );
+         DIP_STACK_TRACE_THIS( FourierTransform( x, tmp, { S::HALF } ));
+         DIP_STACK_TRACE_THIS( MultiplyAdd( tmp, H, G, tmp, -1.0 ));
+         dfloat theta = HalfSpectrumSumSquareModulus( tmp, sizes[ 0 ] ) / ( nPixels * nPixels );
          //std::cout << "theta = " << theta << '\n';
          if( thetaPrev - theta < tolerance ) {
             //std::cout << "Terminating because objective function changed less than `tolerance`\n";
@@ -143,12 +144,12 @@ void FastIterativeShrinkageThresholding(
       }
 
       // Compute y (1st part)
+      // y = x + ( tPrev - 1 ) / t * ( x - xPrev )
       dfloat tPrev = t;
       t = 0.5 + std::sqrt( 0.25 + t * t );
-      Subtract( x, xPrev, y, x.DataType() );
-      y *= ( tPrev - 1 ) / t;
-      y += x;
-      FourierTransform( y, Y );
+      dfloat weight = ( tPrev - 1 ) / t;
+      LinearCombination( x, xPrev, y, 1.0 + weight, -weight );
+      DIP_STACK_TRACE_THIS( FourierTransform( y, Y, { S::HALF } ));
    }
 
    // When padding, we used `temp_out`; crop and write to `out`.
@@ -26,11 +26,14 @@
 #include "diplib/deconvolution.h"
 
 #include <tuple>
+#include <type_traits>
 
 #include "diplib.h"
 #include "diplib/boundary.h"
+#include "diplib/framework.h"
 #include "diplib/linear.h"
 #include "diplib/math.h"
+#include "diplib/saturated_arithmetic.h"
 #include "diplib/transform.h"
 
 #include "common_deconv_utility.h"
@@ -54,6 +57,19 @@ std::tuple< bool, bool >  ParseRichardsonLucyOptions( StringSet const& options )
    return { isOtf, pad };
 }
 
+// Computes `f = f / ( 1 - regularization * div )` in a single pass, using a safe division.
+void ApplyTotalVariationRegularization( Image& f, Image const& div, dfloat regularization ) {
+   DataType dt = f.DataType();
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+   DIP_OVL_CALL_ASSIGN_FLOAT( scanLineFilter, Framework::NewDyadicScanLineFilter, (
+         [ = ]( auto its ) {
+            using TPI = std::remove_const_t< std::remove_reference_t< decltype( *its[ 0 ] ) >>;
+            return saturated_safediv( *its[ 0 ], static_cast< TPI >( 1.0 - regularization * *its[ 1 ] ));
+         }, 3
+   ), dt );
+   DIP_STACK_TRACE_THIS( Framework::ScanDyadic( f, div, f, dt, dt, dt, *scanLineFilter ));
+}
+
 } // namespace
 
 void RichardsonLucy(
@@ -81,25 +97,30 @@ void RichardsonLucy(
    if( pad ) {
       dip::UnsignedArray sizes = in.Sizes();
       for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         sizes[ ii ] += OptimalFourierTransformSize( sizes[ ii ] + psf.Size( ii ) - 1, S::LARGER, S::REAL );
+         sizes[ ii ] = OptimalFourierTransformSize( sizes[ ii ] + 2 * psf.Size( ii ), S::LARGER, S::REAL );
       }
       g = ExtendImageToSize( in, sizes, S::CENTER );
    } else {
       g = in;
    }
-   DIP_STACK_TRACE_THIS( H = GetOTF( psf, g.Sizes(), isOtf ));
+   // We work with half spectra, all images in the spatial domain are real-valued
+   DIP_STACK_TRACE_THIS( H = GetOTF( psf, g.Sizes(), isOtf, true ));
 
 
    // Our first guess for the output is the input
    Image temp_out;
    Image& f = pad ? temp_out : out; // we use `temp_out` if padding, otherwise directly use `out`.
+   // The iterations must happen in a floating-point type, even if the input is an integer image
+   DIP_STACK_TRACE_THIS( f.ReForge( g.Sizes(), 1, DataType::SuggestFlex( g.DataType() ), Option::AcceptDataTypeChange::DO_ALLOW ));
    f.Copy( g );
    RangeArray window;
    if( pad ) {
       window = f.CropWindow( in.Sizes() );
    }
 
-   Image Tmp, tmp, grad, F;
+   // The work images are allocated in the first iteration, and reused in subsequent ones. All pointwise
+   // operations in the frequency domain are computed in place.
+   Image F, tmp, grad;
    while( true ) {
       // f_{k+1} = { [ g / ( f_k * h ) ] * h^c } f_k
       // f_{k+1} = { [ g / ( f_k * h ) ] * h^c } f_k / { 1 - regularization div( grad(f_k) / |grad(f_k)| ) }
@@ -109,17 +130,15 @@ void RichardsonLucy(
             Norm( grad, tmp );
             SafeDivide( grad, tmp, grad, grad.DataType());
             Divergence( grad, tmp, { 0 }, S::FINITEDIFF );
-            tmp *= -regularization;
-            tmp += 1;
-            SafeDivide( f, tmp, f, f.DataType() );
+            ApplyTotalVariationRegularization( f, tmp, regularization );
          }
-         FourierTransform( f, F );
-         Multiply( F, H, Tmp );
-         FourierTransform( Tmp, tmp, { S::INVERSE, S::REAL } );
+         FourierTransform( f, F, { S::HALF } );
+         MultiplySampleWise( F, H, F, F.DataType() );
+         InverseHalfFourierTransform( F, tmp, g.Sizes() );
          SafeDivide( g, tmp, tmp, tmp.DataType() );
-         FourierTransform( tmp, Tmp );
-         MultiplyConjugate( Tmp, H, Tmp, Tmp.DataType() );
-         FourierTransform( Tmp, tmp, { S::INVERSE, S::REAL } );
+         FourierTransform( tmp, F, { S::HALF } );
+         MultiplyConjugate( F, H, F, F.DataType() );
+         InverseHalfFourierTransform( F, tmp, g.Sizes() );
          f *= tmp;
       DIP_END_STACK_TRACE
 
@@ -136,3 +155,43 @@ void RichardsonLucy(
 }
 
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the RichardsonLucy function") {
+   dip::Image input( { 40, 33 }, 1, dip::DT_SFLOAT );
+   input.Fill( 50 );
+   dip::Random random( 0 );
+   dip::UniformNoise( input, input, random, 0, 150 );
+   dip::Image psf( { 9, 9 }, 1, dip::DT_SFLOAT );
+   psf.Fill( 0 );
+   dip::DrawBandlimitedPoint( psf, { 4, 4 }, { 1 }, { 1.5 } );
+   dip::Image blurred = dip::Convert( dip::ConvolveFT( input, psf ), dip::DT_UINT8 );
+   // The iterations use floating-point arithmetic, even if the input is an integer image
+   dip::Image out1 = dip::RichardsonLucy( blurred, psf, 0.0, 5 );
+   DOCTEST_CHECK( out1.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( out1.Sizes() == input.Sizes() );
+   dip::Image out2 = dip::RichardsonLucy( dip::Convert( blurred, dip::DT_SFLOAT ), psf, 0.0, 5 );
+   DOCTEST_CHECK( dip::MaximumAbs( out1 - out2 ).As< dip::dfloat >() < 1e-3 );
+   // The result is closer to the original image than the blurred one
+   DOCTEST_CHECK( dip::MeanSquareError( out1, input ) < dip::MeanSquareError( blurred, input ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the sum of square modulus over a half spectrum") {
+   for( dip::uint width : { 16u, 15u } ) {
+      dip::Image input( { width, 10 }, 1, dip::DT_DFLOAT );
+      input.Fill( 0 );
+      dip::Random random( 0 );
+      dip::UniformNoise( input, input, random );
+      dip::Image full = dip::FourierTransform( input );
+      dip::Image half = dip::FourierTransform( input, { "half" } );
+      dip::dfloat expected = dip::SumSquareModulus( full ).As< dip::dfloat >();
+      DOCTEST_CHECK( dip::HalfSpectrumSumSquareModulus( half, width ) == doctest::Approx( expected ));
+   }
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -48,7 +48,9 @@ std::tuple< bool, bool > ParseTikhonovMillerOptions( StringSet const& options )
    return { isOtf, pad };
 }
 
-Image ComputeMatrixC( UnsignedArray const& sizes ) {
+// If `half`, computes only the non-redundant half of C (see the "half" option to `dip::FourierTransform`),
+// `sizes` are always the sizes of the full spectrum.
+Image ComputeMatrixC( UnsignedArray const& sizes, bool half ) {
    // Regularization (an ideal Laplacian) (in the frequency domain)
    dip::uint nD = sizes.size();
    Image C;
@@ -56,6 +58,11 @@ Image ComputeMatrixC( UnsignedArray const& sizes ) {
       Image ramp;
       CreateRamp( ramp, sizes, ii, { S::FREQUENCY } );
       ramp.UnexpandSingletonDimensions();
+      if( half && ( ii == 0 )) {
+         RangeArray window( nD );
+         window[ 0 ].stop = static_cast< dip::sint >( sizes[ 0 ] / 2 );
+         ramp = ramp.At( window );
+      }
       Power( ramp, 2, ramp );
       if( ii == 0 ) {
          C = ramp;
@@ -67,9 +74,10 @@ Image ComputeMatrixC( UnsignedArray const& sizes ) {
    return C;
 }
 
-Image ComputeMatrixA( Image const& G, Image const& H, double regularization) {
+// `H` is the non-redundant half of the OTF, `sizes` are the sizes of the full OTF.
+Image ComputeMatrixA( UnsignedArray const& sizes, Image const& H, double regularization ) {
    // Regularization matrix C (an ideal Laplacian) (in the frequency domain)
-   Image CtC = ComputeMatrixC( G.Sizes() );
+   Image CtC = ComputeMatrixC( sizes, true );
    // A = HtH + regularization CtC (in the frequency domain)
    SquareModulus( CtC, CtC );
    CtC *= regularization;
@@ -94,24 +102,25 @@ void TikhonovMiller(
    bool isOtf{}, pad{};
    DIP_STACK_TRACE_THIS( std::tie( isOtf, pad ) = ParseTikhonovMillerOptions( options ));
 
-   // Fourier transform of inputs
+   // Fourier transform of inputs. We work with half spectra, all images in the spatial domain are real-valued.
    Image G, H;
-   DIP_STACK_TRACE_THIS( FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad ));
+   UnsignedArray sizes;
+   DIP_STACK_TRACE_THIS( sizes = FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad, 0, true ));
 
    // A = HtH + regularization CtC (in the frequency domain)
-   Image A = ComputeMatrixA( G, H, regularization );
+   Image A = ComputeMatrixA( sizes, H, regularization );
    // H^T g (in the frequency domain)
-   Image HtG = MultiplyConjugate( G, H );
+   MultiplyConjugate( G, H, G, G.DataType() );
    H.Strip();
-   SafeDivide( HtG, A, G, G.DataType() );
+   SafeDivide( G, A, G, G.DataType() );
 
    // Inverse Fourier transform
    if( pad ) {
       Image tmp;
-      DIP_STACK_TRACE_THIS( FourierTransform( G, tmp, { S::INVERSE, S::REAL } ));
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( G, tmp, sizes ));
       out = tmp.Cropped( in.Sizes() );
    } else {
-      DIP_STACK_TRACE_THIS( FourierTransform( G, out, { S::INVERSE, S::REAL } ));
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( G, out, sizes ));
    }
 }
 
@@ -138,12 +147,14 @@ void IterativeConstrainedTikhonovMiller(
    tolerance *= maxVal * maxVal;
    //std::cout << "tolerance = " << tolerance << '\n';
 
-   // Fourier transform of inputs
+   // Fourier transform of inputs. We work with half spectra, all images in the spatial domain are real-valued.
    Image G, H;
-   DIP_STACK_TRACE_THIS( FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad ));
+   UnsignedArray sizes;
+   DIP_STACK_TRACE_THIS( sizes = FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad, 0, true ));
+   dfloat nPixels = static_cast< dfloat >( sizes.product() );
 
    // A = H^T H + regularization C^T C (in the frequency domain)
-   Image A = ComputeMatrixA( G, H, regularization );
+   Image A = ComputeMatrixA( sizes, H, regularization );
    // H^T g (in the frequency domain)
    Image HtG = MultiplyConjugate( G, H );
 
@@ -155,20 +166,20 @@ void IterativeConstrainedTikhonovMiller(
    Image& f = pad ? temp_out : out; // we use `temp_out` if padding, otherwise directly use `out`.
    RangeArray window;
    if( pad ) {
-      window = F.CropWindow( in.Sizes() );
+      window = Image::CropWindow( sizes, in.Sizes() );
    }
 
    // Initialize the remaining intermediate images used in the iterative process
    Image d;
    Image r;
    Image Tf{ true };
-   Image rNorm;
+   dfloat rNorm = 0;
    dfloat thetaPrev = 1e8; // previous step's objective function value
-   Image tmp;
+   Image tmp, dSpatial, rSpatial, ATfd;
    while( true ) {
       // r = A * f - H^T * g
-      r = A * F;
-      r -= HtG;
+      r.Strip(); // `d` can share data with `r`
+      DIP_STACK_TRACE_THIS( MultiplyAdd( F, A, HtG, r, -1.0 ));
 
       // d
       if( steepest_descent ) {
@@ -176,19 +187,19 @@ void IterativeConstrainedTikhonovMiller(
       } else if( !d.IsForged() ) {
          // First step of conjugate gradients
          d = r;
-         SumSquareModulus( r, {}, rNorm );
-         //std::cout << "rNorm = " << rNorm.As< double >() << '\n';
+         rNorm = HalfSpectrumSumSquareModulus( r, sizes[ 0 ] );
+         //std::cout << "rNorm = " << rNorm << '\n';
       } else {
          // d = r + |r|^2 / |rPrev|^2 * dPrev
          // |r| = sqrt(sum( abs(r(i))^2 )) (in the spatial domain) = sqrt(1/N sum( abs(r(i))^2 )) (in the Fourier domain)
          // using Parseval's theorem. We ignore the sqrt(1/N), since it is present on both sides of the division.
-         SafeDivide( d, rNorm, d );
-         SumSquareModulus( r, {}, rNorm );
-         d *= rNorm;
-         d += r;
-         //std::cout << "rNorm = " << rNorm.As< double >() << '\n';
+         dfloat rNormPrev = rNorm;
+         rNorm = HalfSpectrumSumSquareModulus( r, sizes[ 0 ] );
+         dfloat weight = rNormPrev == 0 ? 0 : rNorm / rNormPrev;
+         LinearCombination( d, r, d, dcomplex( weight ), dcomplex( 1 ));
+         //std::cout << "rNorm = " << rNorm << '\n';
       }
-      //std::cout << "dNorm = " << SumSquareModulus(d).As< double >() << '\n';
+      //std::cout << "dNorm = " << HalfSpectrumSumSquareModulus( d, sizes[ 0 ] ) << '\n';
 
       // beta
       dfloat beta = -stepSize;
@@ -196,24 +207,24 @@ void IterativeConstrainedTikhonovMiller(
          // beta = - ( d^T T(f) r ) / ( d^T T(f) A T(f) d )
          // This must be computed in the spatial domain
          // r and d are in the Fourier domain, we need to inverse transform then first.
-         Image dSpatial = FourierTransform( d, { S::INVERSE, S::REAL } );
+         DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( d, dSpatial, sizes ));
          dSpatial *= Tf;
-         Image rSpatial = FourierTransform( r, { S::INVERSE, S::REAL } );
+         DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( r, rSpatial, sizes ));
          rSpatial *= Tf;
          // A is a convolution, so we compute it in the Fourier domain
-         Image ATfd = FourierTransform( dSpatial );
-         ATfd *= A;
-         FourierTransform( ATfd, ATfd, { S::INVERSE, S::REAL } );
+         DIP_STACK_TRACE_THIS( FourierTransform( dSpatial, tmp, { S::HALF } ));
+         MultiplySampleWise( tmp, A, tmp, tmp.DataType() );
+         DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( tmp, ATfd, sizes ));
          // Put them all together. a^T b is the inner product between vectors a and b
          beta = - InProduct( dSpatial, rSpatial ) / InProduct( dSpatial, ATfd );
       }
       //std::cout << "beta = " << beta << '\n';
 
       // f = P( fPrev + beta * d )
-      F += beta * d;
+      LinearCombination( F, d, F, dcomplex( 1 ), dcomplex( beta ));
 
       // To the spatial domain so we can apply the non-negative constraint
-      DIP_STACK_TRACE_THIS( FourierTransform( F, f, { S::INVERSE, S::REAL } ));
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( F, f, sizes ));
       Tf = f >= 0; // save this for next iteration
       //std::cout << "Number of negative values corrected: " << ( Tf.NumberOfPixels() - Count( Tf )) << '\n';
       f *= Tf; // P(.) sets negative pixels to 0.
@@ -225,14 +236,13 @@ void IterativeConstrainedTikhonovMiller(
       }
 
       // Back to the frequency domain
-      DIP_STACK_TRACE_THIS( FourierTransform( f, F ));
+      DIP_STACK_TRACE_THIS( FourierTransform( f, F, { S::HALF } ));
 
       // Do we stop iterating? (pt II)
       if( tolerance > 0 ) {
          // Note that we ignore the regularization term of the objective function
-         MultiplySampleWise( F, H, tmp );
-         tmp -= G;
-         dfloat theta = MeanSquareModulus( tmp ).As< dfloat >() / static_cast< dfloat >( tmp.NumberOfPixels() );
+         DIP_STACK_TRACE_THIS( MultiplyAdd( F, H, G, tmp, -1.0 ));
+         dfloat theta = HalfSpectrumSumSquareModulus( tmp, sizes[ 0 ] ) / ( nPixels * nPixels );
          //std::cout << "theta = " << theta << '\n';
          if(( thetaPrev - theta ) < tolerance ) {
             //std::cout << "Terminating because objective function changed less than `tolerance`\n";
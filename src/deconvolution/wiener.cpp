@@ -115,8 +115,10 @@ void WienerDeconvolution(
    DIP_STACK_TRACE_THIS( std::tie( isOtf, pad ) = ParseWienerOptions( options ));
 
    // Fourier transforms etc.
+   // We work with half spectra, the output is real-valued
    Image G, H;
-   DIP_STACK_TRACE_THIS( FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad ));
+   UnsignedArray sizes;
+   DIP_STACK_TRACE_THIS( sizes = FourierTransformImageAndKernel( in, psf, G, H, isOtf, pad, 0, true ));
 
    // Compute the Wiener filter in the frequency domain
    DIP_START_STACK_TRACE
@@ -130,10 +132,10 @@ void WienerDeconvolution(
    // Inverse Fourier transform
    if( pad ) {
       Image tmp;
-      DIP_STACK_TRACE_THIS( FourierTransform( G, tmp, { S::INVERSE, S::REAL } ));
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( G, tmp, sizes ));
       out = tmp.Cropped( in.Sizes() );
    } else {
-      DIP_STACK_TRACE_THIS( FourierTransform( G, out, { S::INVERSE, S::REAL } ));
+      DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( G, out, sizes ));
    }
 }
 
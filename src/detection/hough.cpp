@@ -25,8 +25,10 @@
 #include "diplib.h"
 #include "diplib/distribution.h"
 #include "diplib/generic_iterators.h"
+#include "diplib/iterators.h"
 #include "diplib/measurement.h"
 #include "diplib/morphology.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -129,6 +131,100 @@ void DrawLine( Image& out, UnsignedArray const& start, UnsignedArray const& end,
    } while( ++it );
 }
 
+// An 'on' pixel in the input to `HoughTransformCircleCenters`, with its gradient vector
+struct EdgePixel {
+   IntegerCoords c;
+   dfloat dx;
+   dfloat dy;
+};
+
+// The 'on' pixels of a binary image, sorted into the cells of a regular grid. Each cell is a box of
+// `cellSize_` pixels along each dimension. For a given point, this allows skipping all cells that are
+// too far from or too close to the point.
+class GriddedPixels {
+   public:
+      explicit GriddedPixels( Image const& in ) : sizes_( in.Sizes() ) {
+         DIP_ASSERT( in.DataType() == DT_BIN );
+         dip::uint nDims = sizes_.size();
+         // Aim for about 256 pixels per cell
+         cellSize_ = std::max< dip::uint >( 2, static_cast< dip::uint >( std::round( std::pow( 256.0, 1.0 / static_cast< dfloat >( nDims )))));
+         gridSizes_.resize( nDims );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            gridSizes_[ ii ] = div_ceil( sizes_[ ii ], cellSize_ );
+         }
+         dip::uint nCells = gridSizes_.product();
+         // Count the pixels in each cell
+         cellStart_.resize( nCells + 1, 0 );
+         ImageIterator< bin > it( in );
+         do {
+            if( *it ) {
+               ++cellStart_[ CellIndex( it.Coordinates() ) + 1 ];
+            }
+         } while( ++it );
+         for( dip::uint ii = 0; ii < nCells; ++ii ) {
+            if( cellStart_[ ii + 1 ] > 0 ) {
+               cells_.push_back( ii );
+            }
+            cellStart_[ ii + 1 ] += cellStart_[ ii ];
+         }
+         // Copy the coordinates of the pixels into the cells
+         coords_.resize( cellStart_.back() * nDims );
+         std::vector< dip::uint > next( cellStart_.begin(), cellStart_.end() - 1 );
+         it.Reset();
+         do {
+            if( *it ) {
+               dfloat* dest = coords_.data() + next[ CellIndex( it.Coordinates() ) ]++ * nDims;
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  dest[ ii ] = static_cast< dfloat >( it.Coordinates()[ ii ] );
+               }
+            }
+         } while( ++it );
+      }
+
+      // The number of non-empty cells
+      dip::uint NumberOfCells() const { return cells_.size(); }
+
+      // The range of pixels in the `index`-th non-empty cell, coordinates are `nDims` consecutive values
+      dfloat const* CellBegin( dip::uint index ) const { return coords_.data() + cellStart_[ cells_[ index ]] * sizes_.size(); }
+      dfloat const* CellEnd( dip::uint index ) const { return coords_.data() + cellStart_[ cells_[ index ] + 1 ] * sizes_.size(); }
+
+      // The square of the smallest and largest distances between `point` and any pixel in the `index`-th non-empty cell
+      std::pair< dfloat, dfloat > CellDistanceBounds( dip::uint index, dfloat const* point ) const {
+         dip::uint cell = cells_[ index ];
+         dfloat minDist = 0;
+         dfloat maxDist = 0;
+         for( dip::uint ii = 0; ii < sizes_.size(); ++ii ) {
+            dip::uint lower = ( cell % gridSizes_[ ii ] ) * cellSize_;
+            dip::uint upper = std::min( lower + cellSize_, sizes_[ ii ] ) - 1;
+            cell /= gridSizes_[ ii ];
+            dfloat lowerDist = point[ ii ] - static_cast< dfloat >( lower );
+            dfloat upperDist = static_cast< dfloat >( upper ) - point[ ii ];
+            dfloat d = std::max( 0.0, std::max( -lowerDist, -upperDist ));
+            minDist += d * d;
+            d = std::max( std::abs( lowerDist ), std::abs( upperDist ));
+            maxDist += d * d;
+         }
+         return { minDist, maxDist };
+      }
+
+   private:
+      UnsignedArray sizes_;
+      UnsignedArray gridSizes_;
+      dip::uint cellSize_;
+      std::vector< dip::uint > cellStart_; // for each cell, index into the pixel list; one more than the number of cells
+      std::vector< dip::uint > cells_;     // the non-empty cells
+      std::vector< dfloat > coords_;       // the coordinates of the pixels, sorted by cell
+
+      dip::uint CellIndex( UnsignedArray const& coords ) const {
+         dip::uint index = 0;
+         for( dip::uint ii = sizes_.size(); ii > 0; ) {
+            --ii;
+            index = index * gridSizes_[ ii ] + coords[ ii ] / cellSize_;
+         }
+         return index;
+      }
+};
+
 } // namespace
 
 void HoughTransformCircleCenters(
@@ -160,49 +256,74 @@ void HoughTransformCircleCenters(
       maxsz = static_cast< dfloat >( range[ 1 ] );
    }
 
+   // Collect the 'on' pixels and their gradient vectors
+   std::vector< EdgePixel > pixels;
+   auto coordComp = gv.OffsetToCoordinatesComputer();
+   // NOTE: calling end() on View does not work
+   for( auto it = gv.At( in ).begin(); it; ++it ) {
+      auto coord = coordComp( it.Offset() );
+      pixels.push_back( { IntegerCoords{ static_cast< dip::sint >( coord[ 0 ] ), static_cast< dip::sint >( coord[ 1 ] ) },
+                          it[ 0 ].As< dfloat >(), it[ 1 ].As< dfloat >() } );
+   }
+
    // Initialize accumulator
    out.ReForge( in.Sizes(), 1, DT_SFLOAT );
    out.Fill( 0 );
 
-   auto coordComp = gv.OffsetToCoordinatesComputer();
+   // Each thread draws into its own accumulator, these are added together at the end
+   dip::uint nThreads = 1;
+   if( pixels.size() * static_cast< dip::uint >( std::max( maxsz, 1.0 )) > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), pixels.size() );
+   }
+   std::vector< Image > accumulators( nThreads - 1 );
+   for( auto& acc : accumulators ) {
+      acc.ReForge( in.Sizes(), 1, DT_SFLOAT );
+      acc.Fill( 0 );
+   }
 
    // Iterate over on pixels
-   // NOTE: calling end() on View does not work
-   for( auto it = gv.At( in ).begin(); it; ++it ) {
-      auto coord = coordComp( it.Offset() );
-      IntegerCoords c{ static_cast< dip::sint >( coord[ 0 ] ),
-                       static_cast< dip::sint >( coord[ 1 ] ) };
-      dfloat dx = it[ 0 ].As< dfloat >();
-      dfloat dy = it[ 1 ].As< dfloat >();
-      dfloat angle = std::atan2( dy, dx );
-      sfloat magnitude = static_cast< sfloat >( std::hypot( dx, dy ));
-      // TODO: option to select inside or outside
-      IntegerCoords max = { round_cast( std::cos( angle ) * maxsz ),
-                            round_cast( std::sin( angle ) * maxsz ) };
-      if( minsz == 0 ) {
-         // Draw single line
-         IntegerCoords start = c - max;
-         IntegerCoords end = c + max;
-         if( clip( start, end, sz )) {
-            // Note that after clipping we can be sure that all coordinates are positive
-            DrawLine( out, start, end, magnitude );
-         }
-      } else {
-         // Draw two line segments
-         IntegerCoords min = { round_cast( std::cos( angle ) * minsz ),
-                               round_cast( std::sin( angle ) * minsz ) };
-         IntegerCoords start = c - min;
-         IntegerCoords end = c - max;
-         if( clip( start, end, sz )) {
-            DrawLine( out, start, end, magnitude );
-         }
-         start = c + min;
-         end = c + max;
-         if( clip( start, end, sz )) {
-            DrawLine( out, start, end, magnitude );
+   dip::sint nPixels = static_cast< dip::sint >( pixels.size() );
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      Image& acc = thread == 0 ? out : accumulators[ thread - 1 ];
+      #pragma omp for schedule( static )
+      for( dip::sint ii = 0; ii < nPixels; ++ii ) {
+         EdgePixel const& pixel = pixels[ static_cast< dip::uint >( ii ) ];
+         IntegerCoords c = pixel.c;
+         dfloat angle = std::atan2( pixel.dy, pixel.dx );
+         sfloat magnitude = static_cast< sfloat >( std::hypot( pixel.dx, pixel.dy ));
+         // TODO: option to select inside or outside
+         IntegerCoords max = { round_cast( std::cos( angle ) * maxsz ),
+                               round_cast( std::sin( angle ) * maxsz ) };
+         if( minsz == 0 ) {
+            // Draw single line
+            IntegerCoords start = c - max;
+            IntegerCoords end = c + max;
+            if( clip( start, end, sz )) {
+               // Note that after clipping we can be sure that all coordinates are positive
+               DrawLine( acc, start, end, magnitude );
+            }
+         } else {
+            // Draw two line segments
+            IntegerCoords min = { round_cast( std::cos( angle ) * minsz ),
+                                  round_cast( std::sin( angle ) * minsz ) };
+            IntegerCoords start = c - min;
+            IntegerCoords end = c - max;
+            if( clip( start, end, sz )) {
+               DrawLine( acc, start, end, magnitude );
+            }
+            start = c + min;
+            end = c + max;
+            if( clip( start, end, sz )) {
+               DrawLine( acc, start, end, magnitude );
+            }
          }
       }
    }
+   for( auto const& acc : accumulators ) {
+      out += acc;
+   }
 }
 
 CoordinateArray FindHoughMaxima(
@@ -274,31 +395,82 @@ Distribution PointDistanceDistribution(
 ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( in.DataType() != DT_BIN, E::IMAGE_NOT_BINARY );
+   dip::uint nDims = in.Dimensionality();
+   for( auto const& point : points ) {
+      DIP_THROW_IF( point.size() != nDims, E::DIMENSIONALITIES_DONT_MATCH );
+   }
 
    if( range.empty() ) {
       range = { 0, static_cast< dip::uint >( std::ceil( std::sqrt( in.Sizes().norm_square() ))) };
+   } else {
+      DIP_THROW_IF( range.size() != 2, E::ARRAY_PARAMETER_WRONG_LENGTH );
+      DIP_THROW_IF( range[ 0 ] > range[ 1 ], E::INVALID_PARAMETER );
    }
 
-   auto coordComp = in.OffsetToCoordinatesComputer();
    dip::uint steps = range[ 1 ] - range[ 0 ] + 1;
+   dip::uint nPoints = points.size();
+   std::vector< dfloat > pointCoords( nPoints * nDims );
+   for( dip::uint cid = 0; cid < nPoints; ++cid ) {
+      std::copy( points[ cid ].begin(), points[ cid ].end(), pointCoords.begin() + static_cast< dip::sint >( cid * nDims ));
+   }
 
-   Distribution distribution( steps, points.size(), 1 );
+   Distribution distribution( steps, nPoints, 1 );
    distribution.SetSampling( {}, static_cast< dfloat >( range[ 0 ] ), 1. );
 
-   // Iterate over on pixels
-   // NOTE: calling end() on View does not work
-   for( auto pit = in.At( in ).begin(); pit; ++pit ) {
-      auto coord = coordComp( pit.Offset() );
-
-      // Iterate over points
-      dip::uint cid = 0;
-      for( auto cit = points.begin(); cit != points.end(); ++cit, ++cid ) {
-         double dist = std::sqrt( norm_square( coord, *cit ));
+   // The pixels that can end up in a bin are at a distance in [ range[ 0 ] - 0.5, range[ 1 ] + 0.5 ) of the point;
+   // cells are skipped if they are entirely outside this range (with a bit of margin for rounding errors).
+   GriddedPixels pixels( in );
+   dfloat minDist = std::max( static_cast< dfloat >( range[ 0 ] ) - 1.5, 0.0 );
+   minDist *= minDist;
+   dfloat maxDist = static_cast< dfloat >( range[ 1 ] ) + 1.5;
+   maxDist *= maxDist;
+
+   // Each thread counts into its own histograms (one per point), these are added together at the end
+   dip::uint nCells = pixels.NumberOfCells();
+   dip::uint nThreads = 1;
+   if( nCells * 256 * nPoints > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), nCells );
+   }
+   std::vector< std::vector< dip::uint >> counts( nThreads );
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      std::vector< dip::uint >& count = counts[ thread ];
+      count.resize( steps * nPoints, 0 );
+      #pragma omp for schedule( dynamic, 16 )
+      for( dip::sint ii = 0; ii < static_cast< dip::sint >( nCells ); ++ii ) {
+         dip::uint cell = static_cast< dip::uint >( ii );
+         for( dip::uint cid = 0; cid < nPoints; ++cid ) {
+            dfloat const* point = pointCoords.data() + cid * nDims;
+            auto bounds = pixels.CellDistanceBounds( cell, point );
+            if(( bounds.first > maxDist ) || ( bounds.second < minDist )) {
+               continue;
+            }
+            dip::uint* hist = count.data() + cid * steps;
+            for( dfloat const* coords = pixels.CellBegin( cell ); coords != pixels.CellEnd( cell ); coords += nDims ) {
+               dfloat n = 0;
+               for( dip::uint jj = 0; jj < nDims; ++jj ) {
+                  dfloat d = coords[ jj ] - point[ jj ];
+                  n += d * d;
+               }
+               dip::sint bin = round_cast( std::sqrt( n ) - static_cast< dfloat >( range[ 0 ] ));
+               if( bin >= 0 && bin < static_cast< dip::sint >( steps )) {
+                  ++hist[ static_cast< dip::uint >( bin ) ];
+               }
+            }
+         }
+      }
+   }
 
-         dip::sint bin = round_cast( dist - static_cast< dfloat >( range[ 0 ] ));
-         if( bin >= 0 && bin < static_cast< dip::sint >( steps )) {
-            distribution[ static_cast< dip::uint >( bin ) ].Y( cid )++;
+   // Copy the counts into the distribution
+   for( dip::uint cid = 0; cid < nPoints; ++cid ) {
+      for( dip::uint bin = 0; bin < steps; ++bin ) {
+         dip::uint sum = 0;
+         for( auto const& count : counts ) {
+            sum += count[ cid * steps + bin ];
          }
+         distribution[ bin ].Y( cid ) = static_cast< dfloat >( sum );
       }
    }
 
@@ -383,4 +555,40 @@ DOCTEST_TEST_CASE( "[DIPlib] testing the FindHoughCircles function" ) {
    DOCTEST_CHECK( cir[ 1 ] == dip::FloatArray{ 350, 350, 25 } );
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing the PointDistanceDistribution function" ) {
+   dip::Image in( { 90, 70 }, 1, dip::DT_BIN );
+   in.Fill( 0 );
+   dip::DrawEllipsoid( in, { 40, 30 }, { 30, 40 } );
+   dip::DrawEllipsoid( in, { 10, 10 }, { 70, 20 } );
+   dip::CoordinateArray points{ { 30, 40 }, { 0, 69 }, { 89, 0 } };
+   dip::Distribution dist = dip::PointDistanceDistribution( in, points, { 5, 45 } );
+   DOCTEST_REQUIRE( dist.Size() == 41 );
+   DOCTEST_REQUIRE( dist.ValuesPerSample() == 3 );
+   // Compare to brute-force computation
+   std::vector< dip::uint > expected( 41 * 3, 0 );
+   for( dip::uint y = 0; y < 70; ++y ) {
+      for( dip::uint x = 0; x < 90; ++x ) {
+         if( !in.At( x, y ).As< bool >() ) {
+            continue;
+         }
+         for( dip::uint ii = 0; ii < 3; ++ii ) {
+            dip::dfloat dx = static_cast< dip::dfloat >( x ) - static_cast< dip::dfloat >( points[ ii ][ 0 ] );
+            dip::dfloat dy = static_cast< dip::dfloat >( y ) - static_cast< dip::dfloat >( points[ ii ][ 1 ] );
+            dip::sint bin = dip::round_cast( std::sqrt( dx * dx + dy * dy )) - 5;
+            if(( bin >= 0 ) && ( bin <= 40 )) {
+               ++expected[ static_cast< dip::uint >( bin ) * 3 + ii ];
+            }
+         }
+      }
+   }
+   bool equal = true;
+   for( dip::uint bin = 0; bin < 41; ++bin ) {
+      for( dip::uint ii = 0; ii < 3; ++ii ) {
+         equal &= dist[ bin ].Y( ii ) == static_cast< dip::dfloat >( expected[ bin * 3 + ii ] );
+      }
+   }
+   DOCTEST_CHECK( equal );
+   DOCTEST_CHECK( dist[ 0 ].X() == 5.0 );
+}
+
 #endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -37,6 +37,10 @@ namespace {
 
 enum class RadonTransformCirclesMode : uint8 { full, projection, subpixelProjection };
 
+// When computing the full parameter space in slabs, the number of slices in the core of the slab, and on either side
+constexpr dip::uint SLAB_CORE = 16;
+constexpr dip::uint SLAB_HALO = 8;
+
 enum class RadonTransformCirclesOption : uint8 { normalize, correct, hollow, filled, detectMaxima, saveParamSpace };
 DIP_DECLARE_OPTIONS( RadonTransformCirclesOption, RadonTransformCirclesOptions )
 
@@ -276,6 +280,75 @@ RadonCircleParametersArray RadonCircleSubpixelMaxima(
    return out;
 }
 
+// Computes the full parameter space in slabs along the *r* axis, and finds the local maxima in each slab.
+// Each slab consists of `core` slices, plus `halo` slices on either side, which overlap with the neighboring slabs.
+// Maxima are found in the whole slab as in the full parameter space, but only those within the core slices are kept.
+// Slices in the overlap are copied to the next slab, not recomputed. The result is the same as that of
+// `RadonCircleSubpixelMaxima` on the full parameter space, except if the depth of a peak is determined by a path
+// that leaves the slab, and except for the order of the maxima. `core` must be at least `2 * halo`.
+RadonCircleParametersArray ComputeFullParameterSpaceMaxima(
+      Image const& inFT,
+      Range const& radii,
+      dfloat sigma,
+      dfloat threshold,
+      RadonTransformCirclesOptions options,
+      dip::uint core,
+      dip::uint halo
+) {
+   dip::uint nRadii = radii.Size();
+   DIP_ASSERT( nRadii > core + 2 * halo );
+   DIP_ASSERT( core >= 2 * halo );
+   UnsignedArray outSize = inFT.Sizes();
+   Image sphere( outSize, 1, DT_SFLOAT );
+   Image sphereFT;
+   dip::uint nDims = outSize.size();
+   outSize.push_back( core + 2 * halo );
+   Image slab( outSize, 1, DT_SFLOAT );
+   dfloat step = static_cast< dfloat >( radii.Step() );
+   RadonCircleParametersArray out;
+   dip::uint first = 0; // index of the first slice in `slab`
+   dip::uint computed = 0; // number of slices in `slab` that are already computed
+   while( true ) {
+      // The core of this slab goes from `first + halo` to `first + halo + core`, except for the first and last slabs,
+      // which have their core extended to the edge of the parameter space.
+      dip::uint last = std::min( first + core + 2 * halo, nRadii ); // one past the last slice in `slab`
+      RangeArray slices( nDims, Range{} );
+      slices.push_back( Range{ 0, static_cast< dip::sint >( last - first ) - 1 } );
+      Image view = slab.At( slices );
+      ImageSliceIterator dest( view, nDims );
+      dest += computed;
+      for( dip::uint ii = first + computed; ii < last; ++ii, ++dest ) {
+         dfloat radius = static_cast< dfloat >( radii.start ) + static_cast< dfloat >( ii ) * step;
+         ComputeParameterSpaceSlice( inFT, sphere, sphereFT, *dest, radius, sigma, options );
+         ClipLow( *dest, *dest, 0 );
+      }
+      dip::uint coreBegin = first == 0 ? 0 : halo;
+      dip::uint coreEnd = last == nRadii ? last - first : halo + core;
+      RadonCircleParametersArray params = RadonCircleSubpixelMaxima( view, threshold );
+      for( auto& p : params ) {
+         dfloat r = p.origin.back();
+         if(( r >= static_cast< dfloat >( coreBegin ) - 0.5 ) && ( r < static_cast< dfloat >( coreEnd ) - 0.5 )) {
+            p.radius = ( r + static_cast< dfloat >( first )) * step + static_cast< dfloat >( radii.start );
+            p.origin.erase( nDims );
+            out.push_back( std::move( p ));
+         }
+      }
+      if( last == nRadii ) {
+         break;
+      }
+      // Move the last `2 * halo` slices to the start of the slab
+      ImageSliceIterator src( slab, nDims );
+      src += core;
+      ImageSliceIterator dst( slab, nDims );
+      for( dip::uint ii = 0; ii < 2 * halo; ++ii, ++src, ++dst ) {
+         dst->Copy( *src );
+      }
+      first += core;
+      computed = 2 * halo;
+   }
+   return out;
+}
+
 } // namespace
 
 RadonCircleParametersArray RadonTransformCircles(
@@ -346,13 +419,13 @@ RadonCircleParametersArray RadonTransformCircles(
    }
    switch( mode ) {
       case RadonTransformCirclesMode::full:
-         //if ( options.Contains( RadonTransformCirclesOption::saveParamSpace ) || ( radii.Size() < 3 )) {
+         if( options.Contains( RadonTransformCirclesOption::saveParamSpace ) || ( radii.Size() <= SLAB_CORE + 2 * SLAB_HALO )) {
             DIP_STACK_TRACE_THIS( ComputeFullParameterSpace( inFT, parameterSpace, radii, sigma, options ));
-         //} else {
-            // TODO: Compute `parameterSpace` in chunks and fill `out_params`
-            //       This will change the maxima found, as we use the watershed method, which will be affected
-            //return out_params;
-         //}
+         } else {
+            // We don't need to keep the parameter space, compute it in slabs and find maxima as we go.
+            DIP_STACK_TRACE_THIS( out_params = ComputeFullParameterSpaceMaxima( inFT, radii, sigma, threshold, options, SLAB_CORE, SLAB_HALO ));
+            return out_params;
+         }
          break;
       case RadonTransformCirclesMode::projection:
          DIP_STACK_TRACE_THIS( ComputeProjectedParameterSpace( inFT, parameterSpace, radii, sigma, options ));
@@ -390,3 +463,37 @@ RadonCircleParametersArray RadonTransformCircles(
 }
 
 } // namespace
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::RadonTransformCircles") {
+   dip::Image in( { 170, 150 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::DrawBandlimitedBall( in, 2 * 20.3, { 40.2, 45.6 }, { 1 }, dip::S::EMPTY );
+   dip::DrawBandlimitedBall( in, 2 * 14.7, { 90.8, 60.1 }, { 1 }, dip::S::EMPTY );
+   dip::DrawBandlimitedBall( in, 2 * 35.2, { 120.4, 108.9 }, { 1 }, dip::S::EMPTY );
+   dip::Image ps;
+   // 40 radii: the parameter space is computed in multiple slabs if not saved
+   auto full = dip::RadonTransformCircles( in, ps, { 6, 45 }, 1.0, 0.2, dip::S::FULL );
+   auto chunked = dip::RadonTransformCircles( in, ps, { 6, 45 }, 1.0, 0.2, dip::S::FULL, { dip::S::NORMALIZE, dip::S::CORRECT, dip::S::NO_PARAMETER_SPACE } );
+   DOCTEST_REQUIRE( full.size() == 3 );
+   DOCTEST_REQUIRE( chunked.size() == 3 );
+   auto byRadius = []( dip::RadonCircleParameters const& a, dip::RadonCircleParameters const& b ) { return a.radius < b.radius; };
+   std::sort( full.begin(), full.end(), byRadius );
+   std::sort( chunked.begin(), chunked.end(), byRadius );
+   for( dip::uint ii = 0; ii < 3; ++ii ) {
+      DOCTEST_CHECK( chunked[ ii ].origin[ 0 ] == doctest::Approx( full[ ii ].origin[ 0 ] ));
+      DOCTEST_CHECK( chunked[ ii ].origin[ 1 ] == doctest::Approx( full[ ii ].origin[ 1 ] ));
+      DOCTEST_CHECK( chunked[ ii ].radius == doctest::Approx( full[ ii ].radius ));
+   }
+   // The circles are found accurately
+   DOCTEST_CHECK( chunked[ 0 ].origin[ 0 ] == doctest::Approx( 90.8 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( chunked[ 0 ].radius == doctest::Approx( 14.7 ).epsilon( 0.02 ));
+   DOCTEST_CHECK( chunked[ 1 ].origin[ 1 ] == doctest::Approx( 45.6 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( chunked[ 1 ].radius == doctest::Approx( 20.3 ).epsilon( 0.02 ));
+   DOCTEST_CHECK( chunked[ 2 ].origin[ 0 ] == doctest::Approx( 120.4 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( chunked[ 2 ].radius == doctest::Approx( 35.2 ).epsilon( 0.02 ));
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
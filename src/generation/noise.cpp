@@ -17,9 +17,9 @@
 
 #include "diplib/generation.h"
 
+#include <array>
 #include <cmath>
-#include <memory>
-#include <vector>
+#include <limits>
 
 #include "diplib.h"
 #include "diplib/framework.h"
@@ -29,273 +29,171 @@
 
 namespace dip {
 
-// TODO: Is there false sharing in these line filters?
-
 namespace {
-class UniformScanLineFilter : public Framework::ScanLineFilter {
+
+// Adds noise to each sample of the image, using a `CounterBasedRandom` generator keyed with a value drawn from the
+// caller's `Random` object. The generator's index is the linear index of the sample, considering the tensor dimension
+// (if the image is not scalar) as the last spatial dimension. Therefore the noise added to each sample does not depend
+// on how the image is divided up among threads.
+// `func` is called as `func( value, generator, index )`, and must return the new value. It must call
+// `generator.SetIndex()` with `index` (or a value derived from it), and can keep state between calls within
+// one image line.
+template< typename TPI, typename F >
+class NoiseScanLineFilter : public Framework::ScanLineFilter {
    public:
-      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 40; }
+      NoiseScanLineFilter( Random& random, Image const& in, F const& func, dip::uint cost ) :
+            generator_( static_cast< dip::uint >( random() )), func_( func ), cost_( cost ) {
+         UnsignedArray sizes = in.Sizes();
+         if( !in.IsScalar() ) {
+            sizes.push_back( in.TensorElements() );
+         }
+         strides_.resize( sizes.size() );
+         dip::uint stride = 1;
+         for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+            strides_[ ii ] = stride;
+            stride *= sizes[ ii ];
+         }
+      }
+      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return cost_; }
       void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dfloat const* in = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
+         TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
          dip::sint inStride = params.inBuffer[ 0 ].stride;
          dip::uint const bufferLength = params.bufferLength;
-         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
+         TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
          dip::sint const outStride = params.outBuffer[ 0 ].stride;
-         UniformRandomGenerator& generator = *generatorArray_[ params.thread ];
+         DIP_ASSERT( params.position.size() == strides_.size() );
+         dip::uint index = 0;
+         for( dip::uint ii = 0; ii < strides_.size(); ++ii ) {
+            index += params.position[ ii ] * strides_[ ii ];
+         }
+         dip::uint const step = strides_[ params.dimension ];
+         CounterBasedRandom generator = generator_; // each thread uses its own copy
+         F func = func_;
          for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-            *out = *in + generator( lowerBound_, upperBound_ );
+            *out = func( *in, generator, index );
+            index += step;
             in += inStride;
             out += outStride;
          }
       }
-      void SetNumberOfThreads( dip::uint threads ) override  {
-         generatorArray_.resize( threads );
-         generatorArray_[ 0 ] = std::make_unique< UniformRandomGenerator >( random_ );
-         if( threads > 1 ) {
-            randomArray_.resize( threads - 1, Random( 0 ));
-            for( dip::uint ii = 1; ii < threads; ++ii ) {
-               randomArray_[ ii - 1 ] = random_.Split();
-               generatorArray_[ ii ] = std::make_unique< UniformRandomGenerator >( randomArray_[ ii - 1 ] );
-            }
-         }
-      }
-      UniformScanLineFilter( Random& random, dfloat lowerBound, dfloat upperBound ) :
-            random_( random ), lowerBound_( lowerBound ), upperBound_( upperBound ) {}
-      // Make the class non copyable (generatorArray_ cannot be copied)
-      UniformScanLineFilter( const UniformScanLineFilter& ) = delete;
-      UniformScanLineFilter& operator=( const UniformScanLineFilter& ) = delete;
-      // Complete the set of special functions
-      UniformScanLineFilter( UniformScanLineFilter&& ) = delete;
-      UniformScanLineFilter& operator=( UniformScanLineFilter&& ) = delete;
-      ~UniformScanLineFilter() override = default;
    private:
-      Random& random_;
-      std::vector< Random > randomArray_;
-      std::vector< std::unique_ptr< UniformRandomGenerator >> generatorArray_;
-      dfloat lowerBound_;
-      dfloat upperBound_;
+      CounterBasedRandom generator_;
+      UnsignedArray strides_;
+      F func_;
+      dip::uint cost_;
 };
-} // namespace
 
-void UniformNoise( Image const& in, Image& out, Random& random, dfloat lowerBound, dfloat upperBound ) {
-   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-   UniformScanLineFilter filter( random, lowerBound, upperBound );
-   DataType dt = in.DataType();
-   Framework::ScanMonadic( in, out, DT_DFLOAT, dt, 1, filter, Framework::ScanOption::TensorAsSpatialDim );
+template< typename TPI, typename F >
+void AddNoise( Image const& in, Image& out, Random& random, DataType outType, F const& func, dip::uint cost ) {
+   NoiseScanLineFilter< TPI, F > filter( random, in, func, cost );
+   DIP_STACK_TRACE_THIS( Framework::ScanMonadic( in, out, DataType( TPI( 0 )), outType, 1, filter,
+                                                 Framework::ScanOption::TensorAsSpatialDim + Framework::ScanOption::NeedCoordinates ));
 }
 
-namespace {
-class GaussianScanLineFilter : public Framework::ScanLineFilter {
-   public:
-      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 150; }
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dfloat const* in = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
-         dip::sint inStride = params.inBuffer[ 0 ].stride;
-         dip::uint const bufferLength = params.bufferLength;
-         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
-         dip::sint const outStride = params.outBuffer[ 0 ].stride;
-         GaussianRandomGenerator& generator = *( generatorArray_[ params.thread ] );
-         for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-            *out = generator( *in, std_ );
-            in += inStride;
-            out += outStride;
+// Draws a Poisson-distributed value with the given mean, using only values produced by `generator`, so that the
+// result does not depend on the standard library implementation (the algorithm used by `std::poisson_distribution`
+// is not specified). Small means use inversion by sequential search, larger means use the transformed rejection
+// with squeeze method (PTRS) by Hörmann.
+//
+// W. Hörmann, "The transformed rejection method for generating Poisson random variables",
+// Insurance: Mathematics and Economics 12(1):39-45, 1993.
+dfloat PoissonSample( dfloat mean, CounterBasedRandom& generator ) {
+   if( mean < 10.0 ) {
+      dfloat u = CounterBasedRandom::Canonical( generator() );
+      dfloat p = std::exp( -mean );
+      dfloat cdf = p;
+      dfloat k = 0.0;
+      while( u > cdf ) {
+         k += 1.0;
+         p *= mean / k;
+         if( p == 0.0 ) {
+            break; // far in the tail, `cdf` could be stuck just below `u` due to rounding
          }
+         cdf += p;
       }
-      void SetNumberOfThreads( dip::uint threads ) override {
-         generatorArray_.resize( threads );
-         generatorArray_[ 0 ] = std::make_unique< GaussianRandomGenerator >( random_ );
-         if( threads > 1 ) {
-            randomArray_.resize( threads - 1, Random( 0 ));
-            for( dip::uint ii = 1; ii < threads; ++ii ) {
-               randomArray_[ ii - 1 ] = random_.Split();
-               generatorArray_[ ii ] = std::make_unique< GaussianRandomGenerator >( randomArray_[ ii - 1 ] );
-            }
-         }
+      return k;
+   }
+   dfloat const logMean = std::log( mean );
+   dfloat const b = 0.931 + 2.53 * std::sqrt( mean );
+   dfloat const a = -0.059 + 0.02483 * b;
+   dfloat const logInvAlpha = std::log( 1.1239 + 1.1328 / ( b - 3.4 ));
+   dfloat const vr = 0.9277 - 3.6224 / ( b - 2.0 );
+   while( true ) {
+      dfloat u = CounterBasedRandom::Canonical( generator() ) - 0.5;
+      dfloat v = CounterBasedRandom::Canonical( generator() );
+      dfloat us = 0.5 - std::abs( u );
+      dfloat k = std::floor(( 2.0 * a / us + b ) * u + mean + 0.43 );
+      if(( us >= 0.07 ) && ( v <= vr )) {
+         return k;
       }
-      GaussianScanLineFilter( Random& random, dfloat std ) : random_( random ), std_( std ) {}
-      // Make the class non copyable (generatorArray_ cannot be copied)
-      GaussianScanLineFilter( const GaussianScanLineFilter& ) = delete;
-      GaussianScanLineFilter& operator=( const GaussianScanLineFilter& ) = delete;
-      // Complete the set of special functions
-      GaussianScanLineFilter( GaussianScanLineFilter&& ) = delete;
-      GaussianScanLineFilter& operator=( GaussianScanLineFilter&& ) = delete;
-      ~GaussianScanLineFilter() override = default;
-   private:
-      Random& random_;
-      std::vector< Random > randomArray_;
-      std::vector< std::unique_ptr< GaussianRandomGenerator >> generatorArray_;
-      dfloat std_;
-};
+      if(( k < 0.0 ) || (( us < 0.013 ) && ( v > us ))) {
+         continue;
+      }
+      if( std::log( v ) + logInvAlpha - std::log( a / ( us * us ) + b ) <= -mean + k * logMean - std::lgamma( k + 1.0 )) {
+         return k;
+      }
+   }
+}
+
 } // namespace
 
-void GaussianNoise( Image const& in, Image& out, Random& random, dfloat variance ) {
+void UniformNoise( Image const& in, Image& out, Random& random, dfloat lowerBound, dfloat upperBound ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-   GaussianScanLineFilter filter( random, std::sqrt( variance ));
-   DataType dt = in.DataType();
-   Framework::ScanMonadic( in, out, DT_DFLOAT, dt, 1, filter, Framework::ScanOption::TensorAsSpatialDim );
+   dfloat range = upperBound - lowerBound;
+   AddNoise< dfloat >( in, out, random, in.DataType(), [ = ]( dfloat value, CounterBasedRandom& generator, dip::uint index ) {
+      generator.SetIndex( index );
+      return value + lowerBound + range * CounterBasedRandom::Canonical( generator() );
+   }, 30 );
 }
 
-namespace {
-class PoissonScanLineFilter : public Framework::ScanLineFilter {
-   public:
-      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 800; }
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dfloat const* in = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
-         dip::sint inStride = params.inBuffer[ 0 ].stride;
-         dip::uint const bufferLength = params.bufferLength;
-         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
-         dip::sint const outStride = params.outBuffer[ 0 ].stride;
-         PoissonRandomGenerator& generator = *generatorArray_[ params.thread ];
-         for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-            *out = static_cast< dfloat >( generator( *in * conversion_ )) / conversion_;
-            in += inStride;
-            out += outStride;
-         }
-      }
-      void SetNumberOfThreads( dip::uint threads ) override {
-         generatorArray_.resize( threads );
-         generatorArray_[ 0 ] = std::make_unique< PoissonRandomGenerator >( random_ );
-         if( threads > 1 ) {
-            randomArray_.resize( threads - 1, Random( 0 ));
-            for( dip::uint ii = 1; ii < threads; ++ii ) {
-               randomArray_[ ii - 1 ] = random_.Split();
-               generatorArray_[ ii ] = std::make_unique< PoissonRandomGenerator >( randomArray_[ ii - 1 ] );
-            }
-         }
+void GaussianNoise( Image const& in, Image& out, Random& random, dfloat variance ) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   dfloat std = std::sqrt( variance );
+   // The Box-Muller transform produces two normally distributed values, we use these for samples `2*n` and `2*n+1`.
+   // Along an image line these two samples are usually processed one after the other.
+   dip::uint pair = std::numeric_limits< dip::uint >::max();
+   std::array< dfloat, 2 > normal{};
+   AddNoise< dfloat >( in, out, random, in.DataType(), [ = ]( dfloat value, CounterBasedRandom& generator, dip::uint index ) mutable {
+      if( index / 2 != pair ) {
+         pair = index / 2;
+         generator.SetIndex( pair );
+         dfloat r = std * std::sqrt( -2.0 * std::log( 1.0 - CounterBasedRandom::Canonical( generator() )));
+         dfloat theta = 2.0 * pi * CounterBasedRandom::Canonical( generator() );
+         normal = { r * std::cos( theta ), r * std::sin( theta ) };
       }
-      PoissonScanLineFilter( Random& random, dfloat conversion ) : random_( random ), conversion_( conversion ) {}
-      // Make the class non copyable (generatorArray_ cannot be copied)
-      PoissonScanLineFilter( const PoissonScanLineFilter& ) = delete;
-      PoissonScanLineFilter& operator=( const PoissonScanLineFilter& ) = delete;
-      // Complete the set of special functions
-      PoissonScanLineFilter( PoissonScanLineFilter&& ) = delete;
-      PoissonScanLineFilter& operator=( PoissonScanLineFilter&& ) = delete;
-      ~PoissonScanLineFilter() override = default;
-   private:
-      Random& random_;
-      std::vector< Random > randomArray_;
-      std::vector< std::unique_ptr< PoissonRandomGenerator >> generatorArray_;
-      dfloat conversion_;
-};
-} // namespace
+      return value + normal[ index & 1u ];
+   }, 50 );
+}
 
 void PoissonNoise( Image const& in, Image& out, Random& random, dfloat conversion ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-   PoissonScanLineFilter filter( random, conversion );
-   DataType dt = in.DataType();
-   Framework::ScanMonadic( in, out, DT_DFLOAT, dt, 1, filter, Framework::ScanOption::TensorAsSpatialDim );
-}
-
-namespace {
-class BinaryScanLineFilter : public Framework::ScanLineFilter {
-   public:
-      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 40; }
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         bin const* in = static_cast< bin const* >( params.inBuffer[ 0 ].buffer );
-         dip::sint inStride = params.inBuffer[ 0 ].stride;
-         dip::uint const bufferLength = params.bufferLength;
-         bin* out = static_cast< bin* >( params.outBuffer[ 0 ].buffer );
-         dip::sint const outStride = params.outBuffer[ 0 ].stride;
-         BinaryRandomGenerator& generator = *generatorArray_[ params.thread ];
-         for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-            *out = generator( *in ? pForeground_ : pBackground_ );
-            in += inStride;
-            out += outStride;
-         }
-      }
-      void SetNumberOfThreads( dip::uint threads ) override {
-         generatorArray_.resize( threads );
-         generatorArray_[ 0 ] = std::make_unique< BinaryRandomGenerator >( random_ );
-         if( threads > 1 ) {
-            randomArray_.resize( threads - 1, Random( 0 ));
-            for( dip::uint ii = 1; ii < threads; ++ii ) {
-               randomArray_[ ii - 1 ] = random_.Split();
-               generatorArray_[ ii ] = std::make_unique< BinaryRandomGenerator >( randomArray_[ ii - 1 ] );
-            }
-         }
+   AddNoise< dfloat >( in, out, random, in.DataType(), [ = ]( dfloat value, CounterBasedRandom& generator, dip::uint index ) {
+      generator.SetIndex( index );
+      dfloat mean = value * conversion;
+      if( !( mean > 0 )) {
+         return 0.0;
       }
-      BinaryScanLineFilter( Random& random, dfloat p10, dfloat p01 ) :
-            random_( random ), pForeground_( 1.0 - p10 ), pBackground_( p01 ) {}
-      // Make the class non copyable (generatorArray_ cannot be copied)
-      BinaryScanLineFilter( const BinaryScanLineFilter& ) = delete;
-      BinaryScanLineFilter& operator=( const BinaryScanLineFilter& ) = delete;
-      // Complete the set of special functions
-      BinaryScanLineFilter( BinaryScanLineFilter&& ) = delete;
-      BinaryScanLineFilter& operator=( BinaryScanLineFilter&& ) = delete;
-      ~BinaryScanLineFilter() override = default;
-   private:
-      Random& random_;
-      std::vector< Random > randomArray_;
-      std::vector< std::unique_ptr< BinaryRandomGenerator >> generatorArray_;
-      dfloat pForeground_;
-      dfloat pBackground_;
-};
-} // namespace
+      return PoissonSample( mean, generator ) / conversion;
+   }, 200 );
+}
 
 void BinaryNoise( Image const& in, Image& out, Random& random, dfloat p10, dfloat p01 ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.DataType().IsBinary(), E::IMAGE_NOT_BINARY );
-   BinaryScanLineFilter filter( random, p10, p01 );
-   Framework::ScanMonadic( in, out, DT_BIN, DT_BIN, 1, filter, Framework::ScanOption::TensorAsSpatialDim );
+   dfloat pForeground = 1.0 - p10;
+   dfloat pBackground = p01;
+   AddNoise< bin >( in, out, random, DT_BIN, [ = ]( bin value, CounterBasedRandom& generator, dip::uint index ) {
+      dfloat p = value ? pForeground : pBackground;
+      if( p <= 0.0 ) { return bin( false ); }
+      if( p >= 1.0 ) { return bin( true ); }
+      generator.SetIndex( index );
+      return bin( CounterBasedRandom::Canonical( generator() ) < p );
+   }, 30 );
 }
 
-namespace {
-class SaltPepperScanLineFilter : public Framework::ScanLineFilter {
-   public:
-      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 40; }
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dfloat const* in = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
-         dip::sint inStride = params.inBuffer[ 0 ].stride;
-         dip::uint const bufferLength = params.bufferLength;
-         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
-         dip::sint const outStride = params.outBuffer[ 0 ].stride;
-         UniformRandomGenerator& generator = *generatorArray_[ params.thread ];
-         for( dip::uint kk = 0; kk < bufferLength; ++kk ) {
-            dfloat p = generator( 0.0, 1.0 );
-            if( p < p0_ ) {
-               *out = 0;
-            } else if( p >= p1_ ) {
-               *out = white_;
-            } else {
-               *out = *in;
-            }
-            in += inStride;
-            out += outStride;
-         }
-      }
-      void SetNumberOfThreads( dip::uint threads ) override  {
-         generatorArray_.resize( threads );
-         generatorArray_[ 0 ] = std::make_unique< UniformRandomGenerator >( random_ );
-         if( threads > 1 ) {
-            randomArray_.resize( threads - 1, Random( 0 ));
-            for( dip::uint ii = 1; ii < threads; ++ii ) {
-               randomArray_[ ii - 1 ] = random_.Split();
-               generatorArray_[ ii ] = std::make_unique< UniformRandomGenerator >( randomArray_[ ii - 1 ] );
-            }
-         }
-      }
-      SaltPepperScanLineFilter( Random& random, dfloat p0, dfloat p1, dfloat white ) :
-            random_( random ), p0_( p0 ), p1_( 1.0 - p1 ), white_( white ) {}
-      // Make the class non copyable (generatorArray_ cannot be copied)
-      SaltPepperScanLineFilter( const SaltPepperScanLineFilter& ) = delete;
-      SaltPepperScanLineFilter& operator=( const SaltPepperScanLineFilter& ) = delete;
-      // Complete the set of special functions
-      SaltPepperScanLineFilter( SaltPepperScanLineFilter&& ) = delete;
-      SaltPepperScanLineFilter& operator=( SaltPepperScanLineFilter&& ) = delete;
-      ~SaltPepperScanLineFilter() override = default;
-   private:
-      Random& random_;
-      std::vector< Random > randomArray_;
-      std::vector< std::unique_ptr< UniformRandomGenerator >> generatorArray_;
-      dfloat p0_;
-      dfloat p1_;
-      dfloat white_;
-};
-} // namespace
-
 void SaltPepperNoise( Image const& in, Image& out, Random& random, dfloat p0, dfloat p1, dfloat white ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
@@ -305,9 +203,18 @@ void SaltPepperNoise( Image const& in, Image& out, Random& random, dfloat p0, df
       p0 /= s;
       p1 /= s; // This means the whole image will be black and white noise!
    }
-   SaltPepperScanLineFilter filter( random, p0, p1, white );
-   DataType dt = in.DataType();
-   Framework::ScanMonadic( in, out, DT_DFLOAT, dt, 1, filter, Framework::ScanOption::TensorAsSpatialDim );
+   p1 = 1.0 - p1;
+   AddNoise< dfloat >( in, out, random, in.DataType(), [ = ]( dfloat value, CounterBasedRandom& generator, dip::uint index ) {
+      generator.SetIndex( index );
+      dfloat p = CounterBasedRandom::Canonical( generator() );
+      if( p < p0 ) {
+         return 0.0;
+      }
+      if( p >= p1 ) {
+         return white;
+      }
+      return value;
+   }, 30 );
 }
 
 void FillColoredNoise( Image& out, Random& random, dfloat variance, dfloat color ) {
@@ -344,3 +251,74 @@ void FillColoredNoise( Image& out, Random& random, dfloat variance, dfloat color
 }
 
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/math.h"
+#include "diplib/multithreading.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the counter-based random generator") {
+   // Known-answer tests from the Random123 library
+   dip::CounterBasedRandom generator( 0 );
+   auto block = generator.Generate( { 0, 0, 0, 0 } );
+   DOCTEST_CHECK( block == dip::CounterBasedRandom::Block{ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u } );
+   generator.Seed( 0x299f31d0a4093822u );
+   block = generator.Generate( { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u } );
+   DOCTEST_CHECK( block == dip::CounterBasedRandom::Block{ 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u } );
+   // Sequences depend only on the index
+   generator.SetIndex( 5 );
+   auto a = generator();
+   auto b = generator();
+   auto c = generator();
+   generator.SetIndex( 6 );
+   auto d = generator();
+   generator.SetIndex( 5 );
+   DOCTEST_CHECK( generator() == a );
+   DOCTEST_CHECK( generator() == b );
+   DOCTEST_CHECK( generator() == c );
+   DOCTEST_CHECK( a != d );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing noise generation") {
+   dip::Image img( { 300, 200 }, 2, dip::DT_SFLOAT );
+   img.Fill( 10.0 );
+   // The result does not depend on the number of threads
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Random random( 42 );
+   dip::Image out1 = dip::GaussianNoise( img, random, 4.0 );
+   dip::SetNumberOfThreads( 3 );
+   random.Seed( 42 );
+   dip::Image out2 = dip::GaussianNoise( img, random, 4.0 );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::testing::CompareImages( out1, out2 ));
+   // Nor on the strides of the image, only on the pixel coordinates
+   random.Seed( 42 );
+   dip::Image out3 = img.Copy();
+   out3.Mirror( { true, false } );
+   dip::GaussianNoise( out3, out3, random, 4.0 );
+   DOCTEST_CHECK( dip::testing::CompareImages( out1, out3 ));
+   // Statistics
+   img = img[ 1 ];
+   DOCTEST_CHECK( dip::Mean( out1[ 1 ] ).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( dip::Variance( out1[ 1 ] ).As< dip::dfloat >() == doctest::Approx( 4.0 ).epsilon( 0.02 ));
+   dip::Image out4 = dip::UniformNoise( img, random, -1.0, 1.0 );
+   DOCTEST_CHECK( dip::Mean( out4 ).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( dip::Variance( out4 ).As< dip::dfloat >() == doctest::Approx( 1.0 / 3.0 ).epsilon( 0.02 ));
+   DOCTEST_CHECK( dip::Minimum( out4 ).As< dip::dfloat >() >= 9.0 );
+   DOCTEST_CHECK( dip::Maximum( out4 ).As< dip::dfloat >() < 11.0 );
+   dip::Image out5 = dip::PoissonNoise( img, random );
+   DOCTEST_CHECK( dip::Mean( out5 ).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( dip::Variance( out5 ).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.03 ));
+   DOCTEST_CHECK( dip::Count( out5 != dip::Round( out5 )) == 0 );
+   // Poisson noise with a small mean (inversion) and a large mean (transformed rejection)
+   out5 = dip::PoissonNoise( img, random, 0.25 );
+   DOCTEST_CHECK( dip::Mean( out5 ).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.02 ));
+   DOCTEST_CHECK( dip::Variance( out5 ).As< dip::dfloat >() == doctest::Approx( 40.0 ).epsilon( 0.03 ));
+   out5 = dip::PoissonNoise( img, random, 100.0 );
+   DOCTEST_CHECK( dip::Mean( out5 ).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.01 ));
+   DOCTEST_CHECK( dip::Variance( out5 ).As< dip::dfloat >() == doctest::Approx( 0.1 ).epsilon( 0.03 ));
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -19,7 +19,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -209,61 +211,176 @@ class HistogramBaseLineFilter : public Framework::ScanLineFilter {
       ImageArray imageArray_;
 };
 
+// The scalar histogram keeps per-thread counts in plain arrays, with one additional bin at the end where
+// masked-out and excluded out-of-range samples are counted, so that the inner loop has no branches.
+class ScalarHistogramBaseLineFilter : public Framework::ScanLineFilter {
+   public:
+      void SetNumberOfThreads( dip::uint threads ) override {
+         counts_.resize( threads );
+         // We don't allocate the arrays here, the Filter() function should do that so each thread allocates its own
+         // data segment. This ensures there's no false sharing.
+      }
+      virtual void Reduce( Image& image ) = 0;
+   protected:
+      std::vector< std::vector< CountType >> counts_;
+
+      std::vector< CountType >& ThreadCounts( dip::uint thread, dip::uint size ) {
+         auto& counts = counts_[ thread ];
+         if( counts.empty() ) {
+            counts.resize( size, 0 );
+         }
+         return counts;
+      }
+};
+
 template< typename TPI >
-class ScalarImageHistogramLineFilter : public HistogramBaseLineFilter {
+class ScalarImageHistogramLineFilter : public ScalarHistogramBaseLineFilter {
    public:
       dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 6; }
       void Filter( Framework::ScanLineFilterParameters const& params ) override {
          TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
          auto bufferLength = params.bufferLength;
          auto inStride = params.inBuffer[ 0 ].stride;
-         Image& image = params.thread == 0 ? image_ : imageArray_[ params.thread - 1 ];
-         if( !image.IsForged() ) {
-            image.Forge();
-            image.Fill( 0 );
+         bin const* mask = nullptr;
+         dip::sint maskStride = 0;
+         if( params.inBuffer.size() > 1 ) {
+            // If there's two input buffers, we have a mask image.
+            mask = static_cast< bin const* >( params.inBuffer[ 1 ].buffer );
+            maskStride = params.inBuffer[ 1 ].stride;
          }
-         CountType* data = static_cast< CountType* >( image.Origin() );
-         // Note: `image_` strides are always normal.
+         CountType* data = ThreadCounts( params.thread, nBins_ + 1 ).data();
+         // We compute bin indices for a block of samples at the time, in a loop without branches that the compiler
+         // can vectorize. The bin index computation is the same as in `Configuration::FindBin()`, but NaN maps to
+         // the first bin. Excluded and masked-out samples go to the extra bin at the end. The number of bins is
+         // limited to what fits in a 32-bit integer, so the conversion from floating point can be vectorized too.
+         constexpr dip::uint blockSize = 256;
+         sint32 bins[ blockSize ];
+         sint32 const dumpBin = static_cast< sint32 >( nBins_ );
+         while( bufferLength > 0 ) {
+            dip::uint n = std::min( bufferLength, blockSize );
+            for( dip::uint ii = 0; ii < n; ++ii ) {
+               dfloat value = static_cast< dfloat >( in[ static_cast< dip::sint >( ii ) * inStride ] );
+               dfloat index = ( value - lowerBound_ ) / binSize_;
+               index = index > 0.0 ? index : 0.0;
+               index = index < lastBin_ ? index : lastBin_;
+               sint32 binIndex = static_cast< sint32 >( index );
+               if( excludeOutOfBoundValues_ ) {
+                  binIndex = (( value >= lowerBound_ ) && ( value < upperBound_ )) ? binIndex : dumpBin;
+               }
+               bins[ ii ] = binIndex;
+            }
+            if( mask ) {
+               for( dip::uint ii = 0; ii < n; ++ii ) {
+                  ++data[ mask[ static_cast< dip::sint >( ii ) * maskStride ] ? bins[ ii ] : dumpBin ];
+               }
+               mask += static_cast< dip::sint >( n ) * maskStride;
+            } else {
+               for( dip::uint ii = 0; ii < n; ++ii ) {
+                  ++data[ bins[ ii ]];
+               }
+            }
+            in += static_cast< dip::sint >( n ) * inStride;
+            bufferLength -= n;
+         }
+      }
+      void Reduce( Image& image ) override {
+         image.Forge();
+         image.Fill( 0 );
+         CountType* data = static_cast< CountType* >( image.Origin() ); // `image` strides are always normal.
+         for( auto const& counts : counts_ ) {
+            if( !counts.empty() ) {
+               for( dip::uint ii = 0; ii < nBins_; ++ii ) {
+                  data[ ii ] += counts[ ii ];
+               }
+            }
+         }
+      }
+      ScalarImageHistogramLineFilter( Histogram::Configuration const& configuration ) :
+            lowerBound_( configuration.lowerBound ), upperBound_( configuration.upperBound ), binSize_( configuration.binSize ),
+            lastBin_( static_cast< dfloat >( configuration.nBins - 1 )), nBins_( configuration.nBins ),
+            excludeOutOfBoundValues_( configuration.excludeOutOfBoundValues ) {}
+   private:
+      dfloat lowerBound_;
+      dfloat upperBound_;
+      dfloat binSize_;
+      dfloat lastBin_;
+      dip::uint nBins_;
+      bool excludeOutOfBoundValues_;
+};
+
+// For 8-bit and 16-bit integer images we count how often each possible input value occurs, and compute the
+// histogram from those counts at the end. The inner loop needs no bin computation at all.
+template< typename TPI >
+class SmallIntegerHistogramLineFilter : public ScalarHistogramBaseLineFilter {
+   public:
+      using UnsignedType = std::make_unsigned_t< TPI >;
+      static constexpr dip::uint nValues = dip::uint( 1 ) << ( sizeof( TPI ) * 8 );
+      // For 8-bit images each thread uses 4 sub-histograms, consecutive samples are counted in different ones.
+      // Otherwise consecutive samples with the same value stall the loop, as each increment must wait for the
+      // previous one to be stored. For 16-bit images the values are more spread out, and the tables larger.
+      static constexpr dip::uint nCopies = sizeof( TPI ) == 1 ? 4 : 1;
+      static constexpr dip::uint TableSize() { return nValues * nCopies; }
+
+      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override { return 2; }
+      void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
+         auto bufferLength = params.bufferLength;
+         auto inStride = params.inBuffer[ 0 ].stride;
+         CountType* data = ThreadCounts( params.thread, TableSize() ).data();
+         dip::uint ii = 0;
          if( params.inBuffer.size() > 1 ) {
             // If there's two input buffers, we have a mask image.
             bin const* mask = static_cast< bin const* >( params.inBuffer[ 1 ].buffer );
             auto maskStride = params.inBuffer[ 1 ].stride;
-            if( configuration_.excludeOutOfBoundValues ) {
-               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-                  if( *mask && configuration_.IsInRange( static_cast< dfloat >( *in ))) {
-                     ++data[ configuration_.FindBin( *in ) ];
-                  }
-                  in += inStride;
-                  mask += maskStride;
-               }
-            } else {
-               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-                  if( *mask ) {
-                     ++data[ configuration_.FindBin( *in ) ];
-                  }
+            for( ; ii + nCopies <= bufferLength; ii += nCopies ) {
+               for( dip::uint jj = 0; jj < nCopies; ++jj ) {
+                  data[ jj * nValues + static_cast< UnsignedType >( *in ) ] += static_cast< bool >( *mask );
                   in += inStride;
                   mask += maskStride;
                }
             }
+            for( ; ii < bufferLength; ++ii ) {
+               data[ static_cast< UnsignedType >( *in ) ] += static_cast< bool >( *mask );
+               in += inStride;
+               mask += maskStride;
+            }
          } else {
-            // Otherwise we don't.
-            if( configuration_.excludeOutOfBoundValues ) {
-               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-                  if( configuration_.IsInRange( static_cast< dfloat >( *in ))) {
-                     ++data[ configuration_.FindBin( *in ) ];
-                  }
+            for( ; ii + nCopies <= bufferLength; ii += nCopies ) {
+               for( dip::uint jj = 0; jj < nCopies; ++jj ) {
+                  ++data[ jj * nValues + static_cast< UnsignedType >( *in ) ];
                   in += inStride;
                }
-            } else {
-               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-                  ++data[ configuration_.FindBin( *in ) ];
-                  in += inStride;
+            }
+            for( ; ii < bufferLength; ++ii ) {
+               ++data[ static_cast< UnsignedType >( *in ) ];
+               in += inStride;
+            }
+         }
+      }
+      void Reduce( Image& image ) override {
+         image.Forge();
+         image.Fill( 0 );
+         CountType* data = static_cast< CountType* >( image.Origin() ); // `image` strides are always normal.
+         std::vector< CountType > total( nValues, 0 );
+         for( auto const& counts : counts_ ) {
+            if( !counts.empty() ) {
+               for( dip::uint ii = 0; ii < TableSize(); ++ii ) {
+                  total[ ii % nValues ] += counts[ ii ];
                }
             }
          }
+         for( dip::uint ii = 0; ii < nValues; ++ii ) {
+            if( total[ ii ] == 0 ) {
+               continue;
+            }
+            TPI value = static_cast< TPI >( static_cast< UnsignedType >( ii ));
+            if( configuration_.IsOutOfRange( static_cast< dfloat >( value ))) {
+               continue;
+            }
+            data[ configuration_.FindBin( value ) ] += total[ ii ];
+         }
       }
-      ScalarImageHistogramLineFilter( Image& image, Histogram::Configuration const& configuration ) :
-            HistogramBaseLineFilter( image ), configuration_( configuration ) {}
+      SmallIntegerHistogramLineFilter( Histogram::Configuration const& configuration ) : configuration_( configuration ) {}
    private:
       Histogram::Configuration const& configuration_;
 };
@@ -379,18 +496,51 @@ void Histogram::ScalarImageHistogram( Image const& input, Image const& mask, His
    binSizes_ = { configuration.binSize };
    data_.SetSizes( { configuration.nBins } );
    data_.SetDataType( DT_COUNT );
-   std::unique_ptr< HistogramBaseLineFilter >scanLineFilter;
-   DIP_OVL_NEW_REAL( scanLineFilter, ScalarImageHistogramLineFilter, ( data_, configuration ), input.DataType() );
+   std::unique_ptr< ScalarHistogramBaseLineFilter > scanLineFilter;
+   dip::uint operationsPerPixel = 6;
+   dip::uint tableSize = data_.NumberOfPixels();
+   // The small integer fast path needs a table with one count per possible input value, we only use it
+   // if the image has at least as many pixels as that table has elements.
+   switch( input.DataType() ) {
+      case DT_UINT8:
+         scanLineFilter = std::make_unique< SmallIntegerHistogramLineFilter< uint8 >>( configuration );
+         tableSize = SmallIntegerHistogramLineFilter< uint8 >::TableSize();
+         break;
+      case DT_SINT8:
+         scanLineFilter = std::make_unique< SmallIntegerHistogramLineFilter< sint8 >>( configuration );
+         tableSize = SmallIntegerHistogramLineFilter< sint8 >::TableSize();
+         break;
+      case DT_UINT16:
+         if( input.NumberOfPixels() >= SmallIntegerHistogramLineFilter< uint16 >::TableSize() ) {
+            scanLineFilter = std::make_unique< SmallIntegerHistogramLineFilter< uint16 >>( configuration );
+            tableSize = SmallIntegerHistogramLineFilter< uint16 >::TableSize();
+         }
+         break;
+      case DT_SINT16:
+         if( input.NumberOfPixels() >= SmallIntegerHistogramLineFilter< sint16 >::TableSize() ) {
+            scanLineFilter = std::make_unique< SmallIntegerHistogramLineFilter< sint16 >>( configuration );
+            tableSize = SmallIntegerHistogramLineFilter< sint16 >::TableSize();
+         }
+         break;
+      default:
+         break;
+   }
+   if( scanLineFilter ) {
+      operationsPerPixel = 2;
+   } else {
+      DIP_THROW_IF( configuration.nBins >= static_cast< dip::uint >( std::numeric_limits< sint32 >::max() ), E::SIZE_EXCEEDS_LIMIT );
+      DIP_OVL_NEW_REAL( scanLineFilter, ScalarImageHistogramLineFilter, ( configuration ), input.DataType() );
+   }
    Framework::ScanOptions opts;
    if( GetNumberOfThreads() > 1 ) {
-      dip::uint parallelOperations = input.NumberOfPixels() * 6;
-      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( data_.NumberOfPixels() * 2 + 10000 );
+      dip::uint parallelOperations = input.NumberOfPixels() * operationsPerPixel;
+      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( tableSize * 2 + 10000 );
       if( parallelOperations / GetNumberOfThreads() + sequentialOperations + threadingThreshold > parallelOperations ) {
          opts = Framework::ScanOption::NoMultiThreading; // Turn off multithreading if we'll do a lot of work to reduce.
       }
    }
    DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( input, mask, input.DataType(), *scanLineFilter, opts ));
-   scanLineFilter->Reduce();
+   scanLineFilter->Reduce( data_ );
 }
 
 void Histogram::TensorImageHistogram( Image const& input, Image const& mask, Histogram::ConfigurationArray& configuration ) {
@@ -652,6 +802,7 @@ Histogram& Histogram::Smooth( FloatArray sigma ) {
 #include "doctest.h"
 #include "diplib/iterators.h"
 #include "diplib/random.h"
+#include "diplib/generation.h"
 
 DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram" ) {
    dip::Image zero( {}, 1, dip::DT_SFLOAT );
@@ -814,6 +965,44 @@ DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram" ) {
    DOCTEST_CHECK_THROWS( histograms[ 2 ].Count() );
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing the dip::Histogram fast paths" ) {
+   // Compares the histogram to one computed pixel by pixel, for the small integer types and a float type
+   dip::Random random( 0 );
+   dip::Image mask( { 300, 250 }, 1, dip::DT_BIN );
+   mask.Fill( 0 );
+   dip::BinaryNoise( mask, mask, random, 0.5, 0.5 );
+   for( dip::DataType dt : { dip::DT_UINT8, dip::DT_SINT8, dip::DT_UINT16, dip::DT_SINT16, dip::DT_SFLOAT } ) {
+      dip::Image img( { 300, 250 }, 1, dt );
+      img.Fill( 0 );
+      dip::GaussianNoise( img, img, random, 40.0 * 40.0 );
+      img += 20;
+      for( bool exclude : { false, true } ) {
+         dip::Histogram::Configuration conf( -30.0, 100.0, 3.0 );
+         conf.excludeOutOfBoundValues = exclude;
+         for( bool useMask : { false, true } ) {
+            dip::Histogram hist( img, useMask ? mask : dip::Image{}, conf );
+            dip::Histogram::Configuration completed = conf;
+            completed.Complete( dt.IsInteger() );
+            std::vector< dip::Histogram::CountType > expected( completed.nBins, 0 );
+            dip::Image dimg = dip::Convert( img, dip::DT_DFLOAT );
+            dip::ImageIterator< dip::dfloat > it( dimg );
+            dip::ImageIterator< dip::bin > mit( mask );
+            do {
+               if(( !useMask || *mit ) && !completed.IsOutOfRange( *it )) {
+                  ++expected[ static_cast< dip::uint >( completed.FindBin( *it )) ];
+               }
+            } while( ++mit, ++it );
+            DOCTEST_REQUIRE( hist.Bins() == completed.nBins );
+            bool equal = true;
+            for( dip::uint ii = 0; ii < completed.nBins; ++ii ) {
+               equal &= hist.At( ii ) == expected[ ii ];
+            }
+            DOCTEST_CHECK( equal );
+         }
+      }
+   }
+}
+
 DOCTEST_TEST_CASE( "[DIPlib] testing that dip::Histogram handles NaN values" ) {
    dip::Image img( { dip::nan, 10.0, 2.0, dip::nan, dip::nan, 5.0, dip::nan, 6.0, 3.0, 7.0, 4.0, dip::nan, dip::nan }, dip::DT_DFLOAT );
    img.TensorToSpatial();  // The line above creates a single-pixel tensor image.
@@ -19,70 +19,41 @@
 
 #include "diplib.h"
 #include "diplib/distribution.h"
-#include "diplib/framework.h"
 #include "diplib/statistics.h"
 
+#include "../statistics/per_label_reduction.h"
+
 namespace dip {
 
 namespace {
 
-class PerObjectHistogramLineFilter : public Framework::ScanLineFilter {
+// Accumulator for `PerLabelReduction`: a histogram for each tensor element.
+class HistogramAccumulator {
    public:
-      //void SetNumberOfThreads( dip::uint threads ) override {
-      //   for( dip::uint ii = 1; ii < threads; ++ii ) {
-      //      imageArray_.emplace_back( image_ );       // makes a copy; image_ is not yet forged, so data is not shared.
-      //   }
-      //   // We don't forge the images here, the Filter() function should do that so each thread allocates its own
-      //   // data segment. This ensures there's no false sharing.
-      //}
-      //dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint tensorElements ) override {
-      //   return ( tensorInput_ ? tensorElements : 2 ) * 6;
-      //}
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         // 0: Grey image
-         dfloat const* grey = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
-         dip::sint gStride = params.inBuffer[ 0 ].stride;
-         dip::uint tLength = params.inBuffer[ 0 ].tensorLength;
-         dip::sint tStride = params.inBuffer[ 0 ].tensorStride;
-         // 1: Label image
-         LabelType const* label = static_cast< LabelType const* >( params.inBuffer[ 1 ].buffer );
-         dip::sint lStride = params.inBuffer[ 1 ].stride;
-         // 2: Mask image
-         bool hasMask = params.inBuffer.size() > 2;
-         bin const* mask = hasMask ? static_cast< bin const* >( params.inBuffer[ 2 ].buffer ) : nullptr;
-         dip::sint mStride = hasMask ? params.inBuffer[ 2 ].stride : 0;
-         // Process
-         for( dip::uint ii = 0; ii < params.bufferLength; ++ii ) {
-            if( !hasMask || *mask ) {
-               dip::uint lab = *label;
-               if( !exclude0_ || lab != 0 ) {
-                  if( exclude0_ ) {
-                     --lab; // index 0 corresponds to label 1.
-                  }
-                  dfloat const* tgrey = grey;
-                  for( dip::uint jj = 0; jj < tLength; ++jj ) {
-                     if( !configuration_.IsOutOfRange( *tgrey )) {
-                        auto index = static_cast< dip::uint >( configuration_.FindBin( *tgrey ));
-                        ++( distribution_[ index ].Y( lab, jj ));
-                     }
-                     tgrey += tStride;
-                  }
-               }
+      HistogramAccumulator( Histogram::Configuration const& configuration, dip::uint nTensor ) :
+            configuration_( &configuration ), counts_( configuration.nBins * nTensor, 0 ) {}
+      void Push( dfloat const* values, dip::sint tensorStride ) {
+         dip::uint nBins = configuration_->nBins;
+         for( dip::uint jj = 0; jj < counts_.size(); jj += nBins, values += tensorStride ) {
+            if( !configuration_->IsOutOfRange( *values )) {
+               ++counts_[ jj + static_cast< dip::uint >( configuration_->FindBin( *values )) ];
             }
-            grey += gStride;
-            label += lStride;
-            mask += mStride;
          }
       }
-      PerObjectHistogramLineFilter( Distribution& distribution, Histogram::Configuration const& configuration, bool include0 ) :
-            distribution_( distribution ), configuration_( configuration ), exclude0_( !include0 ) {}
+      void Merge( HistogramAccumulator const& other ) {
+         for( dip::uint ii = 0; ii < counts_.size(); ++ii ) {
+            counts_[ ii ] += other.counts_[ ii ];
+         }
+      }
+      // Count for bin `bin` of tensor element `jj`
+      Histogram::CountType Count( dip::uint bin, dip::uint jj ) const {
+         return counts_[ jj * configuration_->nBins + bin ];
+      }
    private:
-      Distribution& distribution_;
-      Histogram::Configuration const& configuration_;
-      bool exclude0_;
+      Histogram::Configuration const* configuration_;
+      std::vector< Histogram::CountType > counts_;
 };
 
-
 } // namespace
 
 Distribution PerObjectHistogram(
@@ -101,14 +72,12 @@ Distribution PerObjectHistogram(
 
    // Check mask, expand mask singleton dimensions if necessary
    Image mask;
-   bool hasMask = false;
    if( c_mask.IsForged() ) {
       mask = c_mask.QuickCopy();
       DIP_START_STACK_TRACE
          mask.CheckIsMask( grey.Sizes(), Option::AllowSingletonExpansion::DO_ALLOW, Option::ThrowException::DO_THROW );
          mask.ExpandSingletonDimensions( grey.Sizes() );
       DIP_END_STACK_TRACE
-      hasMask = true;
    }
 
    // Check and fix other parameters
@@ -141,15 +110,16 @@ Distribution PerObjectHistogram(
    }
 
    // Fill output
-   PerObjectHistogramLineFilter scanLineFilter( distribution, configuration, include0 );
-   ImageConstRefArray inputs{ grey, label };
-   DataTypeArray inBufferTypes{ DT_DFLOAT, DT_LABEL };
-   if( hasMask ) {
-      inputs.push_back( mask );
-      inBufferTypes.push_back( DT_BIN );
+   tsl::robin_map< LabelType, HistogramAccumulator > histograms;
+   DIP_STACK_TRACE_THIS( histograms = PerLabelReduction( grey, label, mask, HistogramAccumulator( configuration, grey.TensorElements() ), include0 ));
+   for( auto const& object : histograms ) {
+      dip::uint index = include0 ? object.first : object.first - 1; // if excluding 0, index 0 corresponds to label 1.
+      for( dip::uint ii = 0; ii < configuration.nBins; ++ii ) {
+         for( dip::uint jj = 0; jj < grey.TensorElements(); ++jj ) {
+            distribution[ ii ].Y( index, jj ) = static_cast< dfloat >( object.second.Count( ii, jj ));
+         }
+      }
    }
-   ImageRefArray outputs{};
-   DIP_STACK_TRACE_THIS( Framework::Scan( inputs, outputs, inBufferTypes, {}, {}, {}, scanLineFilter, Framework::ScanOption::NoMultiThreading ));
 
    // Normalize
    if( fraction ) {
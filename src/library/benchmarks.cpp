@@ -0,0 +1,573 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Define this value when compiling the dip_benchmarks program
+#ifdef DIP_IMPLEMENT_BENCHMARKS
+
+/*
+ * The dip_benchmarks program times a fixed set of functions over a grid of image sizes, dimensionalities,
+ * data types and thread counts. Run `dip_benchmarks --help` for the command-line options.
+ *
+ * Each measurement is identified by a string "<name>/<sizes>/<data type>/<threads>t", for example
+ * "GaussFIR/1024x1024/SFLOAT/4t". The results can be written to a JSON file with `--output`. A JSON file
+ * written earlier can be given with `--compare`, the minimum times are then compared to the ones in that
+ * file, and the program exits with a non-zero value if any benchmark became slower by more than the
+ * tolerance given with `--tolerance`. The minimum over repetitions is used because it is least affected by
+ * other processes running on the machine. The comparison only looks at the "id" and "min" fields of each
+ * benchmark, so files written by older versions of this program can be compared as long as these exist.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "diplib.h"
+#include "diplib/distance.h"
+#include "diplib/file_io.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+#include "diplib/mapping.h"
+#include "diplib/measurement.h"
+#include "diplib/morphology.h"
+#include "diplib/multithreading.h"
+#include "diplib/nonlinear.h"
+#include "diplib/random.h"
+#include "diplib/regions.h"
+#include "diplib/testing.h"
+#include "diplib/transform.h"
+
+namespace {
+
+using dip::Image;
+using dip::String;
+using dip::dfloat;
+
+// The kind of input image a benchmark needs.
+enum class Input {
+   GREY,    // smooth random grey-value image, converted to the benchmark's data type
+   BINARY,  // the grey-value image thresholded, gives blobs covering about half of the image
+   LABELS   // the binary image labeled; the fixture's `aux` image contains the grey-value image in SFLOAT
+};
+
+struct Fixture {
+   Image in;
+   Image aux;
+   String filename;
+};
+
+struct Benchmark {
+   char const* name;
+   Input input;
+   std::vector< dip::uint > dims;
+   std::vector< dip::DataType > dataTypes;
+   std::function< void( Fixture const&, Image& ) > run;
+   std::function< void( Fixture& ) > setup = {}; // Called once for each fixture, before timing
+   char const* extension = nullptr;              // If set, `Fixture::filename` is a temporary file with this extension
+   bool ( *available )() = nullptr;              // If set and returns false, the benchmark is skipped
+};
+
+// Sizes for the "small" and "large" classes, indexed by dimensionality
+dip::UnsignedArray ImageSizes( dip::uint nDims, String const& sizeClass ) {
+   bool large = sizeClass == "large";
+   if( nDims == 2 ) {
+      return large ? dip::UnsignedArray{ 1024, 1024 } : dip::UnsignedArray{ 256, 256 };
+   }
+   return large ? dip::UnsignedArray{ 100, 100, 100 } : dip::UnsignedArray{ 40, 40, 40 };
+}
+
+Image MakeGrey( dip::UnsignedArray const& sizes ) {
+   dip::Random random( 0 );
+   Image img( sizes, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::GaussianNoise( img, img, random, 1.0 );
+   dip::Gauss( img, img, { 2.0 } );
+   dip::ContrastStretch( img, img, 0.0, 100.0, 0.0, 255.0 );
+   return img;
+}
+
+Fixture MakeFixture(
+      Benchmark const& benchmark,
+      dip::UnsignedArray const& sizes,
+      dip::DataType dataType,
+      String const& tempDir
+) {
+   Fixture fixture;
+   if( benchmark.extension ) {
+      fixture.filename = tempDir + "/dip_benchmark" + benchmark.extension;
+   }
+   Image grey = MakeGrey( sizes );
+   switch( benchmark.input ) {
+      case Input::GREY:
+         fixture.in = dip::Convert( grey, dataType );
+         break;
+      case Input::BINARY:
+         fixture.in = grey > 128;
+         break;
+      case Input::LABELS:
+         fixture.in = dip::Label( grey > 128 );
+         fixture.aux = grey;
+         break;
+   }
+   if( benchmark.setup ) {
+      benchmark.setup( fixture );
+   }
+   return fixture;
+}
+
+bool HasICS() { return dip::libraryInformation.hasICS; }
+bool HasTIFF() { return dip::libraryInformation.hasTIFF; }
+bool HasPNG() { return dip::libraryInformation.hasPNG; }
+
+std::vector< Benchmark > const& Benchmarks() {
+   static std::vector< Benchmark > const benchmarks{
+         // Frameworks
+         { "Scan/Add", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::Add( f.in, f.in, out, f.in.DataType() ); } },
+         { "Separable/Uniform", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::Uniform( f.in, out, { 7, dip::S::RECTANGULAR } ); } },
+         { "Full/GeneralConvolution", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::GeneralConvolution( f.in, f.aux, out ); },
+           []( Fixture& f ) {
+              f.aux = Image( dip::UnsignedArray( f.in.Dimensionality(), 5 ), 1, dip::DT_SFLOAT );
+              dip::Random random( 1 );
+              f.aux.Fill( 0 );
+              dip::UniformNoise( f.aux, f.aux, random, 0.0, 1.0 );
+           } },
+         // Linear filters
+         { "GaussFIR", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::GaussFIR( f.in, out, { 3.0 } ); } },
+         { "GaussIIR", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::GaussIIR( f.in, out, { 3.0 } ); } },
+         { "GaussFT", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::GaussFT( f.in, out, { 3.0 } ); } },
+         { "FourierTransform", Input::GREY, { 2, 3 }, { dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::FourierTransform( f.in, out ); } },
+         // Morphology and non-linear filters
+         { "Dilation/PixelTable", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::Dilation( f.in, out, { 7, dip::S::ELLIPTIC } ); } },
+         { "Dilation/Line", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) {
+              dip::FloatArray length{ 15, 5, 3 };
+              length.resize( f.in.Dimensionality() );
+              dip::Dilation( f.in, out, { length, dip::S::LINE } );
+           } },
+         { "Dilation/Parabolic", Input::GREY, { 2, 3 }, { dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::Dilation( f.in, out, { 10, dip::S::PARABOLIC } ); } },
+         { "PercentileFilter", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::PercentileFilter( f.in, out, 30, { 5 } ); } },
+         { "Watershed", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::Watershed( f.in, {}, out ); } },
+         // Binary and labeled images
+         { "Label", Input::BINARY, { 2, 3 }, { dip::DT_BIN },
+           []( Fixture const& f, Image& out ) { dip::Label( f.in, out ); } },
+         { "EuclideanDistanceTransform", Input::BINARY, { 2, 3 }, { dip::DT_BIN },
+           []( Fixture const& f, Image& out ) { dip::EuclideanDistanceTransform( f.in, out ); } },
+         { "MeasurementTool", Input::LABELS, { 2, 3 }, { dip::DT_UINT32 },
+           []( Fixture const& f, Image& /*out*/ ) {
+              static dip::MeasurementTool const tool;
+              tool.Measure( f.in, f.aux, { "Size", "Center", "Mean", "StandardDeviation", "Maximum" } );
+           } },
+         // File I/O
+         { "WriteICS", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& ) { dip::ImageWriteICS( f.in, f.filename ); },
+           {}, ".ics", HasICS },
+         { "ReadICS", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::ImageReadICS( out, f.filename ); },
+           []( Fixture& f ) { dip::ImageWriteICS( f.in, f.filename ); }, ".ics", HasICS },
+         { "WriteTIFF", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& ) { dip::ImageWriteTIFF( f.in, f.filename ); },
+           {}, ".tif", HasTIFF },
+         { "ReadTIFF", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::ImageReadTIFF( out, f.filename, dip::Range{ 0, -1 } ); },
+           []( Fixture& f ) { dip::ImageWriteTIFF( f.in, f.filename ); }, ".tif", HasTIFF },
+         { "WritePNG", Input::GREY, { 2 }, { dip::DT_UINT8, dip::DT_UINT16 },
+           []( Fixture const& f, Image& ) { dip::ImageWritePNG( f.in, f.filename ); },
+           {}, ".png", HasPNG },
+         { "ReadPNG", Input::GREY, { 2 }, { dip::DT_UINT8, dip::DT_UINT16 },
+           []( Fixture const& f, Image& out ) { dip::ImageReadPNG( out, f.filename ); },
+           []( Fixture& f ) { dip::ImageWritePNG( f.in, f.filename ); }, ".png", HasPNG },
+         { "WriteNPY", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& ) { dip::ImageWriteNPY( f.in, f.filename ); },
+           {}, ".npy" },
+         { "ReadNPY", Input::GREY, { 2, 3 }, { dip::DT_UINT8, dip::DT_SFLOAT },
+           []( Fixture const& f, Image& out ) { dip::ImageReadNPY( out, f.filename ); },
+           []( Fixture& f ) { dip::ImageWriteNPY( f.in, f.filename ); }, ".npy" },
+   };
+   return benchmarks;
+}
+
+struct Options {
+   std::vector< String > filters;
+   std::vector< String > sizeClasses{ "small", "large" };
+   std::vector< dip::uint > dims{ 2, 3 };
+   std::vector< dip::DataType > dataTypes;  // empty means all
+   std::vector< dip::uint > threads;        // empty means 1 and the default maximum
+   dip::uint minRepetitions = 3;
+   dfloat minTime = 0.2;
+   String output;
+   String compare;
+   dfloat tolerance = 0.1;
+   String tempDir;
+   bool list = false;
+};
+
+struct Result {
+   String id;
+   String name;
+   dip::UnsignedArray sizes;
+   dip::DataType dataType;
+   dip::uint threads;
+   dip::uint runs;
+   dfloat min;
+   dfloat median;
+   dfloat mean;
+   dfloat baseline = 0; // minimum time in the baseline file, 0 if there is no baseline
+};
+
+String SizesString( dip::UnsignedArray const& sizes ) {
+   String out;
+   for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+      if( ii > 0 ) {
+         out += 'x';
+      }
+      out += std::to_string( sizes[ ii ] );
+   }
+   return out;
+}
+
+std::vector< String > SplitList( String const& list ) {
+   std::vector< String > out;
+   std::istringstream stream( list );
+   String item;
+   while( std::getline( stream, item, ',' )) {
+      if( !item.empty() ) {
+         out.push_back( item );
+      }
+   }
+   return out;
+}
+
+std::vector< dip::uint > SplitUnsignedList( String const& list ) {
+   std::vector< dip::uint > out;
+   for( auto const& item : SplitList( list )) {
+      out.push_back( std::stoul( item ));
+   }
+   return out;
+}
+
+bool Contains( std::vector< dip::uint > const& list, dip::uint value ) {
+   return std::find( list.begin(), list.end(), value ) != list.end();
+}
+
+bool MatchesFilter( Options const& options, String const& name ) {
+   if( options.filters.empty() ) {
+      return true;
+   }
+   for( auto const& filter : options.filters ) {
+      if( name.find( filter ) != String::npos ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+String DefaultTempDir() {
+   for( char const* var : { "TMPDIR", "TEMP", "TMP" } ) {
+      char const* value = std::getenv( var );
+      if( value && *value ) {
+         return value;
+      }
+   }
+   return ".";
+}
+
+void PrintHelp() {
+   std::cout <<
+      "Usage: dip_benchmarks [options]\n"
+      "  --list                 List the benchmarks and exit\n"
+      "  --filter <a,b,...>     Run only benchmarks whose name contains one of these strings\n"
+      "  --sizes <a,b,...>      Image size classes to use: small, large (default: small,large)\n"
+      "  --dims <a,b,...>       Image dimensionalities to use: 2, 3 (default: 2,3)\n"
+      "  --types <a,b,...>      Data types to use, e.g. UINT8,SFLOAT (default: all)\n"
+      "  --threads <a,b,...>    Thread counts to use (default: 1 and the default maximum)\n"
+      "  --repetitions <n>      Minimum number of timed runs (default: 3)\n"
+      "  --min-time <seconds>   Minimum total time of the timed runs (default: 0.2)\n"
+      "  --output <file.json>   Write the results to a JSON file\n"
+      "  --compare <file.json>  Compare the minimum times to those in a JSON file written earlier\n"
+      "  --tolerance <fraction> Relative slow-down considered a regression (default: 0.1)\n"
+      "  --tmpdir <directory>   Directory for the files written by the I/O benchmarks\n";
+}
+
+// Returns false if the program should exit
+bool ParseOptions( int argc, char const* const* argv, Options& options ) {
+   for( int ii = 1; ii < argc; ++ii ) {
+      String arg = argv[ ii ];
+      if( arg == "--help" || arg == "-h" ) {
+         PrintHelp();
+         return false;
+      }
+      if( arg == "--list" ) {
+         options.list = true;
+         continue;
+      }
+      static std::vector< String > const valueOptions{ "--filter", "--sizes", "--dims", "--types", "--threads",
+                                                      "--repetitions", "--min-time", "--output", "--compare",
+                                                      "--tolerance", "--tmpdir" };
+      DIP_THROW_IF( std::find( valueOptions.begin(), valueOptions.end(), arg ) == valueOptions.end(),
+                    "Unknown option: " + arg );
+      DIP_THROW_IF( ii + 1 >= argc, "Option " + arg + " requires a value" );
+      String value = argv[ ++ii ];
+      if( arg == "--filter" ) {
+         options.filters = SplitList( value );
+      } else if( arg == "--sizes" ) {
+         options.sizeClasses = SplitList( value );
+         for( auto const& sizeClass : options.sizeClasses ) {
+            DIP_THROW_IF(( sizeClass != "small" ) && ( sizeClass != "large" ), "Unknown size class: " + sizeClass );
+         }
+      } else if( arg == "--dims" ) {
+         options.dims = SplitUnsignedList( value );
+      } else if( arg == "--types" ) {
+         options.dataTypes.clear();
+         for( auto const& name : SplitList( value )) {
+            options.dataTypes.emplace_back( name );
+         }
+      } else if( arg == "--threads" ) {
+         options.threads = SplitUnsignedList( value );
+      } else if( arg == "--repetitions" ) {
+         options.minRepetitions = std::max< dip::uint >( std::stoul( value ), 1 );
+      } else if( arg == "--min-time" ) {
+         options.minTime = std::stod( value );
+      } else if( arg == "--output" ) {
+         options.output = value;
+      } else if( arg == "--compare" ) {
+         options.compare = value;
+      } else if( arg == "--tolerance" ) {
+         options.tolerance = std::stod( value );
+         DIP_THROW_IF( options.tolerance < 0, "The tolerance must be non-negative" );
+      } else if( arg == "--tmpdir" ) {
+         options.tempDir = value;
+      }
+   }
+   return true;
+}
+
+// Reads the "id" and "min" fields of each benchmark in a JSON file written by `WriteJSON`.
+std::map< String, dfloat > ReadBaseline( String const& filename ) {
+   std::ifstream file( filename );
+   DIP_THROW_IF( !file, "Could not open file " + filename );
+   std::ostringstream contents;
+   contents << file.rdbuf();
+   String const text = contents.str();
+   std::map< String, dfloat > baseline;
+   String const idKey = "\"id\"";
+   String const minKey = "\"min\"";
+   auto pos = text.find( idKey );
+   while( pos != String::npos ) {
+      auto start = text.find( '"', text.find( ':', pos + idKey.size() ));
+      auto end = text.find( '"', start + 1 );
+      auto next = text.find( idKey, end );
+      auto min = text.find( minKey, end );
+      DIP_THROW_IF(( start == String::npos ) || ( end == String::npos ) || ( min == String::npos ) || ( min > next ),
+                   "Could not parse file " + filename );
+      auto colon = text.find( ':', min + minKey.size() );
+      baseline[ text.substr( start + 1, end - start - 1 ) ] = std::strtod( text.c_str() + colon + 1, nullptr );
+      pos = next;
+   }
+   return baseline;
+}
+
+void WriteJSON( String const& filename, std::vector< Result > const& results ) {
+   std::ofstream file( filename );
+   DIP_THROW_IF( !file, "Could not open file " + filename );
+   file << std::setprecision( 6 );
+   file << "{\n";
+   file << "  \"library\": \"" << dip::libraryInformation.name << "\",\n";
+   file << "  \"version\": \"" << dip::libraryInformation.version << "\",\n";
+   file << "  \"date\": \"" << dip::libraryInformation.date << "\",\n";
+   file << "  \"type\": \"" << dip::libraryInformation.type << "\",\n";
+   file << "  \"maxThreads\": " << dip::GetNumberOfThreads() << ",\n";
+   file << "  \"benchmarks\": [";
+   bool first = true;
+   for( auto const& result : results ) {
+      file << ( first ? "\n" : ",\n" );
+      first = false;
+      file << "    {\"id\": \"" << result.id << "\", \"name\": \"" << result.name << "\", \"sizes\": [";
+      for( dip::uint ii = 0; ii < result.sizes.size(); ++ii ) {
+         file << ( ii > 0 ? ", " : "" ) << result.sizes[ ii ];
+      }
+      file << "], \"dataType\": \"" << result.dataType.Name() << "\", \"threads\": " << result.threads
+           << ", \"runs\": " << result.runs << ", \"min\": " << result.min << ", \"median\": " << result.median
+           << ", \"mean\": " << result.mean;
+      if( result.baseline > 0 ) {
+         file << ", \"baseline\": " << result.baseline << ", \"ratio\": " << result.min / result.baseline;
+      }
+      file << "}";
+   }
+   file << "\n  ]\n}\n";
+}
+
+Result Time( Benchmark const& benchmark, Fixture const& fixture, Options const& options ) {
+   Image out;
+   benchmark.run( fixture, out ); // warm-up run, also initializes caches such as FFT plans
+   std::vector< dfloat > times;
+   dfloat total = 0;
+   while(( times.size() < options.minRepetitions ) || (( total < options.minTime ) && ( times.size() < 1000 ))) {
+      out.Strip();
+      dip::testing::Timer timer;
+      benchmark.run( fixture, out );
+      timer.Stop();
+      times.push_back( timer.GetWall() );
+      total += times.back();
+   }
+   std::sort( times.begin(), times.end() );
+   Result result;
+   result.runs = times.size();
+   result.min = times.front();
+   result.median = ( times.size() % 2 ) ? times[ times.size() / 2 ]
+                                        : ( times[ times.size() / 2 - 1 ] + times[ times.size() / 2 ] ) / 2;
+   result.mean = total / static_cast< dfloat >( times.size() );
+   return result;
+}
+
+int Run( Options const& options ) {
+   std::vector< dip::uint > threads = options.threads;
+   dip::uint defaultThreads = dip::GetNumberOfThreads();
+   if( threads.empty() ) {
+      threads.push_back( 1 );
+      if( defaultThreads > 1 ) {
+         threads.push_back( defaultThreads );
+      }
+   }
+   std::map< String, dfloat > baseline;
+   if( !options.compare.empty() ) {
+      baseline = ReadBaseline( options.compare );
+   }
+   String tempDir = options.tempDir.empty() ? DefaultTempDir() : options.tempDir;
+
+   std::vector< Result > results;
+   dip::uint regressions = 0;
+   if( !options.list ) {
+      std::cout << std::left << std::setw( 56 ) << "benchmark" << std::right << std::setw( 6 ) << "runs"
+                << std::setw( 12 ) << "min (ms)" << std::setw( 12 ) << "median (ms)";
+      if( !baseline.empty() ) {
+         std::cout << std::setw( 14 ) << "base min (ms)" << std::setw( 8 ) << "ratio";
+      }
+      std::cout << std::endl;
+   }
+
+   for( auto const& benchmark : Benchmarks() ) {
+      if( !MatchesFilter( options, benchmark.name )) {
+         continue;
+      }
+      if( benchmark.available && !benchmark.available() ) {
+         std::cout << benchmark.name << ": skipped, not available in this build\n";
+         continue;
+      }
+      for( dip::uint nDims : benchmark.dims ) {
+         if( !Contains( options.dims, nDims )) {
+            continue;
+         }
+         for( auto const& sizeClass : options.sizeClasses ) {
+            dip::UnsignedArray sizes = ImageSizes( nDims, sizeClass );
+            for( auto dataType : benchmark.dataTypes ) {
+               if( !options.dataTypes.empty() &&
+                   ( std::find( options.dataTypes.begin(), options.dataTypes.end(), dataType ) == options.dataTypes.end() )) {
+                  continue;
+               }
+               String id = String( benchmark.name ) + "/" + SizesString( sizes ) + "/" + dataType.Name();
+               if( options.list ) {
+                  std::cout << id << '\n';
+                  continue;
+               }
+               Fixture fixture;
+               try {
+                  fixture = MakeFixture( benchmark, sizes, dataType, tempDir );
+               } catch( dip::Error const& e ) {
+                  std::cout << id << ": skipped, " << e.Message() << '\n';
+                  continue;
+               }
+               for( dip::uint nThreads : threads ) {
+                  dip::SetNumberOfThreads( nThreads );
+                  Result result = Time( benchmark, fixture, options );
+                  result.id = id + "/" + std::to_string( nThreads ) + "t";
+                  result.name = benchmark.name;
+                  result.sizes = sizes;
+                  result.dataType = dataType;
+                  result.threads = nThreads;
+                  std::cout << std::left << std::setw( 56 ) << result.id << std::right << std::setw( 6 ) << result.runs
+                            << std::fixed << std::setprecision( 3 )
+                            << std::setw( 12 ) << result.min * 1e3 << std::setw( 12 ) << result.median * 1e3;
+                  auto it = baseline.find( result.id );
+                  if( it != baseline.end() && it->second > 0 ) {
+                     result.baseline = it->second;
+                     dfloat ratio = result.min / result.baseline;
+                     std::cout << std::setw( 14 ) << result.baseline * 1e3 << std::setw( 8 ) << std::setprecision( 2 ) << ratio;
+                     if( ratio > 1.0 + options.tolerance ) {
+                        std::cout << "  REGRESSION";
+                        ++regressions;
+                     } else if( ratio < 1.0 / ( 1.0 + options.tolerance )) {
+                        std::cout << "  improvement";
+                     }
+                  }
+                  std::cout << std::defaultfloat << std::endl;
+                  results.push_back( std::move( result ));
+               }
+               if( !fixture.filename.empty() ) {
+                  std::remove( fixture.filename.c_str() );
+               }
+            }
+         }
+      }
+   }
+   dip::SetNumberOfThreads( defaultThreads );
+
+   if( !options.output.empty() ) {
+      WriteJSON( options.output, results );
+   }
+   if( regressions > 0 ) {
+      std::cout << regressions << " benchmark(s) are more than " << options.tolerance * 100
+                << "% slower than the baseline\n";
+      return 1;
+   }
+   return 0;
+}
+
+} // namespace
+
+int main( int argc, char const* const* argv ) {
+   try {
+      Options options;
+      if( !ParseOptions( argc, argv, options )) {
+         return 0;
+      }
+      return Run( options );
+   } catch( dip::Error const& e ) {
+      std::cerr << "Error: " << e.Message() << std::endl;
+      return 2;
+   } catch( std::exception const& e ) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return 2;
+   }
+}
+
+#endif // DIP_IMPLEMENT_BENCHMARKS
@@ -17,7 +17,9 @@
 
 #include "diplib/library/copy_buffer.h"
 
+#include <algorithm>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 #include "diplib.h"
@@ -41,6 +43,30 @@ inline void cast_copy( ConstSampleIterator< inT > in, ConstSampleIterator< inT >
    }
 }
 
+// Casting from floating-point to an integer type smaller than 32 bits
+template< class inT, class outT >
+struct IsNarrowingToSmallInteger {
+   static constexpr bool value = std::is_floating_point< inT >::value && std::is_integral< outT >::value && ( sizeof( outT ) < 4 );
+};
+
+// Contiguous version of the above, this one the compiler can vectorize
+template< class inT, class outT, std::enable_if_t< !IsNarrowingToSmallInteger< inT, outT >::value, int > = 0 >
+inline void cast_copy( inT const* in, inT const* end, outT* out ) {
+   for( ; in != end; ++in, ++out ) {
+      *out = clamp_cast< outT >( *in );
+   }
+}
+
+// Same as `clamp_cast`, but converting through `sint32`, for which there exist vector instructions
+template< class inT, class outT, std::enable_if_t< IsNarrowingToSmallInteger< inT, outT >::value, int > = 0 >
+inline void cast_copy( inT const* in, inT const* end, outT* out ) {
+   constexpr inT lowest = static_cast< inT >( std::numeric_limits< outT >::lowest() );
+   constexpr inT max = static_cast< inT >( std::numeric_limits< outT >::max() );
+   for( ; in != end; ++in, ++out ) {
+      *out = static_cast< outT >( static_cast< sint32 >( std::min( std::max( *in, lowest ), max )));
+   }
+}
+
 template< typename inT, typename outT >
 inline void CopyBufferFromTo(
       inT const* inBuffer,
@@ -58,15 +84,24 @@ inline void CopyBufferFromTo(
       if( inStride == 0 ) {
          //std::cout << "CopyBufferFromTo<inT,outT>, mode 1\n";
          FillBufferFromTo( outBuffer, outStride, 1, pixels, 1, clamp_cast< outT >( *inBuffer ) );
+      } else if(( inStride == 1 ) && ( outStride == 1 )) {
+         //std::cout << "CopyBufferFromTo<inT,outT>, mode 2a\n";
+         cast_copy( inBuffer, inBuffer + pixels, outBuffer );
       } else {
-         //std::cout << "CopyBufferFromTo<inT,outT>, mode 2\n";
+         //std::cout << "CopyBufferFromTo<inT,outT>, mode 2b\n";
          auto inIt = ConstSampleIterator< inT >( inBuffer, inStride );
          auto outIt = SampleIterator< outT >( outBuffer, outStride );
          cast_copy( inIt, inIt + pixels, outIt );
       }
    } else if( lookUpTable.empty() ) {
-      // TODO: tensorElements * {in|out}TensorStride == {in|out}Stride -> do a single loop. Is that worth it?
-      if( inStride == 0 ) {
+      dip::sint sTensorElements = static_cast< dip::sint >( tensorElements );
+      dip::sint sPixels = static_cast< dip::sint >( pixels );
+      if((( inTensorStride == 1 ) && ( outTensorStride == 1 ) && ( inStride == sTensorElements ) && ( outStride == sTensorElements )) ||
+         (( inStride == 1 ) && ( outStride == 1 ) && ( inTensorStride == sPixels ) && ( outTensorStride == sPixels ))) {
+         //std::cout << "CopyBufferFromTo<inT,outT>, mode 3a\n";
+         // Both buffers are contiguous and have the same layout
+         cast_copy( inBuffer, inBuffer + pixels * tensorElements, outBuffer );
+      } else if( inStride == 0 ) {
          if( inTensorStride == 0 ) {
             //std::cout << "CopyBufferFromTo<inT,outT>, mode 3\n";
             FillBufferFromTo( outBuffer, outStride, outTensorStride, pixels, tensorElements, clamp_cast< outT >( *inBuffer ) );
@@ -1253,6 +1288,68 @@ DOCTEST_TEST_CASE("[DIPlib] testing the CopyBuffer function") {
       error |= output[ ii * 5 + 3 ] != kk++;
    }
    DOCTEST_CHECK_FALSE( error );
+
+   std::fill( output.begin(), output.end(), 101 );
+   dip::detail::CopyBuffer( // mode 2a
+         input.data(), dip::DT_UINT8, 1, 1,
+         output.data(), dip::DT_SINT8, 1, 1,
+         20, 1 );
+   error = false;
+   kk = 0;
+   for( dip::uint ii = 0; ii < 20; ++ii ) {
+      error |= output[ ii ] != kk++;
+   }
+   error |= output[ 20 ] != 101;
+   DOCTEST_CHECK_FALSE( error );
+
+   std::fill( output.begin(), output.end(), 101 );
+   dip::detail::CopyBuffer( // mode 3a, interleaved
+         input.data(), dip::DT_UINT8, 5, 1,
+         output.data(), dip::DT_SINT8, 5, 1,
+         20, 5 );
+   error = false;
+   kk = 0;
+   for( dip::uint ii = 0; ii < 100; ++ii ) {
+      error |= output[ ii ] != kk++;
+   }
+   error |= output[ 100 ] != 101;
+   DOCTEST_CHECK_FALSE( error );
+
+   std::fill( output.begin(), output.end(), 101 );
+   dip::detail::CopyBuffer( // mode 3a, planar
+         input.data(), dip::DT_UINT8, 1, 20,
+         output.data(), dip::DT_SINT8, 1, 20,
+         20, 5 );
+   error = false;
+   kk = 0;
+   for( dip::uint ii = 0; ii < 100; ++ii ) {
+      error |= output[ ii ] != kk++;
+   }
+   error |= output[ 100 ] != 101;
+   DOCTEST_CHECK_FALSE( error );
+
+   // 3- Saturated conversion from floating-point to small integer types
+
+   std::vector< dip::sfloat > floatInput{ -3.7f, 0.4f, 254.6f, 300.0f, 1e10f, -1e10f, 40000.0f, -40000.0f };
+   std::vector< dip::uint8 > uint8Output( floatInput.size() );
+   dip::detail::CopyBuffer(
+         floatInput.data(), dip::DT_SFLOAT, 1, 1,
+         uint8Output.data(), dip::DT_UINT8, 1, 1,
+         floatInput.size(), 1 );
+   DOCTEST_CHECK( uint8Output == std::vector< dip::uint8 >{ 0, 0, 254, 255, 255, 0, 255, 0 } );
+   std::vector< dip::sint16 > sint16Output( floatInput.size() );
+   dip::detail::CopyBuffer(
+         floatInput.data(), dip::DT_SFLOAT, 1, 1,
+         sint16Output.data(), dip::DT_SINT16, 1, 1,
+         floatInput.size(), 1 );
+   DOCTEST_CHECK( sint16Output == std::vector< dip::sint16 >{ -3, 0, 254, 300, 32767, -32768, 32767, -32768 } );
+   std::vector< dip::dfloat > doubleInput( floatInput.begin(), floatInput.end() );
+   std::vector< dip::uint16 > uint16Output( doubleInput.size() );
+   dip::detail::CopyBuffer(
+         doubleInput.data(), dip::DT_DFLOAT, 1, 1,
+         uint16Output.data(), dip::DT_UINT16, 1, 1,
+         doubleInput.size(), 1 );
+   DOCTEST_CHECK( uint16Output == std::vector< dip::uint16 >{ 0, 0, 254, 300, 65535, 0, 40000, 0 } );
 }
 
 #endif // DIP_CONFIG_ENABLE_DOCTEST
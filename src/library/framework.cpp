@@ -17,6 +17,8 @@
 
 #include "diplib/framework.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <vector>
 
@@ -187,5 +189,94 @@ std::vector< UnsignedArray >  SplitImageEvenlyForProcessing(
    return startCoords;
 }
 
+namespace {
+
+constexpr dip::uint maxPooledBuffers = 8;                  // number of buffers kept per thread
+constexpr dip::uint maxPooledBufferSize = 4 * 1024 * 1024; // larger buffers are freed, not pooled
+
+thread_local std::vector< AlignedBuffer > bufferPool;
+std::atomic< dip::uint > bufferAllocations{ 0 };
+std::atomic< dip::uint > bufferReuses{ 0 };
+
+} // namespace
+
+void PooledBuffer::resize( dip::uint size ) {
+   if( buffer_.size() >= size ) {
+      return;
+   }
+   Release();
+   // Find the smallest buffer in the pool that is large enough
+   auto best = bufferPool.end();
+   for( auto it = bufferPool.begin(); it != bufferPool.end(); ++it ) {
+      if(( it->size() >= size ) && (( best == bufferPool.end() ) || ( it->size() < best->size() ))) {
+         best = it;
+      }
+   }
+   if( best != bufferPool.end() ) {
+      buffer_.swap( *best );
+      bufferPool.erase( best );
+      ++bufferReuses;
+   } else {
+      buffer_.resize( size );
+      ++bufferAllocations;
+   }
+}
+
+void PooledBuffer::Release() noexcept {
+   if( buffer_.empty() || ( buffer_.size() > maxPooledBufferSize )) {
+      buffer_.clear();
+      return;
+   }
+   try {
+      if( bufferPool.size() >= maxPooledBuffers ) {
+         // Drop the smallest buffer to make space
+         auto smallest = std::min_element( bufferPool.begin(), bufferPool.end(), []( AlignedBuffer const& a, AlignedBuffer const& b ) {
+            return a.size() < b.size();
+         } );
+         if( smallest->size() >= buffer_.size() ) {
+            buffer_.clear();
+            return;
+         }
+         bufferPool.erase( smallest );
+      }
+      bufferPool.push_back( std::move( buffer_ ));
+   } catch( ... ) {
+      // Allocation failure in `push_back`: just free the buffer
+   }
+   buffer_.clear();
+}
+
+BufferPoolStatistics GetBufferPoolStatistics() {
+   BufferPoolStatistics out;
+   out.allocations = bufferAllocations.load();
+   out.reuses = bufferReuses.load();
+   return out;
+}
+
 } // namespace Framework
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the framework buffer pool") {
+   dip::uint8* ptr{};
+   {
+      dip::Framework::PooledBuffer buffer( 1000 );
+      ptr = buffer.data();
+   }
+   auto stats = dip::Framework::GetBufferPoolStatistics();
+   {
+      dip::Framework::PooledBuffer buffer( 800 ); // reuses the buffer allocated above
+      DOCTEST_CHECK( buffer.data() == ptr );
+      dip::Framework::PooledBuffer other( 800 ); // needs a different buffer, maybe one left in the pool by earlier tests
+      DOCTEST_CHECK( other.data() != ptr );
+      buffer.resize( 500 ); // no need to re-allocate
+      DOCTEST_CHECK( buffer.data() == ptr );
+   }
+   auto newStats = dip::Framework::GetBufferPoolStatistics();
+   DOCTEST_CHECK( newStats.reuses >= stats.reuses + 1 );
+   DOCTEST_CHECK( newStats.reuses + newStats.allocations == stats.reuses + stats.allocations + 2 ); // the resize is not counted
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -18,6 +18,7 @@
 #include "diplib/framework.h"
 
 #include <algorithm>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -47,6 +48,8 @@ void Full(
       FullOptions opts
 ) {
    DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   FrameworkProfiler profiler( "dip::Framework::Full", typeid( lineFilter ));
+   profiler.AddInput( c_in, inBufferType );
    UnsignedArray sizes = c_in.Sizes();
 
    // Check inputs
@@ -111,10 +114,13 @@ void Full(
       }
    DIP_END_STACK_TRACE
    Image output = c_out.QuickCopy();
+   profiler.AddOutput( output, outBufferType );
 
    // Copy input if necessary (this is the input buffer!)
    // If we do copy the input, we'll adjust its strides to match those of output.
    Image input;
+   LineTimer inputTimer( profiler.IsActive() );
+   inputTimer.Start();
    if( adjustInput ) {
       input.SetDataType( inBufferType );
       if( expandTensor ) {
@@ -146,6 +152,9 @@ void Full(
    } else {
       input = cc_in.QuickCopy();
    }
+   inputTimer.Conversion();
+   profiler.AddTimes( inputTimer );
+   profiler.AddBytes( cc_in );
    cc_in.Strip(); // we don't need to keep that around any more
 
    // Create a pixel table suitable to be applied to `input`
@@ -172,20 +181,21 @@ void Full(
    dip::uint nThreads = 1;
    if( !opts.Contains( FullOption::NoMultiThreading )) {
       nThreads = std::min( GetNumberOfThreads(), nLines );
-      if( nThreads > 1 ) {
+      if(( nThreads > 1 ) || profiler.IsActive() ) {
          DIP_START_STACK_TRACE
          dip::uint operations = nLines *
                lineFilter.GetNumberOfOperations( lineLength, input.TensorElements(), pixelTableOffsets.NumberOfPixels(), pixelTableOffsets.Runs().size() );
-         // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-         if( operations < threadingThreshold ) {
-            nThreads = 1;
-         }
+         // Starting threads is only worth while if the work to do compensates for the cost of starting them
+         nThreads = ChooseNumberOfThreads( operations, nThreads, typeid( lineFilter ).name() );
+         profiler.SetOperations( operations );
          DIP_END_STACK_TRACE
       }
    }
    dip::uint nLinesPerThread = div_ceil( nLines, nThreads );
    nThreads = std::min( div_ceil( nLines, nLinesPerThread ), nThreads );
    std::vector< UnsignedArray > startCoords;
+   profiler.AddBytes( output );
+   profiler.AddLines( nLines );
 
    // Start threads, each thread makes its own buffers
    DIP_PARALLEL_ERROR_DECLARE
@@ -211,7 +221,7 @@ void Full(
       inBuffer.buffer = nullptr;
 
       // Create output buffer data struct and allocate buffer if necessary
-      AlignedBuffer outputBuffer;
+      PooledBuffer outputBuffer;
       FullBuffer outBuffer{};
       outBuffer.tensorLength = output.TensorElements();
       if( useOutBuffer ) {
@@ -231,6 +241,8 @@ void Full(
       FullLineFilterParameters fullLineFilterParameters{
             inBuffer, outBuffer, lineLength, processingDim, it.Coordinates(), pixelTableOffsets, thread
       }; // Takes inBuffer, outBuffer, it.Coordinates(), pixelTableOffsets as references
+      LineTimer timer( profiler.IsActive() );
+      timer.Start();
       for( dip::uint ii = 0; ( ii < nLinesPerThread ) && it; ++ii, ++it ) {
          inBuffer.buffer = it.InPointer();
          if( !useOutBuffer ) {
@@ -239,6 +251,7 @@ void Full(
          }
          // Filter the line
          lineFilter.Filter( fullLineFilterParameters );
+         timer.Filter();
          if( useOutBuffer ) {
             // Copy output buffer to output image
             detail::CopyBuffer(
@@ -253,8 +266,11 @@ void Full(
                   lineLength,
                   outBuffer.tensorLength );
          }
+         timer.Conversion();
       }
+      profiler.AddTimes( timer );
    DIP_PARALLEL_ERROR_END
+   profiler.SetThreads( nThreads );
 }
 
 } // namespace Framework
@@ -18,6 +18,7 @@
 #include "diplib/framework.h"
 
 #include <algorithm>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -39,6 +40,9 @@ void Projection(
       ProjectionOptions opts
 ) {
    DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   FrameworkProfiler profiler( "dip::Framework::Projection", typeid( projectionFunction ));
+   profiler.AddInput( c_in, c_in.DataType() );
+   profiler.AddBytes( c_in );
    UnsignedArray inSizes = c_in.Sizes();
    dip::uint nDims = inSizes.size();
 
@@ -70,6 +74,7 @@ void Projection(
          mask.ExpandSingletonTensor( input.TensorElements() ); // We've checked that it has a single tensor element
       DIP_END_STACK_TRACE
       hasMask = true;
+      profiler.AddBytes( mask );
    }
 
    // Determine output sizes
@@ -101,6 +106,8 @@ void Projection(
    out.SetPixelSize( std::move( pixelSize ));
    out.SetColorSpace( std::move( colorSpace ));
    Image output = out.QuickCopy();
+   profiler.AddOutput( output, outImageType );
+   profiler.AddBytes( output );
    // output.Fill( 42 ); // for debugging, to see if all output samples get written to
 
    // Do tensor to spatial dimension if necessary
@@ -194,19 +201,19 @@ void Projection(
    dip::uint nLoop = output.NumberOfPixels();
    if( !opts.Contains( ProjectionOption::NoMultiThreading )) {
       nThreads = std::min( GetNumberOfThreads(), nLoop );
-      if( nThreads > 1 ) {
+      if(( nThreads > 1 ) || profiler.IsActive() ) {
          DIP_START_STACK_TRACE
          dip::uint operations = nLoop * projectionFunction.GetNumberOfOperations( tempIn.NumberOfPixels() );
-         // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-         if( operations < threadingThreshold ) {
-            nThreads = 1;
-         }
+         // Starting threads is only worth while if the work to do compensates for the cost of starting them
+         nThreads = ChooseNumberOfThreads( operations, nThreads, typeid( projectionFunction ).name() );
+         profiler.SetOperations( operations );
          DIP_END_STACK_TRACE
       }
    }
    dip::uint nLoopPerThread = div_ceil( nLoop, nThreads );
    nThreads = std::min( div_ceil( nLoop, nLoopPerThread ), nThreads );
    std::vector< UnsignedArray > startCoords;
+   profiler.AddLines( nLoop );
 
    // Start threads
    DIP_PARALLEL_ERROR_DECLARE
@@ -232,6 +239,8 @@ void Projection(
          localTempMask.ShiftOriginUnsafe( Image::Offset( startPosition, maskStride ));
       }
       dip::uint8* localOutputPointer = outputPointer + Image::Offset( startPosition, outStride );
+      LineTimer timer( profiler.IsActive() );
+      timer.Start();
 
       // Iterate over the pixels in the output image. For each, we create a view in the input image.
       for( dip::uint ii = 0; ii < nLoopPerThread; ++ii ) {
@@ -272,7 +281,10 @@ void Projection(
             break;            // We're done!
          }
       }
+      timer.Filter();
+      profiler.AddTimes( timer );
    DIP_PARALLEL_ERROR_END
+   profiler.SetThreads( nThreads );
 }
 
 } // namespace Framework
@@ -18,6 +18,7 @@
 #include "diplib/framework.h"
 
 #include <algorithm>
+#include <typeinfo>
 #include <vector>
 
 #include "diplib.h"
@@ -74,6 +75,7 @@ void Scan(
       // Duh!
       return;
    }
+   FrameworkProfiler profiler( "dip::Framework::Scan", typeid( lineFilter ));
 
    // Check array sizes
    DIP_THROW_IF(( inBufferTypes.size()  != nIn )  ||
@@ -97,6 +99,7 @@ void Scan(
       if( !pixelSize.IsDefined() && tmp.HasPixelSize() ) {
          pixelSize = tmp.PixelSize();
       }
+      profiler.AddInput( tmp, inBufferTypes[ ii ] );
    }
 
    // Will we convert tensor to spatial dimension?
@@ -208,6 +211,19 @@ void Scan(
       }
    }
 
+   // If all non-scalar inputs have a planar layout, we give the new outputs that same layout. This avoids
+   // interleaving data that the next operation in a pipeline would then need to access one plane at the time.
+   bool planarOutput = false;
+   for( dip::uint ii = 0; ii < nIn; ++ii ) {
+      if( !in[ ii ].IsScalar() ) {
+         if( !in[ ii ].HasPlanarStrides() ) {
+            planarOutput = false;
+            break;
+         }
+         planarOutput = true;
+      }
+   }
+
    // Adjust output if necessary (and possible)
    DIP_START_STACK_TRACE
    for( dip::uint ii = 0; ii < nOut; ++ii ) {
@@ -222,7 +238,18 @@ void Scan(
       if( tmp.IsForged() && tmp.IsOverlappingView( in )) {
          tmp.Strip();
       }
-      tmp.ReForge( sizes, nTensor, outImageTypes[ ii ], Option::AcceptDataTypeChange::DO_ALLOW );
+      if( planarOutput && ( nTensor > 1 ) && !tmp.IsProtected() &&
+          !( tmp.IsForged() && ( tmp.Sizes() == sizes ) && ( tmp.TensorElements() == nTensor ) && ( tmp.DataType() == outImageTypes[ ii ] ))) {
+         tmp.Strip();
+         tmp.SetSizes( sizes );
+         tmp.SetTensorSizes( nTensor );
+         tmp.SetDataType( outImageTypes[ ii ] );
+         tmp.SetPlanarStrides();
+         tmp.Forge();
+      } else {
+         tmp.ReForge( sizes, nTensor, outImageTypes[ ii ], Option::AcceptDataTypeChange::DO_ALLOW );
+      }
+      profiler.AddOutput( tmp, outBufferTypes[ ii ] );
    }
    DIP_END_STACK_TRACE
 
@@ -364,13 +391,12 @@ void Scan(
       // Determine the number of threads we'll be using
       if( !opts.Contains( ScanOption::NoMultiThreading )) {
          nThreads = GetNumberOfThreads();
-         if( nThreads > 1 ) {
+         if(( nThreads > 1 ) || profiler.IsActive() ) {
             DIP_START_STACK_TRACE
             dip::uint operations = lineLength * lineFilter.GetNumberOfOperations( nIn, nOut, ( nIn > 0 ? in[ 0 ] : out[ 0 ] ).TensorElements() );
-            // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-            if( operations < threadingThreshold ) {
-               nThreads = 1;
-            }
+            // Starting threads is only worth while if the work to do compensates for the cost of starting them
+            nThreads = ChooseNumberOfThreads( operations, nThreads, typeid( lineFilter ).name() );
+            profiler.SetOperations( operations );
             DIP_END_STACK_TRACE
          }
       }
@@ -405,13 +431,12 @@ void Scan(
       // Determine the number of threads we'll be using
       if( !opts.Contains( ScanOption::NoMultiThreading )) {
          nThreads = std::min( GetNumberOfThreads(), nLines );
-         if( nThreads > 1 ) {
+         if(( nThreads > 1 ) || profiler.IsActive() ) {
             DIP_START_STACK_TRACE
             dip::uint operations = nLines * lineLength * lineFilter.GetNumberOfOperations( nIn, nOut, ( nIn > 0 ? in[ 0 ] : out[ 0 ] ).TensorElements() );
-            // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-            if( operations < threadingThreshold ) {
-               nThreads = 1;
-            }
+            // Starting threads is only worth while if the work to do compensates for the cost of starting them
+            nThreads = ChooseNumberOfThreads( operations, nThreads, typeid( lineFilter ).name() );
+            profiler.SetOperations( operations );
             DIP_END_STACK_TRACE
          }
       }
@@ -425,6 +450,15 @@ void Scan(
       nThreads = std::min( div_ceil( nLines, nLinesPerThread ), nThreads);
    }
    std::vector< UnsignedArray > startCoords;
+   if( profiler.IsActive() ) {
+      for( dip::uint ii = 0; ii < nIn; ++ii ) {
+         profiler.AddBytes( in[ ii ] );
+      }
+      for( dip::uint ii = 0; ii < nOut; ++ii ) {
+         profiler.AddBytes( out[ ii ] );
+      }
+      profiler.AddLines( nLines );
+   }
 
    // Start threads, each thread makes its own buffers
    DIP_PARALLEL_ERROR_DECLARE
@@ -450,7 +484,7 @@ void Scan(
       #pragma omp barrier
 
       dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
-      std::vector< AlignedBuffer > buffers; // The outer one here is not a DimensionArray, because it won't delete() its contents
+      std::vector< PooledBuffer > buffers; // The outer one here is not a DimensionArray, because it won't delete() its contents
 
       // Create input buffer data structs and allocate buffers
       std::vector< ScanBuffer > inBuffers( nIn );  // We don't use DimensionArray here either, but we could
@@ -534,6 +568,8 @@ void Scan(
          lastCoord = position[ 0 ] + lineLength;
          lastCoord = std::min( lastCoord, sizes[ 0 ] );
       }
+      LineTimer timer( profiler.IsActive() );
+      timer.Start();
 
       // Loop over nLinesPerThread image lines
       for( dip::uint jj = 0; jj < nLinesPerThread ; ++jj ) {
@@ -573,9 +609,11 @@ void Scan(
                outBuffers[ ii ].buffer = out[ ii ].Pointer( outOffsets[ ii ] );
             }
          }
+         timer.Conversion();
 
          // Filter the line
          lineFilter.Filter( scanLineFilterParams );
+         timer.Filter();
 
          // Copy back the line from output buffer to the image
          for( dip::uint ii = 0; ii < nOut; ++ii ) {
@@ -634,7 +672,10 @@ void Scan(
             }
          }
       }
+      timer.Conversion();
+      profiler.AddTimes( timer );
    DIP_PARALLEL_ERROR_END
+   profiler.SetThreads( nThreads );
 
    // Correct output image properties
    for( dip::uint ii = 0; ii < nOut; ++ii ) {
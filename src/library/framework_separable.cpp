@@ -18,6 +18,7 @@
 #include "diplib/framework.h"
 
 #include <algorithm>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -44,6 +45,8 @@ void Separable(
       SeparableOptions opts
 ) {
    DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   FrameworkProfiler profiler( "dip::Framework::Separable", typeid( lineFilter ));
+   profiler.AddInput( c_in, bufferType );
    UnsignedArray inSizes = c_in.Sizes();
    dip::uint nDims = inSizes.size();
 
@@ -133,6 +136,7 @@ void Separable(
 
    // Make simplified copies of output image headers so we can modify them at will
    Image output = c_out.QuickCopy();
+   profiler.AddOutput( output, bufferType );
 
    // Do tensor to spatial dimension if necessary
    if( tensorToSpatial ) {
@@ -207,7 +211,7 @@ void Separable(
 
    // Determine the number of threads we'll be using
    dip::uint nThreads = 1;
-   if( !opts.Contains( SeparableOption::NoMultiThreading ) && ( GetNumberOfThreads() > 1 )) {
+   if( !opts.Contains( SeparableOption::NoMultiThreading ) && (( GetNumberOfThreads() > 1 ) || profiler.IsActive() )) {
       dip::uint operations = 0;
       dip::uint maxNLines = 0;
       UnsignedArray sizes = input.Sizes();
@@ -221,12 +225,11 @@ void Separable(
          }
          //std::cout << "lineLength = " << lineLength << ", nLines = " << nLines << ", operations = " << operations << std::endl;
       }
-      // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
+      // Starting threads is only worth while if the work to do compensates for the cost of starting them
       //std::cout << "GetNumberOfThreads() = " << GetNumberOfThreads() << ", maxNLines = " << maxNLines << ", operations = " << operations << std::endl;
-      if( operations >= threadingThreshold ) {
-         // We can't do more threads than the max, and we can't do more threads than lines we have to process
-         nThreads = std::min( GetNumberOfThreads(), maxNLines );
-      }
+      // We can't do more threads than the max, and we can't do more threads than lines we have to process
+      nThreads = ChooseNumberOfThreads( operations, std::min( GetNumberOfThreads(), maxNLines ), typeid( lineFilter ).name() );
+      profiler.SetOperations( operations );
       // Note that we pick the number of threads according to the dimension where most threads can be used.
       // It is possible that one dimension has fewer image lines than threads we're starting. We need to deal
       // with this below.
@@ -253,8 +256,9 @@ void Separable(
       dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
 
       // The temporary buffers, if needed, will be stored here (each thread their own!)
-      AlignedBuffer inBufferStorage;
-      AlignedBuffer outBufferStorage;
+      PooledBuffer inBufferStorage;
+      PooledBuffer outBufferStorage;
+      LineTimer timer( profiler.IsActive() );
 
       // Iterate over the dimensions to be processed. This loop should not parallelized!
       for( dip::uint rep = 0; rep < order.size(); ++rep ) {
@@ -284,6 +288,9 @@ void Separable(
             DIP_ASSERT( nLinesPerThread == div_ceil( outImage.NumberOfPixels() / outSizes[ processingDim ], nThreads ));
             dThreads = std::min( div_ceil( inImage.NumberOfPixels() / inSizes[ processingDim ], nLinesPerThread ), nThreads );
             startCoords = SplitImageEvenlyForProcessing( sizes, dThreads, nLinesPerThread, processingDim );
+            profiler.AddBytes( inImage );
+            profiler.AddBytes( outImage );
+            profiler.AddLines( inImage.NumberOfPixels() / inSizes[ processingDim ] );
          }
          #pragma omp barrier
 
@@ -351,6 +358,7 @@ void Separable(
             SeparableLineFilterParameters separableLineFilterParams{
                   inBuffer, outBuffer, processingDim, rep, order.size(), it.Coordinates(), tensorToSpatial, thread
             }; // Takes inBuffer, outBuffer, it.Coordinates() as references
+            timer.Start();
             for( dip::uint ii = 0; ( ii < nLinesPerThread ) && it; ++ii, ++it ) {
                // Get pointers to input and output lines
                if( inUseBuffer ) {
@@ -384,9 +392,11 @@ void Separable(
                if( !outUseBuffer ) {
                   outBuffer.buffer = it.OutPointer();
                }
+               timer.Conversion();
 
                // Filter the line
                lineFilter.Filter( separableLineFilterParams );
+               timer.Filter();
 
                // Copy back the line from output buffer to the image
                if( outUseBuffer ) {
@@ -417,6 +427,7 @@ void Separable(
                   }
                }
             }
+            timer.Conversion();
          }
 
          // Wait to start the next iteration until all threads have finished their work
@@ -427,7 +438,9 @@ void Separable(
          #pragma omp master
          lookUpTable.clear();
       }
+      profiler.AddTimes( timer );
    DIP_PARALLEL_ERROR_END
+   profiler.SetThreads( nThreads );
 }
 
 
@@ -444,6 +457,8 @@ void OneDimensionalLineFilter(
       SeparableOptions opts
 ) {
    DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   FrameworkProfiler profiler( "dip::Framework::OneDimensionalLineFilter", typeid( lineFilter ));
+   profiler.AddInput( c_in, inBufferType );
    UnsignedArray inSizes = c_in.Sizes();
    dip::uint nDims = inSizes.size();
 
@@ -516,6 +531,7 @@ void OneDimensionalLineFilter(
 
    // Make simplified copies of output image headers so we can modify them at will
    Image output = c_out.QuickCopy();
+   profiler.AddOutput( output, outBufferType );
 
    // Do tensor to spatial dimension if necessary
    if( tensorToSpatial ) {
@@ -525,7 +541,7 @@ void OneDimensionalLineFilter(
 
    // Determine the number of threads we'll be using
    dip::uint nThreads = 1;
-   if( !opts.Contains( SeparableOption::NoMultiThreading ) && ( GetNumberOfThreads() > 1 )) {
+   if( !opts.Contains( SeparableOption::NoMultiThreading ) && (( GetNumberOfThreads() > 1 ) || profiler.IsActive() )) {
       dip::uint operations = 0;
       dip::uint lineLength = outSizes[ processingDim ];
       dip::uint nLines = inSizes.product() / inSizes[ processingDim ];
@@ -533,11 +549,10 @@ void OneDimensionalLineFilter(
          DIP_STACK_TRACE_THIS( operations = nLines *
                                             lineFilter.GetNumberOfOperations( lineLength, input.TensorElements(), border, processingDim ));
       }
-      // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
-      if( operations >= threadingThreshold ) {
-         // We can't do more threads than the max, and we can't do more threads than lines we have to process
-         nThreads = std::min( GetNumberOfThreads(), nLines );
-      }
+      // Starting threads is only worth while if the work to do compensates for the cost of starting them
+      // We can't do more threads than the max, and we can't do more threads than lines we have to process
+      nThreads = ChooseNumberOfThreads( operations, std::min( GetNumberOfThreads(), nLines ), typeid( lineFilter ).name() );
+      profiler.SetOperations( operations );
    }
    dip::uint nLinesPerThread = div_ceil( input.NumberOfPixels() / inSizes[ processingDim ], nThreads );
    nThreads = std::min( div_ceil( input.NumberOfPixels() / inSizes[ processingDim ], nLinesPerThread ), nThreads );
@@ -558,6 +573,9 @@ void OneDimensionalLineFilter(
    }
    bool useRealComponentOfOutput = outUseBuffer && outBufferType.IsComplex() && !output.DataType().IsComplex()
                                    && opts.Contains( SeparableOption::UseRealComponentOfOutput );
+   profiler.AddBytes( input );
+   profiler.AddBytes( output );
+   profiler.AddLines( input.NumberOfPixels() / inLength );
 
    // Start threads, each thread makes its own buffers
    DIP_PARALLEL_ERROR_DECLARE
@@ -576,8 +594,8 @@ void OneDimensionalLineFilter(
       dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
 
       // The temporary buffers, if needed, will be stored here (each thread their own!)
-      AlignedBuffer inBufferStorage;
-      AlignedBuffer outBufferStorage;
+      PooledBuffer inBufferStorage;
+      PooledBuffer outBufferStorage;
 
       // Create buffer data structs and (re-)allocate buffers
       SeparableBuffer inBuffer{};
@@ -624,6 +642,8 @@ void OneDimensionalLineFilter(
       SeparableLineFilterParameters separableLineFilterParams{
             inBuffer, outBuffer, processingDim, 0, 1, it.Coordinates(), tensorToSpatial, thread
       }; // Takes inBuffer, outBuffer, it.Coordinates() as references
+      LineTimer timer( profiler.IsActive() );
+      timer.Start();
       for( dip::uint ii = 0; ( ii < nLinesPerThread ) && it; ++ii, ++it ) {
          // Get pointers to input and output lines
          if( inUseBuffer ) {
@@ -657,9 +677,11 @@ void OneDimensionalLineFilter(
          if( !outUseBuffer ) {
             outBuffer.buffer = it.OutPointer();
          }
+         timer.Conversion();
 
          // Filter the line
          lineFilter.Filter( separableLineFilterParams );
+         timer.Filter();
 
          // Copy back the line from output buffer to the image
          if( outUseBuffer ) {
@@ -690,7 +712,10 @@ void OneDimensionalLineFilter(
             }
          }
       }
+      timer.Conversion();
+      profiler.AddTimes( timer );
    DIP_PARALLEL_ERROR_END
+   profiler.SetThreads( nThreads );
 }
 
 } // namespace Framework
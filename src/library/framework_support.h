@@ -20,9 +20,14 @@
 
 #include "diplib/framework.h"
 
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
 #include <vector>
 
 #include "diplib.h"
+#include "diplib/profiling.h"
 
 namespace dip {
 namespace Framework {
@@ -34,6 +39,130 @@ std::vector< UnsignedArray >  SplitImageEvenlyForProcessing(
    dip::uint processingDim // set to sizes.size() or larger if there's none
 );
 
+// A buffer for the frameworks' line buffers. The memory is taken from a thread-local pool, and returned to it
+// when the object is destroyed, such that consecutive framework calls in the same thread don't need to allocate.
+// Like `AlignedBuffer`, data is not preserved when resizing.
+class PooledBuffer {
+   public:
+      PooledBuffer() = default;
+      explicit PooledBuffer( dip::uint size ) {
+         resize( size );
+      }
+      PooledBuffer( PooledBuffer const& ) = delete;
+      PooledBuffer( PooledBuffer&& ) noexcept = default;
+      PooledBuffer& operator=( PooledBuffer const& ) = delete;
+      PooledBuffer& operator=( PooledBuffer&& other ) noexcept {
+         buffer_.swap( other.buffer_ );
+         return *this;
+      }
+      ~PooledBuffer() {
+         Release();
+      }
+      // Makes sure the buffer has at least `size` bytes.
+      void resize( dip::uint size );
+      dip::uint8* data() noexcept { return buffer_.data(); }
+   private:
+      AlignedBuffer buffer_;
+      void Release() noexcept;
+};
+
+// Counters for the use of the pool of `PooledBuffer` objects, over all threads.
+struct BufferPoolStatistics {
+   dip::uint allocations = 0; // number of buffers allocated
+   dip::uint reuses = 0;      // number of buffers taken from the pool
+};
+BufferPoolStatistics GetBufferPoolStatistics();
+
+// Accumulates, for one thread, the time spent copying data to and from buffers, and the time spent in the line
+// filter. `Conversion()` and `Filter()` add the time elapsed since the previous call (or since `Start()`) to one
+// of the two. Does nothing if `active` is false.
+class LineTimer {
+   public:
+      explicit LineTimer( bool active ) : active_( active ) {}
+      void Start() {
+         if( active_ ) {
+            last_ = std::chrono::steady_clock::now();
+         }
+      }
+      void Conversion() {
+         if( active_ ) {
+            conversion_ += Lap();
+         }
+      }
+      void Filter() {
+         if( active_ ) {
+            filter_ += Lap();
+         }
+      }
+      double ConversionTime() const { return conversion_; }
+      double FilterTime() const { return filter_; }
+   private:
+      bool active_;
+      std::chrono::steady_clock::time_point last_;
+      double conversion_ = 0;
+      double filter_ = 0;
+      double Lap() {
+         auto now = std::chrono::steady_clock::now();
+         std::chrono::duration< double > time = now - last_;
+         last_ = now;
+         return time.count();
+      }
+};
+
+// Whether the frameworks should time the line filters to learn their cost, see `dip::LearnThreadingCosts`.
+bool IsLearningThreadingCosts();
+
+// Updates the cost per operation for the line filter `filter` in the threading cost model, given that it took
+// `seconds` to perform `operations` operations.
+void LearnThreadingCost( char const* filter, dip::uint operations, dfloat seconds );
+
+// Collects the data for a `dip::profiling::Event` for one framework call using `lineFilter`. When destroyed,
+// it records the event if profiling is enabled, and updates the threading cost model for `lineFilter` if
+// learning is enabled. If neither is enabled when the object is created, all member functions do nothing,
+// and `IsActive()` is false.
+class FrameworkProfiler {
+   public:
+      FrameworkProfiler( char const* name, std::type_info const& lineFilter );
+      FrameworkProfiler( FrameworkProfiler const& ) = delete;
+      FrameworkProfiler& operator=( FrameworkProfiler const& ) = delete;
+      ~FrameworkProfiler();
+      bool IsActive() const { return event_ != nullptr; }
+      // Records the data type of an input or output image and of its buffer. The first image added determines
+      // the sizes recorded.
+      void AddInput( Image const& image, DataType bufferType );
+      void AddOutput( Image const& image, DataType bufferType );
+      // Adds the size of the samples of `image` to the number of bytes read or written.
+      void AddBytes( Image const& image ) {
+         if( event_ ) {
+            event_->bytes += image.NumberOfSamples() * image.DataType().SizeOf();
+         }
+      }
+      void SetOperations( dip::uint operations ) {
+         if( event_ ) {
+            event_->operations = operations;
+         }
+      }
+      void AddLines( dip::uint lines ) {
+         if( event_ ) {
+            event_->lines += lines;
+         }
+      }
+      void SetThreads( dip::uint nThreads ) {
+         if( event_ ) {
+            event_->nThreads = nThreads;
+         }
+      }
+      // Adds the times of one thread's timer. Can be called from multiple threads simultaneously.
+      void AddTimes( LineTimer const& timer );
+   private:
+      std::unique_ptr< profiling::Event > event_;
+      char const* lineFilter_ = nullptr;
+      bool record_ = false;
+      bool learn_ = false;
+      std::chrono::steady_clock::time_point start_;
+      std::mutex mutex_;
+};
+
 } // namespace Framework
 } // namespace dip
 
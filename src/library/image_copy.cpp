@@ -15,6 +15,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring> // std::memcpy
 #include <utility>
 #include <vector>
@@ -25,6 +27,7 @@
 #include "diplib/generic_iterators.h"
 #include "diplib/iterators.h"
 #include "diplib/library/copy_buffer.h"
+#include "diplib/multithreading.h"
 #include "diplib/overload.h"
 #include "diplib/statistics.h"
 
@@ -261,6 +264,101 @@ void CopyTo( Image const& src, Image& dest, IntegerArray const& destOffsets ) {
 
 //
 
+namespace {
+
+// Copies all samples of `src` to `dest`, converting the data type if necessary. The two images must have the same
+// sizes and number of tensor elements. `dest` can be the same image as `src`, but with a different data type of
+// the same size, to convert in place.
+void CopySamples( Image const& src, Image& dest ) {
+   // A single CopyBuffer call if both images have simple strides and same dimension order
+   dip::sint sstride_d{};
+   void* origin_d{};
+   std::tie( sstride_d, origin_d ) = dest.GetSimpleStrideAndOrigin();
+   if( origin_d ) {
+      dip::sint sstride_s{};
+      void* origin_s{};
+      std::tie( sstride_s, origin_s ) = src.GetSimpleStrideAndOrigin();
+      if( origin_s && dest.HasSameDimensionOrder( src )) {
+         // No need to loop
+         detail::CopyBuffer(
+               origin_s,
+               src.DataType(),
+               sstride_s,
+               src.TensorStride(),
+               origin_d,
+               dest.DataType(),
+               sstride_d,
+               dest.TensorStride(),
+               dest.NumberOfPixels(),
+               dest.TensorElements()
+         );
+         return;
+      }
+   }
+   // Otherwise, make nD loop
+   dip::uint processingDim = Framework::OptimalProcessingDim( src );
+   GenericJointImageIterator< 2 > it( { src, dest }, processingDim );
+   dip::sint srcStride = src.Stride( processingDim );
+   dip::sint destStride = dest.Stride( processingDim );
+   dip::uint nPixels = dest.Size( processingDim );
+   dip::uint nTElems = dest.TensorElements();
+   do {
+      detail::CopyBuffer(
+            it.InPointer(),
+            src.DataType(),
+            srcStride,
+            src.TensorStride(),
+            it.OutPointer(),
+            dest.DataType(),
+            destStride,
+            dest.TensorStride(),
+            nPixels,
+            nTElems
+      );
+   } while( ++it );
+}
+
+// Calls `CopySamples()` in parallel, for chunks of the images obtained by splitting along the dimension with the
+// largest stride in `dest`.
+void ParallelCopySamples( Image const& src, Image& dest ) {
+   dip::uint nThreads = 1;
+   dip::uint splitDim = 0;
+   if(( dest.Dimensionality() > 0 ) && ( dest.NumberOfSamples() > threadingThreshold )) {
+      for( dip::uint ii = 1; ii < dest.Dimensionality(); ++ii ) {
+         if(( dest.Size( ii ) > 1 ) && ( std::abs( dest.Stride( ii )) > std::abs( dest.Stride( splitDim )))) {
+            splitDim = ii;
+         }
+      }
+      nThreads = std::min( GetNumberOfThreads(), dest.Size( splitDim ));
+   }
+   if( nThreads <= 1 ) {
+      CopySamples( src, dest );
+      return;
+   }
+   dip::uint size = dest.Size( splitDim );
+   DIP_PARALLEL_ERROR_DECLARE
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   DIP_PARALLEL_ERROR_START
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      dip::uint nChunks = static_cast< dip::uint >( omp_get_num_threads() );
+      dip::uint first = size * thread / nChunks;
+      dip::uint last = size * ( thread + 1 ) / nChunks;
+      if( last > first ) {
+         UnsignedArray sizes = dest.Sizes();
+         sizes[ splitDim ] = last - first;
+         Image srcChunk = src.QuickCopy();
+         srcChunk.SetSizesUnsafe( sizes );
+         srcChunk.SetOriginUnsafe( src.Pointer( static_cast< dip::sint >( first ) * src.Stride( splitDim )));
+         Image destChunk = dest.QuickCopy();
+         destChunk.SetSizesUnsafe( sizes );
+         destChunk.SetOriginUnsafe( dest.Pointer( static_cast< dip::sint >( first ) * dest.Stride( splitDim )));
+         CopySamples( srcChunk, destChunk );
+      }
+   DIP_PARALLEL_ERROR_END
+}
+
+} // namespace
+
 void Image::Copy( Image const& src ) {
    // TODO: allow copying with singleton expansion.
    DIP_THROW_IF( !src.IsForged(), E::IMAGE_NOT_FORGED );
@@ -289,58 +387,7 @@ void Image::Copy( Image const& src ) {
       externalInterface_ = ei; // This is only really relevant if `ei` is `nullptr`...
       DIP_STACK_TRACE_THIS( Forge() );
    }
-   // A single CopyBuffer call if both images have simple strides and same dimension order
-   dip::sint sstride_d{};
-   void* origin_d{};
-   std::tie( sstride_d, origin_d ) = GetSimpleStrideAndOrigin();
-   if( origin_d ) {
-      //std::cout << "dip::Image::Copy: destination has simple strides\n";
-      dip::sint sstride_s{};
-      void* origin_s{};
-      std::tie( sstride_s, origin_s ) = src.GetSimpleStrideAndOrigin();
-      if( origin_s ) {
-         //std::cout << "dip::Image::Copy: source has simple strides\n";
-         if( HasSameDimensionOrder( src )) {
-            // No need to loop
-            //std::cout << "dip::Image::Copy: no need to loop\n";
-            detail::CopyBuffer(
-                  origin_s,
-                  src.dataType_,
-                  sstride_s,
-                  src.tensorStride_,
-                  origin_d,
-                  dataType_,
-                  sstride_d,
-                  tensorStride_,
-                  NumberOfPixels(),
-                  tensor_.Elements()
-            );
-            return;
-         }
-      }
-   }
-   // Otherwise, make nD loop
-   //std::cout << "dip::Image::Copy: nD loop\n";
-   dip::uint processingDim = Framework::OptimalProcessingDim( src );
-   GenericJointImageIterator< 2 > it( { src, *this }, processingDim );
-   dip::sint srcStride = src.strides_[ processingDim ];
-   dip::sint destStride = strides_[ processingDim ];
-   dip::uint nPixels = sizes_[ processingDim ];
-   dip::uint nTElems = tensor_.Elements();
-   do {
-      detail::CopyBuffer(
-            it.InPointer(),
-            src.dataType_,
-            srcStride,
-            src.tensorStride_,
-            it.OutPointer(),
-            dataType_,
-            destStride,
-            tensorStride_,
-            nPixels,
-            nTElems
-      );
-   } while( ++it );
+   DIP_STACK_TRACE_THIS( ParallelCopySamples( src, *this ));
 }
 
 void Image::Copy( Image::View const& src ) {
@@ -461,45 +508,9 @@ void Image::Convert( dip::DataType dt ) {
       if( !IsShared() && ( dt.SizeOf() == dataType_.SizeOf() )) {
          // The operation can happen in place.
          // Loop over all pixels, casting with clamp each of the values; finally set the data type field.
-         dip::sint sstride{};
-         void* origin{};
-         std::tie( sstride, origin ) = GetSimpleStrideAndOrigin();
-         if( origin ) {
-            // No need to loop
-            //std::cout << "dip::Image::Convert: in-place, no need to loop\n";
-            detail::CopyBuffer(
-                  origin,
-                  dataType_,
-                  sstride,
-                  tensorStride_,
-                  origin,
-                  dt,
-                  sstride,
-                  tensorStride_,
-                  NumberOfPixels(),
-                  tensor_.Elements()
-            );
-         } else {
-            // Make nD loop
-            //std::cout << "dip::Image::Convert: in-place, nD loop\n";
-            dip::uint processingDim = Framework::OptimalProcessingDim( *this );
-            GenericImageIterator<> it( *this, processingDim );
-            it.OptimizeAndFlatten();
-            do {
-               detail::CopyBuffer(
-                     it.Pointer(),
-                     dataType_,
-                     strides_[ processingDim ],
-                     tensorStride_,
-                     it.Pointer(),
-                     dt,
-                     strides_[ processingDim ],
-                     tensorStride_,
-                     sizes_[ processingDim ],
-                     tensor_.Elements()
-               );
-            } while( ++it );
-         }
+         Image dest = QuickCopy();
+         dest.dataType_ = dt;
+         DIP_STACK_TRACE_THIS( ParallelCopySamples( *this, dest ));
          dataType_ = dt;
       } else {
          // We need to create a new data segment and copy it over.
@@ -663,6 +674,7 @@ void Image::Mask( dip::Image const& mask ) {
 
 #ifdef DIP_CONFIG_ENABLE_DOCTEST
 #include "doctest.h"
+#include "diplib/testing.h"
 
 DOCTEST_TEST_CASE( "[DIPlib] testing dip::Image::SwapBytesInSample" ) {
    dip::Image img( { 5, 8 }, 3, dip::DT_SINT16 );
@@ -706,4 +718,33 @@ DOCTEST_TEST_CASE( "[DIPlib] testing dip::Image::Mask" ) {
    DOCTEST_CHECK( img.At( 1, 1 ).As< dip::scomplex >() == 1.f );
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::Image::Copy and dip::Image::Convert with multiple threads" ) {
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 3 );
+   dip::Image img( { 300, 257 }, 2, dip::DT_SFLOAT );
+   dip::ImageIterator< dip::sfloat > it( img );
+   dip::sfloat v = -1000;
+   do {
+      it[ 0 ] = v;
+      it[ 1 ] = -v;
+      v += 0.1f;
+   } while( ++it );
+   // Simple strides
+   dip::Image out = dip::Convert( img, dip::DT_SINT16 );
+   DOCTEST_CHECK( out.At( 0, 0 )[ 0 ].As< dip::sint16 >() == -1000 );
+   DOCTEST_CHECK( out.At( 299, 256 )[ 0 ].As< dip::sint16 >() == static_cast< dip::sint16 >( img.At( 299, 256 )[ 0 ].As< dip::sfloat >() ));
+   DOCTEST_CHECK( out.At( 299, 256 )[ 1 ].As< dip::sint16 >() == static_cast< dip::sint16 >( img.At( 299, 256 )[ 1 ].As< dip::sfloat >() ));
+   // Non-simple strides
+   dip::Image view = img.At( dip::Range{ 0, -1, 2 }, dip::Range{ -1, 0 } );
+   out = view.Copy();
+   DOCTEST_CHECK( dip::testing::CompareImages( out, view, dip::Option::CompareImagesMode::EXACT ));
+   out = dip::Convert( view, dip::DT_DFLOAT );
+   DOCTEST_CHECK( dip::testing::CompareImages( out, view, dip::Option::CompareImagesMode::APPROX, 0.0 ));
+   // In place
+   out.Convert( dip::DT_SINT64 );
+   DOCTEST_CHECK( out.At( 10, 0 )[ 1 ].As< dip::sint64 >() == static_cast< dip::sint64 >( view.At( 10, 0 )[ 1 ].As< dip::sfloat >() ));
+   DOCTEST_CHECK( out.At( 149, 256 )[ 0 ].As< dip::sint64 >() == static_cast< dip::sint64 >( view.At( 149, 256 )[ 0 ].As< dip::sfloat >() ));
+   dip::SetNumberOfThreads( nThreads );
+}
+
 #endif // DIP_CONFIG_ENABLE_DOCTEST
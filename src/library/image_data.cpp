@@ -21,9 +21,12 @@
 #include <cstdlib>   // std::malloc, std::realloc, std::free
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <utility>
+#include <vector>
 
 #include "diplib.h"
 
@@ -231,6 +234,132 @@ DataSegment AlignedAllocInterface::AllocateData(
 }
 
 
+class PooledAllocInterface::Pool {
+   public:
+      explicit Pool( dip::uint maxCachedBytes ) : maxCachedBytes_( maxCachedBytes ) {}
+      Pool( Pool const& ) = delete;
+      Pool& operator=( Pool const& ) = delete;
+      ~Pool() {
+         Clear();
+      }
+
+      // Four size classes per power of two, the smallest class is 256 bytes.
+      static dip::uint SizeClass( dip::uint bytes ) {
+         if( bytes <= 256 ) {
+            return 256;
+         }
+         dip::uint step = 1;
+         while( step * 8 <= bytes ) {
+            step <<= 1u;
+         }
+         return div_ceil( bytes, step ) * step;
+      }
+
+      // Returns a block of `bytes` bytes, `bytes` must be a size class.
+      void* Get( dip::uint bytes ) {
+         {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            auto it = free_.find( bytes );
+            if(( it != free_.end() ) && !it->second.empty() ) {
+               void* ptr = it->second.back();
+               it->second.pop_back();
+               cachedBytes_ -= bytes;
+               ++reuses_;
+               return ptr;
+            }
+            ++allocations_;
+         }
+         void* ptr = std::malloc( bytes );
+         if( !ptr ) {
+            // Maybe the memory we're holding on to is in the way
+            Clear();
+            ptr = std::malloc( bytes );
+            if( !ptr ) {
+               DIP_THROW_RUNTIME( MALLOC_FAILED );
+            }
+         }
+         return ptr;
+      }
+
+      // Takes back a block obtained through `Get()`.
+      void Put( void* ptr, dip::uint bytes ) noexcept {
+         {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            if( cachedBytes_ + bytes <= maxCachedBytes_ ) {
+               try {
+                  free_[ bytes ].push_back( ptr );
+                  cachedBytes_ += bytes;
+                  return;
+               } catch( ... ) {
+                  // Allocation failure in `push_back`: just free the block
+               }
+            }
+         }
+         std::free( ptr );
+      }
+
+      void Clear() {
+         std::map< dip::uint, std::vector< void* >> blocks;
+         {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            blocks.swap( free_ );
+            cachedBytes_ = 0;
+         }
+         for( auto& sizeClass : blocks ) {
+            for( void* ptr : sizeClass.second ) {
+               std::free( ptr );
+            }
+         }
+      }
+
+      PooledAllocInterface::Statistics GetStatistics() const {
+         std::lock_guard< std::mutex > lock( mutex_ );
+         PooledAllocInterface::Statistics out;
+         out.allocations = allocations_;
+         out.reuses = reuses_;
+         out.cachedBytes = cachedBytes_;
+         return out;
+      }
+
+   private:
+      mutable std::mutex mutex_;
+      std::map< dip::uint, std::vector< void* >> free_; // free blocks, indexed by their size class
+      dip::uint maxCachedBytes_;
+      dip::uint cachedBytes_ = 0;
+      dip::uint allocations_ = 0;
+      dip::uint reuses_ = 0;
+};
+
+PooledAllocInterface::PooledAllocInterface( dip::uint maxCachedBytes )
+      : pool_( std::make_shared< Pool >( maxCachedBytes )) {}
+
+DataSegment PooledAllocInterface::AllocateData(
+      void*& origin,
+      dip::DataType dataType,
+      UnsignedArray const& sizes,
+      IntegerArray& strides,
+      dip::Tensor const& tensor,
+      dip::sint& tensorStride
+) {
+   dip::uint bytes = Pool::SizeClass( FindNumberOfPixels( sizes ) * tensor.Elements() * dataType.SizeOf() );
+   void* ptr = pool_->Get( bytes );
+   std::shared_ptr< Pool > pool = pool_;
+   DataSegment dataBlock{ ptr, [ pool, bytes ]( void* p ) { pool->Put( p, bytes ); }};
+   tensorStride = 1; // We set tensor strides to 1 by default
+   ComputeStrides( sizes, tensor.Elements(), strides );
+   origin = ptr;
+   return dataBlock;
+}
+
+PooledAllocInterface::Statistics PooledAllocInterface::GetStatistics() const {
+   return pool_->GetStatistics();
+}
+
+void PooledAllocInterface::Clear() {
+   pool_->Clear();
+}
+
+
 // Constructor.
 CoordinatesComputer::CoordinatesComputer( UnsignedArray const& sizes, IntegerArray const& strides ) {
    dip::uint N = strides.size();
@@ -322,6 +451,13 @@ void Image::SetNormalStrides() {
    dip::ComputeStrides( sizes_, tensor_.Elements(), strides_ );
 }
 
+//
+void Image::SetPlanarStrides() {
+   DIP_THROW_IF( IsForged(), E::IMAGE_NOT_RAW );
+   dip::ComputeStrides( sizes_, 1, strides_ );
+   tensorStride_ = tensor_.Elements() > 1 ? static_cast< dip::sint >( FindNumberOfPixels( sizes_ )) : 1;
+}
+
 //
 void Image::MatchStrideOrder( Image const& src ) {
    DIP_THROW_IF( IsForged(), E::IMAGE_NOT_RAW );
@@ -356,6 +492,19 @@ bool Image::HasNormalStrides() const {
 }
 
 
+// Planar strides: each tensor element is an image with normal strides,
+// and these images are stored one after the other.
+bool Image::HasPlanarStrides() const {
+   dip::sint total = 1;
+   for( dip::uint ii = 0; ii < sizes_.size(); ++ii ) {
+      if( strides_[ ii ] != total ) {
+         return false;
+      }
+      total *= static_cast< dip::sint >( sizes_[ ii ] );
+   }
+   return ( tensor_.Elements() == 1 ) || ( tensorStride_ == total );
+}
+
 // If any dimension is 1, there is a singleton dimension
 bool Image::HasSingletonDimension() const {
    DIP_THROW_IF( !IsForged(), E::IMAGE_NOT_FORGED );
@@ -951,6 +1100,44 @@ DOCTEST_TEST_CASE("[DIPlib] testing dip::Image::MatchStrideOrder") {
    DOCTEST_CHECK( img.TensorStride() == 6 );
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing planar strides") {
+   dip::Image img;
+   img.SetSizes( { 5, 6 } );
+   img.SetTensorSizes( 3 );
+   img.SetDataType( dip::DT_SFLOAT );
+   img.SetPlanarStrides();
+   img.Forge();
+   DOCTEST_CHECK( img.HasPlanarStrides() );
+   DOCTEST_CHECK( !img.HasNormalStrides() );
+   DOCTEST_CHECK( img.Stride( 0 ) == 1 );
+   DOCTEST_CHECK( img.Stride( 1 ) == 5 );
+   DOCTEST_CHECK( img.TensorStride() == 30 );
+   img.Fill( 0 );
+   img.At( 2, 3 ) = { 1, 2, 3 };
+   // The sum of two planar images is planar too
+   dip::Image sum = img + img;
+   DOCTEST_CHECK( sum.HasPlanarStrides() );
+   DOCTEST_CHECK( sum.At( 2, 3 ) == dip::Image::Pixel( { 2, 4, 6 } ));
+   // Converting to normal strides and back
+   sum.ForceNormalStrides();
+   DOCTEST_CHECK( sum.HasNormalStrides() );
+   DOCTEST_CHECK( !sum.HasPlanarStrides() );
+   sum.ForcePlanarStrides();
+   DOCTEST_CHECK( sum.HasPlanarStrides() );
+   DOCTEST_CHECK( sum.At( 2, 3 ) == dip::Image::Pixel( { 2, 4, 6 } ));
+   // Converting to planar strides doesn't copy if not needed
+   void const* ptr = img.Origin();
+   img.ForcePlanarStrides();
+   DOCTEST_CHECK( img.Origin() == ptr );
+   // Tensor to spatial gives normal strides without a copy
+   img.TensorToSpatial();
+   DOCTEST_CHECK( img.HasNormalStrides() );
+   DOCTEST_CHECK( img.Origin() == ptr );
+   // A scalar image with normal strides is also planar
+   dip::Image scalar( { 5, 6 }, 1, dip::DT_UINT8 );
+   DOCTEST_CHECK( scalar.HasPlanarStrides() );
+}
+
 DOCTEST_TEST_CASE("[DIPlib] testing dip::Image move constructor") {
    dip::Image img( { 10, 13 }, 1, dip::DT_UINT8 );
    DOCTEST_REQUIRE( img.IsForged() );
@@ -991,4 +1178,39 @@ DOCTEST_TEST_CASE("[DIPlib] testing dip::AlignedAllocInterface") {
    // TODO: How to disambiguate which of the bits raises the exception?
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing dip::PooledAllocInterface") {
+   auto pool = std::make_unique< dip::PooledAllocInterface >();
+   void* origin{};
+   {
+      dip::Image img;
+      img.SetExternalInterface( pool.get() );
+      img.ReForge( { 100, 80 }, 3, dip::DT_SFLOAT );
+      DOCTEST_REQUIRE( img.IsForged() );
+      DOCTEST_CHECK( img.HasNormalStrides() );
+      origin = img.Origin();
+      img.Fill( 1 );
+   }
+   auto stats = pool->GetStatistics();
+   DOCTEST_CHECK( stats.allocations == 1 );
+   DOCTEST_CHECK( stats.reuses == 0 );
+   DOCTEST_CHECK( stats.cachedBytes >= 100 * 80 * 3 * sizeof( dip::sfloat ));
+   dip::Image img;
+   img.SetExternalInterface( pool.get() );
+   img.ReForge( { 90, 125 }, 1, dip::DT_DFLOAT ); // a little bit smaller, same size class
+   DOCTEST_CHECK( img.Origin() == origin );
+   dip::Image other;
+   other.SetExternalInterface( pool.get() );
+   other.ReForge( { 100, 80 }, 3, dip::DT_SFLOAT );
+   DOCTEST_CHECK( other.Origin() != origin );
+   stats = pool->GetStatistics();
+   DOCTEST_CHECK( stats.allocations == 2 );
+   DOCTEST_CHECK( stats.reuses == 1 );
+   DOCTEST_CHECK( stats.cachedBytes == 0 );
+   // The interface can be destroyed before the images that use it
+   pool.reset();
+   img.Fill( 2 );
+   img.Strip();
+   other.Strip();
+}
+
 #endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -16,10 +16,20 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
 
 #include "diplib.h"
+#include "diplib/framework.h"
 #include "diplib/multithreading.h"
 
+#include "framework_support.h"
+
 namespace dip {
 
 namespace {
@@ -29,6 +39,34 @@ dip::uint const defaultMaxNumberOfThreads = static_cast< dip::uint >( omp_get_ma
 
 thread_local dip::uint maxNumberOfThreads = defaultMaxNumberOfThreads;
 
+// `model` is protected by `mutex`. The scalar costs are also stored in atomic variables, so that
+// `ChooseNumberOfThreads` can read them without locking; it only locks the mutex to look up a filter.
+struct CostModelStorage {
+   std::mutex mutex;
+   ThreadingCostModel model;
+   std::atomic< dfloat > secondsPerOperation{ model.secondsPerOperation };
+   std::atomic< dfloat > startupCost{ model.startupCost };
+   std::atomic< dfloat > perThreadCost{ model.perThreadCost };
+   std::atomic< bool > hasFilterCosts{ false };
+};
+
+CostModelStorage& CostModel() {
+   static CostModelStorage storage;
+   return storage;
+}
+
+std::atomic< bool > learnCosts{ false };
+
+// Set while `CalibrateThreadingCostModel` runs in this thread: the frameworks then use all the threads
+// allowed by `SetNumberOfThreads`, as if the overhead of threads were zero.
+thread_local bool calibrating = false;
+
+// Calls with fewer estimated operations than this are not used to learn a filter's cost, their timing is too noisy.
+constexpr dip::uint minOperationsToLearn = threadingThreshold;
+
+// The header line of a file written by `SaveThreadingCostModel`.
+constexpr char const* costModelHeader = "DIPlib threading cost model";
+
 }
 
 void SetNumberOfThreads( dip::uint nThreads ) {
@@ -43,4 +81,282 @@ dip::uint GetNumberOfThreads() {
    return maxNumberOfThreads;
 }
 
+ThreadingCostModel GetThreadingCostModel() {
+   CostModelStorage& storage = CostModel();
+   std::lock_guard< std::mutex > guard( storage.mutex );
+   return storage.model;
+}
+
+void SetThreadingCostModel( ThreadingCostModel const& model ) {
+   DIP_THROW_IF( !( model.secondsPerOperation > 0 ) || !std::isfinite( model.secondsPerOperation ), E::PARAMETER_OUT_OF_RANGE );
+   DIP_THROW_IF( !( model.startupCost >= 0 ) || !std::isfinite( model.startupCost ), E::PARAMETER_OUT_OF_RANGE );
+   DIP_THROW_IF( !( model.perThreadCost >= 0 ) || !std::isfinite( model.perThreadCost ), E::PARAMETER_OUT_OF_RANGE );
+   for( auto const& filter : model.filterCosts ) {
+      DIP_THROW_IF( !( filter.second > 0 ) || !std::isfinite( filter.second ), E::PARAMETER_OUT_OF_RANGE );
+   }
+   CostModelStorage& storage = CostModel();
+   std::lock_guard< std::mutex > guard( storage.mutex );
+   storage.model = model;
+   storage.secondsPerOperation = model.secondsPerOperation;
+   storage.startupCost = model.startupCost;
+   storage.perThreadCost = model.perThreadCost;
+   storage.hasFilterCosts = !model.filterCosts.empty();
+}
+
+dip::uint ChooseNumberOfThreads( dip::uint operations, dip::uint maxThreads, char const* filter ) {
+   if( maxThreads <= 1 ) {
+      return 1;
+   }
+   if( calibrating ) {
+      return maxThreads;
+   }
+   CostModelStorage& storage = CostModel();
+   dfloat secondsPerOperation = storage.secondsPerOperation;
+   dfloat startupCost = storage.startupCost;
+   dfloat perThreadCost = storage.perThreadCost;
+   if( filter && storage.hasFilterCosts ) {
+      std::lock_guard< std::mutex > guard( storage.mutex );
+      auto it = storage.model.filterCosts.find( filter ); // `std::less<>` allows finding a `char const*` without copying it
+      if( it != storage.model.filterCosts.end() ) {
+         secondsPerOperation = it->second;
+      }
+   }
+   dfloat work = static_cast< dfloat >( operations ) * secondsPerOperation;
+   // Time with n threads is `work / n + startupCost + n * perThreadCost`, which is minimal for
+   // n = sqrt( work / perThreadCost ). We compare the two integers around it with the single-threaded time.
+   dfloat optimum = perThreadCost > 0 ? std::sqrt( work / perThreadCost ) : static_cast< dfloat >( maxThreads );
+   dip::uint candidates[ 2 ] = {
+         static_cast< dip::uint >( std::min( std::floor( optimum ), static_cast< dfloat >( maxThreads ))),
+         static_cast< dip::uint >( std::min( std::ceil( optimum ), static_cast< dfloat >( maxThreads )))
+   };
+   dip::uint nThreads = 1;
+   dfloat time = work;
+   for( dip::uint n : candidates ) {
+      n = std::max( n, dip::uint( 2 ));
+      dfloat t = work / static_cast< dfloat >( n ) + startupCost + static_cast< dfloat >( n ) * perThreadCost;
+      if( t < time ) {
+         time = t;
+         nThreads = n;
+      }
+   }
+   return nThreads;
+}
+
+void LearnThreadingCosts( bool enable ) {
+   learnCosts = enable;
+}
+
+namespace Framework {
+
+bool IsLearningThreadingCosts() {
+   return learnCosts;
+}
+
+void LearnThreadingCost( char const* filter, dip::uint operations, dfloat seconds ) {
+   if( !filter || ( operations < minOperationsToLearn ) || !( seconds > 0 )) {
+      return;
+   }
+   dfloat cost = seconds / static_cast< dfloat >( operations );
+   CostModelStorage& storage = CostModel();
+   std::lock_guard< std::mutex > guard( storage.mutex );
+   auto it = storage.model.filterCosts.find( filter );
+   if( it == storage.model.filterCosts.end() ) {
+      storage.model.filterCosts.emplace( filter, cost );
+      storage.hasFilterCosts = true;
+   } else {
+      it->second = 0.75 * it->second + 0.25 * cost; // exponential moving average, to smooth out the noise
+   }
+}
+
+} // namespace Framework
+
+namespace {
+
+// A simple line filter used to measure the costs of the model: one multiplication and one addition per sample.
+class CalibrationLineFilter : public Framework::ScanLineFilter {
+   public:
+      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint nTensorElements ) override {
+         return 2 * nTensorElements;
+      }
+      void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         sfloat const* in = static_cast< sfloat const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint inStride = params.inBuffer[ 0 ].stride;
+         sfloat* out = static_cast< sfloat* >( params.outBuffer[ 0 ].buffer );
+         dip::sint outStride = params.outBuffer[ 0 ].stride;
+         for( dip::uint ii = 0; ii < params.bufferLength; ++ii, in += inStride, out += outStride ) {
+            *out = *in * 0.5f + 1.0f;
+         }
+      }
+};
+
+// Returns the shortest time over `repetitions` runs of the calibration filter over `in`, using up to `nThreads` threads.
+dfloat TimeCalibrationFilter( Image const& in, Image& out, dip::uint nThreads, dip::uint repetitions ) {
+   SetNumberOfThreads( nThreads );
+   CalibrationLineFilter filter;
+   dfloat time = std::numeric_limits< dfloat >::max();
+   for( dip::uint ii = 0; ii < repetitions; ++ii ) {
+      auto start = std::chrono::steady_clock::now();
+      Framework::ScanMonadic( in, out, DT_SFLOAT, DT_SFLOAT, 1, filter );
+      std::chrono::duration< dfloat > elapsed = std::chrono::steady_clock::now() - start;
+      time = std::min( time, elapsed.count() );
+   }
+   return time;
+}
+
+} // namespace
+
+void CalibrateThreadingCostModel() {
+   ThreadingCostModel model = GetThreadingCostModel();
+   dip::uint maxThreads = GetNumberOfThreads();
+   // During calibration, threads are always used, we limit their number with `SetNumberOfThreads`.
+   // The model used by other threads is not affected.
+   DIP_START_STACK_TRACE
+      calibrating = true;
+      try {
+         // Cost per operation: a large image in a single thread
+         Image large( { 1024, 1024 }, 1, DT_SFLOAT );
+         large.Fill( 1.0 );
+         Image out;
+         dfloat time = TimeCalibrationFilter( large, out, 1, 5 );
+         model.secondsPerOperation = time / static_cast< dfloat >( 2 * large.NumberOfPixels() );
+         // Overhead of threads: a small image, where the overhead dominates
+         if( maxThreads > 1 ) {
+            Image small( { 64, 64 }, 1, DT_SFLOAT );
+            small.Fill( 1.0 );
+            dfloat time1 = TimeCalibrationFilter( small, out, 1, 200 );
+            auto Overhead = [ & ]( dip::uint n ) {
+               return std::max( 0.0, TimeCalibrationFilter( small, out, n, 200 ) - time1 / static_cast< dfloat >( n ));
+            };
+            dfloat overhead2 = Overhead( 2 );
+            if( maxThreads > 2 ) {
+               dfloat overheadMax = Overhead( maxThreads );
+               model.perThreadCost = std::max( 0.0, ( overheadMax - overhead2 ) / static_cast< dfloat >( maxThreads - 2 ));
+               model.startupCost = std::max( 0.0, overhead2 - 2 * model.perThreadCost );
+            } else {
+               model.perThreadCost = 0;
+               model.startupCost = overhead2;
+            }
+         }
+      } catch( ... ) {
+         calibrating = false;
+         SetNumberOfThreads( maxThreads );
+         throw;
+      }
+      calibrating = false;
+      SetNumberOfThreads( maxThreads );
+      SetThreadingCostModel( model );
+   DIP_END_STACK_TRACE
+}
+
+void SaveThreadingCostModel( String const& filename ) {
+   ThreadingCostModel model = GetThreadingCostModel();
+   std::ofstream file( filename, std::ios_base::trunc );
+   DIP_THROW_IF( !file.is_open(), "Could not open file for writing" );
+   file.precision( std::numeric_limits< dfloat >::max_digits10 );
+   file << costModelHeader << '\n';
+   file << "secondsPerOperation " << model.secondsPerOperation << '\n';
+   file << "startupCost " << model.startupCost << '\n';
+   file << "perThreadCost " << model.perThreadCost << '\n';
+   for( auto const& filter : model.filterCosts ) {
+      // The name goes last because it can contain spaces
+      file << "filter " << filter.second << ' ' << filter.first << '\n';
+   }
+}
+
+void LoadThreadingCostModel( String const& filename ) {
+   std::ifstream file( filename );
+   DIP_THROW_IF( !file.is_open(), "Could not open the specified file" );
+   String line;
+   std::getline( file, line );
+   DIP_THROW_IF( line != costModelHeader, "The file does not contain a threading cost model" );
+   ThreadingCostModel model;
+   while( std::getline( file, line )) {
+      if( line.empty() ) {
+         continue;
+      }
+      std::istringstream stream( line );
+      String key;
+      dfloat value{};
+      stream >> key >> value;
+      DIP_THROW_IF( stream.fail(), "The file does not contain a threading cost model" );
+      if( key == "secondsPerOperation" ) {
+         model.secondsPerOperation = value;
+      } else if( key == "startupCost" ) {
+         model.startupCost = value;
+      } else if( key == "perThreadCost" ) {
+         model.perThreadCost = value;
+      } else if( key == "filter" ) {
+         String name;
+         stream >> std::ws;
+         std::getline( stream, name );
+         DIP_THROW_IF( name.empty(), "The file does not contain a threading cost model" );
+         model.filterCosts[ name ] = value;
+      } else {
+         DIP_THROW( "The file does not contain a threading cost model" );
+      }
+   }
+   DIP_STACK_TRACE_THIS( SetThreadingCostModel( model ));
+}
+
 } // namespace dip
+
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include <cstdio>
+#include "doctest.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing the threading cost model" ) {
+   dip::ThreadingCostModel original = dip::GetThreadingCostModel();
+   dip::ThreadingCostModel model;
+   model.secondsPerOperation = 1e-9;
+   model.startupCost = 20e-6;
+   model.perThreadCost = 1e-6;
+   model.filterCosts[ "expensive filter" ] = 1e-8;
+   dip::SetThreadingCostModel( model );
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 1000000000, 1 ) == 1 );
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 10000, 16 ) == 1 );     // 10 us of work: not worth it
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 40000, 16 ) == 6 );     // 40 us: 40 / 6 + 20 + 6 = 32.7 us
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 100000, 16 ) == 10 );   // 100 us: sqrt( 100 / 1 ) = 10 threads
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 100000000, 16 ) == 16 );
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 10000, 16, "expensive filter" ) == 10 );
+   DOCTEST_CHECK( dip::ChooseNumberOfThreads( 10000, 16, "other filter" ) == 1 );
+   dip::ThreadingCostModel invalid = model;
+   invalid.filterCosts[ "invalid filter" ] = -1e-9;
+   DOCTEST_CHECK_THROWS( dip::SetThreadingCostModel( invalid ));
+   invalid.filterCosts[ "invalid filter" ] = std::numeric_limits< dip::dfloat >::quiet_NaN();
+   DOCTEST_CHECK_THROWS( dip::SetThreadingCostModel( invalid ));
+   DOCTEST_CHECK( dip::GetThreadingCostModel().filterCosts.count( "invalid filter" ) == 0 );
+
+   // Learning updates the cost for the filter
+   dip::Framework::LearnThreadingCost( "expensive filter", 1000000, 2e-2 );
+   DOCTEST_CHECK( dip::GetThreadingCostModel().filterCosts[ "expensive filter" ] == doctest::Approx( 0.75e-8 + 0.25 * 2e-8 ));
+   dip::Framework::LearnThreadingCost( "new filter", 1000000, 2e-3 );
+   DOCTEST_CHECK( dip::GetThreadingCostModel().filterCosts[ "new filter" ] == doctest::Approx( 2e-9 ));
+   dip::Framework::LearnThreadingCost( "small filter", 100, 2e-3 ); // too few operations to learn from
+   DOCTEST_CHECK( dip::GetThreadingCostModel().filterCosts.count( "small filter" ) == 0 );
+
+   // Save and load
+   dip::String filename = "dip_test_threading_cost_model.txt";
+   model.filterCosts[ "a name with spaces" ] = 3e-9;
+   dip::SetThreadingCostModel( model );
+   dip::SaveThreadingCostModel( filename );
+   dip::SetThreadingCostModel( original );
+   dip::LoadThreadingCostModel( filename );
+   std::remove( filename.c_str() );
+   dip::ThreadingCostModel loaded = dip::GetThreadingCostModel();
+   DOCTEST_CHECK( loaded.secondsPerOperation == model.secondsPerOperation );
+   DOCTEST_CHECK( loaded.startupCost == model.startupCost );
+   DOCTEST_CHECK( loaded.perThreadCost == model.perThreadCost );
+   DOCTEST_CHECK( loaded.filterCosts == model.filterCosts );
+
+   // Calibration produces a valid model
+   dip::CalibrateThreadingCostModel();
+   dip::ThreadingCostModel calibrated = dip::GetThreadingCostModel();
+   DOCTEST_CHECK( calibrated.secondsPerOperation > 0 );
+   DOCTEST_CHECK( calibrated.startupCost >= 0 );
+   DOCTEST_CHECK( calibrated.perThreadCost >= 0 );
+   DOCTEST_CHECK( calibrated.filterCosts == model.filterCosts );
+   dip::SetThreadingCostModel( original );
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -46,9 +46,13 @@ PixelTableOffsets::PixelTableOffsets(
 {
    auto const& inRuns = pt.Runs();
    runs_.resize( inRuns.size() );
+   trailingEdge_.resize( inRuns.size() );
+   leadingEdge_.resize( inRuns.size() );
    for( dip::uint ii = 0; ii < runs_.size(); ++ii ) {
       runs_[ ii ].offset = image.Offset( inRuns[ ii ].coordinates );
       runs_[ ii ].length = inRuns[ ii ].length;
+      trailingEdge_[ ii ] = runs_[ ii ].offset;
+      leadingEdge_[ ii ] = runs_[ ii ].offset + static_cast< dip::sint >( runs_[ ii ].length ) * stride_;
    }
 }
 
@@ -598,4 +602,61 @@ DOCTEST_TEST_CASE("[DIPlib] testing the PixelTable class") {
    DOCTEST_CHECK_FALSE( pt5.HasWeights() );
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the PixelTableOffsets sliding window and weighted sum") {
+   dip::PixelTable pt( "elliptic", dip::FloatArray{ 5, 5 }, 0 );
+   pt.AddDistanceToOriginAsWeights();
+   dip::Image img( { 40, 30 }, 1, dip::DT_SFLOAT );
+   dip::sint stride = img.Stride( 0 );
+   dip::PixelTableOffsets pto = pt.Prepare( img );
+   dip::sfloat* data = static_cast< dip::sfloat* >( img.Origin() );
+   for( dip::uint ii = 0; ii < img.NumberOfPixels(); ++ii ) {
+      data[ ii ] = static_cast< dip::sfloat >(( ii * 7 ) % 13 );
+   }
+   std::vector< dip::sint > offsets = pto.Offsets();
+   dip::sfloat const* in = static_cast< dip::sfloat const* >( img.Pointer( dip::UnsignedArray{ 3, 15 } ));
+   dip::uint length = 34;
+
+   // Slide a running sum along a line in the middle of the image using the edges, and compare to
+   // the sum over the full neighborhood at each position
+   DOCTEST_REQUIRE( pto.TrailingEdge().size() == pto.Runs().size() );
+   DOCTEST_REQUIRE( pto.LeadingEdge().size() == pto.Runs().size() );
+   auto NeighborhoodSum = [ & ]( dip::sfloat const* pixel ) {
+      dip::dfloat sum = 0;
+      for( auto offset : offsets ) {
+         sum += pixel[ offset ];
+      }
+      return sum;
+   };
+   dip::dfloat runningSum = NeighborhoodSum( in );
+   bool matchSum = true;
+   for( dip::uint ii = 1; ii < length; ++ii ) {
+      dip::sfloat const* previous = in + static_cast< dip::sint >( ii - 1 ) * stride;
+      for( dip::uint jj = 0; jj < pto.Runs().size(); ++jj ) {
+         runningSum -= previous[ pto.TrailingEdge()[ jj ]];
+         runningSum += previous[ pto.LeadingEdge()[ jj ]];
+      }
+      matchSum &= runningSum == NeighborhoodSum( previous + stride );
+   }
+   DOCTEST_CHECK( matchSum );
+
+   // Compute the weighted sum along the same line, and compare to the straight-forward loop
+   std::vector< dip::sfloat > weights( pto.Weights().begin(), pto.Weights().end() );
+   std::vector< dip::sfloat > out1( length );
+   std::vector< dip::sfloat > out2( 2 * length );
+   pto.WeightedSum( in, stride, out1.data(), 1, length, weights.data() );
+   pto.WeightedSum( in, stride, out2.data() + 1, 2, length, weights.data() ); // also test the strided version
+   bool match1 = true;
+   bool match2 = true;
+   for( dip::uint ii = 0; ii < length; ++ii ) {
+      dip::sfloat sum = 0;
+      for( dip::uint jj = 0; jj < offsets.size(); ++jj ) {
+         sum += in[ offsets[ jj ] + static_cast< dip::sint >( ii ) * stride ] * weights[ jj ];
+      }
+      match1 &= out1[ ii ] == sum;
+      match2 &= out2[ 2 * ii + 1 ] == sum;
+   }
+   DOCTEST_CHECK( match1 );
+   DOCTEST_CHECK( match2 );
+}
+
 #endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -0,0 +1,408 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib/profiling.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "diplib.h"
+
+#include "framework_support.h"
+
+namespace dip {
+namespace profiling {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr dip::uint maxEvents = 1024 * 1024;
+
+std::atomic< bool > enabled{ false };
+
+struct EventLog {
+   std::mutex mutex;
+   std::vector< Event > events;
+   dip::uint dropped = 0;
+   bool hasOrigin = false;
+   Clock::time_point origin;
+};
+
+EventLog& Log() {
+   static EventLog log;
+   return log;
+}
+
+// The name of the innermost `Region` alive in this thread
+thread_local char const* currentRegion = nullptr;
+
+dip::uint ThreadIdentifier() {
+   static std::atomic< dip::uint > counter{ 0 };
+   thread_local dip::uint id = counter++;
+   return id;
+}
+
+// Fills in the fields common to all events.
+void InitializeEvent( Event& event, char const* name ) {
+   event.name = name;
+   if( currentRegion ) {
+      event.caller = currentRegion;
+   }
+   event.thread = ThreadIdentifier();
+}
+
+// Adds the event to the log. Does not throw, if we cannot record the event, it is lost.
+void RecordEvent( Event&& event, Clock::time_point start, Clock::time_point end ) noexcept {
+   EventLog& log = Log();
+   std::lock_guard< std::mutex > guard( log.mutex );
+   if( log.events.size() >= maxEvents ) {
+      ++log.dropped;
+      return;
+   }
+   event.start = std::chrono::duration< double >( start - log.origin ).count();
+   event.duration = std::chrono::duration< double >( end - start ).count();
+   try {
+      log.events.push_back( std::move( event ));
+   } catch( ... ) {
+      ++log.dropped;
+   }
+}
+
+void WriteJsonString( std::ostream& os, String const& string ) {
+   os << '"';
+   for( char c : string ) {
+      if(( c == '"' ) || ( c == '\\' )) {
+         os << '\\' << c;
+      } else if( static_cast< unsigned char >( c ) < 0x20 ) {
+         os << ' ';
+      } else {
+         os << c;
+      }
+   }
+   os << '"';
+}
+
+void WriteJsonArray( std::ostream& os, UnsignedArray const& array ) {
+   os << '[';
+   for( dip::uint ii = 0; ii < array.size(); ++ii ) {
+      os << ( ii == 0 ? "" : "," ) << array[ ii ];
+   }
+   os << ']';
+}
+
+void WriteJsonArray( std::ostream& os, DataTypeArray const& array ) {
+   os << '[';
+   for( dip::uint ii = 0; ii < array.size(); ++ii ) {
+      os << ( ii == 0 ? "\"" : ",\"" ) << array[ ii ].Name() << '"';
+   }
+   os << ']';
+}
+
+bool IsFrameworkEvent( Event const& event ) {
+   return event.name.compare( 0, 16, "dip::Framework::" ) == 0;
+}
+
+} // namespace
+
+void Enable( bool enable ) {
+   if( enable ) {
+      EventLog& log = Log();
+      std::lock_guard< std::mutex > guard( log.mutex );
+      if( !log.hasOrigin ) {
+         log.origin = Clock::now();
+         log.hasOrigin = true;
+      }
+   }
+   enabled = enable;
+}
+
+bool IsEnabled() {
+   return enabled;
+}
+
+void Clear() {
+   EventLog& log = Log();
+   std::lock_guard< std::mutex > guard( log.mutex );
+   log.events.clear();
+   log.dropped = 0;
+   log.origin = Clock::now();
+   log.hasOrigin = true;
+}
+
+std::vector< Event > Events() {
+   EventLog& log = Log();
+   std::lock_guard< std::mutex > guard( log.mutex );
+   return log.events;
+}
+
+String Report() {
+   struct Summary {
+      dip::uint calls = 0;
+      double duration = 0;
+      double conversionTime = 0;
+      double filterTime = 0;
+      dip::uint threads = 0;
+      dip::uint bytes = 0;
+   };
+   std::map< std::pair< String, String >, Summary > summaries;
+   dip::uint dropped = 0;
+   {
+      EventLog& log = Log();
+      std::lock_guard< std::mutex > guard( log.mutex );
+      for( auto const& event : log.events ) {
+         Summary& summary = summaries[ std::make_pair( event.name, event.caller ) ];
+         ++summary.calls;
+         summary.duration += event.duration;
+         summary.conversionTime += event.conversionTime;
+         summary.filterTime += event.filterTime;
+         summary.threads += event.nThreads;
+         summary.bytes += event.bytes;
+      }
+      dropped = log.dropped;
+   }
+   // Sort by total duration, longest first
+   std::vector< std::pair< std::pair< String, String >, Summary >> rows( summaries.begin(), summaries.end() );
+   std::stable_sort( rows.begin(), rows.end(), []( auto const& a, auto const& b ) {
+      return a.second.duration > b.second.duration;
+   } );
+   dip::uint nameWidth = 4;
+   dip::uint callerWidth = 6;
+   for( auto const& row : rows ) {
+      nameWidth = std::max( nameWidth, row.first.first.size() );
+      callerWidth = std::max( callerWidth, row.first.second.size() );
+   }
+   std::ostringstream os;
+   os << std::left << std::setw( static_cast< int >( nameWidth )) << "name" << "  "
+      << std::setw( static_cast< int >( callerWidth )) << "caller" << std::right
+      << std::setw( 8 ) << "calls"
+      << std::setw( 13 ) << "total (ms)"
+      << std::setw( 13 ) << "convert (ms)"
+      << std::setw( 13 ) << "filter (ms)"
+      << std::setw( 9 ) << "threads"
+      << std::setw( 9 ) << "GB/s" << '\n';
+   os << std::fixed;
+   for( auto const& row : rows ) {
+      Summary const& summary = row.second;
+      os << std::left << std::setw( static_cast< int >( nameWidth )) << row.first.first << "  "
+         << std::setw( static_cast< int >( callerWidth )) << row.first.second << std::right
+         << std::setw( 8 ) << summary.calls
+         << std::setprecision( 3 )
+         << std::setw( 13 ) << summary.duration * 1e3
+         << std::setw( 13 ) << summary.conversionTime * 1e3
+         << std::setw( 13 ) << summary.filterTime * 1e3
+         << std::setprecision( 1 )
+         << std::setw( 9 ) << static_cast< double >( summary.threads ) / static_cast< double >( summary.calls )
+         << std::setprecision( 2 )
+         << std::setw( 9 ) << ( summary.duration > 0 ? static_cast< double >( summary.bytes ) / summary.duration * 1e-9 : 0.0 )
+         << '\n';
+   }
+   if( dropped > 0 ) {
+      os << dropped << " events were not recorded because the log was full\n";
+   }
+   return os.str();
+}
+
+String ChromeTrace() {
+   std::ostringstream os;
+   os << std::fixed << std::setprecision( 3 );
+   os << "{\"traceEvents\":[";
+   {
+      EventLog& log = Log();
+      std::lock_guard< std::mutex > guard( log.mutex );
+      bool first = true;
+      for( auto const& event : log.events ) {
+         os << ( first ? "\n" : ",\n" );
+         first = false;
+         // Times are in microseconds
+         os << "{\"name\":";
+         WriteJsonString( os, event.name );
+         os << ",\"cat\":\"" << ( IsFrameworkEvent( event ) ? "framework" : "algorithm" ) << '"'
+            << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+            << ",\"ts\":" << event.start * 1e6
+            << ",\"dur\":" << event.duration * 1e6
+            << ",\"args\":{\"caller\":";
+         WriteJsonString( os, event.caller );
+         os << ",\"sizes\":";
+         WriteJsonArray( os, event.sizes );
+         os << ",\"tensorElements\":" << event.tensorElements;
+         os << ",\"inImageTypes\":";
+         WriteJsonArray( os, event.inImageTypes );
+         if( IsFrameworkEvent( event )) {
+            os << ",\"inBufferTypes\":";
+            WriteJsonArray( os, event.inBufferTypes );
+            os << ",\"outBufferTypes\":";
+            WriteJsonArray( os, event.outBufferTypes );
+            os << ",\"outImageTypes\":";
+            WriteJsonArray( os, event.outImageTypes );
+            os << ",\"nThreads\":" << event.nThreads
+               << ",\"operations\":" << event.operations
+               << ",\"lines\":" << event.lines
+               << ",\"bytes\":" << event.bytes
+               << ",\"conversionTime\":" << event.conversionTime * 1e6
+               << ",\"filterTime\":" << event.filterTime * 1e6;
+         }
+         os << "}}";
+      }
+   }
+   os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+   return os.str();
+}
+
+void WriteChromeTrace( String const& filename ) {
+   std::ofstream file( filename, std::ios_base::trunc );
+   DIP_THROW_IF( !file.is_open(), "Could not open file for writing" );
+   file << ChromeTrace();
+}
+
+Region::Region( char const* name ) {
+   if( enabled ) {
+      event_ = std::make_unique< Event >();
+      InitializeEvent( *event_, name );
+      parent_ = currentRegion;
+      currentRegion = name;
+      start_ = Clock::now();
+   }
+}
+
+Region::Region( char const* name, Image const& image ) : Region( name ) {
+   if( event_ && image.IsForged() ) {
+      event_->sizes = image.Sizes();
+      event_->tensorElements = image.TensorElements();
+      event_->inImageTypes.push_back( image.DataType() );
+   }
+}
+
+Region::~Region() {
+   if( event_ ) {
+      currentRegion = parent_;
+      RecordEvent( std::move( *event_ ), start_, Clock::now() );
+   }
+}
+
+} // namespace profiling
+
+namespace Framework {
+
+FrameworkProfiler::FrameworkProfiler( char const* name, std::type_info const& lineFilter ) {
+   record_ = profiling::enabled;
+   learn_ = IsLearningThreadingCosts();
+   if( record_ || learn_ ) {
+      event_ = std::make_unique< profiling::Event >();
+      profiling::InitializeEvent( *event_, name );
+      lineFilter_ = lineFilter.name();
+      event_->lineFilter = lineFilter_;
+      start_ = profiling::Clock::now();
+   }
+}
+
+FrameworkProfiler::~FrameworkProfiler() {
+   if( learn_ ) {
+      try {
+         LearnThreadingCost( lineFilter_, event_->operations, event_->filterTime );
+      } catch( ... ) {}
+   }
+   if( record_ ) {
+      profiling::RecordEvent( std::move( *event_ ), start_, profiling::Clock::now() );
+   }
+}
+
+void FrameworkProfiler::AddInput( Image const& image, DataType bufferType ) {
+   if( event_ ) {
+      if( event_->inImageTypes.empty() && event_->outImageTypes.empty() ) {
+         event_->sizes = image.Sizes();
+         event_->tensorElements = image.TensorElements();
+      }
+      event_->inImageTypes.push_back( image.DataType() );
+      event_->inBufferTypes.push_back( bufferType );
+   }
+}
+
+void FrameworkProfiler::AddOutput( Image const& image, DataType bufferType ) {
+   if( event_ ) {
+      if( event_->inImageTypes.empty() && event_->outImageTypes.empty() ) {
+         event_->sizes = image.Sizes();
+         event_->tensorElements = image.TensorElements();
+      }
+      event_->outImageTypes.push_back( image.DataType() );
+      event_->outBufferTypes.push_back( bufferType );
+   }
+}
+
+void FrameworkProfiler::AddTimes( LineTimer const& timer ) {
+   if( event_ ) {
+      std::lock_guard< std::mutex > guard( mutex_ );
+      event_->conversionTime += timer.ConversionTime();
+      event_->filterTime += timer.FilterTime();
+   }
+}
+
+} // namespace Framework
+
+} // namespace dip
+
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/math.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing the profiling instrumentation" ) {
+   dip::Image in( { 200, 100 }, 1, dip::DT_UINT8 );
+   in.Fill( 3 );
+   dip::Image out;
+   dip::profiling::Clear();
+   dip::Add( in, in, out, dip::DT_SFLOAT ); // not recorded
+   DOCTEST_CHECK( dip::profiling::Events().empty() );
+   dip::profiling::Enable();
+   {
+      dip::profiling::Region region( "test region", in );
+      dip::Add( in, in, out, dip::DT_SFLOAT );
+   }
+   dip::profiling::Enable( false );
+   auto events = dip::profiling::Events();
+   DOCTEST_REQUIRE( events.size() == 2 );
+   // The framework call completes first
+   DOCTEST_CHECK( events[ 0 ].name == "dip::Framework::Scan" );
+   DOCTEST_CHECK( events[ 0 ].caller == "test region" );
+   DOCTEST_CHECK( events[ 0 ].sizes == dip::UnsignedArray{ 200, 100 } );
+   DOCTEST_REQUIRE( events[ 0 ].inImageTypes.size() == 2 );
+   DOCTEST_CHECK( events[ 0 ].inImageTypes[ 0 ] == dip::DT_UINT8 );
+   DOCTEST_CHECK( events[ 0 ].inBufferTypes[ 0 ] == dip::DT_SFLOAT );
+   DOCTEST_REQUIRE( events[ 0 ].outImageTypes.size() == 1 );
+   DOCTEST_CHECK( events[ 0 ].outImageTypes[ 0 ] == dip::DT_SFLOAT );
+   DOCTEST_CHECK( events[ 0 ].bytes == 200 * 100 * ( 1 + 1 + 4 ));
+   DOCTEST_CHECK( events[ 0 ].nThreads >= 1 );
+   DOCTEST_CHECK( events[ 0 ].conversionTime + events[ 0 ].filterTime <= events[ 0 ].duration * static_cast< double >( events[ 0 ].nThreads ));
+   DOCTEST_CHECK( events[ 1 ].name == "test region" );
+   DOCTEST_CHECK( events[ 1 ].caller.empty() );
+   DOCTEST_CHECK( events[ 1 ].start <= events[ 0 ].start );
+   DOCTEST_CHECK( events[ 1 ].duration >= events[ 0 ].duration );
+   dip::String trace = dip::profiling::ChromeTrace();
+   DOCTEST_CHECK( trace.find( "\"name\":\"dip::Framework::Scan\",\"cat\":\"framework\"" ) != dip::String::npos );
+   DOCTEST_CHECK( trace.find( "\"caller\":\"test region\"" ) != dip::String::npos );
+   dip::String report = dip::profiling::Report();
+   DOCTEST_CHECK( report.find( "dip::Framework::Scan  test region" ) != dip::String::npos );
+   dip::profiling::Clear();
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -31,6 +31,7 @@
 #include "diplib/kernel.h"
 #include "diplib/overload.h"
 #include "diplib/pixel_table.h"
+#include "diplib/profiling.h"
 #include "diplib/transform.h"
 
 namespace dip {
@@ -324,6 +325,7 @@ void SeparableConvolution(
       BooleanArray process
 ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   profiling::Region region( "dip::SeparableConvolution", in );
    dip::uint nDims = in.Dimensionality();
    DIP_THROW_IF( nDims < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
    DIP_THROW_IF(( filterArray.size() != 1 ) && ( filterArray.size() != nDims ), E::ARRAY_PARAMETER_WRONG_LENGTH );
@@ -433,6 +435,7 @@ void ConvolveFT(
    // Test inputs
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !filter.IsForged(), E::IMAGE_NOT_FORGED );
+   profiling::Region region( "dip::ConvolveFT", in );
    bool inSpatial{};
    DIP_STACK_TRACE_THIS( inSpatial = BooleanFromString( inRepresentation, S::SPATIAL, S::FREQUENCY ));
    bool filterSpatial{};
@@ -451,6 +454,13 @@ void ConvolveFT(
    bool inPadding = ( inSpatial && filterSpatial && outSpatial && !boundaryCondition.empty() );
    UnsignedArray const& inSizes = in.Sizes();
    bool real = true;
+   // If all of the computation happens here, and the inputs are real-valued, we compute only half the spectrum
+   bool half = inSpatial && filterSpatial && outSpatial && in.DataType().IsReal() && filter.DataType().IsReal();
+   StringSet forwardOptions;
+   if( half ) {
+      forwardOptions.insert( S::HALF );
+   }
+   UnsignedArray ftSizes = inSizes; // sizes of the full spectrum
    Image inFT;
    bool reuseInFT = false;
    if( inSpatial ) {
@@ -458,14 +468,13 @@ void ConvolveFT(
       dip::String purpose = real ? S::COMPLEX : S::REAL;
       if( inPadding ) {
          // Pad the input image with at least the size of `filter`, but make it larger so it's a nice size
-         UnsignedArray sizes = inSizes;
-         for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
-            sizes[ ii ] = OptimalFourierTransformSize( sizes[ ii ] + filter.Size( ii ) - 1, S::LARGER, purpose );
+         for( dip::uint ii = 0; ii < ftSizes.size(); ++ii ) {
+            ftSizes[ ii ] = OptimalFourierTransformSize( ftSizes[ ii ] + filter.Size( ii ) - 1, S::LARGER, purpose );
          }
-         ExtendImageToSize( in, inFT, sizes, S::CENTER, boundaryCondition );
-         DIP_STACK_TRACE_THIS( FourierTransform( inFT, inFT ));
+         ExtendImageToSize( in, inFT, ftSizes, S::CENTER, boundaryCondition );
+         DIP_STACK_TRACE_THIS( FourierTransform( inFT, inFT, forwardOptions ));
       } else {
-         DIP_STACK_TRACE_THIS( FourierTransform( in, inFT ));
+         DIP_STACK_TRACE_THIS( FourierTransform( in, inFT, forwardOptions ));
       }
       reuseInFT = true;
    } else {
@@ -475,17 +484,17 @@ void ConvolveFT(
 
    // Prepare filter image
    bool reuseFilterFT = false;
-   if( filterFT.Sizes() < inFT.Sizes() ) {
-      filterFT = filterFT.Pad( inFT.Sizes(), { 0 }, Option::CropLocation::CENTER );
+   if( filterFT.Sizes() < ftSizes ) {
+      filterFT = filterFT.Pad( ftSizes, { 0 }, Option::CropLocation::CENTER );
       reuseFilterFT = true;
    }
    if( filterSpatial ) {
       real &= filterFT.DataType().IsReal();
       if( reuseFilterFT ) {
-         DIP_STACK_TRACE_THIS( FourierTransform( filterFT, filterFT ));
+         DIP_STACK_TRACE_THIS( FourierTransform( filterFT, filterFT, forwardOptions ));
       } else {
          Image tmp;
-         DIP_STACK_TRACE_THIS( FourierTransform( filterFT, tmp ));
+         DIP_STACK_TRACE_THIS( FourierTransform( filterFT, tmp, forwardOptions ));
          filterFT.swap( tmp );
          reuseFilterFT = true;
       }
@@ -517,10 +526,18 @@ void ConvolveFT(
       }
       if( inPadding ) {
          Image tmp;
-         DIP_STACK_TRACE_THIS( FourierTransform( outFT, tmp, options ));
+         if( half ) {
+            DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( outFT, tmp, ftSizes ));
+         } else {
+            DIP_STACK_TRACE_THIS( FourierTransform( outFT, tmp, options ));
+         }
          out = tmp.Crop( inSizes, Option::CropLocation::CENTER ); // copies if `out` is protected
       } else {
-         DIP_STACK_TRACE_THIS( FourierTransform( outFT, out, options ));
+         if( half ) {
+            DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( outFT, out, ftSizes ));
+         } else {
+            DIP_STACK_TRACE_THIS( FourierTransform( outFT, out, options ));
+         }
       }
    }
 }
@@ -532,32 +549,22 @@ template< typename TPI >
 class GeneralConvolutionLineFilter : public Framework::FullLineFilter {
    public:
       void SetNumberOfThreads( dip::uint /*threads*/, PixelTableOffsets const& pixelTable ) override {
-         offsets_ = pixelTable.Offsets();
+         std::vector< dfloat > const& weights = pixelTable.Weights();
+         weights_.resize( weights.size() );
+         std::transform( weights.begin(), weights.end(), weights_.begin(), []( dfloat w ) { return static_cast< FloatType< TPI >>( w ); } );
+      }
+      dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint /*nTensorElements*/, dip::uint nKernelPixels, dip::uint nRuns ) override {
+         return lineLength * nKernelPixels         // number of multiply-adds
+                + lineLength + nKernelPixels + nRuns;
       }
       void Filter( Framework::FullLineFilterParameters const& params ) override {
-         TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
-         dip::sint inStride = params.inBuffer.stride;
-         TPI* out = static_cast< TPI* >( params.outBuffer.buffer );
-         dip::sint outStride = params.outBuffer.stride;
-         dip::uint length = params.bufferLength;
-         PixelTableOffsets const& pixelTable = params.pixelTable;
-         std::vector< dfloat > const& weights = pixelTable.Weights();
-         for( dip::uint ii = 0; ii < length; ++ii ) {
-            TPI sum = 0;
-            auto ito = offsets_.begin();
-            auto itw = weights.begin();
-            while( ito != offsets_.end() ) {
-               sum += in[ *ito ] * static_cast< FloatType< TPI >>( *itw );
-               ++ito;
-               ++itw;
-            }
-            *out = sum;
-            in += inStride;
-            out += outStride;
-         }
+         params.pixelTable.WeightedSum(
+               static_cast< TPI const* >( params.inBuffer.buffer ), params.inBuffer.stride,
+               static_cast< TPI* >( params.outBuffer.buffer ), params.outBuffer.stride,
+               params.bufferLength, weights_.data() );
       }
    private:
-      std::vector< dip::sint > offsets_;
+      std::vector< FloatType< TPI >> weights_;
 };
 
 template< typename TPI >
@@ -565,32 +572,22 @@ class GeneralConvolutionLineFilterComplex : public Framework::FullLineFilter {
       // Idem as above, but for complex kernel weights. TPI is guaranteed a complex type
    public:
       void SetNumberOfThreads( dip::uint /*threads*/, PixelTableOffsets const& pixelTable ) override {
-         offsets_ = pixelTable.Offsets();
+         dcomplex const* weights = reinterpret_cast< dcomplex const* >( pixelTable.Weights().data() );
+         weights_.resize( pixelTable.NumberOfPixels() );
+         std::transform( weights, weights + weights_.size(), weights_.begin(), []( dcomplex w ) { return static_cast< TPI >( w ); } );
+      }
+      dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint /*nTensorElements*/, dip::uint nKernelPixels, dip::uint nRuns ) override {
+         return lineLength * nKernelPixels         // number of multiply-adds
+                + lineLength + nKernelPixels + nRuns;
       }
       void Filter( Framework::FullLineFilterParameters const& params ) override {
-         TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
-         dip::sint inStride = params.inBuffer.stride;
-         TPI* out = static_cast< TPI* >( params.outBuffer.buffer );
-         dip::sint outStride = params.outBuffer.stride;
-         dip::uint length = params.bufferLength;
-         PixelTableOffsets const& pixelTable = params.pixelTable;
-         std::vector< dfloat > const& weights = pixelTable.Weights();
-         for( dip::uint ii = 0; ii < length; ++ii ) {
-            TPI sum = 0;
-            auto ito = offsets_.begin();
-            dcomplex const* itw = reinterpret_cast< dcomplex const* >( weights.data() );
-            while( ito != offsets_.end() ) {
-               sum += in[ *ito ] * static_cast< TPI >( *itw );
-               ++ito;
-               ++itw;
-            }
-            *out = sum;
-            in += inStride;
-            out += outStride;
-         }
+         params.pixelTable.WeightedSum(
+               static_cast< TPI const* >( params.inBuffer.buffer ), params.inBuffer.stride,
+               static_cast< TPI* >( params.outBuffer.buffer ), params.outBuffer.stride,
+               params.bufferLength, weights_.data() );
       }
    private:
-      std::vector< dip::sint > offsets_;
+      std::vector< TPI > weights_;
 };
 
 } // namespace
@@ -603,6 +600,7 @@ void GeneralConvolution(
 ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !c_filter.IsForged(), E::IMAGE_NOT_FORGED );
+   profiling::Region region( "dip::GeneralConvolution", in );
    DIP_START_STACK_TRACE
       Kernel filter{ c_filter };
       filter.Mirror();
@@ -22,6 +22,7 @@
 #include "diplib.h"
 #include "diplib/generic_iterators.h"
 #include "diplib/math.h"
+#include "diplib/profiling.h"
 
 namespace dip {
 
@@ -68,6 +69,7 @@ void Gauss(
       StringArray const& boundaryCondition,
       dfloat truncation
 ) {
+   profiling::Region region( "dip::Gauss", in );
    String method = ( c_method.substr( 0, 5 ) == GAUSS ) ? c_method.substr( 5, String::npos ) : c_method;
    if( method == S::BEST ) {
       method = BestGaussMethod( sigmas, derivativeOrder );
@@ -442,13 +442,21 @@ void GaussFT(
       DIP_END_STACK_TRACE
    }
    bool real = false;
+   bool half = false; // if true, we compute only half of the spectrum
+   UnsignedArray ftSizes = in.Sizes(); // sizes of the full spectrum
    Image inFT;
    bool reuseInFT = false;
    if( inSpatial ) {
       real = !in.DataType().IsComplex();
+      half = real && outSpatial;
       expanded = !boundaryCondition.empty();
       dip::Image const& tmp = expanded ? ExpandInput( in, sigmas, order, truncation, boundaryCondition ) : in;
-      DIP_STACK_TRACE_THIS( inFT = FourierTransform( tmp ));
+      ftSizes = tmp.Sizes();
+      StringSet options;
+      if( half ) {
+         options.insert( S::HALF );
+      }
+      DIP_STACK_TRACE_THIS( inFT = FourierTransform( tmp, options ));
       reuseInFT = true;
    } else {
       inFT = in.QuickCopy();
@@ -465,7 +473,8 @@ void GaussFT(
       } // else outFT will be a new temporary
    }
    std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
-   DIP_OVL_NEW_COMPLEX( scanLineFilter, GaussFTLineFilter, ( inFT.Sizes(), sigmas, order, truncation ), dtype );
+   // For a half spectrum, the coordinates in `inFT` are those of the first half of the full spectrum
+   DIP_OVL_NEW_COMPLEX( scanLineFilter, GaussFTLineFilter, ( ftSizes, sigmas, order, truncation ), dtype );
    Framework::ScanMonadic(
          inFT, outFT, dtype, dtype, 1, *scanLineFilter,
          Framework::ScanOption::TensorAsSpatialDim + Framework::ScanOption::NeedCoordinates );
@@ -476,10 +485,18 @@ void GaussFT(
       }
       if( expanded ) {
          dip::Image tmp;
-         DIP_STACK_TRACE_THIS( FourierTransform( outFT, tmp, options ));
+         if( half ) {
+            DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( outFT, tmp, ftSizes ));
+         } else {
+            DIP_STACK_TRACE_THIS( FourierTransform( outFT, tmp, options ));
+         }
          out = tmp.Crop( originalSizes );
       } else {
-         DIP_STACK_TRACE_THIS( FourierTransform( outFT, out, options ));
+         if( half ) {
+            DIP_STACK_TRACE_THIS( InverseHalfFourierTransform( outFT, out, ftSizes ));
+         } else {
+            DIP_STACK_TRACE_THIS( FourierTransform( outFT, out, options ));
+         }
       }
    } else {
       out.SetPixelSize( inFT.PixelSize() );
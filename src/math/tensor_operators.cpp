@@ -525,6 +525,221 @@ void Rank( Image const& in, Image& out ) {
                                           Framework::ScanOption::ExpandTensorInBuffer ));
 }
 
+namespace {
+
+// Sorts the three values by decreasing magnitude. The input must be sorted by increasing value;
+// values with the same magnitude keep this order. This is the order produced by `SymmetricEigenDecomposition3`.
+void SortByMagnitude( dfloat& l0, dfloat& l1, dfloat& l2 ) {
+   if( std::abs( l1 ) > std::abs( l0 )) {
+      std::swap( l0, l1 );
+   }
+   if( std::abs( l2 ) > std::abs( l1 )) {
+      std::swap( l1, l2 );
+      if( std::abs( l1 ) > std::abs( l0 )) {
+         std::swap( l0, l1 );
+      }
+   }
+}
+
+// Eigenvalues of the symmetric 2x2 matrix [ xx, xy ; xy, yy ], sorted by decreasing magnitude.
+// This closed form is as precise as the QR algorithm, the discriminant is a sum of squares.
+void SymmetricEigenvalues2( dfloat xx, dfloat yy, dfloat xy, dfloat* lambdas ) {
+   dfloat mean = ( xx + yy ) / 2;
+   dfloat diff = ( xx - yy ) / 2;
+   dfloat radius = std::sqrt( diff * diff + xy * xy );
+   lambdas[ 0 ] = mean - radius;
+   lambdas[ 1 ] = mean + radius;
+   if( std::abs( lambdas[ 1 ] ) > std::abs( lambdas[ 0 ] )) {
+      std::swap( lambdas[ 0 ], lambdas[ 1 ] );
+   }
+}
+
+// Eigenvalues of the symmetric 3x3 matrix [ xx, xy, xz ; xy, yy, yz ; xz, yz, zz ], unsorted. Reduces the matrix
+// to tridiagonal form with a Householder reflection, then applies the implicit QL algorithm.
+void SymmetricEigenvalues3QL( dfloat xx, dfloat yy, dfloat zz, dfloat xy, dfloat xz, dfloat yz, dfloat* w ) {
+   // Householder reflection that zeros `xz`
+   dfloat e[ 3 ];
+   dfloat h = xy * xy + xz * xz;
+   dfloat g = xy > 0 ? -std::sqrt( h ) : std::sqrt( h );
+   e[ 0 ] = g;
+   dfloat omega = h - g * xy;
+   if( omega > 0 ) {
+      omega = 1 / omega;
+      dfloat u1 = xy - g;
+      dfloat u2 = xz;
+      dfloat f1 = yy * u1 + yz * u2;
+      dfloat f2 = yz * u1 + zz * u2;
+      dfloat k = ( u1 * f1 + u2 * f2 ) * 0.5 * omega * omega;
+      dfloat q1 = omega * f1 - k * u1;
+      dfloat q2 = omega * f2 - k * u2;
+      w[ 0 ] = xx;
+      w[ 1 ] = yy - 2 * q1 * u1;
+      w[ 2 ] = zz - 2 * q2 * u2;
+      e[ 1 ] = yz - q1 * u2 - u1 * q2;
+   } else {
+      w[ 0 ] = xx;
+      w[ 1 ] = yy;
+      w[ 2 ] = zz;
+      e[ 1 ] = yz;
+   }
+   e[ 2 ] = 0;
+   // Implicit QL iterations with Wilkinson shift
+   for( dip::uint l = 0; l < 2; ++l ) {
+      for( dip::uint iter = 0; iter < 30; ++iter ) {
+         dip::uint m = l;
+         for( ; m < 2; ++m ) {
+            dfloat d = std::abs( w[ m ] ) + std::abs( w[ m + 1 ] );
+            if( std::abs( e[ m ] ) + d == d ) {
+               break;
+            }
+         }
+         if( m == l ) {
+            break;
+         }
+         g = ( w[ l + 1 ] - w[ l ] ) / ( 2 * e[ l ] );
+         dfloat r = std::sqrt( g * g + 1 );
+         g = w[ m ] - w[ l ] + e[ l ] / ( g > 0 ? g + r : g - r );
+         dfloat s = 1;
+         dfloat c = 1;
+         dfloat p = 0;
+         for( dip::uint i = m; i > l; ) {
+            --i;
+            dfloat f = s * e[ i ];
+            dfloat b = c * e[ i ];
+            if( std::abs( f ) > std::abs( g )) {
+               c = g / f;
+               r = std::sqrt( c * c + 1 );
+               e[ i + 1 ] = f * r;
+               s = 1 / r;
+               c *= s;
+            } else {
+               s = f / g;
+               r = std::sqrt( s * s + 1 );
+               e[ i + 1 ] = g * r;
+               c = 1 / r;
+               s *= c;
+            }
+            g = w[ i + 1 ] - p;
+            r = ( w[ i ] - g ) * s + 2 * c * b;
+            p = s * r;
+            w[ i + 1 ] = g + p;
+            g = c * r - b;
+         }
+         w[ l ] -= p;
+         e[ l ] = g;
+         e[ m ] = 0;
+      }
+   }
+}
+
+// Eigenvalues of the symmetric 3x3 matrix [ xx, xy, xz ; xy, yy, yz ; xz, yz, zz ], sorted by decreasing magnitude.
+// Uses the trigonometric solution to the characteristic polynomial. This solution loses precision when two
+// eigenvalues are nearly equal; with `method == PRECISE` we fall back to the QL algorithm for those matrices.
+void SymmetricEigenvalues3(
+      dfloat xx, dfloat yy, dfloat zz, dfloat xy, dfloat xz, dfloat yz,
+      dfloat* lambdas,
+      Option::DecompositionMethod method
+) {
+   dfloat q = ( xx + yy + zz ) / 3;
+   dfloat bxx = xx - q;
+   dfloat byy = yy - q;
+   dfloat bzz = zz - q;
+   dfloat p2 = bxx * bxx + byy * byy + bzz * bzz + 2 * ( xy * xy + xz * xz + yz * yz );
+   if( p2 == 0 ) {
+      lambdas[ 0 ] = lambdas[ 1 ] = lambdas[ 2 ] = q;
+      return;
+   }
+   dfloat p = std::sqrt( p2 / 6 );
+   dfloat det = bxx * ( byy * bzz - yz * yz ) - xy * ( xy * bzz - yz * xz ) + xz * ( xy * yz - byy * xz );
+   dfloat r = clamp( det / ( 2 * p * p * p ), -1.0, 1.0 );
+   if(( method == Option::DecompositionMethod::PRECISE ) && ( 1 - std::abs( r ) < 0.01 )) {
+      SymmetricEigenvalues3QL( xx, yy, zz, xy, xz, yz, lambdas );
+      std::sort( lambdas, lambdas + 3 );
+   } else {
+      dfloat phi = std::acos( r ) / 3;
+      lambdas[ 2 ] = q + 2 * p * std::cos( phi );
+      lambdas[ 0 ] = q + 2 * p * std::cos( phi + 2 * pi / 3 );
+      lambdas[ 1 ] = 3 * q - lambdas[ 0 ] - lambdas[ 2 ];
+   }
+   SortByMagnitude( lambdas[ 0 ], lambdas[ 1 ], lambdas[ 2 ] );
+}
+
+enum class EigenvalueSelection : uint8 { ALL, LARGEST, SMALLEST };
+
+// Computes the eigenvalues of 2x2 and 3x3 symmetric matrices, reading the packed tensor storage directly.
+template< typename TPI, dip::uint N >
+class SymmetricEigenvaluesLineFilter : public Framework::ScanLineFilter {
+   public:
+      SymmetricEigenvaluesLineFilter( Option::DecompositionMethod method, EigenvalueSelection selection ) :
+            method_( method ), selection_( selection ) {}
+      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override {
+         return N == 2 ? 20 : 100;
+      }
+      void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dip::uint const bufferLength = params.bufferLength;
+         TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint const inStride = params.inBuffer[ 0 ].stride;
+         dip::sint const inTStride = params.inBuffer[ 0 ].tensorStride;
+         DIP_ASSERT( params.inBuffer[ 0 ].tensorLength == N * ( N + 1 ) / 2 );
+         TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
+         dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         dip::sint const outTStride = params.outBuffer[ 0 ].tensorStride;
+         dfloat lambdas[ N ];
+         for( dip::uint ii = 0; ii < bufferLength; ++ii, in += inStride, out += outStride ) {
+            if( N == 2 ) {
+               SymmetricEigenvalues2( in[ 0 ], in[ inTStride ], in[ 2 * inTStride ], lambdas );
+            } else {
+               SymmetricEigenvalues3( in[ 0 ], in[ inTStride ], in[ 2 * inTStride ],
+                                      in[ 3 * inTStride ], in[ 4 * inTStride ], in[ 5 * inTStride ], lambdas, method_ );
+            }
+            switch( selection_ ) {
+               case EigenvalueSelection::ALL:
+                  for( dip::uint jj = 0; jj < N; ++jj ) {
+                     out[ static_cast< dip::sint >( jj ) * outTStride ] = static_cast< TPI >( lambdas[ jj ] );
+                  }
+                  break;
+               case EigenvalueSelection::LARGEST:
+                  *out = static_cast< TPI >( lambdas[ 0 ] );
+                  break;
+               case EigenvalueSelection::SMALLEST:
+                  *out = static_cast< TPI >( lambdas[ N - 1 ] );
+                  break;
+            }
+         }
+      }
+   private:
+      Option::DecompositionMethod method_;
+      EigenvalueSelection selection_;
+};
+
+// Computes the eigenvalues of a 2x2 or 3x3 symmetric, real-valued tensor image, or only the largest or smallest
+// eigenvalue. Computation is done in double precision, but the buffers are single precision if `in` is.
+void SymmetricEigenvalues( Image const& in, Image& out, Option::DecompositionMethod method, EigenvalueSelection selection ) {
+   dip::uint n = in.TensorRows();
+   DIP_ASSERT(( n == 2 ) || ( n == 3 ));
+   DataType outtype = DataType::SuggestFlex( in.DataType() );
+   DataType buffertype = outtype == DT_SFLOAT ? DT_SFLOAT : DT_DFLOAT;
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+   if( buffertype == DT_SFLOAT ) {
+      if( n == 2 ) {
+         scanLineFilter = std::make_unique< SymmetricEigenvaluesLineFilter< sfloat, 2 >>( method, selection );
+      } else {
+         scanLineFilter = std::make_unique< SymmetricEigenvaluesLineFilter< sfloat, 3 >>( method, selection );
+      }
+   } else {
+      if( n == 2 ) {
+         scanLineFilter = std::make_unique< SymmetricEigenvaluesLineFilter< dfloat, 2 >>( method, selection );
+      } else {
+         scanLineFilter = std::make_unique< SymmetricEigenvaluesLineFilter< dfloat, 3 >>( method, selection );
+      }
+   }
+   dip::uint nOut = selection == EigenvalueSelection::ALL ? n : 1;
+   ImageRefArray outar{ out };
+   DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { buffertype }, { buffertype }, { outtype }, { nOut }, *scanLineFilter ));
+}
+
+} // namespace
+
 void Eigenvalues( Image const& in, Image& out, String const& method ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.Tensor().IsSquare(), E::IMAGE_NOT_SQUARE_MATRIX );
@@ -544,24 +759,13 @@ void Eigenvalues( Image const& in, Image& out, String const& method ) {
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         dip::uint cost = precise ? 400 * n : 60 * n; // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-         switch( n ) {
-            case 2:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     [ m ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition2( pin, pout, nullptr, m ); }, cost
-               );
-               break;
-            case 3:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     [ m ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition3( pin, pout, nullptr, m ); }, cost
-               );
-               break;
-            default:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n
-               );
-               break;
+         if(( n == 2 ) || ( n == 3 )) {
+            DIP_STACK_TRACE_THIS( SymmetricEigenvalues( in, out, m, EigenvalueSelection::ALL ));
+            return;
          }
+         scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+               [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n
+         );
          inbuffertype = outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
       } else {
@@ -636,50 +840,6 @@ class SelectEigenvalueLineFilter : public Framework::ScanLineFilter {
       std::vector< std::vector< TPO >> buffers_; // one for each thread
 };
 
-template< typename TPI, typename TPO >
-class SelectEigenvalueLineFilterN : public Framework::ScanLineFilter {
-   using funcType = void ( * )( ConstSampleIterator< TPI >, SampleIterator< TPO >, SampleIterator< TPO >, Option::DecompositionMethod );
-   public:
-      SelectEigenvalueLineFilterN( funcType function, dip::uint n, Option::DecompositionMethod method, bool first ) :
-         function_( function ), n_( n ), method_( method ), first_( first ) {}
-      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint tensorElements ) override {
-         return (( method_ == Option::DecompositionMethod::PRECISE ) ? 400 : 60 ) * tensorElements * (( typeid( TPI ) == typeid( dfloat )) ? 1 : 2 );
-         // NOTE: currently TPI is always dfloat here, but it could be dcomplex in the future (where the cost doubles).
-      }
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dip::uint const bufferLength = params.bufferLength;
-         ConstLineIterator< TPI > in(
-               static_cast< TPI const* >( params.inBuffer[ 0 ].buffer ),
-               bufferLength,
-               params.inBuffer[ 0 ].stride,
-               params.inBuffer[ 0 ].tensorLength,
-               params.inBuffer[ 0 ].tensorStride
-         );
-         LineIterator< TPO > out(
-               static_cast< TPO* >( params.outBuffer[ 0 ].buffer ),
-               bufferLength,
-               params.outBuffer[ 0 ].stride,
-               params.outBuffer[ 0 ].tensorLength, // == 1
-               params.outBuffer[ 0 ].tensorStride
-         );
-         std::array< TPO, 3 > buf{}; // NOTE!!! `function_` is either `SymmetricEigenDecomposition2` or `SymmetricEigenDecomposition3`
-         TPO* bufPtr = buf.data();
-         if( !first_ ) {
-            bufPtr += n_ - 1;
-         }
-         // Compute
-         do {
-            function_( in.begin(), buf.data(), nullptr, method_ );
-            *out = *bufPtr;
-         } while( ++in, ++out );
-      }
-   private:
-      funcType function_;
-      dip::uint n_;
-      Option::DecompositionMethod method_;
-      bool first_;
-};
-
 void SelectEigenvalue( Image const& in, Image& out, String const& method, bool first ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.Tensor().IsSquare(), E::IMAGE_NOT_SQUARE_MATRIX );
@@ -698,20 +858,12 @@ void SelectEigenvalue( Image const& in, Image& out, String const& method, bool f
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         switch( n ) {
-            case 2:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilterN< dfloat, dfloat >( &SymmetricEigenDecomposition2, 2, m, first ));
-               break;
-            case 3:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilterN< dfloat, dfloat >( &SymmetricEigenDecomposition3, 3, m, first ));
-               break;
-            default:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilter< dfloat, dfloat >( &SymmetricEigenDecomposition, n, first ));
-               break;
+         if(( n == 2 ) || ( n == 3 )) {
+            DIP_STACK_TRACE_THIS( SymmetricEigenvalues( in, out, m, first ? EigenvalueSelection::LARGEST : EigenvalueSelection::SMALLEST ));
+            return;
          }
+         scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
+               new SelectEigenvalueLineFilter< dfloat, dfloat >( &SymmetricEigenDecomposition, n, first ));
          inbuffertype = DT_DFLOAT;
          outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
@@ -1179,3 +1331,52 @@ void GeometricMeanTensorElement( Image const& in, Image& out ) {
 }
 
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::Eigenvalues for 2x2 and 3x3 symmetric matrices") {
+   // Matrices in packed storage: xx, yy, zz, xy, xz, yz; includes matrices with repeated eigenvalues
+   std::vector< std::array< dip::dfloat, 6 >> matrices{
+         {{ 3, 1.5, 1.5, 0, 0, -0.5 }},
+         {{ 2, 2, -5, 0, 0, 0 }},
+         {{ 1, 1, 2, 1, 0, 0 }},
+         {{ 4, 4, 4, 0, 0, 0 }},
+         {{ 0.3, -1.2, 2.5, 0.7, -0.4, 1.1 }},
+         {{ 1e6, 1e6 + 1e-3, 1e6, 1e-4, 0, 2e-4 }},
+   };
+   dip::Image in3( { matrices.size() }, 6, dip::DT_DFLOAT );
+   in3.ReshapeTensor( dip::Tensor( dip::Tensor::Shape::SYMMETRIC_MATRIX, 3, 3 ));
+   dip::Image in2( { matrices.size() }, 3, dip::DT_DFLOAT );
+   in2.ReshapeTensor( dip::Tensor( dip::Tensor::Shape::SYMMETRIC_MATRIX, 2, 2 ));
+   for( dip::uint ii = 0; ii < matrices.size(); ++ii ) {
+      auto const& m = matrices[ ii ];
+      in3.At( ii ) = { m[ 0 ], m[ 1 ], m[ 2 ], m[ 3 ], m[ 4 ], m[ 5 ] };
+      in2.At( ii ) = { m[ 0 ], m[ 1 ], m[ 3 ] };
+   }
+   // Compare to the QR algorithm; the closed-form solution is less precise for repeated eigenvalues
+   for( auto method : { dip::S::PRECISE, dip::S::FAST } ) {
+      dip::dfloat epsilon = method == dip::S::PRECISE ? 1e-12 : 1e-7;
+      dip::Image out3 = dip::Eigenvalues( in3, method );
+      dip::Image out2 = dip::Eigenvalues( in2, method );
+      dip::Image largest = dip::LargestEigenvalue( in3, method );
+      dip::Image smallest = dip::SmallestEigenvalue( in2, method );
+      for( dip::uint ii = 0; ii < matrices.size(); ++ii ) {
+         auto const& m3 = matrices[ ii ];
+         dip::dfloat full[ 9 ] = { m3[ 0 ], m3[ 3 ], m3[ 4 ], m3[ 3 ], m3[ 1 ], m3[ 5 ], m3[ 4 ], m3[ 5 ], m3[ 2 ] };
+         dip::dfloat lambdas[ 3 ];
+         dip::SymmetricEigenDecomposition3( full, lambdas );
+         for( dip::uint jj = 0; jj < 3; ++jj ) {
+            DOCTEST_CHECK( out3.At( ii )[ jj ].As< dip::dfloat >() == doctest::Approx( lambdas[ jj ] ).epsilon( epsilon ).scale( std::abs( lambdas[ 0 ] )));
+         }
+         DOCTEST_CHECK( largest.At( ii ).As< dip::dfloat >() == out3.At( ii )[ 0 ].As< dip::dfloat >() );
+         dip::dfloat full2[ 4 ] = { m3[ 0 ], m3[ 3 ], m3[ 3 ], m3[ 1 ] };
+         dip::SymmetricEigenDecomposition2( full2, lambdas );
+         DOCTEST_CHECK( out2.At( ii )[ 0 ].As< dip::dfloat >() == doctest::Approx( lambdas[ 0 ] ));
+         DOCTEST_CHECK( out2.At( ii )[ 1 ].As< dip::dfloat >() == doctest::Approx( lambdas[ 1 ] ));
+         DOCTEST_CHECK( smallest.At( ii ).As< dip::dfloat >() == out2.At( ii )[ 1 ].As< dip::dfloat >() );
+      }
+   }
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -0,0 +1,249 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib/measurement.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "diplib.h"
+#include "diplib/accumulators.h"
+
+#include "../statistics/per_label_reduction.h"
+
+namespace dip {
+
+namespace {
+
+// Accumulator for `PerLabelReduction`: all the statistics for one object, for each tensor element.
+class ObjectStatisticsAccumulator {
+   public:
+      ObjectStatisticsAccumulator( dip::uint nTensor, bool keepValues )
+            : sum_( nTensor, 0.0 ), sumSquares_( nTensor, 0.0 ), variance_( nTensor ), minmax_( nTensor ) {
+         if( keepValues ) {
+            values_.resize( nTensor );
+         }
+      }
+      void Push( dfloat const* values, dip::sint tensorStride ) {
+         ++count_;
+         for( dip::uint jj = 0; jj < sum_.size(); ++jj, values += tensorStride ) {
+            dfloat v = *values;
+            sum_[ jj ] += v;
+            sumSquares_[ jj ] += v * v;
+            variance_[ jj ].Push( v );
+            minmax_[ jj ].Push( v );
+            if( !values_.empty() ) {
+               values_[ jj ].push_back( v );
+            }
+         }
+      }
+      void Merge( ObjectStatisticsAccumulator& other ) {
+         count_ += other.count_;
+         for( dip::uint jj = 0; jj < sum_.size(); ++jj ) {
+            sum_[ jj ] += other.sum_[ jj ];
+            sumSquares_[ jj ] += other.sumSquares_[ jj ];
+            variance_[ jj ] += other.variance_[ jj ];
+            minmax_[ jj ] += other.minmax_[ jj ];
+            if( !values_.empty() ) {
+               values_[ jj ].insert( values_[ jj ].end(), other.values_[ jj ].begin(), other.values_[ jj ].end() );
+               other.values_[ jj ].clear();
+            }
+         }
+      }
+
+      dip::uint Count() const { return count_; }
+      dfloat Sum( dip::uint jj ) const { return sum_[ jj ]; }
+      dfloat SumSquares( dip::uint jj ) const { return sumSquares_[ jj ]; }
+      dfloat Mean( dip::uint jj ) const { return variance_[ jj ].Mean(); }
+      dfloat StandardDeviation( dip::uint jj ) const { return variance_[ jj ].StandardDeviation(); }
+      dfloat Minimum( dip::uint jj ) const { return minmax_[ jj ].Minimum(); }
+      dfloat Maximum( dip::uint jj ) const { return minmax_[ jj ].Maximum(); }
+      // Reorders the stored values!
+      dfloat Percentile( dip::uint jj, dfloat percentile ) {
+         std::vector< dfloat >& values = values_[ jj ];
+         auto ourGuy = values.begin() + static_cast< dip::sint >( RankFromPercentile( percentile, values.size() ));
+         std::nth_element( values.begin(), ourGuy, values.end() );
+         return *ourGuy;
+      }
+
+   private:
+      dip::uint count_ = 0;
+      std::vector< dfloat > sum_;
+      std::vector< dfloat > sumSquares_;
+      std::vector< VarianceAccumulator > variance_;
+      std::vector< MinMaxAccumulator > minmax_;
+      std::vector< std::vector< dfloat >> values_; // empty if we don't compute percentiles
+};
+
+enum class Statistic { COUNT, SUM, SUM_SQUARES, MEAN, STANDARD_DEVIATION, MINIMUM, MAXIMUM };
+
+Statistic StatisticFromString( String const& name ) {
+   if( name == "Count" ) { return Statistic::COUNT; }
+   if( name == "Sum" ) { return Statistic::SUM; }
+   if( name == "SumSquares" ) { return Statistic::SUM_SQUARES; }
+   if( name == "Mean" ) { return Statistic::MEAN; }
+   if( name == "StandardDeviation" ) { return Statistic::STANDARD_DEVIATION; }
+   if( name == "Minimum" ) { return Statistic::MINIMUM; }
+   if( name == "Maximum" ) { return Statistic::MAXIMUM; }
+   DIP_THROW_INVALID_FLAG( name );
+}
+
+} // namespace
+
+Measurement PerObjectStatistics(
+      Image const& grey,
+      Image const& label,
+      Image const& mask,
+      StringArray const& statistics,
+      FloatArray const& percentiles,
+      String const& background
+) {
+   DIP_THROW_IF( statistics.empty() && percentiles.empty(), E::ARRAY_PARAMETER_EMPTY );
+   std::vector< Statistic > stats( statistics.size() );
+   for( dip::uint ii = 0; ii < statistics.size(); ++ii ) {
+      DIP_STACK_TRACE_THIS( stats[ ii ] = StatisticFromString( statistics[ ii ] ));
+   }
+   for( auto p : percentiles ) {
+      DIP_THROW_IF(( p < 0.0 ) || ( p > 100.0 ), E::PARAMETER_OUT_OF_RANGE );
+   }
+   bool include0{};
+   DIP_STACK_TRACE_THIS( include0 = BooleanFromString( background, S::INCLUDE, S::EXCLUDE ));
+
+   // Collect statistics
+   dip::uint nTensor = grey.TensorElements();
+   tsl::robin_map< LabelType, ObjectStatisticsAccumulator > objects;
+   DIP_STACK_TRACE_THIS( objects = PerLabelReduction( grey, label, mask, ObjectStatisticsAccumulator( nTensor, !percentiles.empty() ), include0 ));
+
+   // Create output
+   Measurement out;
+   Feature::ValueInformationArray values( nTensor );
+   if( nTensor > 1 ) {
+      for( dip::uint jj = 0; jj < nTensor; ++jj ) {
+         values[ jj ].name = String( "chan" ) + std::to_string( jj );
+      }
+   }
+   for( dip::uint ii = 0; ii < stats.size(); ++ii ) {
+      if( stats[ ii ] == Statistic::COUNT ) {
+         out.AddFeature( statistics[ ii ], Feature::ValueInformationArray( 1 ));
+      } else {
+         out.AddFeature( statistics[ ii ], values );
+      }
+   }
+   if( !percentiles.empty() ) {
+      Feature::ValueInformationArray pValues( nTensor * percentiles.size() );
+      for( dip::uint jj = 0; jj < nTensor; ++jj ) {
+         for( dip::uint kk = 0; kk < percentiles.size(); ++kk ) {
+            String& name = pValues[ jj * percentiles.size() + kk ].name;
+            std::ostringstream os;
+            os << 'P' << percentiles[ kk ];
+            name = os.str();
+            if( nTensor > 1 ) {
+               name = values[ jj ].name + '_' + name;
+            }
+         }
+      }
+      out.AddFeature( "Percentiles", pValues );
+   }
+   std::vector< LabelType > objectIDs;
+   objectIDs.reserve( objects.size() );
+   for( auto const& object : objects ) {
+      objectIDs.push_back( object.first );
+   }
+   std::sort( objectIDs.begin(), objectIDs.end() );
+   out.SetObjectIDs( objectIDs );
+   out.Forge();
+
+   // Fill output
+   for( auto it = objects.begin(); it != objects.end(); ++it ) {
+      ObjectStatisticsAccumulator& acc = it.value();
+      auto row = out[ it->first ];
+      auto feature = row.FirstFeature();
+      for( auto stat : stats ) {
+         dfloat* data = feature.data();
+         for( dip::uint jj = 0; jj < ( stat == Statistic::COUNT ? 1 : nTensor ); ++jj ) {
+            switch( stat ) {
+               case Statistic::COUNT: data[ jj ] = static_cast< dfloat >( acc.Count() ); break;
+               case Statistic::SUM: data[ jj ] = acc.Sum( jj ); break;
+               case Statistic::SUM_SQUARES: data[ jj ] = acc.SumSquares( jj ); break;
+               case Statistic::MEAN: data[ jj ] = acc.Mean( jj ); break;
+               case Statistic::STANDARD_DEVIATION: data[ jj ] = acc.StandardDeviation( jj ); break;
+               case Statistic::MINIMUM: data[ jj ] = acc.Minimum( jj ); break;
+               case Statistic::MAXIMUM: data[ jj ] = acc.Maximum( jj ); break;
+            }
+         }
+         ++feature;
+      }
+      if( !percentiles.empty() ) {
+         dfloat* data = feature.data();
+         for( dip::uint jj = 0; jj < nTensor; ++jj ) {
+            for( dip::uint kk = 0; kk < percentiles.size(); ++kk ) {
+               *data = acc.Percentile( jj, percentiles[ kk ] );
+               ++data;
+            }
+         }
+      }
+   }
+   return out;
+}
+
+} // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/regions.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::PerObjectStatistics") {
+   dip::Image grey( { 80, 60 }, 2, dip::DT_SFLOAT );
+   grey.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( grey, grey, random, 0.0, 100.0 );
+   dip::Image label( { 80, 60 }, 1, dip::DT_UINT8 );
+   label.Fill( 0 );
+   label.At( dip::Range{ 5, 30 }, dip::Range{ 5, 25 } ).Fill( 1 );
+   label.At( dip::Range{ 40, 70 }, dip::Range{ 10, 50 } ).Fill( 3 );
+   label.At( dip::Range{ 10, 20 }, dip::Range{ 35, 55 } ).Fill( 4 );
+   dip::Measurement msr = dip::PerObjectStatistics(
+         grey, label, {}, { "Count", "Sum", "Mean", "StandardDeviation", "Minimum", "Maximum" }, { 50.0 } );
+   DOCTEST_REQUIRE( msr.NumberOfObjects() == 3 );
+   DOCTEST_CHECK( msr.Objects() == dip::UnsignedArray{ 1, 3, 4 } );
+   DOCTEST_CHECK( msr.NumberOfValues() == 1 + 2 * 5 + 2 );
+   for( dip::uint id : msr.Objects() ) {
+      dip::Image mask = label == id;
+      DOCTEST_CHECK( msr[ "Count" ][ id ][ 0 ] == static_cast< dip::dfloat >( dip::Count( mask )));
+      for( dip::uint jj = 0; jj < 2; ++jj ) {
+         dip::Image channel = grey[ jj ];
+         DOCTEST_CHECK( msr[ "Sum" ][ id ][ jj ] == doctest::Approx( dip::Sum( channel, mask ).As< dip::dfloat >() ));
+         DOCTEST_CHECK( msr[ "Mean" ][ id ][ jj ] == doctest::Approx( dip::Mean( channel, mask ).As< dip::dfloat >() ));
+         DOCTEST_CHECK( msr[ "StandardDeviation" ][ id ][ jj ] == doctest::Approx( dip::StandardDeviation( channel, mask ).As< dip::dfloat >() ));
+         DOCTEST_CHECK( msr[ "Minimum" ][ id ][ jj ] == dip::Minimum( channel, mask ).As< dip::dfloat >() );
+         DOCTEST_CHECK( msr[ "Maximum" ][ id ][ jj ] == dip::Maximum( channel, mask ).As< dip::dfloat >() );
+         DOCTEST_CHECK( msr[ "Percentiles" ][ id ][ jj ] == dip::Percentile( channel, mask, 50.0 ).As< dip::dfloat >() );
+      }
+   }
+   // With a mask and including the background
+   dip::Image mask = grey[ 0 ] > 50;
+   msr = dip::PerObjectStatistics( grey[ 0 ], label, mask, { "Count" }, {}, dip::S::INCLUDE );
+   DOCTEST_REQUIRE( msr.NumberOfObjects() == 4 );
+   DOCTEST_CHECK( msr.Objects()[ 0 ] == 0 );
+   DOCTEST_CHECK( msr[ "Count" ][ 0 ][ 0 ] == static_cast< dip::dfloat >( dip::Count( mask & ( label == 0 ))));
+   DOCTEST_CHECK_THROWS( dip::PerObjectStatistics( grey, label, {}, { "Foo" } ));
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -18,12 +18,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <vector>
 
 #include "diplib.h"
 #include "diplib/generic_iterators.h"
 #include "diplib/histogram.h"
 #include "diplib/iterators.h"
+#include "diplib/multithreading.h"
+#include "diplib/overload.h"
 #include "diplib/random.h"
 #include "diplib/statistics.h"
 
@@ -158,11 +161,52 @@ ColocalizationCoefficients CostesColocalizationCoefficients(
       delta = ( bins2[ 1 ] - bins2[ 0 ] ) / params.slope;
    }
 
+   // Moments of the histogram, updated as we remove rows and columns from it. We always remove bins with
+   // indices `ind1` or above along the first axis and `ind2` or above along the second axis; the rows and
+   // columns we remove don't overlap previously removed bins, so each bin is subtracted only once.
+   // Bin centers are taken relative to the histogram mean, for numerical stability.
+   FloatArray mean = Mean( hist );
+   Histogram::CountType const* histPtr = static_cast< Histogram::CountType const* >( histIm.Origin() );
+   dip::sint histStride1 = histIm.Stride( 0 );
+   dip::sint histStride2 = histIm.Stride( 1 );
+   dfloat S0 = 0.0;
+   dfloat S1 = 0.0;
+   dfloat S2 = 0.0;
+   dfloat S11 = 0.0;
+   dfloat S22 = 0.0;
+   dfloat S12 = 0.0;
+   auto AddBin = [ & ]( dip::uint ii, dip::uint jj, dfloat sign ) {
+      dfloat w = sign * static_cast< dfloat >( histPtr[ static_cast< dip::sint >( ii ) * histStride1 + static_cast< dip::sint >( jj ) * histStride2 ] );
+      dfloat x = bins1[ ii ] - mean[ 0 ];
+      dfloat y = bins2[ jj ] - mean[ 1 ];
+      S0 += w;
+      S1 += w * x;
+      S2 += w * y;
+      S11 += w * x * x;
+      S22 += w * y * y;
+      S12 += w * x * y;
+   };
+   for( dip::uint ii = 0; ii < bins1.size(); ++ii ) {
+      for( dip::uint jj = 0; jj < bins2.size(); ++jj ) {
+         AddBin( ii, jj, 1.0 );
+      }
+   }
+   // Removing bins leaves rounding errors in the moments. A variance below this tolerance (relative to the initial
+   // moments) comes from a single row or column of bins, and is exactly zero.
+   dfloat tolerance1 = S11 * 1e-12;
+   dfloat tolerance2 = S22 * 1e-12;
+
    // Iteratively reduce the threshold until we have non-positive correlation
-   // TODO: We could speed this up further by not computing `PearsonCorrelation` every time,
-   //       instead updating the moments when we delete a row/column of the histogram.
    while( true ) {
-      dfloat corr = PearsonCorrelation( hist );
+      // As in `PearsonCorrelation( hist )`, the correlation is 0 if one of the variances is 0
+      dfloat corr = 0.0;
+      if( S0 > 0.0 ) {
+         dfloat var1 = S11 - S1 * S1 / S0;
+         dfloat var2 = S22 - S2 * S2 / S0;
+         if(( var1 > tolerance1 ) && ( var2 > tolerance2 )) {
+            corr = ( S12 - S1 * S2 / S0 ) / std::sqrt( var1 * var2 );
+         }
+      }
       if(( corr <= 0.0 ) || ( T1 - delta < 0.0 ) || ( f( T1 - delta ) < 0.0 )) {
          break;
       }
@@ -170,11 +214,15 @@ ColocalizationCoefficients CostesColocalizationCoefficients(
       T2 = f( T1 );
       if(( ind1 > 0 ) && ( bins1[ ind1 - 1 ] > T1 )) {
          --ind1;
-         histIm.At( Range( static_cast< dip::sint >( ind1 )), Range( static_cast< dip::sint >( ind2 ), -1 )) = 0;
+         for( dip::uint jj = ind2; jj < bins2.size(); ++jj ) {
+            AddBin( ind1, jj, -1.0 );
+         }
       }
       if(( ind2 > 0 ) && ( bins2[ ind2 - 1 ] > T2 )) {
          --ind2;
-         histIm.At( Range( static_cast< dip::sint >( ind1 ), -1 ), Range( static_cast< dip::sint >( ind2 ))) = 0;
+         for( dip::uint ii = ind1; ii < bins1.size(); ++ii ) {
+            AddBin( ii, ind2, -1.0 );
+         }
       }
    }
 
@@ -189,24 +237,126 @@ ColocalizationCoefficients CostesColocalizationCoefficients(
    return { M1, M2 };
 }
 
-dfloat CostesSignificanceTest(
+namespace {
+
+// Offsets to each of the pixels in a block of size `blockSizes`, relative to the first pixel of the block
+std::vector< dip::sint > BlockOffsets( UnsignedArray const& blockSizes, IntegerArray const& strides ) {
+   dip::uint nDims = blockSizes.size();
+   std::vector< dip::sint > offsets( blockSizes.product() );
+   UnsignedArray coords( nDims, 0 );
+   dip::sint offset = 0;
+   for( auto& o : offsets ) {
+      o = offset;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         ++coords[ ii ];
+         offset += strides[ ii ];
+         if( coords[ ii ] < blockSizes[ ii ] ) {
+            break;
+         }
+         offset -= static_cast< dip::sint >( coords[ ii ] ) * strides[ ii ];
+         coords[ ii ] = 0;
+      }
+   }
+   return offsets;
+}
+
+// Computes the correlation between the blocks `origins1` of `channel1` and the blocks `origins2` of `channel2`,
+// for `correlations.size()` random permutations of the latter. The sums and sums of squares of the two channels
+// don't depend on the permutation, only the sum of products does. Thus we compute only that for each permutation,
+// directly from the input pixels. Each permutation uses its own random stream (keyed with `key`, indexed by the
+// repetition number), so that the result doesn't depend on the number of threads used.
+template< typename TPI >
+void CostesShuffledCorrelations(
       Image const& channel1,
       Image const& channel2,
+      std::vector< dip::sint > const& origins1,
+      std::vector< dip::sint > const& origins2,
+      std::vector< dip::sint > const& offsets1,
+      std::vector< dip::sint > const& offsets2,
+      dip::uint key,
+      std::vector< dfloat >& correlations
+) {
+   TPI const* ptr1 = static_cast< TPI const* >( channel1.Origin() );
+   TPI const* ptr2 = static_cast< TPI const* >( channel2.Origin() );
+   dip::uint nBlocks = origins1.size();
+   dip::uint blockPixels = offsets1.size();
+
+   // Mean and sum of squares of each channel, over the pixels in all blocks
+   dfloat mean1 = 0.0;
+   dfloat mean2 = 0.0;
+   for( dip::uint jj = 0; jj < nBlocks; ++jj ) {
+      TPI const* block1 = ptr1 + origins1[ jj ];
+      TPI const* block2 = ptr2 + origins2[ jj ];
+      for( dip::uint kk = 0; kk < blockPixels; ++kk ) {
+         mean1 += static_cast< dfloat >( block1[ offsets1[ kk ]] );
+         mean2 += static_cast< dfloat >( block2[ offsets2[ kk ]] );
+      }
+   }
+   mean1 /= static_cast< dfloat >( nBlocks * blockPixels );
+   mean2 /= static_cast< dfloat >( nBlocks * blockPixels );
+   dfloat sumSquare1 = 0.0;
+   dfloat sumSquare2 = 0.0;
+   for( dip::uint jj = 0; jj < nBlocks; ++jj ) {
+      TPI const* block1 = ptr1 + origins1[ jj ];
+      TPI const* block2 = ptr2 + origins2[ jj ];
+      for( dip::uint kk = 0; kk < blockPixels; ++kk ) {
+         dfloat v1 = static_cast< dfloat >( block1[ offsets1[ kk ]] ) - mean1;
+         dfloat v2 = static_cast< dfloat >( block2[ offsets2[ kk ]] ) - mean2;
+         sumSquare1 += v1 * v1;
+         sumSquare2 += v2 * v2;
+      }
+   }
+   dfloat norm = std::sqrt( sumSquare1 * sumSquare2 );
+
+   dip::uint repetitions = correlations.size();
+   dip::uint nThreads = 1;
+   if( repetitions * nBlocks * blockPixels > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), repetitions );
+   }
+   dip::sint sRepetitions = static_cast< dip::sint >( repetitions );
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      std::vector< dip::uint > permutation( nBlocks );
+      CounterBasedRandom generator( key );
+      #pragma omp for schedule( static )
+      for( dip::sint rep = 0; rep < sRepetitions; ++rep ) {
+         std::iota( permutation.begin(), permutation.end(), dip::uint( 0 ));
+         generator.SetIndex( static_cast< dip::uint >( rep ));
+         std::shuffle( permutation.begin(), permutation.end(), generator );
+         dfloat sumProduct = 0.0;
+         for( dip::uint jj = 0; jj < nBlocks; ++jj ) {
+            TPI const* block1 = ptr1 + origins1[ jj ];
+            TPI const* block2 = ptr2 + origins2[ permutation[ jj ]];
+            for( dip::uint kk = 0; kk < blockPixels; ++kk ) {
+               sumProduct += ( static_cast< dfloat >( block1[ offsets1[ kk ]] ) - mean1 ) *
+                             ( static_cast< dfloat >( block2[ offsets2[ kk ]] ) - mean2 );
+            }
+         }
+         correlations[ static_cast< dip::uint >( rep ) ] = norm != 0.0 ? sumProduct / norm : 0.0;
+      }
+   }
+}
+
+} // namespace
+
+dfloat CostesSignificanceTest(
+      Image const& c_channel1,
+      Image const& c_channel2,
       Image const& c_mask,
       Random& random,
       UnsignedArray blockSizes,
       dip::uint repetitions
 ) {
-   DIP_THROW_IF( !channel1.IsForged() || !channel2.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( !channel1.IsScalar() || !channel2.IsScalar(), E::IMAGE_NOT_SCALAR );
-   DIP_THROW_IF( !channel1.DataType().IsReal() || !channel2.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-   DIP_STACK_TRACE_THIS( channel1.CompareProperties( channel2, Option::CmpProp::Sizes ));
-   dip::uint nDims = channel1.Dimensionality();
+   DIP_THROW_IF( !c_channel1.IsForged() || !c_channel2.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_channel1.IsScalar() || !c_channel2.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !c_channel1.DataType().IsReal() || !c_channel2.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_STACK_TRACE_THIS( c_channel1.CompareProperties( c_channel2, Option::CmpProp::Sizes ));
+   dip::uint nDims = c_channel1.Dimensionality();
    dip::Image mask;
    if( c_mask.IsForged() ) {
       mask = c_mask.QuickCopy();
-      DIP_STACK_TRACE_THIS( mask.CheckIsMask( channel1.Sizes(), Option::AllowSingletonExpansion::DO_ALLOW ));
-      DIP_STACK_TRACE_THIS( mask.ExpandSingletonDimensions( channel1.Sizes() ));
+      DIP_STACK_TRACE_THIS( mask.CheckIsMask( c_channel1.Sizes(), Option::AllowSingletonExpansion::DO_ALLOW ));
+      DIP_STACK_TRACE_THIS( mask.ExpandSingletonDimensions( c_channel1.Sizes() ));
    }
    DIP_STACK_TRACE_THIS( ArrayUseParameter( blockSizes, nDims, dip::uint( 3 )));
    DIP_THROW_IF( blockSizes.minimum_value() < 1, E::INVALID_PARAMETER );
@@ -214,13 +364,22 @@ dfloat CostesSignificanceTest(
 
    // Instead of shuffling blocks in an image and computing the correlation between the result and the
    // other image, we do something that is simpler and faster:
-   // We generate an array with pointers to all blocks within channel1, and a similar one for channel2.
+   // We generate an array with offsets to all blocks within channel1, and a similar one for channel2.
    // We shuffle one of these arrays, and compute correlation between the pairs of blocks. Rinse and repeat.
 
    // Compute correlation without shuffling
-   dfloat corr0 = PearsonCorrelation( channel1, channel2, mask );
+   dfloat corr0 = PearsonCorrelation( c_channel1, c_channel2, mask );
+
+   // The shuffled correlations are computed directly on the pixel data, which requires both channels to be
+   // of the same type
+   Image channel1 = c_channel1.QuickCopy();
+   Image channel2 = c_channel2.QuickCopy();
+   if( channel1.DataType() != channel2.DataType() ) {
+      DIP_STACK_TRACE_THIS( channel1.Convert( DT_DFLOAT ));
+      DIP_STACK_TRACE_THIS( channel2.Convert( DT_DFLOAT ));
+   }
 
-   // Generate arrays with pointers to the first pixel of each block
+   // Generate arrays with offsets to the first pixel of each block
    dip::RangeArray blocks( nDims, { 0, -1 } );
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       if( blockSizes[ ii ] > channel1.Size( ii )) {
@@ -234,52 +393,43 @@ dfloat CostesSignificanceTest(
    dip::Image channel1_blocks = channel1.At( blocks );
    dip::Image channel2_blocks = channel2.At( blocks );
    dip::uint nBlocks = channel1_blocks.NumberOfPixels();
-   std::vector< void* > origins1;
+   std::vector< dip::sint > offsets1 = BlockOffsets( blockSizes, channel1.Strides() );
+   std::vector< dip::sint > offsets2 = BlockOffsets( blockSizes, channel2.Strides() );
+   std::vector< dip::sint > origins1;
    origins1.reserve( nBlocks );
-   std::vector< void* > origins2;
+   std::vector< dip::sint > origins2;
    origins2.reserve( nBlocks );
    dip::GenericJointImageIterator< 2 > it( { channel1_blocks, channel2_blocks } );
    if( mask.IsForged() ) {
       dip::uint threshold = blockSizes.product() * 3 / 4; // three quarter pixels
-      dip::Image block = mask.QuickCopy();
-      block.SetSizesUnsafe( blockSizes );
+      std::vector< dip::sint > maskOffsets = BlockOffsets( blockSizes, mask.Strides() );
       dip::Image mask_blocks = mask.At( blocks );
       dip::ImageIterator< bin > mit( mask_blocks );
       do {
-         block.SetOriginUnsafe( mit.Pointer());
-         if( Count( block ) > threshold ) {
-            origins1.push_back( it.Pointer< 0 >());
-            origins2.push_back( it.Pointer< 1 >());
+         bin const* block = mit.Pointer();
+         dip::uint count = 0;
+         for( auto o : maskOffsets ) {
+            count += block[ o ] ? 1u : 0u;
+         }
+         if( count > threshold ) {
+            origins1.push_back( it.Offset< 0 >() );
+            origins2.push_back( it.Offset< 1 >() );
          }
       } while( ++mit, ++it );
       nBlocks = origins1.size();
    } else { // No mask
       do {
-         origins1.push_back( it.Pointer< 0 >() );
-         origins2.push_back( it.Pointer< 1 >() );
+         origins1.push_back( it.Offset< 0 >() );
+         origins2.push_back( it.Offset< 1 >() );
       } while( ++it );
    }
 
    // Shuffle one array, and compute correlation between pairs of blocks
-   dip::Image block1 = channel1.QuickCopy();
-   block1.SetSizesUnsafe( blockSizes );
-   dip::Image block2 = channel2.QuickCopy();
-   block2.SetSizesUnsafe( blockSizes );
+   std::vector< dfloat > correlations( repetitions );
+   DIP_OVL_CALL_REAL( CostesShuffledCorrelations, ( channel1, channel2, origins1, origins2, offsets1, offsets2, random(), correlations ), channel1.DataType() );
    VarianceAccumulator var;
-   //dip::uint smallerCount = 0;
-   for( dip::uint ii = 0; ii < repetitions; ++ii ) {
-      std::shuffle( origins2.begin(), origins2.end(), random );
-      CovarianceAccumulator cov;
-      for( dip::uint jj = 0; jj < nBlocks; ++jj ) {
-         block1.SetOriginUnsafe( origins1[ jj ] );
-         block2.SetOriginUnsafe( origins2[ jj ] );
-         cov += Covariance( block1, block2 );
-      }
-      dfloat corr = cov.Correlation();
+   for( auto corr : correlations ) {
       var.Push( corr );
-      //if( corr <= corr0 ) {
-      //   ++smallerCount;
-      //}
    }
 
    // Estimate probability to find at least `corr0` with random shuffles
@@ -287,3 +437,141 @@ dfloat CostesSignificanceTest(
 }
 
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+#include "diplib/math.h"
+#include "diplib/multithreading.h"
+
+namespace {
+
+// The Costes threshold search as it was implemented originally, recomputing the correlation from the
+// histogram in each iteration (but not indexing an empty range of bins).
+dip::ColocalizationCoefficients CostesReference( dip::Image const& channel1, dip::Image const& channel2 ) {
+   dip::Image nonZeroMask = channel1 > 0;
+   nonZeroMask |= channel2 > 0;
+   dip::dfloat maxValue1 = dip::Maximum( channel1 ).As< dip::dfloat >();
+   dip::dfloat maxValue2 = dip::Maximum( channel2 ).As< dip::dfloat >();
+   dip::Histogram hist( channel1, channel2, {}, dip::Histogram::ConfigurationArray{{ 0.0, maxValue1 }, { 0.0, maxValue2 }} );
+   dip::Image histIm = hist.GetImage();
+   auto bins1 = hist.BinCenters( 0 );
+   auto bins2 = hist.BinCenters( 1 );
+   dip::RegressionParameters params = dip::Regression( hist );
+   auto f = [ &params ]( dip::dfloat x ){ return params.intercept + x * params.slope; };
+   if( params.slope <= 0.0 ) {
+      return { 0.0, 0.0 };
+   }
+   dip::dfloat T1 = maxValue1;
+   dip::dfloat T2 = f( T1 );
+   if( T2 > maxValue2 ) {
+      T1 = ( maxValue2 - params.intercept ) / params.slope;
+      T2 = f( T1 );
+   }
+   dip::uint ind1 = 0;
+   for( ; ( ind1 < bins1.size() ) && ( bins1[ ind1 ] <= T1 ); ++ind1 ) {}
+   dip::uint ind2 = 0;
+   for( ; ( ind2 < bins2.size() ) && ( bins2[ ind2 ] <= T2 ); ++ind2 ) {}
+   if(( ind1 < bins1.size() ) && ( ind2 < bins2.size() )) {
+      histIm.At( dip::Range( static_cast< dip::sint >( ind1 ), -1 ), dip::Range( static_cast< dip::sint >( ind2 ), -1 ) ) = 0;
+   }
+   dip::dfloat delta = bins1[ 1 ] - bins1[ 0 ];
+   if( delta * params.slope > bins2[ 1 ] - bins2[ 0 ] ) {
+      delta = ( bins2[ 1 ] - bins2[ 0 ] ) / params.slope;
+   }
+   while( true ) {
+      dip::dfloat corr = dip::PearsonCorrelation( hist );
+      if(( corr <= 0.0 ) || ( T1 - delta < 0.0 ) || ( f( T1 - delta ) < 0.0 )) {
+         break;
+      }
+      T1 = T1 - delta;
+      T2 = f( T1 );
+      if(( ind1 > 0 ) && ( bins1[ ind1 - 1 ] > T1 )) {
+         --ind1;
+         if( ind2 < bins2.size() ) {
+            histIm.At( dip::Range( static_cast< dip::sint >( ind1 )), dip::Range( static_cast< dip::sint >( ind2 ), -1 )) = 0;
+         }
+      }
+      if(( ind2 > 0 ) && ( bins2[ ind2 - 1 ] > T2 )) {
+         --ind2;
+         if( ind1 < bins1.size() ) {
+            histIm.At( dip::Range( static_cast< dip::sint >( ind1 ), -1 ), dip::Range( static_cast< dip::sint >( ind2 ))) = 0;
+         }
+      }
+   }
+   dip::Image colocalizedMap = channel1 > T1;
+   colocalizedMap &= channel2 > T2;
+   colocalizedMap &= nonZeroMask;
+   dip::dfloat M1 = dip::Sum( channel1, colocalizedMap ).As< dip::dfloat >() / dip::Sum( channel1, nonZeroMask ).As< dip::dfloat >();
+   dip::dfloat M2 = dip::Sum( channel2, colocalizedMap ).As< dip::dfloat >() / dip::Sum( channel2, nonZeroMask ).As< dip::dfloat >();
+   return { M1, M2 };
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing CostesColocalizationCoefficients") {
+   dip::Random random( 0 );
+   dip::Image a( { 64, 48 }, 1, dip::DT_SFLOAT );
+   a.Fill( 0 );
+   dip::GaussianNoise( a, a, random, 100 );
+   a = dip::Gauss( a, { 1 } );
+   dip::Image b( { 64, 48 }, 1, dip::DT_SFLOAT );
+   b.Fill( 0 );
+   dip::GaussianNoise( b, b, random, 100 );
+   b = dip::Gauss( b, { 1 } );
+   a = dip::Abs( a );
+   b = dip::Abs( b );
+   // Correlated channels
+   dip::Image c = a + b;
+   dip::ColocalizationCoefficients result = dip::CostesColocalizationCoefficients( a, c );
+   dip::ColocalizationCoefficients reference = CostesReference( a, c );
+   DOCTEST_CHECK( result.M1 == doctest::Approx( reference.M1 ));
+   DOCTEST_CHECK( result.M2 == doctest::Approx( reference.M2 ));
+   DOCTEST_CHECK( result.M1 > 0.0 );
+   DOCTEST_CHECK( result.M1 <= 1.0 );
+   // Identical channels: the histogram is a diagonal line, at the end a single bin remains and the variances are 0
+   result = dip::CostesColocalizationCoefficients( a, a );
+   reference = CostesReference( a, a );
+   DOCTEST_CHECK( result.M1 == doctest::Approx( reference.M1 ));
+   DOCTEST_CHECK( result.M2 == doctest::Approx( reference.M2 ));
+   DOCTEST_CHECK( result.M1 == result.M2 );
+   DOCTEST_CHECK( result.M1 > 0.9 );
+   // Anti-correlated channels
+   result = dip::CostesColocalizationCoefficients( a, dip::Maximum( a ).As< dip::dfloat >() - a );
+   DOCTEST_CHECK( result.M1 == 0.0 );
+   DOCTEST_CHECK( result.M2 == 0.0 );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing CostesSignificanceTest") {
+   dip::Random random( 0 );
+   dip::Image a( { 64, 48 }, 1, dip::DT_SFLOAT );
+   a.Fill( 0 );
+   dip::GaussianNoise( a, a, random, 100 );
+   a = dip::Gauss( a, { 1 } );
+   dip::Image b( { 64, 48 }, 1, dip::DT_SFLOAT );
+   b.Fill( 0 );
+   dip::GaussianNoise( b, b, random, 100 );
+   b = dip::Gauss( b, { 1 } );
+   dip::Image c = a + b;
+   dip::Random random1( 5 );
+   DOCTEST_CHECK( dip::CostesSignificanceTest( a, c, {}, random1 ) > 0.99 );
+   dip::Random random2( 5 );
+   DOCTEST_CHECK( dip::CostesSignificanceTest( a, b, {}, random2 ) < 0.99 );
+   // The result doesn't depend on the number of threads
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Random random3( 7 );
+   dip::dfloat p1 = dip::CostesSignificanceTest( a, b, {}, random3 );
+   dip::SetNumberOfThreads( 3 );
+   dip::Random random4( 7 );
+   dip::dfloat p3 = dip::CostesSignificanceTest( a, b, {}, random4 );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( p1 == p3 );
+   // Channels of different types, with a mask
+   dip::Image mask = a > 0;
+   dip::Random random5( 5 );
+   DOCTEST_CHECK( dip::CostesSignificanceTest( a, dip::Convert( c, dip::DT_DFLOAT ), mask, random5 ) > 0.99 );
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -117,6 +117,13 @@ class FullBilateralLineFilter : public Framework::FullLineFilter {
          tonalGaussScaling_ = CreateTonalGauss( tonalGauss_, tonalSigma, DataType( TPF( 0 ) ) );
       }
 
+      void SetNumberOfThreads( dip::uint /*threads*/, PixelTableOffsets const& pixelTable ) override {
+         offsets_ = pixelTable.Offsets();
+         std::vector< dfloat > const& weights = pixelTable.Weights();
+         spatialWeights_.resize( weights.size() );
+         std::transform( weights.begin(), weights.end(), spatialWeights_.begin(), []( dfloat w ) { return static_cast< TPF >( w ); } );
+      }
+
       void Filter( Framework::FullLineFilterParameters const& params ) override {
          TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
          dip::sint inStride = params.inBuffer.stride;
@@ -124,7 +131,6 @@ class FullBilateralLineFilter : public Framework::FullLineFilter {
          dip::sint outStride = params.outBuffer.stride;
          DIP_ASSERT( params.inBuffer.tensorLength == 1 );
          dip::uint length = params.bufferLength;
-         PixelTableOffsets const& pixelTableOffsets = params.pixelTable;
          dip::sint estStride = estimate_.Stride( params.dimension );
 
          // Index tonalGauss_ image as simple array
@@ -142,15 +148,13 @@ class FullBilateralLineFilter : public Framework::FullLineFilter {
             TPI sum = 0;
             TPI norm = 0;
             TPI const tonalCenter = *est;
-            dfloat const* w = pixelTableOffsets.Weights().data();
             // Loop over the kernel
-            for( auto pto = pixelTableOffsets.begin(); pto != pixelTableOffsets.end(); ++pto ) {
-               TPI inValue = in[ pto.Offset() ];
+            for( dip::uint jj = 0; jj < offsets_.size(); ++jj ) {
+               TPI inValue = in[ offsets_[ jj ]];
                dip::uint luIndex = static_cast< dip::uint >( std::min( static_cast< dip::uint >( std::abs( inValue - tonalCenter ) * tonalGaussScaling ), tonalGaussSize - 1 ));
-               TPF weight = static_cast< TPF >( *w ) * tonalGauss[ luIndex ];
+               TPF weight = spatialWeights_[ jj ] * tonalGauss[ luIndex ];
                sum += weight * inValue;
                norm += weight;
-               ++w;
             }
             *out = sum / norm;
             in += inStride;
@@ -163,6 +167,8 @@ class FullBilateralLineFilter : public Framework::FullLineFilter {
       Image const& estimate_;
       Image tonalGauss_;
       dfloat tonalGaussScaling_;
+      std::vector< dip::sint > offsets_;
+      std::vector< TPF > spatialWeights_;
 };
 
 } // End anonymous namespace
@@ -489,11 +489,11 @@ class RankLineFilter : public Framework::FullLineFilter {
             }
             *out = tree.Select( rank_ );
             for( dip::uint ii = 1; ii < length; ++ii ) {
-               for( auto run: pixelTable.Runs() ) {
-                  tree.Remove( in[ run.offset ] );
+               for( auto offset : pixelTable.TrailingEdge() ) {
+                  tree.Remove( in[ offset ] );
                }
-               for( auto run: pixelTable.Runs()) {
-                  tree.Insert( in[ run.offset + static_cast< dip::sint >( run.length ) * inStride ] );
+               for( auto offset : pixelTable.LeadingEdge() ) {
+                  tree.Insert( in[ offset ] );
                }
                in += inStride;
                out += outStride;
@@ -18,6 +18,7 @@
 #include "diplib/nonlinear.h"
 
 #include <memory>
+#include <vector>
 
 #include "diplib.h"
 #include "diplib/accumulators.h"
@@ -53,10 +54,12 @@ class VarianceLineFilter : public Framework::FullLineFilter {
          *out = static_cast< TPI >( acc.Variance() );
          //in += inStride; // we don't increment `in` here, so that we don't have to subtract one index inside the loop
          //out += outStride; // we don't increment `out` here, we increment it in the loop before the assignment, it saves one addition! :)
+         std::vector< dip::sint > const& trailing = pixelTable.TrailingEdge();
+         std::vector< dip::sint > const& leading = pixelTable.LeadingEdge();
          for( dip::uint ii = 1; ii < length; ++ii ) {
-            for( auto run : pixelTable.Runs() ) {
-               acc.Pop( in[ run.offset ] );
-               acc.Push( in[ run.offset + static_cast< dip::sint >( run.length ) * inStride ] );
+            for( dip::uint jj = 0; jj < trailing.size(); ++jj ) {
+               acc.Pop( in[ trailing[ jj ]] );
+               acc.Push( in[ leading[ jj ]] );
             }
             in += inStride;
             out += outStride;
@@ -232,8 +232,9 @@ void LabelFirstPass(
       // The last pixel:
       if( *img ) {
          coords[ procDim ] = length - 1;
+         bool previousIsSet = lastLabel != 0; // if not, we need to test all neighbors, not only the `m` ones
          for( dip::uint ii = 0; ii < neighborList.Size(); ++ii ) {
-            if( neighborIsForward[ ii ] && neighorIsInImage[ ii ] && neighborList.IsInImage( ii, coords, c_img.Sizes() )) {
+            if(( neighborIsForward[ ii ] || !previousIsSet ) && neighorIsInImage[ ii ] && neighborList.IsInImage( ii, coords, c_img.Sizes() )) {
                LabelType lab = img[ neighborOffsets[ ii ]];
                if( lab ) {
                   if( lastLabel ) {
@@ -525,6 +526,14 @@ DOCTEST_TEST_CASE("[DIPlib] testing dip::Label") {
    DOCTEST_CHECK( n1 > n2 ); // I don't know how many labels we'll get, but we do know we'll have more as we reduce the connectivity.
    DOCTEST_CHECK( n2 > n );
 
+   // The last pixel on a line, with the pixel before it not set, connected only through a neighbor that is also
+   // a neighbor of that previous pixel (a diagonal or backward neighbor, not in the forward set)
+   img = dip::Image( { 5, 4, 3 }, 1, dip::DT_BIN );
+   img.Fill( 0 );
+   img.At( 3, 1, 0 ) = 1;
+   img.At( 4, 2, 1 ) = 1;
+   DOCTEST_CHECK( dip::Label( img, lab, 3 ) == 1 );
+
    // Two 2D intertwined spirals. Generated data points using the following Python:
    /*
    t = np.arange(0, 3 * 6) / 6 * np.pi
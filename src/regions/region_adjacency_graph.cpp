@@ -17,7 +17,11 @@
 #include "diplib/regions.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "diplib.h"
@@ -27,6 +31,9 @@
 #include "diplib/measurement.h"
 #include "diplib/overload.h"
 #include "diplib/statistics.h"
+#include "diplib/private/robin_map.h"
+
+#include "../statistics/per_label_reduction.h"
 
 namespace dip {
 
@@ -204,4 +211,492 @@ void Relabel( Image const& label, Image& out, DirectedGraph const& graph ) {
    lut.Apply( label, out );
 }
 
+void Relabel( Image const& label, Image& out, CompactGraph const& graph ) {
+   DIP_THROW_IF( !label.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !label.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !label.DataType().IsUInt(), E::DATA_TYPE_NOT_SUPPORTED );
+   LabelMap lut = Label( graph );
+   lut.Apply( label, out );
+}
+
+namespace {
+
+// Accumulator for `PerLabelReduction`: the size and the sum of the grey values of a region.
+class RegionSumAccumulator {
+   public:
+      explicit RegionSumAccumulator( dip::uint nTensor ) : sum_( nTensor, 0.0 ) {}
+      void Push( dfloat const* values, dip::sint tensorStride ) {
+         ++size_;
+         for( auto& s : sum_ ) {
+            s += *values;
+            values += tensorStride;
+         }
+      }
+      void Merge( RegionSumAccumulator& other ) {
+         size_ += other.size_;
+         for( dip::uint jj = 0; jj < sum_.size(); ++jj ) {
+            sum_[ jj ] += other.sum_[ jj ];
+         }
+      }
+      dip::uint Size() const { return size_; }
+      std::vector< dfloat > const& Sum() const { return sum_; }
+   private:
+      dip::uint size_ = 0;
+      std::vector< dfloat > sum_;
+};
+
+enum class MergeCriterion { MEAN, WARD, BOUNDARY };
+
+// The state of the region merging process. Regions are indexed by their label.
+//
+// Each region keeps track of its cheapest neighbor, and the regions are kept in a binary min-heap sorted by
+// the cost of merging with that neighbor. After merging two regions, the costs to all their neighbors are
+// recomputed, but the heap needs to be updated only for those neighbors whose cheapest merge changed.
+class RegionMerger {
+   public:
+      RegionMerger( dip::uint nRegions, dip::uint nTensor, MergeCriterion criterion )
+            : criterion_( criterion ), nTensor_( nTensor ), size_( nRegions, 0.0 ), mean_( nRegions * nTensor, 0.0 ),
+              boundaryLength_( nRegions, 0.0 ), shared_( nRegions ), best_( nRegions ), heapIndex_( nRegions, NOT_IN_HEAP ) {}
+
+      void SetRegion( LabelType region, dip::uint size, std::vector< dfloat > const& sum, dfloat boundaryLength ) {
+         size_[ region ] = static_cast< dfloat >( size );
+         for( dip::uint jj = 0; jj < nTensor_; ++jj ) {
+            mean_[ region * nTensor_ + jj ] = sum[ jj ] / size_[ region ];
+         }
+         boundaryLength_[ region ] = boundaryLength;
+      }
+
+      void SetSharedBoundary( LabelType region1, LabelType region2, dfloat length ) {
+         shared_[ region1 ][ region2 ] = length;
+         shared_[ region2 ][ region1 ] = length;
+      }
+
+      // Call after all regions and shared boundaries have been set
+      std::vector< RegionMergeHierarchy::Merge > Run() {
+         for( LabelType region = 0; region < shared_.size(); ++region ) {
+            if( !shared_[ region ].empty() ) {
+               FindBest( region );
+               heapIndex_[ region ] = heap_.size();
+               heap_.push_back( region );
+            }
+         }
+         for( dip::uint ii = heap_.size() / 2; ii > 0; --ii ) {
+            SiftDown( ii - 1 );
+         }
+         std::vector< RegionMergeHierarchy::Merge > merges;
+         while( !heap_.empty() ) {
+            Candidate const& candidate = best_[ heap_[ 0 ]];
+            merges.push_back( { candidate.region1, candidate.region2, candidate.cost } );
+            MergeRegions( candidate.region1, candidate.region2 );
+         }
+         return merges;
+      }
+
+   private:
+      static constexpr dip::uint NOT_IN_HEAP = std::numeric_limits< dip::uint >::max();
+
+      struct Candidate {
+         dfloat cost;
+         LabelType region1; // `region1 < region2`
+         LabelType region2;
+         // Lowest cost first, ties broken by label, so that the result is deterministic
+         bool operator<( Candidate const& other ) const {
+            return std::tie( cost, region1, region2 ) < std::tie( other.cost, other.region1, other.region2 );
+         }
+      };
+
+      MergeCriterion criterion_;
+      dip::uint nTensor_;
+      std::vector< dfloat > size_;
+      std::vector< dfloat > mean_;
+      std::vector< dfloat > boundaryLength_;
+      std::vector< tsl::robin_map< LabelType, dfloat >> shared_; // for each region, the length of the boundary shared with each neighbor
+      std::vector< Candidate > best_;     // for each region, the cheapest merge with a neighbor
+      std::vector< LabelType > heap_;     // the regions that have neighbors, as a binary min-heap sorted by `best_`
+      std::vector< dip::uint > heapIndex_; // for each region, its index in `heap_`
+      std::vector< Candidate > candidates_; // temporary buffer
+
+      dfloat Cost( LabelType region1, LabelType region2, dfloat sharedBoundary ) const {
+         if( criterion_ == MergeCriterion::BOUNDARY ) {
+            return 1.0 - std::max( sharedBoundary / boundaryLength_[ region1 ], sharedBoundary / boundaryLength_[ region2 ] );
+         }
+         dfloat distance2 = 0.0;
+         for( dip::uint jj = 0; jj < nTensor_; ++jj ) {
+            dfloat diff = mean_[ region1 * nTensor_ + jj ] - mean_[ region2 * nTensor_ + jj ];
+            distance2 += diff * diff;
+         }
+         if( criterion_ == MergeCriterion::WARD ) {
+            return size_[ region1 ] * size_[ region2 ] / ( size_[ region1 ] + size_[ region2 ] ) * distance2;
+         }
+         return std::sqrt( distance2 );
+      }
+
+      Candidate MakeCandidate( LabelType region1, LabelType region2, dfloat sharedBoundary ) const {
+         return { Cost( region1, region2, sharedBoundary ), std::min( region1, region2 ), std::max( region1, region2 ) };
+      }
+
+      // Recomputes `best_[ region ]` from scratch. `region` must have at least one neighbor.
+      void FindBest( LabelType region ) {
+         auto it = shared_[ region ].begin();
+         Candidate best = MakeCandidate( region, it->first, it->second );
+         for( ++it; it != shared_[ region ].end(); ++it ) {
+            best = std::min( best, MakeCandidate( region, it->first, it->second ));
+         }
+         best_[ region ] = best;
+      }
+
+      // Merges `region2` into `region1`
+      void MergeRegions( LabelType region1, LabelType region2 ) {
+         // Update the statistics
+         dfloat size = size_[ region1 ] + size_[ region2 ];
+         for( dip::uint jj = 0; jj < nTensor_; ++jj ) {
+            mean_[ region1 * nTensor_ + jj ] = ( mean_[ region1 * nTensor_ + jj ] * size_[ region1 ] +
+                                                 mean_[ region2 * nTensor_ + jj ] * size_[ region2 ] ) / size;
+         }
+         size_[ region1 ] = size;
+         boundaryLength_[ region1 ] += boundaryLength_[ region2 ] - 2 * shared_[ region1 ][ region2 ];
+         // Merge the neighbor lists, the smaller one into the larger one. The neighbors' lists need to point
+         // at `region1` instead of `region2`, and have the new shared boundary length.
+         auto& neighbors = shared_[ region1 ];
+         auto& other = shared_[ region2 ];
+         bool swapped = other.size() > neighbors.size();
+         if( swapped ) {
+            std::swap( neighbors, other );
+         }
+         neighbors.erase( region1 );
+         neighbors.erase( region2 );
+         for( auto const& neighbor : other ) {
+            if(( neighbor.first != region1 ) && ( neighbor.first != region2 )) {
+               dfloat& length = neighbors[ neighbor.first ];
+               length += neighbor.second;
+               if( !swapped ) {
+                  auto& map = shared_[ neighbor.first ];
+                  map.erase( region2 );
+                  map[ region1 ] = length;
+               }
+            }
+         }
+         if( swapped ) {
+            for( auto const& neighbor : neighbors ) {
+               auto& map = shared_[ neighbor.first ];
+               map.erase( region2 );
+               map[ region1 ] = neighbor.second;
+            }
+         }
+         tsl::robin_map< LabelType, dfloat >().swap( other ); // free the memory
+         HeapRemove( region2 );
+         if( neighbors.empty() ) {
+            HeapRemove( region1 );
+            return;
+         }
+         // Compute the new merge costs, and update `region1` in the heap
+         candidates_.clear();
+         for( auto const& neighbor : neighbors ) {
+            candidates_.push_back( MakeCandidate( region1, neighbor.first, neighbor.second ));
+         }
+         best_[ region1 ] = *std::min_element( candidates_.begin(), candidates_.end() );
+         SiftUp( heapIndex_[ region1 ] );
+         SiftDown( heapIndex_[ region1 ] );
+         // Update the neighbors in the heap
+         auto candidate = candidates_.begin();
+         for( auto const& neighbor : neighbors ) {
+            LabelType region = neighbor.first;
+            Candidate& best = best_[ region ];
+            if( *candidate < best ) {
+               best = *candidate;
+               SiftUp( heapIndex_[ region ] );
+            } else if(( best.region1 == region1 ) || ( best.region1 == region2 ) ||
+                      ( best.region2 == region1 ) || ( best.region2 == region2 )) {
+               // The cheapest merge for `region` was with `region1` or `region2`, and now costs more
+               FindBest( region );
+               SiftDown( heapIndex_[ region ] );
+            }
+            ++candidate;
+         }
+      }
+
+      // Binary heap operations on `heap_`, keeping `heapIndex_` up to date
+      bool HeapLess( dip::uint ii, dip::uint jj ) const {
+         return best_[ heap_[ ii ]] < best_[ heap_[ jj ]];
+      }
+      void HeapSwap( dip::uint ii, dip::uint jj ) {
+         std::swap( heap_[ ii ], heap_[ jj ] );
+         heapIndex_[ heap_[ ii ]] = ii;
+         heapIndex_[ heap_[ jj ]] = jj;
+      }
+      void SiftUp( dip::uint ii ) {
+         while(( ii > 0 ) && HeapLess( ii, ( ii - 1 ) / 2 )) {
+            HeapSwap( ii, ( ii - 1 ) / 2 );
+            ii = ( ii - 1 ) / 2;
+         }
+      }
+      void SiftDown( dip::uint ii ) {
+         while( true ) {
+            dip::uint smallest = ii;
+            dip::uint child = 2 * ii + 1;
+            if(( child < heap_.size() ) && HeapLess( child, smallest )) {
+               smallest = child;
+            }
+            ++child;
+            if(( child < heap_.size() ) && HeapLess( child, smallest )) {
+               smallest = child;
+            }
+            if( smallest == ii ) {
+               return;
+            }
+            HeapSwap( ii, smallest );
+            ii = smallest;
+         }
+      }
+      void HeapRemove( LabelType region ) {
+         dip::uint ii = heapIndex_[ region ];
+         if( ii == NOT_IN_HEAP ) {
+            return;
+         }
+         HeapSwap( ii, heap_.size() - 1 );
+         heap_.pop_back();
+         heapIndex_[ region ] = NOT_IN_HEAP;
+         if( ii < heap_.size() ) {
+            SiftUp( ii );
+            SiftDown( ii );
+         }
+      }
+};
+
+} // namespace
+
+LabelMap RegionMergeHierarchy::Apply( dip::uint nMerges ) const {
+   LabelMap map( labels_ );
+   // `merges_[ ii ].region2` is merged into `region1`, and never appears again. Walking the merges backwards,
+   // we know what the final label of `region1` is when we reach the merge that removes `region2`.
+   tsl::robin_map< LabelType, LabelType > target;
+   for( dip::uint ii = nMerges; ii > 0; --ii ) {
+      Merge const& merge = merges_[ ii - 1 ];
+      auto it = target.find( merge.region1 );
+      target[ merge.region2 ] = it == target.end() ? merge.region1 : it->second;
+   }
+   for( auto const& t : target ) {
+      map[ t.first ] = t.second;
+   }
+   return map;
+}
+
+LabelMap RegionMergeHierarchy::Cut( dfloat threshold ) const {
+   dip::uint nMerges = 0;
+   while(( nMerges < merges_.size() ) && ( merges_[ nMerges ].cost <= threshold )) {
+      ++nMerges;
+   }
+   return Apply( nMerges );
+}
+
+LabelMap RegionMergeHierarchy::CutNumberOfRegions( dip::uint nRegions ) const {
+   dip::uint nMerges = labels_.size() > nRegions ? labels_.size() - nRegions : 0;
+   return Apply( std::min( nMerges, merges_.size() ));
+}
+
+RegionMergeHierarchy HierarchicalRegionMerging(
+      Image const& labels,
+      Image const& grey,
+      String const& criterion,
+      String const& mode
+) {
+   MergeCriterion crit{};
+   if( criterion == "mean" ) {
+      crit = MergeCriterion::MEAN;
+   } else if( criterion == "Ward" ) {
+      crit = MergeCriterion::WARD;
+   } else if( criterion == "boundary" ) {
+      crit = MergeCriterion::BOUNDARY;
+   } else {
+      DIP_THROW_INVALID_FLAG( criterion );
+   }
+   bool useGrey = crit != MergeCriterion::BOUNDARY;
+   if( useGrey ) {
+      DIP_THROW_IF( !grey.IsForged(), E::IMAGE_NOT_FORGED );
+      DIP_THROW_IF( !grey.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+      DIP_THROW_IF( grey.Sizes() != labels.Sizes(), E::SIZES_DONT_MATCH );
+   }
+
+   // Region adjacency and boundary lengths
+   Graph graph;
+   std::vector< dfloat > boundaryLength;
+   DIP_STACK_TRACE_THIS( graph = RegionAdjacencyGraphInternal( labels, mode, boundaryLength ));
+
+   // Region sizes and sums
+   dip::uint nTensor = useGrey ? grey.TensorElements() : 0;
+   tsl::robin_map< LabelType, RegionSumAccumulator > regions;
+   DIP_STACK_TRACE_THIS( regions = PerLabelReduction( useGrey ? grey : labels, labels, {}, RegionSumAccumulator( nTensor ), false ));
+
+   RegionMerger merger( graph.NumberOfVertices(), nTensor, crit );
+   std::vector< LabelType > labelList;
+   labelList.reserve( regions.size() );
+   for( auto const& region : regions ) {
+      merger.SetRegion( region.first, region.second.Size(), region.second.Sum(), boundaryLength[ region.first ] );
+      labelList.push_back( region.first );
+   }
+   std::sort( labelList.begin(), labelList.end() );
+   for( auto const& edge : graph.Edges() ) {
+      if( edge.IsValid() ) {
+         merger.SetSharedBoundary( static_cast< LabelType >( edge.vertices[ 0 ] ), static_cast< LabelType >( edge.vertices[ 1 ] ), edge.weight );
+      }
+   }
+   return { std::move( labelList ), merger.Run() };
+}
+
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include <array>
+#include <map>
+#include "doctest.h"
+#include "diplib/random.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::HierarchicalRegionMerging") {
+   // Four regions in a 2x2 grid, plus a fifth one not touching the others
+   dip::Image label( { 40, 30 }, 1, dip::DT_UINT16 );
+   label.Fill( 0 );
+   label.At( dip::Range{ 0, 14 }, dip::Range{ 0, 14 } ).Fill( 3 );
+   label.At( dip::Range{ 15, 29 }, dip::Range{ 0, 14 } ).Fill( 5 );
+   label.At( dip::Range{ 0, 14 }, dip::Range{ 15, 29 } ).Fill( 6 );
+   label.At( dip::Range{ 15, 29 }, dip::Range{ 15, 29 } ).Fill( 9 );
+   label.At( dip::Range{ 35, 39 }, dip::Range{ 10, 20 } ).Fill( 10 );
+   dip::Image grey( { 40, 30 }, 1, dip::DT_SFLOAT );
+   grey.Fill( 0 );
+   grey.At( label == 3 ).Fill( 10 );
+   grey.At( label == 5 ).Fill( 12 );
+   grey.At( label == 6 ).Fill( 50 );
+   grey.At( label == 9 ).Fill( 53 );
+   grey.At( dip::Range{ 0, 14 }, dip::Range{ 0, 0 } ).Fill( 16 ); // a row in region 3, its mean becomes 10.4
+
+   dip::RegionMergeHierarchy hierarchy = dip::HierarchicalRegionMerging( label, grey );
+   DOCTEST_CHECK( hierarchy.NumberOfRegions() == 5 );
+   DOCTEST_CHECK( hierarchy.Labels() == std::vector< dip::LabelType >{ 3, 5, 6, 9, 10 } );
+   auto const& merges = hierarchy.Merges();
+   DOCTEST_REQUIRE( merges.size() == 3 );
+   DOCTEST_CHECK( merges[ 0 ].region1 == 3 );
+   DOCTEST_CHECK( merges[ 0 ].region2 == 5 );
+   DOCTEST_CHECK( merges[ 0 ].cost == doctest::Approx( 1.6 ));
+   DOCTEST_CHECK( merges[ 1 ].region1 == 6 );
+   DOCTEST_CHECK( merges[ 1 ].region2 == 9 );
+   DOCTEST_CHECK( merges[ 1 ].cost == doctest::Approx( 3.0 ));
+   DOCTEST_CHECK( merges[ 2 ].region1 == 3 );
+   DOCTEST_CHECK( merges[ 2 ].region2 == 6 );
+   DOCTEST_CHECK( merges[ 2 ].cost == doctest::Approx( 51.5 - 11.2 ));
+
+   dip::Image out = hierarchy.Cut( 2.0 ).Apply( label );
+   DOCTEST_CHECK( dip::ListObjectLabels( out ) == std::vector< dip::LabelType >{ 3, 6, 9, 10 } );
+   out = hierarchy.Cut( 10.0 ).Apply( label );
+   DOCTEST_CHECK( dip::ListObjectLabels( out ) == std::vector< dip::LabelType >{ 3, 6, 10 } );
+   out = hierarchy.CutNumberOfRegions( 1 ).Apply( label );
+   DOCTEST_CHECK( dip::ListObjectLabels( out ) == std::vector< dip::LabelType >{ 3, 10 } );
+   DOCTEST_CHECK( dip::Count( out == 3 ) == dip::Count( label > 0 ) - dip::Count( label == 10 ));
+
+   // Ward's criterion weighs the mean difference by the region sizes, here all regions have the same size
+   hierarchy = dip::HierarchicalRegionMerging( label, grey, "Ward" );
+   DOCTEST_REQUIRE( hierarchy.Merges().size() == 3 );
+   DOCTEST_CHECK( hierarchy.Merges()[ 0 ].cost == doctest::Approx( 112.5 * 1.6 * 1.6 ));
+   DOCTEST_CHECK( hierarchy.Merges()[ 2 ].region2 == 6 );
+
+   // The boundary criterion doesn't need a grey-value image
+   hierarchy = dip::HierarchicalRegionMerging( label, {}, "boundary" );
+   DOCTEST_CHECK( hierarchy.Merges().size() == 3 );
+   DOCTEST_CHECK( hierarchy.Merges()[ 0 ].cost == doctest::Approx( 0.5 ));
+   DOCTEST_CHECK_THROWS( dip::HierarchicalRegionMerging( label, {}, "mean" ));
+   DOCTEST_CHECK_THROWS( dip::HierarchicalRegionMerging( label, grey, "foo" ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::HierarchicalRegionMerging against a brute-force reference") {
+   // Random labels and a random two-channel grey-value image
+   constexpr dip::uint width = 16;
+   constexpr dip::uint height = 12;
+   dip::Image label( { width, height }, 1, dip::DT_UINT16 );
+   dip::Image grey( { width, height }, 2, dip::DT_DFLOAT );
+   std::vector< dip::LabelType > initial( width * height );
+   std::vector< std::array< dip::dfloat, 2 >> values( width * height );
+   dip::Random random( 0 );
+   dip::UniformRandomGenerator uniform( random );
+   for( dip::uint y = 0; y < height; ++y ) {
+      for( dip::uint x = 0; x < width; ++x ) {
+         dip::uint index = x + y * width;
+         initial[ index ] = static_cast< dip::LabelType >( random() % 25 ); // about 4% of pixels is background
+         values[ index ] = { uniform( 0.0, 100.0 ), uniform( 0.0, 100.0 ) };
+         label.At( x, y ) = initial[ index ];
+         grey.At( x, y ) = { values[ index ][ 0 ], values[ index ][ 1 ] };
+      }
+   }
+
+   // Returns the cheapest merge (cost, region1, region2) for the regions in `current`, computing all region
+   // statistics from the pixels. `found` is set to false if no two regions are adjacent.
+   using Candidate = std::tuple< dip::dfloat, dip::LabelType, dip::LabelType >;
+   auto Cheapest = [ & ]( std::vector< dip::LabelType > const& current, dip::String const& criterion, bool& found ) {
+      std::map< dip::LabelType, dip::dfloat > size;
+      std::map< dip::LabelType, dip::dfloat > boundary;
+      std::map< dip::LabelType, std::array< dip::dfloat, 2 >> sum;
+      std::map< std::pair< dip::LabelType, dip::LabelType >, dip::dfloat > shared;
+      for( dip::uint y = 0; y < height; ++y ) {
+         for( dip::uint x = 0; x < width; ++x ) {
+            dip::uint index = x + y * width;
+            dip::LabelType region = current[ index ];
+            if( region == 0 ) {
+               continue;
+            }
+            size[ region ] += 1;
+            sum[ region ][ 0 ] += values[ index ][ 0 ];
+            sum[ region ][ 1 ] += values[ index ][ 1 ];
+            for( dip::uint neighborIndex : { x + 1 < width ? index + 1 : index, y + 1 < height ? index + width : index } ) {
+               dip::LabelType neighbor = current[ neighborIndex ];
+               if(( neighbor != 0 ) && ( neighbor != region )) {
+                  shared[ { std::min( region, neighbor ), std::max( region, neighbor ) } ] += 1;
+                  boundary[ region ] += 1;
+                  boundary[ neighbor ] += 1;
+               }
+            }
+         }
+      }
+      found = false;
+      Candidate best{};
+      for( auto const& pair : shared ) {
+         dip::LabelType a = pair.first.first;
+         dip::LabelType b = pair.first.second;
+         dip::dfloat distance2 = 0.0;
+         for( dip::uint jj = 0; jj < 2; ++jj ) {
+            dip::dfloat diff = sum[ a ][ jj ] / size[ a ] - sum[ b ][ jj ] / size[ b ];
+            distance2 += diff * diff;
+         }
+         dip::dfloat cost{};
+         if( criterion == "mean" ) {
+            cost = std::sqrt( distance2 );
+         } else if( criterion == "Ward" ) {
+            cost = size[ a ] * size[ b ] / ( size[ a ] + size[ b ] ) * distance2;
+         } else {
+            cost = 1.0 - std::max( pair.second / boundary[ a ], pair.second / boundary[ b ] );
+         }
+         Candidate candidate{ cost, a, b };
+         if( !found || ( candidate < best )) {
+            best = candidate;
+            found = true;
+         }
+      }
+      return best;
+   };
+
+   for( dip::String criterion : { "mean", "Ward", "boundary" } ) {
+      DOCTEST_INFO( "criterion = " << criterion );
+      dip::RegionMergeHierarchy hierarchy = dip::HierarchicalRegionMerging( label, grey, criterion );
+      std::vector< dip::LabelType > current = initial;
+      bool found{};
+      for( auto const& merge : hierarchy.Merges() ) {
+         Candidate expected = Cheapest( current, criterion, found );
+         DOCTEST_REQUIRE( found );
+         DOCTEST_CHECK( merge.region1 == std::get< 1 >( expected ));
+         DOCTEST_CHECK( merge.region2 == std::get< 2 >( expected ));
+         DOCTEST_CHECK( merge.cost == doctest::Approx( std::get< 0 >( expected )));
+         std::replace( current.begin(), current.end(), merge.region2, merge.region1 );
+      }
+      // After the last merge, no two regions are adjacent
+      Cheapest( current, criterion, found );
+      DOCTEST_CHECK( !found );
+   }
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -18,15 +18,17 @@
 #include "diplib/graph.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <memory>
-#include <queue>
 #include <vector>
 
 #include "diplib.h"
 #include "diplib/framework.h"
 #include "diplib/label_map.h"
+#include "diplib/multithreading.h"
 #include "diplib/overload.h"
 #include "diplib/union_find.h"
 
@@ -177,6 +179,19 @@ DirectedGraph::DirectedGraph( Graph const& graph )
    }
 }
 
+DirectedGraph::DirectedGraph( CompactGraph const& graph )
+   : DirectedGraph( graph.NumberOfVertices() ) {
+   for( dip::uint ii = 0; ii < graph.NumberOfVertices(); ++ii ) {
+      vertices_[ ii ].value = graph.VertexValue( ii );
+      vertices_[ ii ].edges.reserve( graph.EdgeIndices( ii ).size() );
+   }
+   for( auto const& edge : graph.Edges() ) {
+      if( edge.IsValid() ) {
+         AddEdgePairNoCheck( edge.vertices[ 0 ], edge.vertices[ 1 ], edge.weight, edge.weight );
+      }
+   }
+}
+
 void DirectedGraph::IsConnectedTo( VertexIndex root ) {
    for( auto& vertex: vertices_ ) {
       vertex.value = 0;
@@ -197,56 +212,212 @@ void DirectedGraph::IsConnectedTo( VertexIndex root ) {
    }
 }
 
-Graph MinimumSpanningForest( Graph const& graph, std::vector< Graph::VertexIndex > const& roots ) {
-#ifdef DIP_CONFIG_ENABLE_ASSERT
-   for( auto r : roots ) {
-      DIP_ASSERT( r < graph.NumberOfVertices() );
-   }
-#endif
+namespace {
+
+// Computes the minimum spanning forest using Borůvka's algorithm, in parallel. Returns the list of edges in the forest.
+//
+// In each iteration, each component finds the cheapest edge that joins it to another component (in parallel over the
+// edges, using an atomic compare-and-swap to keep the minimum), and then all those edges are added to the forest and
+// their components merged (in parallel, using a lock-free union-find). Edges with the same weight are ordered by their
+// index, so that the cheapest edge is unique, and the result is deterministic. The roots are merged into one
+// component at the start, so each root spawns its own tree; trees that don't contain a root are discarded at the end.
+//
+// `GraphType` must have the member functions `NumberOfVertices()`, `NumberOfEdges()`, `IsValidEdge(edge)`,
+// `EdgeVertex(edge, which)` and `EdgeWeight(edge)`.
+template< typename GraphType >
+std::vector< Graph::Edge > BoruvkaMinimumSpanningForest( GraphType const& graph, std::vector< Graph::VertexIndex > const& roots ) {
    using EdgeIndex = Graph::EdgeIndex;
    using VertexIndex = Graph::VertexIndex;
-   Graph msf( graph.NumberOfVertices() );
-   for( dip::uint ii = 0; ii < graph.NumberOfVertices(); ++ii ) {
-      msf.VertexValue( ii ) = graph.VertexValue( ii );
+   constexpr EdgeIndex NO_EDGE = std::numeric_limits< EdgeIndex >::max();
+   dip::uint nVertices = graph.NumberOfVertices();
+   dip::uint nEdges = graph.NumberOfEdges();
+   if( nVertices == 0 ) {
+      return {};
    }
-   std::vector< bool > visited( graph.NumberOfVertices(), false );
-   auto Comparator = [ & ]( EdgeIndex lhs, EdgeIndex rhs ) {
-      return graph.EdgeWeight( lhs ) > graph.EdgeWeight( rhs );
-   }; // NOTE! inverted order to give higher priority to lower weights
-   std::priority_queue< EdgeIndex, std::vector< EdgeIndex >, decltype( Comparator ) > queue( Comparator );
-   if( roots.empty() ) {
-      visited[ 0 ] = true;
-      for( auto index : graph.EdgeIndices( 0 )) {
-         queue.push( index );
+   for( auto r : roots ) {
+      DIP_THROW_IF( r >= nVertices, E::INDEX_OUT_OF_RANGE );
+   }
+   auto Less = [ & ]( EdgeIndex lhs, EdgeIndex rhs ) {
+      dfloat lw = graph.EdgeWeight( lhs );
+      dfloat rw = graph.EdgeWeight( rhs );
+      return ( lw < rw ) || (( lw == rw ) && ( lhs < rhs ));
+   };
+   dip::uint nThreads = 1;
+   if( nEdges * 20 > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), nEdges / 1024 + 1 );
+   }
+   dip::sint sVertices = static_cast< dip::sint >( nVertices );
+
+   // Union-find data: `parent` is modified concurrently, `component` is the flattened version, updated after each iteration
+   std::vector< std::atomic< VertexIndex >> parent( nVertices );
+   std::vector< VertexIndex > component( nVertices );
+   std::vector< std::atomic< EdgeIndex >> cheapest( nVertices );
+   #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+   for( dip::sint ii = 0; ii < sVertices; ++ii ) {
+      parent[ static_cast< dip::uint >( ii ) ].store( static_cast< VertexIndex >( ii ), std::memory_order_relaxed );
+   }
+   auto FindRoot = [ & ]( VertexIndex v ) {
+      VertexIndex p = parent[ v ].load( std::memory_order_relaxed );
+      while( p != v ) {
+         v = p;
+         p = parent[ v ].load( std::memory_order_relaxed );
       }
-   } else {
-      for( auto q : roots ) {
-         if( !visited[ q ] ) {
-            visited[ q ] = true;
-            for( auto index : graph.EdgeIndices( q )) {
-               queue.push( index );
-            }
+      return v;
+   };
+   auto Union = [ & ]( VertexIndex a, VertexIndex b ) {
+      while( true ) {
+         a = FindRoot( a );
+         b = FindRoot( b );
+         if( a == b ) {
+            return;
+         }
+         if( a < b ) {
+            std::swap( a, b );
+         }
+         // Link the root with the larger index to the other one. If `a` is no longer a root, try again.
+         VertexIndex expected = a;
+         if( parent[ a ].compare_exchange_strong( expected, b )) {
+            return;
          }
       }
+   };
+   VertexIndex root = roots.empty() ? 0 : roots[ 0 ];
+   for( auto r : roots ) {
+      Union( root, r );
    }
-   while( !queue.empty() ) {
-      EdgeIndex edgeIndex = queue.top();
-      queue.pop();
-      VertexIndex q = graph.EdgeVertex( edgeIndex, 0 );
-      if( visited[ q ] ) {
-         q = graph.EdgeVertex( edgeIndex, 1 ); // try the other end then
+
+   // Edges that still join two different components
+   std::vector< EdgeIndex > candidates;
+   bool firstIteration = true;
+   std::vector< std::vector< EdgeIndex >> threadEdges( nThreads );
+   std::vector< std::vector< EdgeIndex >> threadCandidates( nThreads );
+   while( true ) {
+      bool merged = false;
+      dip::sint sCandidates = firstIteration ? static_cast< dip::sint >( nEdges ) : static_cast< dip::sint >( candidates.size() );
+      #pragma omp parallel num_threads( static_cast< int >( nThreads )) reduction( || : merged )
+      {
+         dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+         // Flatten the union-find structure
+         #pragma omp for schedule( static )
+         for( dip::sint ii = 0; ii < sVertices; ++ii ) {
+            dip::uint v = static_cast< dip::uint >( ii );
+            component[ v ] = FindRoot( v );
+            cheapest[ v ].store( NO_EDGE, std::memory_order_relaxed );
+         }
+         #pragma omp for schedule( static )
+         for( dip::sint ii = 0; ii < sVertices; ++ii ) {
+            parent[ static_cast< dip::uint >( ii ) ].store( component[ static_cast< dip::uint >( ii ) ], std::memory_order_relaxed );
+         }
+         // Find the cheapest edge for each component, and keep the edges that join two components for the next iteration
+         threadCandidates[ thread ].clear();
+         #pragma omp for schedule( static )
+         for( dip::sint ii = 0; ii < sCandidates; ++ii ) {
+            EdgeIndex edge = firstIteration ? static_cast< EdgeIndex >( ii ) : candidates[ static_cast< dip::uint >( ii ) ];
+            if( firstIteration && !graph.IsValidEdge( edge )) {
+               continue;
+            }
+            VertexIndex c0 = component[ graph.EdgeVertex( edge, 0 ) ];
+            VertexIndex c1 = component[ graph.EdgeVertex( edge, 1 ) ];
+            if( c0 == c1 ) {
+               continue;
+            }
+            threadCandidates[ thread ].push_back( edge );
+            for( VertexIndex c : { c0, c1 } ) {
+               EdgeIndex current = cheapest[ c ].load( std::memory_order_relaxed );
+               while((( current == NO_EDGE ) || Less( edge, current )) && !cheapest[ c ].compare_exchange_weak( current, edge )) {}
+            }
+         }
+         // Add the cheapest edges to the forest, and merge components. If two components selected the same edge,
+         // the one with the larger index adds it.
+         #pragma omp for schedule( static )
+         for( dip::sint ii = 0; ii < sVertices; ++ii ) {
+            VertexIndex c = static_cast< VertexIndex >( ii );
+            EdgeIndex edge = cheapest[ c ].load( std::memory_order_relaxed );
+            if( edge == NO_EDGE ) {
+               continue;
+            }
+            VertexIndex c0 = component[ graph.EdgeVertex( edge, 0 ) ];
+            VertexIndex other = c0 == c ? component[ graph.EdgeVertex( edge, 1 ) ] : c0;
+            if(( other > c ) && ( cheapest[ other ].load( std::memory_order_relaxed ) == edge )) {
+               continue;
+            }
+            threadEdges[ thread ].push_back( edge );
+            Union( c, other );
+            merged = true;
+         }
+      }
+      if( !merged ) {
+         break;
+      }
+      // Collect candidate edges for the next iteration
+      dip::uint nCandidates = 0;
+      for( auto const& tc : threadCandidates ) {
+         nCandidates += tc.size();
       }
-      if( !visited[ q ] ) {
-         visited[ q ] = true;
-         msf.AddEdgeNoCheck( graph.Edges()[ edgeIndex ] );
-         for( auto index : graph.EdgeIndices( q )) {
-            queue.push( index );
+      candidates.clear();
+      candidates.reserve( nCandidates );
+      for( auto& tc : threadCandidates ) {
+         candidates.insert( candidates.end(), tc.begin(), tc.end() );
+      }
+      firstIteration = false;
+   }
+
+   // Collect the edges in the trees that contain the roots, sorted by index
+   std::vector< EdgeIndex > forestEdges;
+   VertexIndex rootComponent = component[ root ];
+   for( auto const& te : threadEdges ) {
+      for( auto edge : te ) {
+         if( component[ graph.EdgeVertex( edge, 0 ) ] == rootComponent ) {
+            forestEdges.push_back( edge );
          }
       }
    }
+   std::sort( forestEdges.begin(), forestEdges.end() );
+   std::vector< Graph::Edge > out( forestEdges.size() );
+   for( dip::uint ii = 0; ii < forestEdges.size(); ++ii ) {
+      out[ ii ] = { {{ graph.EdgeVertex( forestEdges[ ii ], 0 ), graph.EdgeVertex( forestEdges[ ii ], 1 ) }}, graph.EdgeWeight( forestEdges[ ii ] ) };
+   }
+   return out;
+}
+
+} // namespace
+
+Graph MinimumSpanningForest( Graph const& graph, std::vector< Graph::VertexIndex > const& roots ) {
+   std::vector< Graph::Edge > edges;
+   DIP_STACK_TRACE_THIS( edges = BoruvkaMinimumSpanningForest( graph, roots ));
+   Graph msf( graph.NumberOfVertices() );
+   for( dip::uint ii = 0; ii < graph.NumberOfVertices(); ++ii ) {
+      msf.VertexValue( ii ) = graph.VertexValue( ii );
+   }
+   for( auto const& edge : edges ) {
+      msf.AddEdgeNoCheck( edge );
+   }
+   return msf;
+}
+
+namespace {
+
+template< typename GraphType >
+CompactGraph CompactMinimumSpanningForest( GraphType const& graph, std::vector< Graph::VertexIndex > const& roots ) {
+   std::vector< Graph::Edge > edges;
+   DIP_STACK_TRACE_THIS( edges = BoruvkaMinimumSpanningForest( graph, roots ));
+   CompactGraph msf( graph.NumberOfVertices(), std::move( edges ));
+   for( dip::uint ii = 0; ii < graph.NumberOfVertices(); ++ii ) {
+      msf.VertexValue( ii ) = graph.VertexValue( ii );
+   }
    return msf;
 }
 
+} // namespace
+
+CompactGraph MinimumSpanningForest( CompactGraph const& graph, std::vector< CompactGraph::VertexIndex > const& roots ) {
+   return CompactMinimumSpanningForest( graph, roots );
+}
+
+CompactGraph MinimumSpanningForest( GridGraph const& graph, std::vector< GridGraph::VertexIndex > const& roots ) {
+   return CompactMinimumSpanningForest( graph, roots );
+}
+
 void Graph::RemoveLargestEdges( dip::uint number ) {
    if( number == 0 ) {
       // Nothing to do
@@ -294,10 +465,232 @@ LabelMap Label( DirectedGraph const& graph ) {
    return LabelMap( regions );
 }
 
+void CompactGraph::BuildAdjacency() {
+   // Counting sort of the edge endpoints by vertex
+   dip::uint nVertices = values_.size();
+   offsets_.assign( nVertices + 1, 0 );
+   for( auto const& edge : edges_ ) {
+      if( edge.IsValid() ) {
+         DIP_THROW_IF( edge.vertices[ 1 ] >= nVertices, E::INDEX_OUT_OF_RANGE );
+         ++offsets_[ edge.vertices[ 0 ] + 1 ];
+         ++offsets_[ edge.vertices[ 1 ] + 1 ];
+      }
+   }
+   for( dip::uint ii = 1; ii <= nVertices; ++ii ) {
+      offsets_[ ii ] += offsets_[ ii - 1 ];
+   }
+   adjacency_.resize( offsets_[ nVertices ] );
+   std::vector< EdgeIndex > next( offsets_.begin(), offsets_.end() - 1 );
+   for( EdgeIndex ii = 0; ii < edges_.size(); ++ii ) {
+      if( edges_[ ii ].IsValid() ) {
+         adjacency_[ next[ edges_[ ii ].vertices[ 0 ]]++ ] = ii;
+         adjacency_[ next[ edges_[ ii ].vertices[ 1 ]]++ ] = ii;
+      }
+   }
+}
+
+CompactGraph::CompactGraph( dip::uint nVertices, std::vector< Edge > edges )
+      : values_( nVertices, 0.0 ), edges_( std::move( edges )) {
+   DIP_STACK_TRACE_THIS( BuildAdjacency() );
+}
+
+CompactGraph::CompactGraph( Graph const& graph ) : values_( graph.NumberOfVertices() ) {
+   for( dip::uint ii = 0; ii < values_.size(); ++ii ) {
+      values_[ ii ] = graph.VertexValue( ii );
+   }
+   edges_.reserve( graph.CountEdges() );
+   for( auto const& edge : graph.Edges() ) {
+      if( edge.IsValid() ) {
+         edges_.push_back( edge );
+      }
+   }
+   BuildAdjacency();
+}
+
+namespace {
+
+// Copies the pixel values of `image` to `values`, in linear index order
+void CopyPixelValues( Image const& image, std::vector< dfloat >& values ) {
+   values.resize( image.NumberOfPixels() );
+   Image wrapper( NonOwnedRefToDataSegment( values.data() ), values.data(), DT_DFLOAT, image.Sizes() );
+   wrapper.Copy( image );
+}
+
+// Increments `coords` to point at the next pixel in linear index order
+void IncrementCoordinates( UnsignedArray& coords, UnsignedArray const& sizes ) {
+   for( dip::uint jj = 0; jj < sizes.size(); ++jj ) {
+      if( ++coords[ jj ] < sizes[ jj ] ) {
+         return;
+      }
+      coords[ jj ] = 0;
+   }
+}
+
+} // namespace
+
+CompactGraph::CompactGraph( Image const& image, dip::uint connectivity, String const& weights ) {
+   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !image.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !image.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( image.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( connectivity != 1, E::NOT_IMPLEMENTED );
+   bool computeEdgeWeights{};
+   bool useDifferences{};
+   DIP_STACK_TRACE_THIS( ParseWeightsParam( weights, computeEdgeWeights, useDifferences ));
+   DIP_STACK_TRACE_THIS( CopyPixelValues( image, values_ ));
+   UnsignedArray const& sizes = image.Sizes();
+   dip::uint nDims = sizes.size();
+   dip::uint nVertices = values_.size();
+
+   // The edges along dimension `dim` are stored together, in linear index order of their first vertex, starting
+   // at `edgeOffsets[ dim ]`. `edgeStrides[ dim ]` are the normal strides of an image with one fewer pixel along
+   // `dim`, the edge at `coords` is at offset `edgeStrides[ dim ] * coords` within its block. This allows us to
+   // compute all edge indices directly, and fill the arrays in parallel.
+   UnsignedArray indexStrides( nDims );
+   std::vector< UnsignedArray > edgeStrides( nDims, UnsignedArray( nDims ));
+   UnsignedArray edgeOffsets( nDims + 1, 0 );
+   indexStrides[ 0 ] = 1;
+   for( dip::uint dim = 0; dim < nDims; ++dim ) {
+      if( dim > 0 ) {
+         indexStrides[ dim ] = indexStrides[ dim - 1 ] * sizes[ dim - 1 ];
+      }
+      edgeOffsets[ dim + 1 ] = edgeOffsets[ dim ] + nVertices / sizes[ dim ] * ( sizes[ dim ] - 1 );
+      edgeStrides[ dim ][ 0 ] = 1;
+      for( dip::uint jj = 1; jj < nDims; ++jj ) {
+         edgeStrides[ dim ][ jj ] = edgeStrides[ dim ][ jj - 1 ] * ( sizes[ jj - 1 ] - ( jj - 1 == dim ? 1 : 0 ));
+      }
+   }
+   auto EdgeAt = [ & ]( UnsignedArray const& coords, dip::uint dim ) {
+      EdgeIndex edge = edgeOffsets[ dim ];
+      for( dip::uint jj = 0; jj < nDims; ++jj ) {
+         edge += coords[ jj ] * edgeStrides[ dim ][ jj ];
+      }
+      return edge;
+   };
+   edges_.resize( edgeOffsets[ nDims ] );
+   offsets_.resize( nVertices + 1 );
+   adjacency_.resize( 2 * edges_.size() );
+
+   dip::uint nThreads = 1;
+   if( nVertices * nDims * 10 > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), nVertices / 1024 + 1 );
+   }
+   UnsignedArray chunkOffsets( nThreads + 1, 0 );
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      dip::uint nChunks = static_cast< dip::uint >( omp_get_num_threads() );
+      VertexIndex first = nVertices * thread / nChunks;
+      VertexIndex last = nVertices * ( thread + 1 ) / nChunks;
+      UnsignedArray startCoords( nDims );
+      for( dip::uint jj = 0; jj < nDims; ++jj ) {
+         startCoords[ jj ] = ( first / indexStrides[ jj ] ) % sizes[ jj ];
+      }
+      // Count the edges for the vertices in our chunk
+      UnsignedArray coords = startCoords;
+      EdgeIndex count = 0;
+      for( VertexIndex vertex = first; vertex < last; ++vertex ) {
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            count += ( coords[ jj ] > 0 ? 1u : 0u ) + ( coords[ jj ] < sizes[ jj ] - 1 ? 1u : 0u );
+         }
+         IncrementCoordinates( coords, sizes );
+      }
+      chunkOffsets[ thread + 1 ] = count;
+      #pragma omp barrier
+      #pragma omp single
+      for( dip::uint ii = 1; ii <= nChunks; ++ii ) {
+         chunkOffsets[ ii ] += chunkOffsets[ ii - 1 ];
+      }
+      // Fill in offsets, adjacency lists and edges
+      coords = startCoords;
+      EdgeIndex pos = chunkOffsets[ thread ];
+      for( VertexIndex vertex = first; vertex < last; ++vertex ) {
+         offsets_[ vertex ] = pos;
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            if( coords[ jj ] > 0 ) {
+               --coords[ jj ];
+               adjacency_[ pos++ ] = EdgeAt( coords, jj );
+               ++coords[ jj ];
+            }
+            if( coords[ jj ] < sizes[ jj ] - 1 ) {
+               EdgeIndex edge = EdgeAt( coords, jj );
+               adjacency_[ pos++ ] = edge;
+               VertexIndex neighbor = vertex + indexStrides[ jj ];
+               dfloat weight = 0;
+               if( computeEdgeWeights ) {
+                  weight = useDifferences ? std::abs( values_[ vertex ] - values_[ neighbor ] )
+                                          : ( values_[ vertex ] + values_[ neighbor ] ) / 2;
+               }
+               edges_[ edge ] = { {{ vertex, neighbor }}, weight };
+            }
+         }
+         IncrementCoordinates( coords, sizes );
+      }
+   }
+   offsets_[ nVertices ] = adjacency_.size();
+}
+
+void CompactGraph::RemoveLargestEdges( dip::uint number ) {
+   if( number == 0 ) {
+      // Nothing to do
+      return;
+   }
+   // Generate list of valid edges
+   std::vector< EdgeIndex > indices;
+   indices.reserve( edges_.size() );
+   for( EdgeIndex ii = 0; ii < edges_.size(); ++ii ) {
+      if( edges_[ ii ].IsValid() ) {
+         indices.push_back( ii );
+      }
+   }
+   // Find the largest edges
+   number = std::min( number, indices.size() ); // If number is too large, we will delete all edges.
+   dip::sint element = static_cast< dip::sint >( number ) - 1;
+   std::nth_element( indices.begin(), indices.begin() + element, indices.end(), [ this ]( EdgeIndex lhs, EdgeIndex rhs ){
+      return edges_[ lhs ].weight > edges_[ rhs ].weight;
+   } );
+   // Delete largest edges
+   for( dip::uint ii = 0; ii < number; ++ii ) {
+      DeleteEdge( indices[ ii ] );
+   }
+}
+
+GridGraph::GridGraph( Image const& image, dip::uint connectivity, String const& weights ) {
+   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !image.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !image.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( image.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( connectivity != 1, E::NOT_IMPLEMENTED );
+   bool computeEdgeWeights{};
+   DIP_STACK_TRACE_THIS( ParseWeightsParam( weights, computeEdgeWeights, useDifferences_ ));
+   if( !computeEdgeWeights ) {
+      DIP_THROW_INVALID_FLAG( weights ); // "zero" doesn't make sense here
+   }
+   sizes_ = image.Sizes();
+   indexStrides_.resize( sizes_.size() );
+   indexStrides_[ 0 ] = 1;
+   for( dip::uint ii = 1; ii < sizes_.size(); ++ii ) {
+      indexStrides_[ ii ] = indexStrides_[ ii - 1 ] * sizes_[ ii - 1 ];
+   }
+   DIP_STACK_TRACE_THIS( CopyPixelValues( image, values_ ));
+}
+
+LabelMap Label( CompactGraph const& graph ) {
+   SimpleUnionFind< CompactGraph::VertexIndex > regions( graph.NumberOfVertices() );
+   for( auto& edge: graph.Edges() ) {
+      if( edge.IsValid() ) {
+         regions.Union( edge.vertices[ 0 ], edge.vertices[ 1 ] );
+      }
+   }
+   regions.Relabel();
+   return LabelMap( regions );
+}
+
 } // namespace dip
 
 #ifdef DIP_CONFIG_ENABLE_DOCTEST
 #include "doctest.h"
+#include "diplib/generation.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing dip::Graph") {
    dip::Image img( { 4, 5 }, 1, dip::DT_UINT8 );
@@ -404,4 +797,82 @@ DOCTEST_TEST_CASE("[DIPlib] testing dip::DirectedGraph") {
    }
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing dip::CompactGraph and dip::GridGraph") {
+   dip::Image img( { 7, 5, 3 }, 1, dip::DT_SFLOAT );
+   dip::Random random( 0 );
+   img.Fill( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   dip::Graph graph( img );
+   dip::CompactGraph compact( img );
+   dip::GridGraph grid( img );
+   DOCTEST_REQUIRE( compact.NumberOfVertices() == graph.NumberOfVertices() );
+   DOCTEST_REQUIRE( grid.NumberOfVertices() == graph.NumberOfVertices() );
+   DOCTEST_CHECK( compact.CountEdges() == graph.CountEdges() );
+   DOCTEST_CHECK( grid.CountEdges() == graph.CountEdges() );
+   auto Neighbors = []( auto& g, dip::uint vertex ) {
+      std::vector< dip::uint > out = g.Neighbors( vertex );
+      std::sort( out.begin(), out.end() );
+      return out;
+   };
+   for( dip::uint ii = 0; ii < graph.NumberOfVertices(); ++ii ) {
+      DOCTEST_CHECK( compact.VertexValue( ii ) == graph.VertexValue( ii ));
+      DOCTEST_CHECK( grid.VertexValue( ii ) == graph.VertexValue( ii ));
+      auto expected = Neighbors( graph, ii );
+      DOCTEST_CHECK( Neighbors( compact, ii ) == expected );
+      DOCTEST_CHECK( Neighbors( grid, ii ) == expected );
+      compact.ForEachEdge( ii, [ & ]( dip::uint edge, dip::uint neighbor ) {
+         DOCTEST_CHECK( compact.EdgeWeight( edge ) == std::abs( graph.VertexValue( ii ) - graph.VertexValue( neighbor )));
+      } );
+      grid.ForEachEdge( ii, [ & ]( dip::uint edge, dip::uint neighbor ) {
+         DOCTEST_CHECK( grid.IsValidEdge( edge ));
+         DOCTEST_CHECK( grid.OtherVertex( edge, ii ) == neighbor );
+         DOCTEST_CHECK( grid.EdgeWeight( edge ) == std::abs( graph.VertexValue( ii ) - graph.VertexValue( neighbor )));
+      } );
+   }
+   // The three MSTs must have the same total weight
+   auto TotalWeight = []( auto const& g ) {
+      dip::dfloat sum = 0;
+      for( auto const& edge : g.Edges() ) {
+         if( edge.IsValid() ) {
+            sum += edge.weight;
+         }
+      }
+      return sum;
+   };
+   dip::Graph msf = dip::MinimumSpanningForest( graph );
+   dip::CompactGraph msf1 = dip::MinimumSpanningForest( compact );
+   dip::CompactGraph msf2 = dip::MinimumSpanningForest( grid );
+   DOCTEST_CHECK( msf1.CountEdges() == graph.NumberOfVertices() - 1 );
+   DOCTEST_CHECK( msf2.CountEdges() == graph.NumberOfVertices() - 1 );
+   DOCTEST_CHECK( TotalWeight( msf1 ) == doctest::Approx( TotalWeight( msf )));
+   DOCTEST_CHECK( TotalWeight( msf2 ) == doctest::Approx( TotalWeight( msf )));
+   // Cutting the trees must give the same segmentation
+   msf.RemoveLargestEdges( 5 );
+   msf1.RemoveLargestEdges( 5 );
+   DOCTEST_CHECK( msf1.CountEdges() == graph.NumberOfVertices() - 6 );
+   dip::LabelMap labels = dip::Label( msf );
+   dip::LabelMap labels1 = dip::Label( msf1 );
+   for( dip::uint ii = 0; ii < graph.NumberOfVertices(); ++ii ) {
+      DOCTEST_CHECK( labels[ static_cast< dip::LabelType >( ii ) ] == labels1[ static_cast< dip::LabelType >( ii ) ] );
+   }
+   // Each root spawns a tree
+   dip::CompactGraph msf3 = dip::MinimumSpanningForest( grid, { 0, 50, 104 } );
+   DOCTEST_CHECK( msf3.CountEdges() == graph.NumberOfVertices() - 3 );
+   dip::LabelMap labels3 = dip::Label( msf3 );
+   DOCTEST_CHECK( labels3[ 0 ] != labels3[ 50 ] );
+   DOCTEST_CHECK( labels3[ 0 ] != labels3[ 104 ] );
+   DOCTEST_CHECK( labels3[ 50 ] != labels3[ 104 ] );
+   // With all weights equal, ties are broken by edge index: the lowest-index edges that form a tree are selected
+   dip::Image flat = img.Similar();
+   flat.Fill( 1 );
+   dip::CompactGraph msf4 = dip::MinimumSpanningForest( dip::CompactGraph( flat ));
+   DOCTEST_REQUIRE( msf4.CountEdges() == graph.NumberOfVertices() - 1 );
+   DOCTEST_CHECK( msf4.Edges()[ 0 ].vertices[ 0 ] == 0 ); // Edges along dimension 0 come first
+   DOCTEST_CHECK( msf4.Edges()[ 0 ].vertices[ 1 ] == 1 );
+   // A graph constructed from the edge list
+   dip::CompactGraph compact2( graph );
+   DOCTEST_CHECK( compact2.CountEdges() == graph.CountEdges() );
+   DOCTEST_CHECK( TotalWeight( dip::MinimumSpanningForest( compact2 )) == doctest::Approx( TotalWeight( dip::MinimumSpanningForest( graph ))));
+}
+
 #endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -21,18 +21,16 @@
 #include <cmath>
 #include <cstdlib>
 #include <limits>
-#include <memory>
 #include <utility>
 #include <vector>
 
 #include "diplib.h"
 #include "diplib/distance.h"
-#include "diplib/framework.h"
 #include "diplib/histogram.h"
 #include "diplib/linear.h"
 #include "diplib/lookup_table.h"
 #include "diplib/math.h"
-#include "diplib/overload.h"
+#include "diplib/multithreading.h"
 #include "diplib/statistics.h"
 
 
@@ -524,93 +522,358 @@ void ComputeTerminalWeights( Image const& in, Image const& markers, Image& sourc
    ComputeTerminalWeights( in, markers == 1, sinkWeights, config, lambda, gamma );
 }
 
-template< typename TPI >
-class AddTerminalEdges : public Framework::ScanLineFilter {
+// Max-flow on an implicit grid graph, for `GraphCut(Image const&, ...)`.
+//
+// This is the same algorithm as above (Boykov and Kolmogorov), but each pixel is a node, and the edges between
+// neighboring pixels are not stored explicitly. For each direction (forward and backward along each dimension)
+// we store the residual capacity of the edge that leaves each node in that direction, in one array per direction.
+// The two terminal edges of a node are combined into a single residual capacity, positive for an edge from the source,
+// negative for an edge to the sink. A node's parent in the search tree is stored as the direction in which it lies.
+//
+// This implementation additionally uses the timestamp and distance heuristic from Kolmogorov's implementation to
+// quickly determine if a node is connected to a terminal, and to prefer short paths when adopting orphans.
+class GridMaxFlow {
    public:
-      AddTerminalEdges(
-         DirectedGraph& graph,
-         Image const& sourceWeights,
-         Image const& sinkWeights,
-         UnsignedArray const& sizes,
-         DirectedGraph::VertexIndex sourceVertex,
-         DirectedGraph::VertexIndex sinkVertex
-      ) : graph_( graph ), sourceWeights_( sourceWeights ), sinkWeights_( sinkWeights ),
-          sizes_( sizes ), sourceVertex_( sourceVertex ), sinkVertex_( sinkVertex ) {
-         DIP_ASSERT( !sourceWeights.IsForged() || sourceWeights.HasNormalStrides() );
-         DIP_ASSERT( !sourceWeights.IsForged() || sourceWeights.DataType() == DT_SFLOAT );
-         DIP_ASSERT( !sinkWeights.IsForged() || sinkWeights.HasNormalStrides() );
-         DIP_ASSERT( !sinkWeights.IsForged() || sinkWeights.DataType() == DT_SFLOAT );
-      }
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
-         dip::sint bufferStride = params.inBuffer[ 0 ].stride;
-         dip::uint length = params.bufferLength;
-         dip::uint index = Image::Index( params.position, sizes_ );
-         dip::uint indexStride = 1;
-         for( dip::uint jj = 0; jj < params.dimension; ++jj ) {
-            indexStride *= sizes_[ jj ];
+      // `sizes` is the image size. After construction, fill in `Residual()` and `TerminalResidual()`, then call `Compute()`.
+      explicit GridMaxFlow( UnsignedArray const& sizes ) : nDirs_( 2 * sizes.size() ) {
+         DIP_THROW_IF( nDirs_ > 32, E::DIMENSIONALITY_NOT_SUPPORTED );
+         nNodes_ = sizes.product();
+         offsets_.resize( nDirs_ );
+         dip::sint stride = 1;
+         for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+            offsets_[ 2 * ii ] = stride;
+            offsets_[ 2 * ii + 1 ] = -stride;
+            stride *= static_cast< dip::sint >( sizes[ ii ] );
          }
-         bool useTerminalWeights = sourceWeights_.IsForged() && sinkWeights_.IsForged();
-         sfloat const* sourceWeightsPtr = useTerminalWeights ? static_cast< sfloat const* >( sourceWeights_.Pointer( params.position )) : nullptr;
-         dip::sint sourceWeightsStride = useTerminalWeights ? sourceWeights_.Stride( params.dimension ) : 0;
-         sfloat const* sinkWeightsPtr = useTerminalWeights ? static_cast< sfloat const* >( sinkWeights_.Pointer( params.position )) : nullptr;
-         dip::sint sinkWeightsStride = useTerminalWeights ? sinkWeights_.Stride( params.dimension ) : 0;
-         for( dip::uint ii = 0; ii < length; ++ii, index += indexStride, in += bufferStride ) {
-            TPI label = *in;
-            if( label == 1 ) { // It's source pixel
-               graph_.AddEdgePair( sourceVertex_, index, dip::infinity );
-               // NOTE: The weight "K" in the paper is 1 + max(edge weights). But that doesn't take lambda into
-               // account, why not? We're just using infinity instead, it's an edge that should never be broken,
-               // so this makes most sense.
-               // NOTE: There's no point, for this algorithm, to add edges with a weight of 0. These just increase
-               // the computation time. So we don't add edges to the sink here.
-            } else if( label == 2 ) { // It's a sink pixel
-               graph_.AddEdgePair( index, sinkVertex_, dip::infinity );
-            } else if( useTerminalWeights ) {
-               // Instead of adding an edge pair to the source with weight w1 and another to the sink with weight w2,
-               // We add a single edge with the difference. We basically subtract min(w1,w2) from both weights, one
-               // will become 0 and therefore we can leave it out. If they're equal, we don't need either edge.
-               dfloat w = sourceWeightsPtr[ static_cast< dip::sint >( ii ) * sourceWeightsStride ] - sinkWeightsPtr[ static_cast< dip::sint >( ii ) * sinkWeightsStride ];
-               if( w < 0.0 ) {
-                  graph_.AddEdgePair( index, sinkVertex_, -w );
-               } else if( w > 0.0 ) {
-                  graph_.AddEdgePair( sourceVertex_, index, w );
+         residual_.resize( nDirs_ );
+         for( auto& r : residual_ ) {
+            r.resize( nNodes_, 0.0 );
+         }
+         terminalResidual_.resize( nNodes_, 0.0 );
+         nodes_.resize( nNodes_ );
+         // Find which neighbors each node has
+         UnsignedArray coords( sizes.size(), 0 );
+         for( auto& node : nodes_ ) {
+            for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+               if( coords[ ii ] < sizes[ ii ] - 1 ) {
+                  node.neighbors |= 1u << ( 2 * ii );
+               }
+               if( coords[ ii ] > 0 ) {
+                  node.neighbors |= 1u << ( 2 * ii + 1 );
+               }
+            }
+            for( dip::uint ii = 0; ii < sizes.size(); ++ii ) {
+               if( ++coords[ ii ] < sizes[ ii ] ) {
+                  break;
                }
+               coords[ ii ] = 0;
             }
          }
       }
 
-   private:
-      DirectedGraph& graph_;
-      Image const& sourceWeights_;
-      Image const& sinkWeights_;
-      UnsignedArray const& sizes_;
-      DirectedGraph::VertexIndex sourceVertex_;
-      DirectedGraph::VertexIndex sinkVertex_;
-};
+      // Number of directions, 2 per dimension
+      dip::uint Directions() const { return nDirs_; }
+      // The residual capacity of the edges from each node in direction `dir`. Even directions go forward, odd ones backward.
+      std::vector< dfloat >& Residual( dip::uint dir ) { return residual_[ dir ]; }
+      // The residual capacity of the terminal edges, positive for the source, negative for the sink.
+      std::vector< dfloat >& TerminalResidual() { return terminalResidual_; }
+      // The edge from node `node` in direction `dir` exists.
+      bool HasNeighbor( VertexIndex node, dip::uint dir ) const { return nodes_[ node ].neighbors & ( 1u << dir ); }
 
-class PaintOut : public Framework::ScanLineFilter {
-   public:
-      PaintOut( DirectedGraph const& graph, UnsignedArray const& sizes ) : graph_( graph ), sizes_( sizes ) {}
-      void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         bin* out = static_cast< bin* >( params.outBuffer[ 0 ].buffer );
-         dip::sint stride = params.outBuffer[ 0 ].stride;
-         dip::uint length = params.bufferLength;
-         dip::uint index = Image::Index( params.position, sizes_ );
-         dip::uint indexStride = 1;
-         for( dip::uint jj = 0; jj < params.dimension; ++jj ) {
-            indexStride *= sizes_[ jj ];
+      // Computes the maximum flow.
+      void Compute() {
+         activeQueue_.clear();
+         activeFirst_ = 0;
+         for( VertexIndex ii = 0; ii < nNodes_; ++ii ) {
+            if( terminalResidual_[ ii ] != 0 ) {
+               nodes_[ ii ].tree = terminalResidual_[ ii ] > 0 ? SOURCE : SINK;
+               nodes_[ ii ].parent = TERMINAL;
+               nodes_[ ii ].distance = 1;
+               Activate( ii );
+            }
          }
-         for( dip::uint ii = 0; ii < length; ++ii, index += indexStride, out += stride ) {
-            *out = graph_.VertexValue( index ) != 0.0;
+         VertexIndex current = NONE;
+         while( true ) {
+            if(( current != NONE ) && ( nodes_[ current ].parent == FREE )) {
+               current = NONE; // The node became free after the last augmentation
+            }
+            if( current == NONE ) {
+               current = NextActive();
+               if( current == NONE ) {
+                  break;
+               }
+            }
+            VertexIndex from{};
+            dip::uint dir{};
+            bool found = Grow( current, from, dir );
+            ++time_;
+            if( found ) {
+               Augment( from, dir );
+               Adopt();
+               // `current` stays active, we'll continue growing from it
+            } else {
+               nodes_[ current ].isActive = false;
+               current = NONE;
+            }
          }
       }
 
+      // After `Compute()`, returns true if the node is on the source side of the cut.
+      bool IsSource( VertexIndex node ) const {
+         return nodes_[ node ].tree == SOURCE;
+      }
+
    private:
-      DirectedGraph const& graph_;
-      UnsignedArray const& sizes_;
+      static constexpr uint8 FREE = 255;     // `parent` value for a node not in a tree
+      static constexpr uint8 TERMINAL = 254; // `parent` value for a node connected to its terminal
+      static constexpr uint8 ORPHAN = 253;   // `parent` value for an orphan
+      static constexpr VertexIndex NONE = std::numeric_limits< VertexIndex >::max();
+
+      struct Node {
+         uint32 neighbors = 0;   // bit `dir` is set if the node has a neighbor in direction `dir`
+         uint32 distance = 0;    // distance to the terminal, valid if `timestamp` is recent
+         dip::uint timestamp = 0;
+         uint8 parent = FREE;    // the direction to the parent, or one of FREE, TERMINAL, ORPHAN
+         uint8 tree = 0;         // SOURCE, SINK or 0
+         bool isActive = false;
+         bool isInQueue = false;
+      };
+
+      dip::uint nDirs_;
+      dip::uint nNodes_;
+      std::vector< dip::sint > offsets_;
+      std::vector< std::vector< dfloat >> residual_;
+      std::vector< dfloat > terminalResidual_;
+      std::vector< Node > nodes_;
+      std::vector< VertexIndex > activeQueue_;
+      dip::uint activeFirst_ = 0;
+      std::vector< VertexIndex > orphans_;
+      dip::uint time_ = 0;
+
+      static dip::uint Reverse( dip::uint dir ) { return dir ^ 1u; }
+
+      VertexIndex Neighbor( VertexIndex node, dip::uint dir ) const {
+         return static_cast< VertexIndex >( static_cast< dip::sint >( node ) + offsets_[ dir ] );
+      }
+
+      void Activate( VertexIndex node ) {
+         nodes_[ node ].isActive = true;
+         if( !nodes_[ node ].isInQueue ) {
+            nodes_[ node ].isInQueue = true;
+            activeQueue_.push_back( node );
+         }
+      }
+
+      VertexIndex NextActive() {
+         while( activeFirst_ < activeQueue_.size() ) {
+            VertexIndex node = activeQueue_[ activeFirst_++ ];
+            nodes_[ node ].isInQueue = false;
+            if( nodes_[ node ].isActive && ( nodes_[ node ].parent != FREE )) {
+               return node;
+            }
+         }
+         // Reclaim queue memory
+         activeQueue_.clear();
+         activeFirst_ = 0;
+         return NONE;
+      }
+
+      // Grows the tree from `node`. Returns true if a path was found, in which case `from` and `dir` are the
+      // edge that joins the source tree to the sink tree.
+      bool Grow( VertexIndex node, VertexIndex& from, dip::uint& dir ) {
+         Node& n = nodes_[ node ];
+         bool isSource = n.tree == SOURCE;
+         for( dip::uint ii = 0; ii < nDirs_; ++ii ) {
+            if( !( n.neighbors & ( 1u << ii ))) {
+               continue;
+            }
+            VertexIndex neighbor = Neighbor( node, ii );
+            // For the source tree the flow goes from `node` to `neighbor`, for the sink tree in the other direction
+            dfloat residual = isSource ? residual_[ ii ][ node ] : residual_[ Reverse( ii ) ][ neighbor ];
+            if( residual <= 0 ) {
+               continue;
+            }
+            Node& m = nodes_[ neighbor ];
+            if( m.parent == FREE ) {
+               m.tree = n.tree;
+               m.parent = static_cast< uint8 >( Reverse( ii ));
+               m.timestamp = n.timestamp;
+               m.distance = n.distance + 1;
+               Activate( neighbor );
+            } else if( m.tree != n.tree ) {
+               if( isSource ) {
+                  from = node;
+                  dir = ii;
+               } else {
+                  from = neighbor;
+                  dir = Reverse( ii );
+               }
+               return true;
+            } else if(( m.timestamp <= n.timestamp ) && ( m.distance > n.distance )) {
+               // Heuristic: make the path to the terminal shorter
+               m.parent = static_cast< uint8 >( Reverse( ii ));
+               m.timestamp = n.timestamp;
+               m.distance = n.distance + 1;
+            }
+         }
+         return false;
+      }
+
+      // Pushes flow along the path through the edge from `from` in direction `dir`.
+      void Augment( VertexIndex from, dip::uint dir ) {
+         // Find the bottleneck capacity
+         dfloat bottleneck = residual_[ dir ][ from ];
+         VertexIndex node = from;
+         while( nodes_[ node ].parent != TERMINAL ) {
+            dip::uint pdir = nodes_[ node ].parent;
+            VertexIndex parent = Neighbor( node, pdir );
+            bottleneck = std::min( bottleneck, residual_[ Reverse( pdir ) ][ parent ] );
+            node = parent;
+         }
+         bottleneck = std::min( bottleneck, terminalResidual_[ node ] );
+         node = Neighbor( from, dir );
+         while( nodes_[ node ].parent != TERMINAL ) {
+            dip::uint pdir = nodes_[ node ].parent;
+            bottleneck = std::min( bottleneck, residual_[ pdir ][ node ] );
+            node = Neighbor( node, pdir );
+         }
+         bottleneck = std::min( bottleneck, -terminalResidual_[ node ] );
+         DIP_ASSERT( bottleneck > 0 );
+         // Push the flow
+         Push( from, dir, bottleneck );
+         node = from;
+         while( nodes_[ node ].parent != TERMINAL ) {
+            dip::uint pdir = nodes_[ node ].parent;
+            VertexIndex parent = Neighbor( node, pdir );
+            if( Push( parent, Reverse( pdir ), bottleneck )) {
+               MakeOrphan( node );
+            }
+            node = parent;
+         }
+         terminalResidual_[ node ] -= bottleneck;
+         if( terminalResidual_[ node ] == 0 ) {
+            MakeOrphan( node );
+         }
+         node = Neighbor( from, dir );
+         while( nodes_[ node ].parent != TERMINAL ) {
+            dip::uint pdir = nodes_[ node ].parent;
+            VertexIndex parent = Neighbor( node, pdir );
+            if( Push( node, pdir, bottleneck )) {
+               MakeOrphan( node );
+            }
+            node = parent;
+         }
+         terminalResidual_[ node ] += bottleneck;
+         if( terminalResidual_[ node ] == 0 ) {
+            MakeOrphan( node );
+         }
+      }
+
+      // Pushes `flow` through the edge from `node` in direction `dir`. Returns true if the edge became saturated.
+      bool Push( VertexIndex node, dip::uint dir, dfloat flow ) {
+         residual_[ dir ][ node ] -= flow;
+         residual_[ Reverse( dir ) ][ Neighbor( node, dir ) ] += flow;
+         return residual_[ dir ][ node ] == 0;
+      }
+
+      void MakeOrphan( VertexIndex node ) {
+         nodes_[ node ].parent = ORPHAN;
+         orphans_.push_back( node );
+      }
+
+      // Tries to find a new parent for each orphan; those that can't find one become free nodes.
+      void Adopt() {
+         // `orphans_` is used as a FIFO queue
+         for( dip::uint kk = 0; kk < orphans_.size(); ++kk ) {
+            VertexIndex orphan = orphans_[ kk ];
+            Node& n = nodes_[ orphan ];
+            bool isSource = n.tree == SOURCE;
+            dip::uint bestDir = FREE;
+            uint32 bestDistance = std::numeric_limits< uint32 >::max();
+            for( dip::uint ii = 0; ii < nDirs_; ++ii ) {
+               if( !( n.neighbors & ( 1u << ii ))) {
+                  continue;
+               }
+               VertexIndex neighbor = Neighbor( orphan, ii );
+               if( nodes_[ neighbor ].tree != n.tree || nodes_[ neighbor ].parent == FREE ) {
+                  continue;
+               }
+               dfloat residual = isSource ? residual_[ Reverse( ii ) ][ neighbor ] : residual_[ ii ][ orphan ];
+               if( residual <= 0 ) {
+                  continue;
+               }
+               // Check that `neighbor` is connected to the terminal, and find its distance
+               uint32 distance = 0;
+               VertexIndex node = neighbor;
+               bool connected = true;
+               while( true ) {
+                  Node& m = nodes_[ node ];
+                  if( m.timestamp == time_ ) {
+                     distance += m.distance;
+                     break;
+                  }
+                  ++distance;
+                  if( m.parent == TERMINAL ) {
+                     m.timestamp = time_;
+                     m.distance = 1;
+                     break;
+                  }
+                  if( m.parent == ORPHAN ) {
+                     connected = false;
+                     break;
+                  }
+                  node = Neighbor( node, m.parent );
+               }
+               if( connected ) {
+                  if( distance < bestDistance ) {
+                     bestDir = ii;
+                     bestDistance = distance;
+                  }
+                  // Mark the path with the current timestamp and the distance
+                  for( node = neighbor; nodes_[ node ].timestamp != time_; node = Neighbor( node, nodes_[ node ].parent )) {
+                     nodes_[ node ].timestamp = time_;
+                     nodes_[ node ].distance = distance--;
+                  }
+               }
+            }
+            if( bestDir != FREE ) {
+               n.parent = static_cast< uint8 >( bestDir );
+               n.timestamp = time_;
+               n.distance = bestDistance + 1;
+               continue;
+            }
+            // No parent found, the orphan becomes a free node
+            for( dip::uint ii = 0; ii < nDirs_; ++ii ) {
+               if( !( n.neighbors & ( 1u << ii ))) {
+                  continue;
+               }
+               VertexIndex neighbor = Neighbor( orphan, ii );
+               Node& m = nodes_[ neighbor ];
+               if( m.tree != n.tree || m.parent == FREE ) {
+                  continue;
+               }
+               dfloat residual = isSource ? residual_[ Reverse( ii ) ][ neighbor ] : residual_[ ii ][ orphan ];
+               if( residual > 0 ) {
+                  Activate( neighbor );
+               }
+               if( m.parent == Reverse( ii )) {
+                  MakeOrphan( neighbor );
+               }
+            }
+            n.parent = FREE;
+            n.tree = 0;
+            n.isActive = false;
+         }
+         orphans_.clear();
+      }
 };
 
+void CopyPixelValues( Image const& image, std::vector< dfloat >& values ) {
+   values.resize( image.NumberOfPixels() );
+   Image wrapper( NonOwnedRefToDataSegment( values.data() ), values.data(), DT_DFLOAT, image.Sizes() );
+   wrapper.Copy( image );
+}
+
 /*
 void PrintGrap( DirectedGraph const& graph ) {
    std::cout << " - Vertices:\n";
@@ -635,49 +898,153 @@ void GraphCut( Image const& in, Image const& markers, Image& out, dfloat sigma,
    DIP_THROW_IF( !markers.CompareProperties( in, Option::CmpPropEnumerator::Dimensionality +
                     Option::CmpPropEnumerator::Sizes +
                     Option::CmpPropEnumerator::TensorElements ), E::SIZES_DONT_MATCH );
-   DIP_THROW_IF( !in.DataType().IsUInt(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( !markers.DataType().IsUInt(), E::DATA_TYPE_NOT_SUPPORTED );
 
-   DirectedGraph graph( in, 1, "zero", "graphcut" );
-   graph.UpdateEdgeWeights( [ sigma ]( dfloat v1, dfloat v2 ) { return std::exp( -0.5 * ( v1 - v2 ) * ( v1 - v2 ) / ( sigma * sigma )); } );
-   auto sourceIndex = graph.AddVertex( in.NumberOfPixels(), 0.0 );
-   auto sinkIndex = graph.AddVertex( in.NumberOfPixels(), 0.0 );
-   Image sourceWeights;
-   Image sinkWeights;
-   if(( lambda > 0.0 ) || ( gamma > 0.0 )) {
-      // We'll need statistics on the source and sink pixel intensities and distances, to define the terminal link weights
-      ComputeTerminalWeights( in, markers, sourceWeights, sinkWeights, lambda, gamma );
+   UnsignedArray const& sizes = in.Sizes();
+   dip::uint nDims = sizes.size();
+   GridMaxFlow flow( sizes );
+   dip::uint nPixels = in.NumberOfPixels();
+   dip::sint sPixels = static_cast< dip::sint >( nPixels );
+   dip::uint nThreads = 1;
+   if( nPixels * nDims * 40 > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), nPixels / 1024 + 1 );
    }
-   std::unique_ptr< Framework::ScanLineFilter > lineFilter;
-   DIP_OVL_NEW_UINT( lineFilter, AddTerminalEdges, ( graph, sourceWeights, sinkWeights, markers.Sizes(),
-                                                     sourceIndex, sinkIndex ), markers.DataType() );
-   DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( markers, {}, markers.DataType(), *lineFilter,
-                                                     Framework::ScanOption::NoMultiThreading + Framework::ScanOption::NeedCoordinates ));
-   sourceWeights.Strip();
-   sinkWeights.Strip();
-
-   GraphCut( graph, sourceIndex, sinkIndex );
-   graph.IsConnectedTo( sourceIndex );
 
-   out.ReForge( in.Sizes(), 1, DT_BIN );
-   lineFilter = std::make_unique< PaintOut >( graph, in.Sizes() );
-   DIP_STACK_TRACE_THIS( Framework::ScanSingleOutput( out, out.DataType(), *lineFilter, Framework::ScanOption::NeedCoordinates ));
-   /*
-   out.ReForge( in.Sizes(), 2, DT_SFLOAT );
-   out.Fill( 0 );
-   ImageIterator< sfloat > it( out );
-   auto const& edges = graph.Edges();
-   do {
-      dip::uint vertexIndex = it.Index();
-      for( EdgeIndex edgeIndex: graph.EdgeIndices( vertexIndex )) {
-         auto const& edge = edges[ edgeIndex ];
-         if( edge.target == sourceIndex ) {
-            it[ 0 ] = edge.weight;
-         } else if( edge.target == sinkIndex ) {
-            it[ 1 ] = edge.weight;
+   // Neighbor edge weights, each edge pair has the same capacity in both directions
+   {
+      std::vector< dfloat > values;
+      DIP_STACK_TRACE_THIS( CopyPixelValues( in, values ));
+      dfloat factor = -0.5 / ( sigma * sigma );
+      dip::sint stride = 1;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         std::vector< dfloat >& forward = flow.Residual( 2 * ii );
+         std::vector< dfloat >& backward = flow.Residual( 2 * ii + 1 );
+         #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+         for( dip::sint jj = 0; jj < sPixels; ++jj ) {
+            VertexIndex v = static_cast< VertexIndex >( jj );
+            if( flow.HasNeighbor( v, 2 * ii )) {
+               VertexIndex w = static_cast< VertexIndex >( jj + stride );
+               dfloat diff = values[ v ] - values[ w ];
+               dfloat weight = std::exp( factor * diff * diff );
+               forward[ v ] = weight;
+               backward[ w ] = weight;
+            }
+         }
+         stride *= static_cast< dip::sint >( sizes[ ii ] );
+      }
+   }
+
+   // Terminal edge weights
+   {
+      std::vector< uint8 > labels( nPixels );
+      Image wrapper( NonOwnedRefToDataSegment( labels.data() ), labels.data(), DT_UINT8, sizes );
+      DIP_STACK_TRACE_THIS( wrapper.Copy( markers )); // Values larger than 255 saturate, and are thus ignored like they should be
+      std::vector< dfloat > sourceWeights;
+      std::vector< dfloat > sinkWeights;
+      bool useTerminalWeights = ( lambda > 0.0 ) || ( gamma > 0.0 );
+      if( useTerminalWeights ) {
+         // We'll need statistics on the source and sink pixel intensities and distances, to define the terminal link weights
+         Image sourceWeightsImg;
+         Image sinkWeightsImg;
+         DIP_START_STACK_TRACE
+            ComputeTerminalWeights( in, markers, sourceWeightsImg, sinkWeightsImg, lambda, gamma );
+            CopyPixelValues( sourceWeightsImg, sourceWeights );
+            CopyPixelValues( sinkWeightsImg, sinkWeights );
+         DIP_END_STACK_TRACE
+      }
+      std::vector< dfloat >& terminal = flow.TerminalResidual();
+      #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+      for( dip::sint jj = 0; jj < sPixels; ++jj ) {
+         dip::uint v = static_cast< dip::uint >( jj );
+         if( labels[ v ] == 1 ) { // It's source pixel
+            // NOTE: The weight "K" in the paper is 1 + max(edge weights). But that doesn't take lambda into
+            // account, why not? We're just using infinity instead, it's an edge that should never be broken,
+            // so this makes most sense.
+            terminal[ v ] = dip::infinity;
+         } else if( labels[ v ] == 2 ) { // It's a sink pixel
+            terminal[ v ] = -dip::infinity;
+         } else if( useTerminalWeights ) {
+            // Instead of an edge to the source with weight w1 and another to the sink with weight w2, we use a
+            // single edge with the difference. We basically subtract min(w1,w2) from both weights, one will
+            // become 0 and therefore we can leave it out. If they're equal, we don't need either edge.
+            terminal[ v ] = sourceWeights[ v ] - sinkWeights[ v ];
          }
       }
-   } while( ++it );
-   */
+   }
+
+   flow.Compute();
+
+   out.ReForge( sizes, 1, DT_BIN );
+   std::vector< bin > result( nPixels );
+   #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+   for( dip::sint jj = 0; jj < sPixels; ++jj ) {
+      result[ static_cast< dip::uint >( jj ) ] = flow.IsSource( static_cast< VertexIndex >( jj ));
+   }
+   Image wrapper( NonOwnedRefToDataSegment( result.data() ), result.data(), DT_BIN, sizes );
+   DIP_STACK_TRACE_THIS( out.Copy( wrapper ));
 }
 
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/iterators.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
+
+namespace {
+
+// Computes the graph cut on an image through a `dip::DirectedGraph`, the way `dip::GraphCut` used to do it.
+dip::Image ReferenceGraphCut( dip::Image const& in, dip::Image const& markers, dip::dfloat sigma ) {
+   dip::DirectedGraph graph( in, 1, "zero", "graphcut" );
+   graph.UpdateEdgeWeights( [ sigma ]( dip::dfloat v1, dip::dfloat v2 ) { return std::exp( -0.5 * ( v1 - v2 ) * ( v1 - v2 ) / ( sigma * sigma )); } );
+   auto sourceIndex = graph.AddVertex( in.NumberOfPixels(), 0.0 );
+   auto sinkIndex = graph.AddVertex( in.NumberOfPixels(), 0.0 );
+   dip::ImageIterator< dip::uint8 > mit( markers );
+   do {
+      if( *mit == 1 ) {
+         graph.AddEdgePair( sourceIndex, mit.Index(), dip::infinity );
+      } else if( *mit == 2 ) {
+         graph.AddEdgePair( mit.Index(), sinkIndex, dip::infinity );
+      }
+   } while( ++mit );
+   dip::GraphCut( graph, sourceIndex, sinkIndex );
+   graph.IsConnectedTo( sourceIndex );
+   dip::Image out( in.Sizes(), 1, dip::DT_BIN );
+   dip::ImageIterator< dip::bin > oit( out );
+   do {
+      *oit = graph.VertexValue( oit.Index() ) != 0.0;
+   } while( ++oit );
+   return out;
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::GraphCut") {
+   dip::Random random( 0 );
+   for( auto const& sizes : { dip::UnsignedArray{ 60, 50 }, dip::UnsignedArray{ 20, 18, 15 }} ) {
+      dip::Image in( sizes, 1, dip::DT_SFLOAT );
+      in.Fill( 0 );
+      dip::DrawBandlimitedBall( in, 14, dip::FloatArray( sizes.size(), 9.0 ), { 100 } );
+      dip::GaussianNoise( in, in, random, 400.0 );
+      dip::Image markers( sizes, 1, dip::DT_UINT8 );
+      markers.Fill( 0 );
+      markers.At( dip::RangeArray( sizes.size(), dip::Range( 8, 10 ))).Fill( 1 );
+      markers.At( dip::RangeArray( sizes.size(), dip::Range( -3, -1 ))).Fill( 2 );
+      dip::RangeArray corner( sizes.size(), dip::Range( 0, 1 ));
+      corner[ 1 ] = dip::Range( -4, -1 );
+      markers.At( corner ).Fill( 2 );
+      dip::Image out = dip::GraphCut( in, markers, 30.0, 0.0, 0.0 );
+      dip::Image ref = ReferenceGraphCut( in, markers, 30.0 );
+      DOCTEST_CHECK( dip::testing::CompareImages( out, ref ));
+      DOCTEST_CHECK( dip::Count( out ) > 0 );
+      DOCTEST_CHECK( dip::Count( out ) < out.NumberOfPixels() );
+   }
+   dip::Image in( { 10, 10 }, 1, dip::DT_SFLOAT );
+   dip::Image markers( { 10, 10 }, 1, dip::DT_SFLOAT );
+   dip::Image out;
+   DOCTEST_CHECK_THROWS( dip::GraphCut( in, markers, out ));
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
@@ -18,13 +18,15 @@
 #include "diplib/segmentation.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <limits>
-#include <memory>
 #include <vector>
 
 #include "diplib.h"
 #include "diplib/framework.h"
+#include "diplib/iterators.h"
+#include "diplib/multithreading.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
 
@@ -34,31 +36,21 @@ namespace {
 
 struct Cluster {
    FloatArray mean;
-   FloatArray newMean;
-   dfloat norm = 0.0;
    LabelType label = 0;
-   explicit Cluster( dip::uint nDim ) : mean( nDim, 0.0 ), newMean( nDim, 0.0 ) {}
+   explicit Cluster( dip::uint nDim ) : mean( nDim, 0.0 ) {}
 };
 
 using ClusterArray = std::vector< Cluster >;
 
-template< typename TPI >
+// Writes the label of the nearest cluster center to each pixel
 class ClusteringLineFilter : public Framework::ScanLineFilter {
    public:
+      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint /**/ ) override {
+         return clusters_.size() * 3;
+      }
       void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         // Either we have one input image, or one output image.
-         TPI const* in = nullptr;
-         LabelType* out = nullptr;
-         dip::sint inStride = 0;
-         dip::sint outStride = 0;
-         if( !params.inBuffer.empty() ) {
-            in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
-            inStride = params.inBuffer[ 0 ].stride;
-         } else {
-            out = static_cast< LabelType* >( params.outBuffer[ 0 ].buffer );
-            outStride = params.outBuffer[ 0 ].stride;
-         }
-         DIP_ASSERT(( out == nullptr ) ^ ( in == nullptr )); // make sure one and only one is nullptr
+         LabelType* out = static_cast< LabelType* >( params.outBuffer[ 0 ].buffer );
+         dip::sint outStride = params.outBuffer[ 0 ].stride;
          dip::uint bufferLength = params.bufferLength;
          dip::uint scanDim = params.dimension;
          auto& pos = params.position;
@@ -86,84 +78,291 @@ class ClusteringLineFilter : public Framework::ScanLineFilter {
                   nearestDist = dist;
                }
             }
-            if( out ) {
-               // Write cluster label to output image
-               *out = clusters_[ nearest ].label;
-               out += outStride;
-            } else {
-               // Update the new mean of nearest mean
-               for( dip::uint ii = 0; ii < nDims; ++ii ) {
-                  clusters_[ nearest ].newMean[ ii ] += static_cast< dfloat >( *in ) * static_cast< dfloat >( pos[ ii ] );
-               }
-               clusters_[ nearest ].newMean[ scanDim ] += static_cast< dfloat >( *in ) * static_cast< dfloat >( xx );
-               clusters_[ nearest ].norm += static_cast< dfloat >( *in );
-               in += inStride;
-            }
+            // Write cluster label to output image
+            *out = clusters_[ nearest ].label;
+            out += outStride;
          }
       }
-      ClusteringLineFilter( ClusterArray& clusters ) : clusters_( clusters ) {}
+      ClusteringLineFilter( ClusterArray const& clusters ) : clusters_( clusters ) {}
    private:
-      ClusterArray& clusters_;
+      ClusterArray const& clusters_;
 };
 
-dfloat Clustering(
-      Image const& in,
-      Image& out,
-      ClusterArray& clusters,
-      bool write  // if `!write`, `out` is left unused
+// The points to cluster: the coordinates of the non-zero pixels, weighted by the pixel value.
+// The points are processed in chunks of a size that doesn't depend on the number of threads, and
+// per-chunk partial sums are added in order, so that the result doesn't depend on the number of threads.
+class Points {
+   public:
+      explicit Points( Image const& in ) : nDims_( in.Dimensionality() ) {
+         DIP_OVL_CALL_NONCOMPLEX( Gather, ( in ), in.DataType() );
+         chunkSize_ = std::max< dip::uint >( 1024, div_ceil< dip::uint >( weights_.size(), 256 ));
+      }
+
+      dip::uint Size() const { return weights_.size(); }
+      dip::uint Dimensionality() const { return nDims_; }
+      dfloat const* Point( dip::uint ii ) const { return coords_.data() + ii * nDims_; }
+      dfloat Weight( dip::uint ii ) const { return weights_[ ii ]; }
+
+      dip::uint NumberOfChunks() const { return div_ceil( Size(), chunkSize_ ); }
+      dip::uint ChunkBegin( dip::uint chunk ) const { return chunk * chunkSize_; }
+      dip::uint ChunkEnd( dip::uint chunk ) const { return std::min( Size(), ( chunk + 1 ) * chunkSize_ ); }
+
+   private:
+      // Reads the non-zero pixels of `in`, in the same order as a linear index, without making a copy of the image
+      template< typename TPI >
+      void Gather( Image const& in ) {
+         dip::uint nPoints = 0;
+         ImageIterator< TPI > it( in );
+         do {
+            if( *it != TPI( 0 )) {
+               ++nPoints;
+            }
+         } while( ++it );
+         weights_.reserve( nPoints );
+         coords_.reserve( nPoints * nDims_ );
+         it.Reset();
+         do {
+            if( *it != TPI( 0 )) {
+               weights_.push_back( clamp_cast< dfloat >( *it ));
+               for( auto c : it.Coordinates() ) {
+                  coords_.push_back( static_cast< dfloat >( c ));
+               }
+            }
+         } while( ++it );
+      }
+
+      dip::uint nDims_;
+      std::vector< dfloat > coords_;
+      std::vector< dfloat > weights_;
+      dip::uint chunkSize_;
+};
+
+dfloat SquareDistance( dfloat const* a, dfloat const* b, dip::uint nDims ) {
+   dfloat dist = 0.0;
+   for( dip::uint jj = 0; jj < nDims; ++jj ) {
+      dfloat d = a[ jj ] - b[ jj ];
+      dist += d * d;
+   }
+   return dist;
+}
+
+// k-means++ seeding: each new center is picked from the points with a probability proportional to the point's
+// weight times its square distance to the nearest center already picked. If there are no points left to pick
+// (all remaining points have zero or negative weight), the center is placed randomly in the image.
+void KMeansPlusPlus(
+      Points const& points,
+      UnsignedArray const& sizes,
+      std::vector< dfloat >& centers,
+      Random& random,
+      dip::uint nThreads
 ) {
-   DataType ovlDataType = in.DataType();
-   if( ovlDataType.IsBinary() ) {
-      ovlDataType = DT_UINT8; // Reading binary images as if they were uint8.
+   dip::uint nDims = points.Dimensionality();
+   dip::uint nClusters = centers.size() / nDims;
+   dip::uint nChunks = points.NumberOfChunks();
+   dip::sint sChunks = static_cast< dip::sint >( nChunks );
+   std::vector< dfloat > probability( points.Size() );
+   for( dip::uint ii = 0; ii < points.Size(); ++ii ) {
+      probability[ ii ] = std::max( points.Weight( ii ), 0.0 );
+   }
+   std::vector< dfloat > chunkSum( nChunks );
+   UniformRandomGenerator generator( random );
+   for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+      dfloat* center = centers.data() + cc * nDims;
+      if( cc > 0 ) {
+         // Update the probabilities given the previous center
+         dfloat const* previous = center - nDims;
+         #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+         for( dip::sint chunk = 0; chunk < sChunks; ++chunk ) {
+            for( dip::uint ii = points.ChunkBegin( static_cast< dip::uint >( chunk )); ii < points.ChunkEnd( static_cast< dip::uint >( chunk )); ++ii ) {
+               if( probability[ ii ] > 0.0 ) {
+                  dfloat dist = SquareDistance( points.Point( ii ), previous, nDims ) * points.Weight( ii );
+                  probability[ ii ] = cc == 1 ? dist : std::min( probability[ ii ], dist );
+               }
+            }
+         }
+      }
+      #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+      for( dip::sint chunk = 0; chunk < sChunks; ++chunk ) {
+         dfloat sum = 0.0;
+         for( dip::uint ii = points.ChunkBegin( static_cast< dip::uint >( chunk )); ii < points.ChunkEnd( static_cast< dip::uint >( chunk )); ++ii ) {
+            sum += probability[ ii ];
+         }
+         chunkSum[ static_cast< dip::uint >( chunk ) ] = sum;
+      }
+      dfloat total = 0.0;
+      for( auto sum : chunkSum ) {
+         total += sum;
+      }
+      if( total <= 0.0 ) {
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            center[ jj ] = generator( 0, static_cast< dfloat >( sizes[ jj ] ));
+         }
+         continue;
+      }
+      // Pick a point
+      dfloat value = generator( 0, total );
+      dip::uint chunk = 0;
+      while(( chunk < nChunks - 1 ) && ( value >= chunkSum[ chunk ] )) {
+         value -= chunkSum[ chunk ];
+         ++chunk;
+      }
+      dip::uint index = points.ChunkBegin( chunk );
+      dip::uint lastNonZero = index;
+      for( ; index < points.ChunkEnd( chunk ); ++index ) {
+         if( probability[ index ] > 0.0 ) {
+            lastNonZero = index;
+            if( value < probability[ index ] ) {
+               break;
+            }
+            value -= probability[ index ];
+         }
+      }
+      index = std::min( index, lastNonZero ); // In case of rounding errors
+      std::copy( points.Point( index ), points.Point( index ) + nDims, center );
    }
-   std::unique_ptr< Framework::ScanLineFilter > lineFilter;
-   DIP_OVL_NEW_REAL( lineFilter, ClusteringLineFilter, ( clusters ), ovlDataType );
-   ImageConstRefArray inImages;
-   ImageRefArray outImages;
-   DataTypeArray inBufferTypes;
-   DataTypeArray outBufferTypes;
-   DataTypeArray outImageTypes;
-   UnsignedArray nTensorElements;
-   if( write ) {
-      // We write cluster labels to `out`
-      outImages.emplace_back( out );
-      outBufferTypes.push_back( DT_LABEL );
-      outImageTypes.push_back( DT_LABEL );
-      nTensorElements.push_back( 1 );
-      // Forge `out` -- we're not passing `in` to `Scan`, so it won't know how large to make `out`.
-      out.ReForge( in, DT_LABEL, Option::AcceptDataTypeChange::DONT_ALLOW );
-   } else {
-      // We update clusters based on `in`
-      inImages.emplace_back( in );
-      inBufferTypes.push_back( ovlDataType );
+}
+
+// Finds the nearest and second-nearest centers to `point`, returns the index of the nearest one,
+// and their distances in `nearestDist` and `secondDist`.
+dip::uint FindNearest(
+      dfloat const* point,
+      std::vector< dfloat > const& centers,
+      dip::uint nDims,
+      dfloat& nearestDist,
+      dfloat& secondDist
+) {
+   dip::uint nearest = 0;
+   nearestDist = std::numeric_limits< dfloat >::max();
+   secondDist = std::numeric_limits< dfloat >::max();
+   dip::uint nClusters = centers.size() / nDims;
+   for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+      dfloat dist = SquareDistance( point, centers.data() + cc * nDims, nDims );
+      if( dist < nearestDist ) {
+         secondDist = nearestDist;
+         nearestDist = dist;
+         nearest = cc;
+      } else if( dist < secondDist ) {
+         secondDist = dist;
+      }
    }
-   DIP_STACK_TRACE_THIS( Framework::Scan( inImages, outImages, inBufferTypes, outBufferTypes, outImageTypes, nTensorElements, *lineFilter,
-                                          Framework::ScanOption::NeedCoordinates + Framework::ScanOption::NoMultiThreading ));
-
-   // Process cluster information
-   dfloat change = 0;
-   dfloat maxval = 0;
-   if( !write ) {
-      //std::cout << "Cluster means: ";
-      for( auto& c : clusters ) {
-         if( c.norm != 0.0 ) {
-            for( dip::uint jj = 0; jj < c.mean.size(); jj++ ) {
-               dfloat val = c.newMean[ jj ] / c.norm;
+   nearestDist = std::sqrt( nearestDist );
+   secondDist = std::sqrt( secondDist );
+   return nearest;
+}
+
+// Lloyd's algorithm, using Hamerly's bounds to avoid most distance computations. Each point keeps an upper bound
+// to the distance to its assigned center, and a lower bound to the distance to any other center. The bounds are
+// updated by how much the centers move. Only if the upper bound is larger than the lower bound, or larger than
+// half the distance from its center to the nearest other center, do we need to compute distances.
+// This produces the same result as the plain algorithm: iterations stop when the centers don't move any more.
+void Hamerly(
+      Points const& points,
+      std::vector< dfloat >& centers,
+      dip::uint nThreads
+) {
+   dip::uint nDims = points.Dimensionality();
+   dip::uint nClusters = centers.size() / nDims;
+   dip::uint nPoints = points.Size();
+   dip::uint nChunks = points.NumberOfChunks();
+   dip::sint sChunks = static_cast< dip::sint >( nChunks );
+   dip::uint accSize = nClusters * ( nDims + 1 );
+   std::vector< dfloat > chunkSums( nChunks * accSize ); // for each chunk, for each cluster, the weighted sum of coordinates and the sum of weights
+   std::vector< dip::uint > assignment( nPoints );
+   std::vector< dfloat > upper( nPoints );
+   std::vector< dfloat > lower( nPoints );
+   std::vector< dfloat > halfDistance( nClusters, 0.0 ); // half the distance to the nearest other center
+   std::vector< dfloat > displacement( nClusters, 0.0 );
+   std::vector< dfloat > newCenters( centers.size() );
+   bool first = true;
+   while( true ) {
+      // Assign points to clusters, and accumulate new cluster centers
+      #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+      for( dip::sint chunk = 0; chunk < sChunks; ++chunk ) {
+         dfloat* acc = chunkSums.data() + static_cast< dip::uint >( chunk ) * accSize;
+         std::fill( acc, acc + accSize, 0.0 );
+         for( dip::uint ii = points.ChunkBegin( static_cast< dip::uint >( chunk )); ii < points.ChunkEnd( static_cast< dip::uint >( chunk )); ++ii ) {
+            dfloat const* point = points.Point( ii );
+            if( first ) {
+               assignment[ ii ] = FindNearest( point, centers, nDims, upper[ ii ], lower[ ii ] );
+            } else {
+               dfloat bound = std::max( halfDistance[ assignment[ ii ]], lower[ ii ] );
+               if( upper[ ii ] > bound ) {
+                  // Tighten the upper bound and test again
+                  upper[ ii ] = std::sqrt( SquareDistance( point, centers.data() + assignment[ ii ] * nDims, nDims ));
+                  if( upper[ ii ] > bound ) {
+                     assignment[ ii ] = FindNearest( point, centers, nDims, upper[ ii ], lower[ ii ] );
+                  }
+               }
+            }
+            dfloat* cluster = acc + assignment[ ii ] * ( nDims + 1 );
+            dfloat weight = points.Weight( ii );
+            for( dip::uint jj = 0; jj < nDims; ++jj ) {
+               cluster[ jj ] += weight * point[ jj ];
+            }
+            cluster[ nDims ] += weight;
+         }
+      }
+      first = false;
+      // Compute the new cluster centers
+      std::fill( newCenters.begin(), newCenters.end(), 0.0 );
+      std::vector< dfloat > norm( nClusters, 0.0 );
+      for( dip::uint chunk = 0; chunk < nChunks; ++chunk ) {
+         dfloat const* acc = chunkSums.data() + chunk * accSize;
+         for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+            for( dip::uint jj = 0; jj < nDims; ++jj ) {
+               newCenters[ cc * nDims + jj ] += acc[ cc * ( nDims + 1 ) + jj ];
+            }
+            norm[ cc ] += acc[ cc * ( nDims + 1 ) + nDims ];
+         }
+      }
+      dfloat change = 0;
+      dfloat maxval = 0;
+      for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+         dfloat dist = 0.0;
+         if( norm[ cc ] != 0.0 ) {
+            for( dip::uint jj = 0; jj < nDims; jj++ ) {
+               dfloat val = newCenters[ cc * nDims + jj ] / norm[ cc ];
                maxval = std::max( std::abs( val ), maxval );
-               dfloat dist = val - c.mean[ jj ];
-               change += dist * dist;
-               c.mean[ jj ] = val;
-               c.newMean[ jj ] = 0.0;
+               dfloat d = val - centers[ cc * nDims + jj ];
+               dist += d * d;
+               centers[ cc * nDims + jj ] = val;
             }
-         } else {
-            std::fill( c.newMean.begin(), c.newMean.end(), 0.0 );
          }
-         c.norm = 0.0;
-         //std::cout << c.mean << " ; ";
+         change += dist;
+         displacement[ cc ] = std::sqrt( dist );
+      }
+      if( change <= 1e-10 * maxval ) {
+         break;
+      }
+      // Update the bounds
+      dip::uint largest = 0;
+      for( dip::uint cc = 1; cc < nClusters; ++cc ) {
+         if( displacement[ cc ] > displacement[ largest ] ) {
+            largest = cc;
+         }
+      }
+      dfloat secondLargest = 0.0;
+      for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+         if( cc != largest ) {
+            secondLargest = std::max( secondLargest, displacement[ cc ] );
+         }
+      }
+      #pragma omp parallel for schedule( static ) num_threads( static_cast< int >( nThreads ))
+      for( dip::sint sii = 0; sii < static_cast< dip::sint >( nPoints ); ++sii ) {
+         dip::uint ii = static_cast< dip::uint >( sii );
+         upper[ ii ] += displacement[ assignment[ ii ]];
+         lower[ ii ] -= assignment[ ii ] == largest ? secondLargest : displacement[ largest ];
+      }
+      for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+         dfloat dist = std::numeric_limits< dfloat >::max();
+         for( dip::uint c2 = 0; c2 < nClusters; ++c2 ) {
+            if( c2 != cc ) {
+               dist = std::min( dist, SquareDistance( centers.data() + cc * nDims, centers.data() + c2 * nDims, nDims ));
+            }
+         }
+         halfDistance[ cc ] = 0.5 * std::sqrt( dist );
       }
-      //std::cout << "change = " << change << '\n';
    }
-   return change <= 1e-10 * maxval ? 0.0 : change;
 }
 
 void LabelClusters(
@@ -202,22 +401,31 @@ CoordinateArray KMeansClustering(
    DIP_THROW_IF( nClusters < 2, "Number of clusters must be 2 or larger" );
    DIP_THROW_IF( nClusters > std::numeric_limits< LabelType >::max(), "Number of clusters is too large" );
 
-   // Allocate the cluster array
+   // Collect the points to cluster
    dip::uint nDims = in.Dimensionality();
-   ClusterArray clusters( nClusters, Cluster( nDims ));
-
-   // Randomly initialise the clusters
-   UniformRandomGenerator generator( random );
-   for( auto& cluster : clusters ) {
-      for( dip::uint jj = 0; jj < nDims; ++jj ) {
-         cluster.mean[ jj ] = generator( 0, static_cast< dfloat >( in.Size( jj )));
-      }
+   Points points( in );
+   dip::uint nThreads = 1;
+   if( points.Size() * nClusters * nDims > threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), points.NumberOfChunks() );
    }
 
-   // Do cluster iterations
-   while( Clustering( in, out, clusters, false ) > 0.0 ) {};
+   // Initialise the clusters, and iterate
+   std::vector< dfloat > centers( nClusters * nDims );
+   DIP_STACK_TRACE_THIS( KMeansPlusPlus( points, in.Sizes(), centers, random, nThreads ));
+   Hamerly( points, centers, nThreads );
+
+   // Label the clusters and write the output
+   ClusterArray clusters( nClusters, Cluster( nDims ));
+   for( dip::uint cc = 0; cc < nClusters; ++cc ) {
+      std::copy( centers.data() + cc * nDims, centers.data() + ( cc + 1 ) * nDims, clusters[ cc ].mean.begin() );
+   }
    LabelClusters( clusters );
-   Clustering( in, out, clusters, true );
+   ImageRefArray outImages{ out };
+   // Forge `out` -- we're not passing `in` to `Scan`, so it won't know how large to make `out`.
+   out.ReForge( in, DT_LABEL, Option::AcceptDataTypeChange::DONT_ALLOW );
+   ClusteringLineFilter lineFilter( clusters );
+   DIP_STACK_TRACE_THIS( Framework::Scan( {}, outImages, {}, { DT_LABEL }, { DT_LABEL }, { 1 }, lineFilter,
+                                          Framework::ScanOption::NeedCoordinates ));
 
    // Copy over cluster centers to output array
    CoordinateArray coords( clusters.size() );
@@ -228,3 +436,31 @@ CoordinateArray KMeansClustering(
 }
 
 } // namespace dip
+
+#ifdef DIP_CONFIG_ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::KMeansClustering") {
+   // Three blobs, the cluster centers should be found at the blob centers
+   dip::Image in( { 120, 100 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::DrawBandlimitedBall( in, 20, { 20, 30 }, { 1 } );
+   dip::DrawBandlimitedBall( in, 20, { 90, 20 }, { 1 } );
+   dip::DrawBandlimitedBall( in, 20, { 60, 80 }, { 1 } );
+   dip::Random random( 0 );
+   dip::Image out;
+   dip::CoordinateArray centers = dip::KMeansClustering( in, out, random, 3 );
+   DOCTEST_REQUIRE( centers.size() == 3 );
+   // Labels are sorted by distance to the origin
+   DOCTEST_CHECK( centers[ 0 ] == dip::UnsignedArray{ 20, 30 } );
+   DOCTEST_CHECK( centers[ 1 ] == dip::UnsignedArray{ 90, 20 } );
+   DOCTEST_CHECK( centers[ 2 ] == dip::UnsignedArray{ 60, 80 } );
+   DOCTEST_CHECK( out.DataType() == dip::DT_LABEL );
+   DOCTEST_CHECK( out.At( 20, 30 ) == 1 );
+   DOCTEST_CHECK( out.At( 90, 20 ) == 2 );
+   DOCTEST_CHECK( out.At( 60, 80 ) == 3 );
+   DOCTEST_CHECK( out.At( 119, 99 ) == 3 );
+}
+
+#endif // DIP_CONFIG_ENABLE_DOCTEST
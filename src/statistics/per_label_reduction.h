@@ -0,0 +1,149 @@
+/*
+ * (c)2026, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_PER_LABEL_REDUCTION_H
+#define DIP_PER_LABEL_REDUCTION_H
+
+#include <utility>
+#include <vector>
+
+#include "diplib.h"
+#include "diplib/framework.h"
+#include "diplib/private/robin_map.h"
+
+namespace dip {
+
+// A "group by label" reduction over the pixels of a grey-value image. Each thread accumulates into its own
+// `tsl::robin_map`, keyed by label, these are merged at the end. Only labels present in the image get an entry.
+//
+// `Accumulator` must be copy-constructible (each new label gets a copy of the prototype passed to the
+// constructor), and have these members:
+//    void Push( dfloat const* values, dip::sint tensorStride ); // adds one pixel, `values` has one value per tensor element
+//    void Merge( Accumulator& other );                          // adds the contents of `other`, which can be destroyed
+template< typename Accumulator >
+class PerLabelReductionLineFilter : public Framework::ScanLineFilter {
+   public:
+      using Map = tsl::robin_map< LabelType, Accumulator >;
+
+      PerLabelReductionLineFilter( Accumulator prototype, bool include0 ) : prototype_( std::move( prototype )), include0_( include0 ) {}
+
+      dip::uint GetNumberOfOperations( dip::uint /**/, dip::uint /**/, dip::uint tensorElements ) override {
+         return 10 + tensorElements * 4;
+      }
+      void SetNumberOfThreads( dip::uint threads ) override {
+         maps_.resize( threads );
+      }
+      void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         // 0: Grey image
+         dfloat const* grey = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint gStride = params.inBuffer[ 0 ].stride;
+         dip::sint tStride = params.inBuffer[ 0 ].tensorStride;
+         // 1: Label image
+         LabelType const* label = static_cast< LabelType const* >( params.inBuffer[ 1 ].buffer );
+         dip::sint lStride = params.inBuffer[ 1 ].stride;
+         // 2: Mask image
+         bool hasMask = params.inBuffer.size() > 2;
+         bin const* mask = hasMask ? static_cast< bin const* >( params.inBuffer[ 2 ].buffer ) : nullptr;
+         dip::sint mStride = hasMask ? params.inBuffer[ 2 ].stride : 0;
+         // Process. Consecutive pixels usually have the same label, we look up the accumulator only when it changes.
+         // The pointer to the accumulator is invalidated when adding a new element to the map, but then we
+         // update it anyway.
+         Map& map = maps_[ params.thread ];
+         Accumulator* accumulator = nullptr;
+         LabelType lastLabel = 0;
+         for( dip::uint ii = 0; ii < params.bufferLength; ++ii ) {
+            if( !hasMask || *mask ) {
+               LabelType lab = *label;
+               if( include0_ || ( lab != 0 )) {
+                  if( !accumulator || ( lab != lastLabel )) {
+                     auto it = map.find( lab );
+                     if( it == map.end() ) {
+                        it = map.emplace( lab, prototype_ ).first;
+                     }
+                     accumulator = &( it.value() );
+                     lastLabel = lab;
+                  }
+                  accumulator->Push( grey, tStride );
+               }
+            }
+            grey += gStride;
+            label += lStride;
+            mask += mStride;
+         }
+      }
+
+      // Merges the per-thread maps and returns the result. Call only once.
+      Map Result() {
+         if( maps_.empty() ) {
+            return {};
+         }
+         Map& out = maps_[ 0 ];
+         for( dip::uint ii = 1; ii < maps_.size(); ++ii ) {
+            for( auto it = maps_[ ii ].begin(); it != maps_[ ii ].end(); ++it ) {
+               auto dest = out.find( it->first );
+               if( dest == out.end() ) {
+                  out.emplace( it->first, std::move( it.value() ));
+               } else {
+                  dest.value().Merge( it.value() );
+               }
+            }
+            maps_[ ii ].clear();
+         }
+         return std::move( out );
+      }
+
+   private:
+      Accumulator prototype_;
+      bool include0_;
+      std::vector< Map > maps_;
+};
+
+// Runs the reduction over `grey` (real-valued, can be a tensor image), grouped by the labels in `label`,
+// optionally restricted by `mask`. Pixels with label 0 are ignored unless `include0` is set.
+template< typename Accumulator >
+tsl::robin_map< LabelType, Accumulator > PerLabelReduction(
+      Image const& grey,
+      Image const& label,
+      Image const& c_mask,
+      Accumulator prototype,
+      bool include0
+) {
+   DIP_THROW_IF( !label.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !label.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !label.DataType().IsUInt(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( !grey.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !grey.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   ImageConstRefArray inputs{ grey, label };
+   DataTypeArray inBufferTypes{ DT_DFLOAT, DT_LABEL };
+   Image mask;
+   if( c_mask.IsForged() ) {
+      mask = c_mask.QuickCopy();
+      DIP_START_STACK_TRACE
+         mask.CheckIsMask( grey.Sizes(), Option::AllowSingletonExpansion::DO_ALLOW, Option::ThrowException::DO_THROW );
+         mask.ExpandSingletonDimensions( grey.Sizes() );
+      DIP_END_STACK_TRACE
+      inputs.push_back( mask );
+      inBufferTypes.push_back( DT_BIN );
+   }
+   PerLabelReductionLineFilter< Accumulator > lineFilter( std::move( prototype ), include0 );
+   ImageRefArray outputs{};
+   DIP_STACK_TRACE_THIS( Framework::Scan( inputs, outputs, inBufferTypes, {}, {}, {}, lineFilter ));
+   return lineFilter.Result();
+}
+
+} // namespace dip
+
+#endif // DIP_PER_LABEL_REDUCTION_H
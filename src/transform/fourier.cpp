@@ -34,6 +34,7 @@
 #include "diplib/geometry.h"
 #include "diplib/math.h"
 #include "diplib/overload.h"
+#include "diplib/profiling.h"
 
 
 namespace dip {
@@ -84,13 +85,14 @@ void ShiftCenterToCorner( TPI* data, dip::uint length ) { // ifftshift
 
 template< typename TPI >
 void ShiftCornerToCenterHalfLine( TPI* data, dip::uint length ) { // fftshift & ifftshift, but for a half-line only
-   bool isOdd = length & 1u;
    length /= 2;  // the central pixel, the last value in the line that we'll use
    dip::uint jj = ( length + 1 ) / 2;  // the number of swaps
    for( dip::uint ii = 0; ii < jj; ++ii ) {
       std::swap( data[ ii ], data[ length - ii ] );
    }
-   for( dip::uint ii = 1; ii < ( length + isOdd ); ++ii ) {
+   // The origin and, for even lengths, the Nyquist frequency are self-conjugate, but for odd lengths the first
+   // element is not, so we conjugate the whole half-line
+   for( dip::uint ii = 0; ii <= length; ++ii ) {
       data[ ii ] = std::conj( data[ ii ] );
    }
 }
@@ -218,7 +220,7 @@ class C2C_DFT_LineFilter : public Framework::SeparableLineFilter {
          auto const& dft = dft_[ params.dimension ];
          dip::uint length = dft.TransformSize();
          DIP_ASSERT( params.inBuffer.length <= length );
-         DIP_ASSERT( params.outBuffer.length == length );
+         DIP_ASSERT(( params.outBuffer.length == length ) || ( params.outBuffer.length == length / 2 + 1 )); // full or half output
          TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
          dip::sint stride = params.inBuffer.stride;
          TPI* out = static_cast< TPI* >( params.outBuffer.buffer );
@@ -258,7 +260,7 @@ class R2C_DFT_LineFilter : public Framework::SeparableLineFilter {
       void Filter( Framework::SeparableLineFilterParameters const& params ) override {
          dip::uint length = dft_.TransformSize();
          DIP_ASSERT( params.inBuffer.length <= length );
-         DIP_ASSERT( params.outBuffer.length == length );
+         DIP_ASSERT(( params.outBuffer.length == length ) || ( params.outBuffer.length == length / 2 + 1 )); // full or half output
          TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
          dip::sint stride = params.inBuffer.stride;
          TPI* outR = static_cast< TPI* >( params.outBuffer.buffer ); // view of complex output data as a real array with double the elements
@@ -352,6 +354,7 @@ void DFT_R2C_1D_compute(
       Image const& in,     // real-valued
       Image& out,          // the first half of the image is filled in, pixels 0 through size/2+1
       dip::uint dimension, // dimension along which to compute
+      dip::uint length,    // transform size, either `out.Size(dimension)` or `out.Size(dimension)==length/2+1`
       bool corner,         // where to put the origin
       dfloat scale
 ) {
@@ -372,7 +375,7 @@ void DFT_R2C_1D_compute(
       dip::Image tmp = out.At( window );
       // Get callback function
       std::unique_ptr< Framework::SeparableLineFilter > lineFilter;
-      DIP_OVL_NEW_FLOAT( lineFilter, R2C_DFT_LineFilter, ( tmp.Size( dimension ), corner, scale ), dtype );
+      DIP_OVL_NEW_FLOAT( lineFilter, R2C_DFT_LineFilter, ( length, corner, scale ), dtype );
       Framework::OneDimensionalLineFilter( in, tmp, dtype, outType, outType, dimension, 0, DFT_PADDING_MODE, *lineFilter,
                                            Framework::SeparableOption::UseOutputBuffer +  // output stride is always 1, buffer is aligned
                                            Framework::SeparableOption::DontResizeOutput + // output is potentially larger than input, if padding with zeros
@@ -479,15 +482,15 @@ void IDFT_C2R_1D_compute(
    DIP_END_STACK_TRACE
 }
 
-} // namespace
-
-void FourierTransform(
+// `sizes` is only used for the inverse transform of a half spectrum, it gives the sizes of the full spectrum.
+// If empty, an even size is assumed along the half dimension.
+void FourierTransformInternal(
       Image const& in,
       Image& out,
       StringSet const& options,
-      BooleanArray process
+      BooleanArray process,
+      UnsignedArray const& sizes
 ) {
-   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    dip::uint nDims = in.Dimensionality();
    DIP_THROW_IF( nDims < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
    // Read `options` set
@@ -496,6 +499,7 @@ void FourierTransform(
    bool fast = false; // pad the image to a "nice" size?
    bool corner = false;
    bool symmetric = false;
+   bool half = false; // half-spectrum representation?
    for( auto const& option : options ) {
       if( option == S::INVERSE ) {
          inverse = true;
@@ -507,6 +511,8 @@ void FourierTransform(
          corner = true;
       } else if( option == S::SYMMETRIC ) {
          symmetric = true;
+      } else if( option == S::HALF ) {
+         half = true;
       } else {
          DIP_THROW_INVALID_FLAG( option );
       }
@@ -514,11 +520,14 @@ void FourierTransform(
    if( inverse ) {
       // If the output is protected and real-valued, compute a real-valued inverse transform
       realOutput |= out.IsProtected() && !out.DataType().IsComplex();
+      // The inverse of a half spectrum is always real-valued
+      realOutput |= half;
    } else {
       DIP_THROW_IF( realOutput, "Cannot use 'real' without 'inverse' option" );
    }
    bool realInput = !inverse && !in.DataType().IsComplex(); // forward transform starting with real-valued data?
    DIP_ASSERT( !( realOutput && realInput )); // can't do real-to-real DFT.
+   DIP_THROW_IF( half && !inverse && !realInput, "Cannot use 'half' with a complex-valued input image" );
    // Handle `process` array
    if( process.empty() ) {
       process.resize( nDims, true );
@@ -528,11 +537,34 @@ void FourierTransform(
    dip::uint nProcDims = process.count();
    DIP_THROW_IF( nProcDims == 0, "Zero dimensions selected for processing" );
 
+   // For a half spectrum, the R2C or C2R dimension is always the first processed dimension
+   dip::uint halfDimension = 0;
+   while( !process[ halfDimension ] ) {
+      ++halfDimension;
+   }
+   UnsignedArray inSizes = in.Sizes(); // For the inverse transform of a half spectrum, these are the sizes of the full spectrum
+   if( half && inverse ) {
+      if( sizes.empty() ) {
+         // The half spectrum doesn't record whether the full spectrum had an odd size. We assume an even size.
+         dip::uint halfSize = inSizes[ halfDimension ];
+         inSizes[ halfDimension ] = halfSize > 1 ? 2 * ( halfSize - 1 ) : 1;
+      } else {
+         DIP_THROW_IF( sizes.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            dip::uint expected = ii == halfDimension ? sizes[ ii ] / 2 + 1 : sizes[ ii ];
+            DIP_THROW_IF( inSizes[ ii ] != expected, E::SIZES_DONT_MATCH );
+         }
+         inSizes = sizes;
+      }
+   } else {
+      DIP_ASSERT( sizes.empty() );
+   }
+
    // Determine output size and scaling
    dip::uint optimalDimension = 0;  // The dimension with the smallest stride is the best to do the R2C or C2R transform on.
                                     // Of course this should probably be the stride of the intermediate (C2R) or output (R2C)
                                     // image, but we haven't allocated those yet... So we look at the input strides?
-   UnsignedArray outSize = in.Sizes();
+   UnsignedArray outSize = inSizes;
    dfloat scale = 1.0;
    dip::uint maxFactor = fast ? MaxFactor( !realInput && !realOutput ) : 2; // Unused if !fast.
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
@@ -558,6 +590,9 @@ void FourierTransform(
          scale /= static_cast< dfloat >( outSize[ ii ] );
       }
    }
+   if( half ) {
+      optimalDimension = halfDimension;
+   }
    if( symmetric ) {
       scale = std::sqrt( scale );
    } else if( !inverse ) {
@@ -570,15 +605,19 @@ void FourierTransform(
       // Real-to-complex transform
 
       // Create complex-valued output, all processing happens in here
-      DIP_STACK_TRACE_THIS( out.ReForge( outSize, in_copy.TensorElements(), DataType::SuggestComplex( in.DataType() ), Option::AcceptDataTypeChange::DO_ALLOW ));
+      UnsignedArray outImageSize = outSize;
+      if( half ) {
+         outImageSize[ optimalDimension ] = outSize[ optimalDimension ] / 2 + 1;
+      }
+      DIP_STACK_TRACE_THIS( out.ReForge( outImageSize, in_copy.TensorElements(), DataType::SuggestComplex( in.DataType() ), Option::AcceptDataTypeChange::DO_ALLOW ));
       DIP_THROW_IF( !out.DataType().IsComplex(), "Cannot compute Fourier Transform in real-valued output" );
       Image tmp = out.QuickCopy();
       tmp.Protect(); // make sure it won't be reforged by the framework function.
       // One dimension we process with the R2C function
-      DIP_STACK_TRACE_THIS( DFT_R2C_1D_compute( in_copy, tmp, optimalDimension, corner, scale ));
+      DIP_STACK_TRACE_THIS( DFT_R2C_1D_compute( in_copy, tmp, optimalDimension, outSize[ optimalDimension ], corner, scale ));
       // Make window over half the image
       RangeArray window( nDims );
-      window[ optimalDimension ].stop = static_cast< dip::sint >( tmp.Size( optimalDimension ) / 2 );
+      window[ optimalDimension ].stop = static_cast< dip::sint >( outSize[ optimalDimension ] / 2 );
       Image tmp2;
       DIP_STACK_TRACE_THIS( tmp2 = tmp.At( window ));
       tmp2.Protect();
@@ -588,14 +627,16 @@ void FourierTransform(
          DIP_STACK_TRACE_THIS( DFT_C2C_compute( tmp2, tmp2, process, inverse, corner, 1.0 ));
       }
       // Copy data to other half of image
-      DIP_STACK_TRACE_THIS( DFT_R2C_1D_finalize( tmp, process, optimalDimension, corner ));
+      if( !half ) {
+         DIP_STACK_TRACE_THIS( DFT_R2C_1D_finalize( tmp, process, optimalDimension, corner ));
+      }
       process[ optimalDimension ] = true; // reset to ensure pixel size is updated along this dimension
 
    } else if( realOutput ) {
       // Complex-to-real transform
 
       // Make a window of about half of the input
-      dip::uint optimalDimSize = in.Size( optimalDimension );
+      dip::uint optimalDimSize = inSizes[ optimalDimension ];
       RangeArray window( nDims );
       window[ optimalDimension ].stop = static_cast< dip::sint >( optimalDimSize / 2 );
       Image tmpIn;
@@ -634,7 +675,7 @@ void FourierTransform(
    PixelSize pixelSize = in_copy.PixelSize();
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       if( process[ ii ] ) {
-         pixelSize.Scale( ii, static_cast< dfloat >( out.Size( ii )));
+         pixelSize.Scale( ii, static_cast< dfloat >( outSize[ ii ] ));
          pixelSize.Invert( ii );
       }
    }
@@ -647,6 +688,33 @@ void FourierTransform(
    }
 }
 
+} // namespace
+
+void FourierTransform(
+      Image const& in,
+      Image& out,
+      StringSet const& options,
+      BooleanArray process
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   profiling::Region region( "dip::FourierTransform", in );
+   DIP_STACK_TRACE_THIS( FourierTransformInternal( in, out, options, std::move( process ), {} ));
+}
+
+void InverseHalfFourierTransform(
+      Image const& in,
+      Image& out,
+      UnsignedArray const& sizes,
+      StringSet options,
+      BooleanArray process
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   profiling::Region region( "dip::InverseHalfFourierTransform", in );
+   options.insert( S::INVERSE );
+   options.insert( S::HALF );
+   DIP_STACK_TRACE_THIS( FourierTransformInternal( in, out, options, std::move( process ), sizes ));
+}
+
 
 dip::uint OptimalFourierTransformSize( dip::uint size, dip::String const& which, dip::String const& purpose ) {
    bool larger = BooleanFromString( which, S::LARGER, S::SMALLER );
@@ -1013,4 +1081,43 @@ DOCTEST_TEST_CASE("[DIPlib] testing the FourierTransform function (3D image, 1D
    DOCTEST_CHECK( maxabs < 2e-18 );
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the FourierTransform function (half option)") {
+   for( dip::uint width : { 32u, 33u } ) {
+      for( bool corner : { false, true } ) {
+         dip::StringSet options;
+         if( corner ) {
+            options.insert( "corner" );
+         }
+         dip::Image input( { width, 25, 3 }, 1, dip::DT_DFLOAT );
+         dip::Random random( 0 );
+         input.Fill( 0 );
+         dip::UniformNoise( input, input, random );
+         dip::BooleanArray process{ true, true, false };
+         dip::Image full = dip::FourierTransform( input, options, process );
+         dip::StringSet halfOptions = options;
+         halfOptions.insert( "half" );
+         dip::Image half = dip::FourierTransform( input, halfOptions, process );
+         DOCTEST_REQUIRE( half.Sizes() == dip::UnsignedArray{ width / 2 + 1, 25, 3 } );
+         DOCTEST_CHECK( half.PixelSize() == full.PixelSize() );
+         dip::RangeArray window( 3 );
+         window[ 0 ].stop = static_cast< dip::sint >( width / 2 );
+         DOCTEST_CHECK( dip::MaximumAbs( half - full.At( window )).As< double >() < 1e-12 );
+         // Inverse transform
+         dip::Image output;
+         dip::InverseHalfFourierTransform( half, output, input.Sizes(), options, process );
+         DOCTEST_CHECK( output.DataType() == dip::DT_DFLOAT );
+         DOCTEST_REQUIRE( output.Sizes() == input.Sizes() );
+         DOCTEST_CHECK( dip::MaximumAbs( output - input ).As< double >() < 1e-14 );
+         // Without explicit sizes, an even size is assumed
+         halfOptions.insert( "inverse" );
+         dip::FourierTransform( half, output, halfOptions, process );
+         DOCTEST_CHECK( output.Size( 0 ) == 2 * ( width / 2 ));
+      }
+   }
+   // Complex input is not accepted
+   dip::Image input( { 10, 12 }, 1, dip::DT_SCOMPLEX );
+   dip::Image output;
+   DOCTEST_CHECK_THROWS( dip::FourierTransform( input, output, { "half" } ));
+}
+
 #endif // DIP_CONFIG_ENABLE_DOCTEST